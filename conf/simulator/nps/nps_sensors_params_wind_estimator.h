@@ -113,6 +113,8 @@
 #define NPS_MAG_NEUTRAL_Y  IMU_MAG_Y_NEUTRAL
 #define NPS_MAG_NEUTRAL_Z  IMU_MAG_Z_NEUTRAL
 
+/* white noise on the normalized field, applied since the sensors draw from
+ * their own noise streams (it was ignored before), 0 for noise free readings */
 #define NPS_MAG_NOISE_STD_DEV_X  2e-3
 #define NPS_MAG_NOISE_STD_DEV_Y  2e-3
 #define NPS_MAG_NOISE_STD_DEV_Z  2e-3
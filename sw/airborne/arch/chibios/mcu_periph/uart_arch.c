@@ -978,6 +978,34 @@ uint8_t uart_getch(struct uart_periph *p)
   return ret;
 }
 
+/**
+ * Get received data without copy
+ */
+uint16_t uart_rx_span(struct uart_periph *p, uint8_t **data)
+{
+  struct SerialInit *init_struct = (struct SerialInit *)(p->init_struct);
+  chMtxLock(init_struct->rx_mtx);
+  uint16_t insert = p->rx_insert_idx;
+  uint16_t extract = p->rx_extract_idx;
+  chMtxUnlock(init_struct->rx_mtx);
+  *data = &p->rx_buf[extract];
+  if (insert >= extract) {
+    return insert - extract;
+  }
+  return UART_RX_BUFFER_SIZE - extract;
+}
+
+/**
+ * Release data read with uart_rx_span
+ */
+void uart_rx_consume(struct uart_periph *p, uint16_t len)
+{
+  struct SerialInit *init_struct = (struct SerialInit *)(p->init_struct);
+  chMtxLock(init_struct->rx_mtx);
+  p->rx_extract_idx = (p->rx_extract_idx + len) % UART_RX_BUFFER_SIZE;
+  chMtxUnlock(init_struct->rx_mtx);
+}
+
 /**
  * Set baudrate
  */
@@ -28,6 +28,7 @@
  */
 
 #include "mcu_arch.h"
+#include "rt_priority.h"
 
 #if USE_LINUX_SIGNAL
 #include "message_pragmas.h"
@@ -63,6 +64,8 @@ static void sig_handler(int signo)
 
 void mcu_arch_init(void)
 {
+  rt_process_setup();
+
   struct sigaction sa;
   sigemptyset(&sa.sa_mask);
   sa.sa_flags = 0;
@@ -74,7 +77,10 @@ void mcu_arch_init(void)
 
 #else
 
-void mcu_arch_init(void) { }
+void mcu_arch_init(void)
+{
+  rt_process_setup();
+}
 
 #endif
 
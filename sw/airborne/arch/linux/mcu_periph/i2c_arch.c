@@ -50,10 +50,17 @@ static void i2c_linux_setbitrate(struct i2c_periph *p  __attribute__((unused)),
 
 static void *i2c_thread(void *thread_data);
 
-// private I2C init structure
+/** private I2C init structure
+ *
+ * The transactions queued when the thread wakes up can be transferred by
+ * batch, with a single I2C_RDWR ioctl (repeated start between the
+ * transactions instead of stop/start).
+ * A failed batch fails all its transactions.
+ */
 struct i2c_thread_t {
   pthread_mutex_t mutex;
   pthread_cond_t condition;
+  uint8_t batch_len;  ///< max number of transactions per ioctl, 1 to transfer them one by one
 };
 
 static void UNUSED i2c_arch_init(struct i2c_periph *p)
@@ -111,100 +118,165 @@ static bool i2c_linux_submit(struct i2c_periph *p, struct i2c_transaction *t)
   return true;
 }
 
-/*
- * Transactions handler thread
- */
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wcast-qual"
-static void *i2c_thread(void *data)
+/** transfer a single transaction */
+static void i2c_linux_transfer(struct i2c_periph *p, int fd, struct i2c_transaction *t)
 {
+  pthread_mutex_t *mutex = &(((struct i2c_thread_t *)(p->init_struct))->mutex);
   struct i2c_msg trx_msgs[2];
   struct i2c_rdwr_ioctl_data trx_data = {
     .msgs = trx_msgs,
     .nmsgs = 2
   };
 
-  get_rt_prio(I2C_THREAD_PRIO);
+  // Switch the different transaction types
+  switch (t->type) {
+    // Just transmitting
+    case I2CTransTx:
+      // Set the slave address, converted to 7 bit
+      ioctl(fd, I2C_SLAVE, t->slave_addr >> 1);
+      if (write(fd, (uint8_t *)t->buf, t->len_w) < 0) {
+        /* if write failed, increment error counter ack_fail_cnt */
+        pthread_mutex_lock(mutex);
+        p->errors->ack_fail_cnt++;
+        pthread_mutex_unlock(mutex);
+        t->status = I2CTransFailed;
+      } else {
+        t->status = I2CTransSuccess;
+      }
+      break;
+    // Just reading
+    case I2CTransRx:
+      // Set the slave address, converted to 7 bit
+      ioctl(fd, I2C_SLAVE, t->slave_addr >> 1);
+      if (read(fd, (uint8_t *)t->buf, t->len_r) < 0) {
+        /* if read failed, increment error counter arb_lost_cnt */
+        pthread_mutex_lock(mutex);
+        p->errors->arb_lost_cnt++;
+        pthread_mutex_unlock(mutex);
+        t->status = I2CTransFailed;
+      } else {
+        t->status = I2CTransSuccess;
+      }
+      break;
+    // First Transmit and then read with repeated start
+    case I2CTransTxRx:
+      trx_msgs[0].addr = t->slave_addr >> 1;
+      trx_msgs[0].flags = 0; /* tx */
+      trx_msgs[0].len = t->len_w;
+      trx_msgs[0].buf = (void *) t->buf;
+      trx_msgs[1].addr = t->slave_addr >> 1;
+      trx_msgs[1].flags = I2C_M_RD;
+      trx_msgs[1].len = t->len_r;
+      trx_msgs[1].buf = (void *) t->buf;
+      if (ioctl(fd, I2C_RDWR, &trx_data) < 0) {
+        /* if write/read failed, increment error counter miss_start_stop_cnt */
+        pthread_mutex_lock(mutex);
+        p->errors->miss_start_stop_cnt++;
+        pthread_mutex_unlock(mutex);
+        t->status = I2CTransFailed;
+      } else {
+        t->status = I2CTransSuccess;
+      }
+      break;
+    default:
+      t->status = I2CTransFailed;
+      break;
+  }
+}
+
+/** transfer several transactions with a single ioctl */
+static void i2c_linux_transfer_batch(struct i2c_periph *p, int fd, struct i2c_transaction **trans, uint8_t nb)
+{
+  struct i2c_msg msgs[2 * I2C_TRANSACTION_QUEUE_LEN];
+  struct i2c_rdwr_ioctl_data data = {
+    .msgs = msgs,
+    .nmsgs = 0
+  };
+
+  for (uint8_t i = 0; i < nb; i++) {
+    struct i2c_transaction *t = trans[i];
+    if (t->type == I2CTransTx || t->type == I2CTransTxRx) {
+      msgs[data.nmsgs].addr = t->slave_addr >> 1;
+      msgs[data.nmsgs].flags = 0; /* tx */
+      msgs[data.nmsgs].len = t->len_w;
+      msgs[data.nmsgs].buf = (void *) t->buf;
+      data.nmsgs++;
+    }
+    if (t->type == I2CTransRx || t->type == I2CTransTxRx) {
+      msgs[data.nmsgs].addr = t->slave_addr >> 1;
+      msgs[data.nmsgs].flags = I2C_M_RD;
+      msgs[data.nmsgs].len = t->len_r;
+      msgs[data.nmsgs].buf = (void *) t->buf;
+      data.nmsgs++;
+    }
+  }
+
+  enum I2CTransactionStatus status = I2CTransSuccess;
+  if (ioctl(fd, I2C_RDWR, &data) < 0) {
+    /* if the batch failed, increment error counter miss_start_stop_cnt */
+    pthread_mutex_t *mutex = &(((struct i2c_thread_t *)(p->init_struct))->mutex);
+    pthread_mutex_lock(mutex);
+    p->errors->miss_start_stop_cnt++;
+    pthread_mutex_unlock(mutex);
+    status = I2CTransFailed;
+  }
+  for (uint8_t i = 0; i < nb; i++) {
+    trans[i]->status = status;
+  }
+}
+#pragma GCC diagnostic pop
+
+/*
+ * Transactions handler thread
+ */
+static void *i2c_thread(void *data)
+{
+  rt_thread_setup(I2C_THREAD_PRIO, RT_CPUS_IO);
 
   struct i2c_periph *p = (struct i2c_periph *)data;
-  pthread_mutex_t *mutex = &(((struct i2c_thread_t *)(p->init_struct))->mutex);
-  pthread_cond_t *condition = &(((struct i2c_thread_t *)(p->init_struct))->condition);
+  struct i2c_thread_t *thread = (struct i2c_thread_t *)(p->init_struct);
+  pthread_mutex_t *mutex = &thread->mutex;
+  pthread_cond_t *condition = &thread->condition;
+  struct i2c_transaction *trans[I2C_TRANSACTION_QUEUE_LEN];
 
   while (1) {
     /* wait for data to transfer */
     pthread_mutex_lock(mutex);
-    if (p->trans_insert_idx == p->trans_extract_idx) {
+    while (p->trans_insert_idx == p->trans_extract_idx) {
       pthread_cond_wait(condition, mutex);
     }
 
     int fd = (int)p->reg_addr;
-    struct i2c_transaction *t = p->trans[p->trans_extract_idx];
+    uint8_t nb = 0;
+    uint8_t idx = p->trans_extract_idx;
+    while (idx != p->trans_insert_idx && nb < thread->batch_len) {
+      trans[nb++] = p->trans[idx];
+      idx = (idx + 1) % I2C_TRANSACTION_QUEUE_LEN;
+    }
     pthread_mutex_unlock(mutex);
 
-    // Switch the different transaction types
-    switch (t->type) {
-      // Just transmitting
-      case I2CTransTx:
-        // Set the slave address, converted to 7 bit
-        ioctl(fd, I2C_SLAVE, t->slave_addr >> 1);
-        if (write(fd, (uint8_t *)t->buf, t->len_w) < 0) {
-          /* if write failed, increment error counter ack_fail_cnt */
-          pthread_mutex_lock(mutex);
-          p->errors->ack_fail_cnt++;
-          pthread_mutex_unlock(mutex);
-          t->status = I2CTransFailed;
-        } else {
-          t->status = I2CTransSuccess;
-        }
-        break;
-      // Just reading
-      case I2CTransRx:
-        // Set the slave address, converted to 7 bit
-        ioctl(fd, I2C_SLAVE, t->slave_addr >> 1);
-        if (read(fd, (uint8_t *)t->buf, t->len_r) < 0) {
-          /* if read failed, increment error counter arb_lost_cnt */
-          pthread_mutex_lock(mutex);
-          p->errors->arb_lost_cnt++;
-          pthread_mutex_unlock(mutex);
-          t->status = I2CTransFailed;
-        } else {
-          t->status = I2CTransSuccess;
-        }
-        break;
-      // First Transmit and then read with repeated start
-      case I2CTransTxRx:
-        trx_msgs[0].addr = t->slave_addr >> 1;
-        trx_msgs[0].flags = 0; /* tx */
-        trx_msgs[0].len = t->len_w;
-        trx_msgs[0].buf = (void *) t->buf;
-        trx_msgs[1].addr = t->slave_addr >> 1;
-        trx_msgs[1].flags = I2C_M_RD;
-        trx_msgs[1].len = t->len_r;
-        trx_msgs[1].buf = (void *) t->buf;
-        if (ioctl(fd, I2C_RDWR, &trx_data) < 0) {
-          /* if write/read failed, increment error counter miss_start_stop_cnt */
-          pthread_mutex_lock(mutex);
-          p->errors->miss_start_stop_cnt++;
-          pthread_mutex_unlock(mutex);
-          t->status = I2CTransFailed;
-        } else {
-          t->status = I2CTransSuccess;
-        }
-        break;
-      default:
-        t->status = I2CTransFailed;
-        break;
+    // a single transaction keeps the usual read/write calls
+    if (nb > 1) {
+      i2c_linux_transfer_batch(p, fd, trans, nb);
+    } else {
+      i2c_linux_transfer(p, fd, trans[0]);
     }
 
     pthread_mutex_lock(mutex);
-    p->trans_extract_idx = (p->trans_extract_idx + 1) % I2C_TRANSACTION_QUEUE_LEN;
+    p->trans_extract_idx = idx;
     pthread_mutex_unlock(mutex);
   }
   return NULL;
 }
-#pragma GCC diagnostic pop
 
 #if USE_I2C0
+/** max number of transactions transferred with a single ioctl */
+#ifndef I2C0_BATCH_LEN
+#define I2C0_BATCH_LEN 1
+#endif
+
 struct i2c_errors i2c0_errors;
 struct i2c_thread_t i2c0_thread;
 
@@ -222,6 +294,7 @@ void i2c0_hw_init(void)
 
   pthread_mutex_init(&i2c0_thread.mutex, NULL);
   pthread_cond_init(&i2c0_thread.condition, NULL);
+  i2c0_thread.batch_len = Max(1, Min(I2C0_BATCH_LEN, I2C_TRANSACTION_QUEUE_LEN - 1));
   i2c0.init_struct = (void *)(&i2c0_thread);
 
   i2c_arch_init(&i2c0);
@@ -229,6 +302,11 @@ void i2c0_hw_init(void)
 #endif
 
 #if USE_I2C1
+/** max number of transactions transferred with a single ioctl */
+#ifndef I2C1_BATCH_LEN
+#define I2C1_BATCH_LEN 1
+#endif
+
 struct i2c_errors i2c1_errors;
 struct i2c_thread_t i2c1_thread;
 
@@ -246,6 +324,7 @@ void i2c1_hw_init(void)
 
   pthread_mutex_init(&i2c1_thread.mutex, NULL);
   pthread_cond_init(&i2c1_thread.condition, NULL);
+  i2c1_thread.batch_len = Max(1, Min(I2C1_BATCH_LEN, I2C_TRANSACTION_QUEUE_LEN - 1));
   i2c1.init_struct = (void *)(&i2c1_thread);
 
   i2c_arch_init(&i2c1);
@@ -253,6 +332,11 @@ void i2c1_hw_init(void)
 #endif
 
 #if USE_I2C2
+/** max number of transactions transferred with a single ioctl */
+#ifndef I2C2_BATCH_LEN
+#define I2C2_BATCH_LEN 1
+#endif
+
 struct i2c_errors i2c2_errors;
 struct i2c_thread_t i2c2_thread;
 
@@ -270,6 +354,7 @@ void i2c2_hw_init(void)
 
   pthread_mutex_init(&i2c2_thread.mutex, NULL);
   pthread_cond_init(&i2c2_thread.condition, NULL);
+  i2c2_thread.batch_len = Max(1, Min(I2C2_BATCH_LEN, I2C_TRANSACTION_QUEUE_LEN - 1));
   i2c2.init_struct = (void *)(&i2c2_thread);
 
   i2c_arch_init(&i2c2);
@@ -277,6 +362,11 @@ void i2c2_hw_init(void)
 #endif
 
 #if USE_I2C3
+/** max number of transactions transferred with a single ioctl */
+#ifndef I2C3_BATCH_LEN
+#define I2C3_BATCH_LEN 1
+#endif
+
 struct i2c_errors i2c3_errors;
 struct i2c_thread_t i2c3_thread;
 
@@ -294,6 +384,7 @@ void i2c3_hw_init(void)
 
   pthread_mutex_init(&i2c3_thread.mutex, NULL);
   pthread_cond_init(&i2c3_thread.condition, NULL);
+  i2c3_thread.batch_len = Max(1, Min(I2C3_BATCH_LEN, I2C_TRANSACTION_QUEUE_LEN - 1));
   i2c3.init_struct = (void *)(&i2c3_thread);
 
   i2c_arch_init(&i2c3);
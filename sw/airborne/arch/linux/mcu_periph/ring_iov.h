@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/** @file arch/linux/mcu_periph/ring_iov.h
+ * Helpers for the single producer / single consumer rings of the linux peripherals.
+ *
+ * The rings are the usual insert/extract index buffers of the peripherals
+ * (one slot is kept empty). Each side only writes its own index and reads
+ * the other one with acquire semantics, so that no lock is needed between
+ * the reading thread and the main thread.
+ * The free and used parts of a ring are described as (at most) two iovecs,
+ * so that a ring can be filled or drained with a single readv/writev call.
+ */
+
+#ifndef RING_IOV_H
+#define RING_IOV_H
+
+#include <stdint.h>
+#include <sys/uio.h>
+
+#define RING_LOAD(_idx) __atomic_load_n(&(_idx), __ATOMIC_ACQUIRE)
+#define RING_STORE(_idx, _v) __atomic_store_n(&(_idx), (_v), __ATOMIC_RELEASE)
+
+/** Number of bytes in the ring */
+static inline uint16_t ring_used(uint16_t size, uint16_t insert, uint16_t extract)
+{
+  return (uint16_t)((insert + size - extract) % size);
+}
+
+/** Number of free bytes in the ring */
+static inline uint16_t ring_free(uint16_t size, uint16_t insert, uint16_t extract)
+{
+  return size - 1 - ring_used(size, insert, extract);
+}
+
+/**
+ * Describe the free space of the ring, starting at the insert index.
+ * @return number of iovecs (0 if the ring is full)
+ */
+static inline int ring_free_iov(uint8_t *buf, uint16_t size, uint16_t insert, uint16_t extract,
+                                struct iovec iov[2])
+{
+  int nb = 0;
+  if (extract > insert) {
+    if (extract - insert > 1) {
+      iov[0].iov_base = buf + insert;
+      iov[0].iov_len = extract - insert - 1;
+      nb = 1;
+    }
+    return nb;
+  }
+  // free space up to the end of the buffer, then before extract
+  uint16_t end = (extract == 0) ? size - 1 : size;
+  if (end > insert) {
+    iov[nb].iov_base = buf + insert;
+    iov[nb].iov_len = end - insert;
+    nb++;
+  }
+  if (extract > 1) {
+    iov[nb].iov_base = buf;
+    iov[nb].iov_len = extract - 1;
+    nb++;
+  }
+  return nb;
+}
+
+/**
+ * Describe the data of the ring, starting at the extract index.
+ * @return number of iovecs (0 if the ring is empty)
+ */
+static inline int ring_used_iov(uint8_t *buf, uint16_t size, uint16_t insert, uint16_t extract,
+                                struct iovec iov[2])
+{
+  int nb = 0;
+  if (insert >= extract) {
+    if (insert > extract) {
+      iov[0].iov_base = buf + extract;
+      iov[0].iov_len = insert - extract;
+      nb = 1;
+    }
+    return nb;
+  }
+  iov[nb].iov_base = buf + extract;
+  iov[nb].iov_len = size - extract;
+  nb++;
+  if (insert > 0) {
+    iov[nb].iov_base = buf;
+    iov[nb].iov_len = insert;
+    nb++;
+  }
+  return nb;
+}
+
+#endif /* RING_IOV_H */
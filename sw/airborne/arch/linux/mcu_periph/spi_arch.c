@@ -36,6 +36,21 @@
 #include BOARD_CONFIG
 
 
+/**
+ * Linux specific data of a SPI peripheral.
+ *
+ * Transactions are either transferred immediately when submitted, or queued
+ * and transferred by batch with a single SPI_IOC_MESSAGE(n) ioctl, when the
+ * batch is full or at the end of the event loop (spi_event).
+ * Batching saves a kernel round trip per transaction, but the transactions
+ * only complete in the next event loop, so it is not suited to drivers
+ * waiting actively for the end of a transaction.
+ */
+struct spi_linux_periph {
+  uint32_t speed_hz;          ///< transfer speed
+  uint8_t batch_len;          ///< max number of transactions per ioctl, 1 for immediate transfers
+};
+
 void spi_init_slaves(void)
 {
   /* for now we assume that each SPI device has it's SLAVE CS already set up
@@ -43,65 +58,139 @@ void spi_init_slaves(void)
    */
 }
 
+static uint8_t spi_linux_queued(struct spi_periph *p)
+{
+  return (p->trans_insert_idx + SPI_TRANSACTION_QUEUE_LEN - p->trans_extract_idx) % SPI_TRANSACTION_QUEUE_LEN;
+}
+
+/** transfer all the queued transactions with a single ioctl */
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wcast-qual"
-bool spi_submit(struct spi_periph *p, struct spi_transaction *t)
+static bool spi_linux_flush(struct spi_periph *p)
 {
+  uint8_t nb = spi_linux_queued(p);
+  if (nb == 0) {
+    return true;
+  }
   int fd = (int)p->reg_addr;
-
-  struct spi_ioc_transfer xfer;
-  memset(&xfer, 0, sizeof xfer);
-
-  /* length in bytes of transaction */
-  uint16_t buf_len = Max(t->input_length, t->output_length);
-
-  // temp buffers, used if necessary
-  uint8_t tx_buf[buf_len], rx_buf[buf_len];
-  memset(tx_buf, 0, buf_len);
-  memset(rx_buf, 0, buf_len);
-
-  /* handle transactions with different input/output length */
-  if (buf_len > t->output_length) {
-    /* copy bytes to transmit to larger buffer, rest filled with zero */
-    memcpy(tx_buf, (void *)t->output_buf, t->output_length);
-    xfer.tx_buf = (unsigned long)tx_buf;
-  } else {
-    xfer.tx_buf = (unsigned long)t->output_buf;
+  struct spi_linux_periph *lp = (struct spi_linux_periph *)p->init_struct;
+
+  // dequeue first, callbacks are allowed to submit new transactions
+  struct spi_transaction *trans[nb];
+  uint16_t tmp_len = 0;
+  for (uint8_t i = 0; i < nb; i++) {
+    struct spi_transaction *t = p->trans[(p->trans_extract_idx + i) % SPI_TRANSACTION_QUEUE_LEN];
+    uint16_t buf_len = Max(t->input_length, t->output_length);
+    if (buf_len > t->output_length) { tmp_len += buf_len; }
+    if (buf_len > t->input_length) { tmp_len += buf_len; }
+    trans[i] = t;
   }
-
-  if (buf_len > t->input_length) {
-    xfer.rx_buf = (unsigned long)rx_buf;
-  } else {
-    xfer.rx_buf = (unsigned long)t->input_buf;
+  p->trans_extract_idx = p->trans_insert_idx;
+
+  struct spi_ioc_transfer xfer[nb];
+  memset(xfer, 0, sizeof xfer);
+
+  // temp buffers, used for transactions with different input/output length
+  uint8_t tmp_buf[tmp_len + 1];
+  memset(tmp_buf, 0, tmp_len + 1);
+  uint8_t *tmp = tmp_buf;
+
+  for (uint8_t i = 0; i < nb; i++) {
+    struct spi_transaction *t = trans[i];
+    if (t->before_cb != NULL) {
+      t->before_cb(t);
+    }
+    t->status = SPITransRunning;
+
+    /* length in bytes of transaction */
+    uint16_t buf_len = Max(t->input_length, t->output_length);
+
+    /* handle transactions with different input/output length */
+    if (buf_len > t->output_length) {
+      /* copy bytes to transmit to larger buffer, rest filled with zero */
+      memcpy(tmp, (void *)t->output_buf, t->output_length);
+      xfer[i].tx_buf = (unsigned long)tmp;
+      tmp += buf_len;
+    } else {
+      xfer[i].tx_buf = (unsigned long)t->output_buf;
+    }
+
+    if (buf_len > t->input_length) {
+      xfer[i].rx_buf = (unsigned long)tmp;
+      tmp += buf_len;
+    } else {
+      xfer[i].rx_buf = (unsigned long)t->input_buf;
+    }
+
+    xfer[i].len = buf_len;
+    xfer[i].speed_hz = lp->speed_hz;
+    xfer[i].delay_usecs = 0;
+    if (t->dss == SPIDss16bit) {
+      xfer[i].bits_per_word = 16;
+    } else {
+      xfer[i].bits_per_word = 8;
+    }
+    if (i < nb - 1) {
+      /* release CS between the transactions of a batch */
+      xfer[i].cs_change = (t->select != SPISelect);
+    } else if (t->select == SPISelectUnselect || t->select == SPIUnselect) {
+      xfer[i].cs_change = 1;
+    }
   }
 
-  xfer.len = buf_len;
-  /* fixed speed of 1Mhz for now, use SPIClockDiv?? */
-  xfer.speed_hz = (uint32_t)p->init_struct;
-  xfer.delay_usecs = 0;
-  if (t->dss == SPIDss16bit) {
-    xfer.bits_per_word = 16;
-  } else {
-    xfer.bits_per_word = 8;
-  }
-  if (t->select == SPISelectUnselect || t->select == SPIUnselect) {
-    xfer.cs_change = 1;
+  bool ok = (ioctl(fd, SPI_IOC_MESSAGE(nb), xfer) >= 0);
+
+  for (uint8_t i = 0; i < nb; i++) {
+    struct spi_transaction *t = trans[i];
+    if (ok) {
+      /* copy received data if we had to use an extra rx_buffer */
+      if (Max(t->input_length, t->output_length) > t->input_length) {
+        memcpy((void *)t->input_buf, (void *)(unsigned long)xfer[i].rx_buf, t->input_length);
+      }
+      t->status = SPITransSuccess;
+    } else {
+      t->status = SPITransFailed;
+    }
+    if (t->after_cb != NULL) {
+      t->after_cb(t);
+    }
   }
+  return ok;
+}
+#pragma GCC diagnostic pop
 
-  if (ioctl(fd, SPI_IOC_MESSAGE(1), &xfer) < 0) {
+bool spi_submit(struct spi_periph *p, struct spi_transaction *t)
+{
+  struct spi_linux_periph *lp = (struct spi_linux_periph *)p->init_struct;
+
+  uint8_t next_idx = (p->trans_insert_idx + 1) % SPI_TRANSACTION_QUEUE_LEN;
+  if (next_idx == p->trans_extract_idx) {
+    // queue full
     t->status = SPITransFailed;
     return false;
   }
+  t->status = SPITransPending;
+  p->trans[p->trans_insert_idx] = t;
+  p->trans_insert_idx = next_idx;
 
-  /* copy received data if we had to use an extra rx_buffer */
-  if (buf_len > t->input_length) {
-    memcpy((void *)t->input_buf, rx_buf, t->input_length);
+  if (lp->batch_len <= 1) {
+    return spi_linux_flush(p);
+  }
+  if (spi_linux_queued(p) >= lp->batch_len) {
+    spi_linux_flush(p);
   }
-
-  t->status = SPITransSuccess;
   return true;
 }
-#pragma GCC diagnostic pop
+
+void spi_event(void)
+{
+#if USE_SPI0
+  spi_linux_flush(&spi0);
+#endif
+#if USE_SPI1
+  spi_linux_flush(&spi1);
+#endif
+}
 
 bool spi_lock(struct spi_periph *p, uint8_t slave)
 {
@@ -134,8 +223,22 @@ bool spi_resume(struct spi_periph *p, uint8_t slave)
 #define SPI0_MAX_SPEED_HZ 1000000
 #endif
 
+/** max number of transactions transferred with a single ioctl,
+ * 1 to transfer each transaction when submitted
+ */
+#ifndef SPI0_BATCH_LEN
+#define SPI0_BATCH_LEN 1
+#endif
+
+static struct spi_linux_periph spi0_linux = {
+  .speed_hz = SPI0_MAX_SPEED_HZ,
+  .batch_len = Max(1, Min(SPI0_BATCH_LEN, SPI_TRANSACTION_QUEUE_LEN - 1))
+};
+
 void spi0_arch_init(void)
 {
+  spi0.init_struct = &spi0_linux;
+
   int fd = open("/dev/spidev1.0", O_RDWR);
 
   if (fd < 0) {
@@ -168,7 +271,6 @@ void spi0_arch_init(void)
   if (ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &spi_speed) < 0) {
     perror("SPI0: can't set max speed hz");
   }
-  spi0.init_struct = (void *)SPI0_MAX_SPEED_HZ;
 }
 #endif /* USE_SPI0 */
 
@@ -190,8 +292,22 @@ void spi0_arch_init(void)
 #define SPI1_MAX_SPEED_HZ 1000000
 #endif
 
+/** max number of transactions transferred with a single ioctl,
+ * 1 to transfer each transaction when submitted
+ */
+#ifndef SPI1_BATCH_LEN
+#define SPI1_BATCH_LEN 1
+#endif
+
+static struct spi_linux_periph spi1_linux = {
+  .speed_hz = SPI1_MAX_SPEED_HZ,
+  .batch_len = Max(1, Min(SPI1_BATCH_LEN, SPI_TRANSACTION_QUEUE_LEN - 1))
+};
+
 void spi1_arch_init(void)
 {
+  spi1.init_struct = &spi1_linux;
+
   int fd = open("/dev/spidev1.1", O_RDWR);
 
   if (fd < 0) {
@@ -215,7 +331,7 @@ void spi1_arch_init(void)
 
   /* bits per word default to 8 */
   unsigned char spi_bits_per_word = SPI1_BITS_PER_WORD;
-  if (ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &spi_bits_per_word) < 0) {r
+  if (ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &spi_bits_per_word) < 0) {
     perror("SPI1: can't set bits per word");
   }
 
@@ -224,6 +340,5 @@ void spi1_arch_init(void)
   if (ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &spi_speed) < 0) {
     perror("SPI1: can't set max speed hz");
   }
-  spi1.init_struct = (void *)SPI1_MAX_SPEED_HZ;
 }
 #endif /* USE_SPI1 */
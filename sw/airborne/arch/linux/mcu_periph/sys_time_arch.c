@@ -41,11 +41,18 @@
 
 static struct timespec startup_time;
 
+struct SysTimeRtStats sys_time_rt_stats;
+
 static void sys_tick_handler(void);
 void *sys_time_thread_main(void *data);
 
 #define NSEC_OF_SEC(sec) ((sec) * 1e9)
 
+static inline uint32_t elapsed_us(struct timespec *t0, struct timespec *t1)
+{
+  return (t1->tv_sec - t0->tv_sec) * 1000000 + (t1->tv_nsec - t0->tv_nsec) / 1000;
+}
+
 void *sys_time_thread_main(void *data)
 {
   int fd;
@@ -57,7 +64,7 @@ void *sys_time_thread_main(void *data)
     return NULL;
   }
 
-  get_rt_prio(SYS_TIME_THREAD_PRIO);
+  rt_thread_setup(SYS_TIME_THREAD_PRIO, RT_CPUS_CONTROL);
 
   /* Make the timer periodic */
   struct itimerspec timer;
@@ -73,6 +80,12 @@ void *sys_time_thread_main(void *data)
     return NULL;
   }
 
+  const uint32_t period_us = sys_time.resolution * 1e6;
+  struct timespec last, now;
+  clock_gettime(CLOCK_MONOTONIC, &last);
+  uint32_t last_report_sec = 0;
+  struct SysTimeRtStats reported = sys_time_rt_stats;
+
   while (1) {
     unsigned long long missed;
     /* Wait for the next timer event. If we have missed any the
@@ -80,12 +93,31 @@ void *sys_time_thread_main(void *data)
     int r = read(fd, &missed, sizeof(missed));
     if (r == -1) {
       perror("Couldn't read timer!");
+      continue;
     }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint32_t dt = elapsed_us(&last, &now);
+    uint32_t expected = period_us * missed;
+    uint32_t jitter = dt > expected ? dt - expected : expected - dt;
+    if (jitter > sys_time_rt_stats.max_jitter_us) {
+      sys_time_rt_stats.max_jitter_us = jitter;
+    }
+    last = now;
     if (missed > 1) {
-      fprintf(stderr, "Missed %lld timer events!\n", missed);
+      sys_time_rt_stats.missed_ticks += missed - 1;
     }
     /* set current sys_time */
     sys_tick_handler();
+
+    if (sys_time.nb_sec != last_report_sec &&
+        (sys_time_rt_stats.missed_ticks != reported.missed_ticks ||
+         sys_time_rt_stats.missed_deadlines != reported.missed_deadlines)) {
+      fprintf(stderr, "[sys_time] missed %u timer events, %u periodic deadlines, max jitter %u us\n",
+              sys_time_rt_stats.missed_ticks, sys_time_rt_stats.missed_deadlines,
+              sys_time_rt_stats.max_jitter_us);
+      reported = sys_time_rt_stats;
+      last_report_sec = sys_time.nb_sec;
+    }
   }
   return NULL;
 }
@@ -139,6 +171,10 @@ static void sys_tick_handler(void)
     if (sys_time.timer[i].in_use &&
         sys_time.nb_tick >= sys_time.timer[i].end_time) {
       sys_time.timer[i].end_time += sys_time.timer[i].duration;
+      /* a polled timer not acknowledged since it last elapsed is a missed deadline of the main loop */
+      if (sys_time.timer[i].elapsed && sys_time.timer[i].cb == NULL) {
+        sys_time_rt_stats.missed_deadlines++;
+      }
       sys_time.timer[i].elapsed = true;
       /* call registered callbacks, WARNING: they will be executed in the sys_time thread! */
       if (sys_time.timer[i].cb) {
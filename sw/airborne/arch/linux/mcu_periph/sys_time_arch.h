@@ -31,6 +31,18 @@
 #include "std.h"
 #include <unistd.h>
 
+/**
+ * Deadline misses of the sys_time thread and of the main loop,
+ * printed at most once per second when they increase.
+ */
+struct SysTimeRtStats {
+  uint32_t missed_ticks;      ///< timer events missed by the sys_time thread
+  uint32_t missed_deadlines;  ///< periodic timers elapsed again before the main loop handled them
+  uint32_t max_jitter_us;     ///< max deviation of the sys_time thread wake up period
+};
+
+extern struct SysTimeRtStats sys_time_rt_stats;
+
 /**
  * Get the time in microseconds since startup.
  * WARNING: overflows after 71min34seconds!
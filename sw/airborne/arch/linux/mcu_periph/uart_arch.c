@@ -36,25 +36,46 @@
 
 #include "serial_port.h"
 #include "rt_priority.h"
+#include "mcu_periph/ring_iov.h"
 
 #include <pthread.h>
 #include <sys/select.h>
+#include <sys/uio.h>
+#include <poll.h>
 
 #ifndef UART_THREAD_PRIO
 #define UART_THREAD_PRIO 11
 #endif
 
+/** Pending tx bytes above which a message is written immediately,
+ * below it the output of a main loop iteration is written at once by uart_event().
+ * Set to 1 to write each message as soon as it is complete.
+ */
+#ifndef UART_TX_FLUSH_THRESHOLD
+#define UART_TX_FLUSH_THRESHOLD (UART_TX_BUFFER_SIZE / 2)
+#endif
+
+/** Max time (ms) uart_put_buffer waits for the driver to accept data when the
+ * tx ring is full, the remaining bytes are discarded after it.
+ */
+#ifndef UART_TX_FULL_TIMEOUT
+#define UART_TX_FULL_TIMEOUT 10
+#endif
+
+/*
+ * The rx buffer of each port is a single producer (uart thread) /
+ * single consumer (main thread) ring, see ring_iov.h.
+ * The tx buffer is filled and written by the main thread only.
+ */
+
 static void uart_receive_handler(struct uart_periph *periph);
 static void *uart_thread(void *data __attribute__((unused)));
-static pthread_mutex_t uart_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 //#define TRACE(fmt,args...)    fprintf(stderr, fmt, args)
 #define TRACE(fmt,args...)
 
 void uart_arch_init(void)
 {
-  pthread_mutex_init(&uart_mutex, NULL);
-
   pthread_t tid;
   if (pthread_create(&tid, NULL, uart_thread, NULL) != 0) {
     fprintf(stderr, "uart_arch_init: Could not create UART reading thread.\n");
@@ -67,7 +88,7 @@ void uart_arch_init(void)
 
 static void *uart_thread(void *data __attribute__((unused)))
 {
-  get_rt_prio(UART_THREAD_PRIO);
+  rt_thread_setup(UART_THREAD_PRIO, RT_CPUS_IO);
 
   /* file descriptor list */
   fd_set fds_master;
@@ -269,66 +290,189 @@ void uart_periph_set_bits_stop_parity(struct uart_periph *periph, uint8_t bits,
   serial_port_set_bits_stop_parity(port, bits, stop, parity);
 }
 
-void uart_put_byte(struct uart_periph *periph, long fd __attribute__((unused)), uint8_t data)
+/** Write as much pending tx data as the driver accepts */
+static void uart_tx_flush(struct uart_periph *periph)
 {
   if (periph->reg_addr == NULL) { return; } // device not initialized ?
 
-  /* write single byte to serial port */
-  struct SerialPort *port = (struct SerialPort *)(periph->reg_addr);
+  int fd = ((struct SerialPort *)(periph->reg_addr))->fd;
+  struct iovec iov[2];
+  int nb_iov;
+  while ((nb_iov = ring_used_iov(periph->tx_buf, UART_TX_BUFFER_SIZE, periph->tx_insert_idx,
+                                 periph->tx_extract_idx, iov)) > 0) {
+    ssize_t ret = writev(fd, iov, nb_iov);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      // driver buffer full (EAGAIN), keep the data for the next event
+      if (ret < 0 && errno != EAGAIN) {
+        TRACE("uart_tx_flush: write failed [%d: %s]\n", errno, strerror(errno));
+      }
+      break;
+    }
+    periph->tx_extract_idx = (periph->tx_extract_idx + ret) % UART_TX_BUFFER_SIZE;
+  }
+}
+
+int uart_check_free_space(struct uart_periph *periph, long *fd __attribute__((unused)), uint16_t len)
+{
+  int space = ring_free(UART_TX_BUFFER_SIZE, periph->tx_insert_idx, periph->tx_extract_idx);
+  if (space < len) {
+    uart_tx_flush(periph);
+    space = ring_free(UART_TX_BUFFER_SIZE, periph->tx_insert_idx, periph->tx_extract_idx);
+  }
+  return space >= len ? space : 0;
+}
 
-  int ret = 0;
+/** Wait for the driver to accept data and flush, false on timeout */
+static bool uart_tx_wait(struct uart_periph *periph)
+{
+  struct pollfd pfd = { .fd = ((struct SerialPort *)(periph->reg_addr))->fd, .events = POLLOUT };
+  int ret;
   do {
-    ret = write((int)(port->fd), &data, 1);
-  } while (ret < 1 && errno == EAGAIN); //FIXME: max retry
+    ret = poll(&pfd, 1, UART_TX_FULL_TIMEOUT);
+  } while (ret < 0 && errno == EINTR);
+  if (ret <= 0) {
+    return false;
+  }
+  uart_tx_flush(periph);
+  return true;
+}
 
-  if (ret < 1) {
-    TRACE("uart_put_byte: write %d failed [%d: %s]\n", data, ret, strerror(errno));
+/** Copy data in the tx ring. Data that does not fit (larger than the ring or
+ * driver slower than the output) is written as the driver accepts it, waiting
+ * at most UART_TX_FULL_TIMEOUT without progress, like the former blocking
+ * byte writes but bounded.
+ */
+void uart_put_buffer(struct uart_periph *periph, long fd __attribute__((unused)), const uint8_t *data, uint16_t len)
+{
+  if (periph->reg_addr == NULL) { return; } // device not initialized ?
+
+  while (len > 0) {
+    uint16_t space = ring_free(UART_TX_BUFFER_SIZE, periph->tx_insert_idx, periph->tx_extract_idx);
+    if (space == 0) {
+      uart_tx_flush(periph);
+      space = ring_free(UART_TX_BUFFER_SIZE, periph->tx_insert_idx, periph->tx_extract_idx);
+    }
+    if (space == 0) {
+      if (!uart_tx_wait(periph)) {
+        TRACE("uart_put_buffer: tx_buf full! discarding %d bytes\n", len);
+        return;
+      }
+      continue;
+    }
+    uint16_t n = space < len ? space : len;
+    uint16_t insert = periph->tx_insert_idx;
+    uint16_t first = UART_TX_BUFFER_SIZE - insert;
+    if (first > n) {
+      first = n;
+    }
+    memcpy(&periph->tx_buf[insert], data, first);
+    memcpy(&periph->tx_buf[0], data + first, n - first);
+    periph->tx_insert_idx = (insert + n) % UART_TX_BUFFER_SIZE;
+    data += n;
+    len -= n;
   }
 }
 
+void uart_put_byte(struct uart_periph *periph, long fd, uint8_t data)
+{
+  uart_put_buffer(periph, fd, &data, 1);
+}
 
-static void __attribute__((unused)) uart_receive_handler(struct uart_periph *periph)
+void uart_send_message(struct uart_periph *periph, long fd __attribute__((unused)))
 {
-  unsigned char c = 'D';
+  if (ring_used(UART_TX_BUFFER_SIZE, periph->tx_insert_idx, periph->tx_extract_idx) >= UART_TX_FLUSH_THRESHOLD) {
+    uart_tx_flush(periph);
+  }
+}
+
+void uart_event(void)
+{
+#if USE_UART0
+  uart_tx_flush(&uart0);
+#endif
+#if USE_UART1
+  uart_tx_flush(&uart1);
+#endif
+#if USE_UART2
+  uart_tx_flush(&uart2);
+#endif
+#if USE_UART3
+  uart_tx_flush(&uart3);
+#endif
+#if USE_UART4
+  uart_tx_flush(&uart4);
+#endif
+#if USE_UART5
+  uart_tx_flush(&uart5);
+#endif
+#if USE_UART6
+  uart_tx_flush(&uart6);
+#endif
+}
+
 
+static void __attribute__((unused)) uart_receive_handler(struct uart_periph *periph)
+{
   if (periph->reg_addr == NULL) { return; } // device not initialized ?
 
   struct SerialPort *port = (struct SerialPort *)(periph->reg_addr);
   int fd = port->fd;
 
-  pthread_mutex_lock(&uart_mutex);
-
-  while (read(fd, &c, 1) > 0) {
-    uint16_t temp = (periph->rx_insert_idx + 1) % UART_RX_BUFFER_SIZE;
-    // check for more room in queue
-    if (temp != periph->rx_extract_idx) {
-      periph->rx_buf[periph->rx_insert_idx] = c;
-      periph->rx_insert_idx = temp;  // update insert index
-    } else {
-      TRACE("uart_receive_handler: rx_buf full! discarding received byte: %x %c\n", c, c);
+  struct iovec iov[2];
+  while (1) {
+    uint16_t insert = periph->rx_insert_idx;
+    uint16_t extract = RING_LOAD(periph->rx_extract_idx);
+    int nb_iov = ring_free_iov(periph->rx_buf, UART_RX_BUFFER_SIZE, insert, extract, iov);
+    if (nb_iov == 0) {
+      // rx_buf full, drain the driver so that select does not spin
+      uint8_t trash[64];
+      ssize_t nb = 0;
+      while ((nb = read(fd, trash, sizeof(trash))) > 0) {
+        TRACE("uart_receive_handler: rx_buf full! discarding %d received bytes\n", (int)nb);
+        periph->ore++;
+      }
+      return;
+    }
+    ssize_t nb = readv(fd, iov, nb_iov);
+    if (nb <= 0) {
+      return;
+    }
+    RING_STORE(periph->rx_insert_idx, (insert + nb) % UART_RX_BUFFER_SIZE);
+    if ((size_t)nb < iov[0].iov_len + (nb_iov > 1 ? iov[1].iov_len : 0)) {
+      return; // driver is empty
     }
   }
-  pthread_mutex_unlock(&uart_mutex);
 }
 
 uint8_t uart_getch(struct uart_periph *p)
 {
-  pthread_mutex_lock(&uart_mutex);
   uint8_t ret = p->rx_buf[p->rx_extract_idx];
-  p->rx_extract_idx = (p->rx_extract_idx + 1) % UART_RX_BUFFER_SIZE;
-  pthread_mutex_unlock(&uart_mutex);
+  RING_STORE(p->rx_extract_idx, (p->rx_extract_idx + 1) % UART_RX_BUFFER_SIZE);
   return ret;
 }
 
 int uart_char_available(struct uart_periph *p)
 {
-  pthread_mutex_lock(&uart_mutex);
-  int available = p->rx_insert_idx - p->rx_extract_idx;
-  if (available < 0) {
-    available += UART_RX_BUFFER_SIZE;
+  return ring_used(UART_RX_BUFFER_SIZE, RING_LOAD(p->rx_insert_idx), p->rx_extract_idx);
+}
+
+uint16_t uart_rx_span(struct uart_periph *p, uint8_t **data)
+{
+  uint16_t insert = RING_LOAD(p->rx_insert_idx);
+  uint16_t extract = p->rx_extract_idx;
+  *data = &p->rx_buf[extract];
+  if (insert >= extract) {
+    return insert - extract;
   }
-  pthread_mutex_unlock(&uart_mutex);
-  return available;
+  return UART_RX_BUFFER_SIZE - extract;
+}
+
+void uart_rx_consume(struct uart_periph *p, uint16_t len)
+{
+  RING_STORE(p->rx_extract_idx, (p->rx_extract_idx + len) % UART_RX_BUFFER_SIZE);
 }
 
 #if USE_UART0
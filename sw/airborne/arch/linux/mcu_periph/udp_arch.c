@@ -27,23 +27,35 @@
 #include "udp_socket.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <errno.h>
 #include <pthread.h>
 #include <sys/select.h>
 
 #include "rt_priority.h"
+#include "mcu_periph/ring_iov.h"
 
 #ifndef UDP_THREAD_PRIO
 #define UDP_THREAD_PRIO 10
 #endif
 
+/** Pending tx bytes above which the datagram is sent immediately,
+ * below it the messages of a main loop iteration are sent in a single datagram by udp_event().
+ * Set to 1 to send one datagram per message.
+ */
+#ifndef UDP_TX_FLUSH_THRESHOLD
+#define UDP_TX_FLUSH_THRESHOLD (UDP_TX_BUFFER_SIZE / 2)
+#endif
+
+/*
+ * The rx buffer of each peripheral is a single producer (udp thread) /
+ * single consumer (main thread) ring, see ring_iov.h.
+ */
+
 static void *udp_thread(void *data __attribute__((unused)));
-static pthread_mutex_t udp_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 void udp_arch_init(void)
 {
-  pthread_mutex_init(&udp_mutex, NULL);
-
 #ifdef USE_UDP0
   UDP0Init();
 #endif
@@ -82,13 +94,7 @@ void udp_arch_periph_init(struct udp_periph *p, char *host, int port_out, int po
  */
 int udp_char_available(struct udp_periph *p)
 {
-  pthread_mutex_lock(&udp_mutex);
-  int available = p->rx_insert_idx - p->rx_extract_idx;
-  if (available < 0) {
-    available += UDP_RX_BUFFER_SIZE;
-  }
-  pthread_mutex_unlock(&udp_mutex);
-  return available;
+  return ring_used(UDP_RX_BUFFER_SIZE, RING_LOAD(p->rx_insert_idx), p->rx_extract_idx);
 }
 
 /**
@@ -98,50 +104,62 @@ int udp_char_available(struct udp_periph *p)
  */
 uint8_t udp_getch(struct udp_periph *p)
 {
-  pthread_mutex_lock(&udp_mutex);
   uint8_t ret = p->rx_buf[p->rx_extract_idx];
-  p->rx_extract_idx = (p->rx_extract_idx + 1) % UDP_RX_BUFFER_SIZE;
-  pthread_mutex_unlock(&udp_mutex);
+  RING_STORE(p->rx_extract_idx, (p->rx_extract_idx + 1) % UDP_RX_BUFFER_SIZE);
   return ret;
 }
 
+uint16_t udp_rx_span(struct udp_periph *p, uint8_t **data)
+{
+  uint16_t insert = RING_LOAD(p->rx_insert_idx);
+  uint16_t extract = p->rx_extract_idx;
+  *data = &p->rx_buf[extract];
+  if (insert >= extract) {
+    return insert - extract;
+  }
+  return UDP_RX_BUFFER_SIZE - extract;
+}
+
+void udp_rx_consume(struct udp_periph *p, uint16_t len)
+{
+  RING_STORE(p->rx_extract_idx, (p->rx_extract_idx + len) % UDP_RX_BUFFER_SIZE);
+}
+
 /**
- * Read bytes from UDP
+ * Read all pending datagrams directly in the receive buffer
  */
 void udp_receive(struct udp_periph *p)
 {
   if (p == NULL) { return; }
   if (p->network == NULL) { return; }
 
-  int16_t i;
-  int16_t available = UDP_RX_BUFFER_SIZE - udp_char_available(p);
-  uint8_t buf[UDP_RX_BUFFER_SIZE];
   struct UdpSocket *sock = (struct UdpSocket *) p->network;
+  struct iovec iov[2];
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_name = &sock->addr_in;
+  msg.msg_iov = iov;
 
-  if (available <= 0) {
-    return;  // No space
-  }
-
-  socklen_t slen = sizeof(struct sockaddr_in);
-  ssize_t byte_read = recvfrom(sock->sockfd, buf, available, MSG_DONTWAIT,
-                               (struct sockaddr *)&sock->addr_in, &slen);
-
-  pthread_mutex_lock(&udp_mutex);
-
-  if (byte_read > 0) {
-    for (i = 0; i < byte_read; i++) {
-      p->rx_buf[p->rx_insert_idx] = buf[i];
-      p->rx_insert_idx = (p->rx_insert_idx + 1) % UDP_RX_BUFFER_SIZE;
+  while (1) {
+    uint16_t insert = p->rx_insert_idx;
+    int nb_iov = ring_free_iov(p->rx_buf, UDP_RX_BUFFER_SIZE, insert, RING_LOAD(p->rx_extract_idx), iov);
+    if (nb_iov == 0) {
+      return;  // No space, datagrams are kept by the socket
+    }
+    msg.msg_namelen = sizeof(struct sockaddr_in);
+    msg.msg_iovlen = nb_iov;
+    ssize_t byte_read = recvmsg(sock->sockfd, &msg, MSG_DONTWAIT);
+    if (byte_read <= 0) {
+      return;
     }
+    RING_STORE(p->rx_insert_idx, (insert + byte_read) % UDP_RX_BUFFER_SIZE);
   }
-
-  pthread_mutex_unlock(&udp_mutex);
 }
 
 /**
- * Send a message
+ * Send the pending datagram
  */
-void udp_send_message(struct udp_periph *p, long fd __attribute__((unused)))
+static void udp_flush(struct udp_periph *p)
 {
   if (p == NULL) { return; }
   if (p->network == NULL) { return; }
@@ -164,13 +182,51 @@ void udp_send_message(struct udp_periph *p, long fd __attribute__((unused)))
 }
 
 /**
- * Send a packet from another buffer
+ * Check if there is enough free space in the transmit buffer,
+ * send the pending datagram to make room if needed.
+ */
+int udp_check_free_space(struct udp_periph *p, long *fd __attribute__((unused)), uint16_t len)
+{
+  int available = UDP_TX_BUFFER_SIZE - p->tx_insert_idx;
+  if (available < len) {
+    udp_flush(p);
+    available = UDP_TX_BUFFER_SIZE - p->tx_insert_idx;
+  }
+  return available >= len ? available : 0;
+}
+
+/**
+ * End of a message, the datagram is sent when large enough or on the next udp_event
+ */
+void udp_send_message(struct udp_periph *p, long fd __attribute__((unused)))
+{
+  if (p != NULL && p->tx_insert_idx >= UDP_TX_FLUSH_THRESHOLD) {
+    udp_flush(p);
+  }
+}
+
+void udp_event(void)
+{
+#if USE_UDP0
+  udp_flush(&udp0);
+#endif
+#if USE_UDP1
+  udp_flush(&udp1);
+#endif
+#if USE_UDP2
+  udp_flush(&udp2);
+#endif
+}
+
+/**
+ * Send a packet from another buffer, after the pending datagram to keep the order
  */
 void udp_send_raw(struct udp_periph *p, long fd __attribute__((unused)), uint8_t *buffer, uint16_t size)
 {
   if (p == NULL) { return; }
   if (p->network == NULL) { return; }
 
+  udp_flush(p);
   struct UdpSocket *sock = (struct UdpSocket *) p->network;
   ssize_t test __attribute__((unused)) = sendto(sock->sockfd, buffer, size, MSG_DONTWAIT,
                                          (struct sockaddr *)&sock->addr_out, sizeof(sock->addr_out));
@@ -181,7 +237,7 @@ void udp_send_raw(struct udp_periph *p, long fd __attribute__((unused)), uint8_t
  */
 static void *udp_thread(void *data __attribute__((unused)))
 {
-  get_rt_prio(UDP_THREAD_PRIO);
+  rt_thread_setup(UDP_THREAD_PRIO, RT_CPUS_IO);
 
   /* file descriptor list */
   fd_set socks_master;
@@ -26,6 +26,15 @@
 #ifndef UDP_ARCH_H
 #define UDP_ARCH_H
 
+// higher default udp buffer sizes on linux,
+// tx messages are batched in datagrams of up to one MTU
+#ifndef UDP_RX_BUFFER_SIZE
+#define UDP_RX_BUFFER_SIZE 2048
+#endif
+#ifndef UDP_TX_BUFFER_SIZE
+#define UDP_TX_BUFFER_SIZE 1472
+#endif
+
 #include "mcu_periph/udp.h"
 #include "udp_socket.h"
 
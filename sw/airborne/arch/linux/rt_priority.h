@@ -20,14 +20,68 @@
 
 /**
  * @file rt_priority.h
- * Functions to obtain rt priority or set the nice level.
+ * Functions to obtain rt priority or set the nice level,
+ * and the thread policy of the autopilot threads.
+ *
+ * Each thread belongs to a class with a set of cores (bit mask, 0 to leave
+ * the affinity unchanged):
+ *  - RT_CPUS_CONTROL: main loop (periodic tasks) and sys_time threads
+ *  - RT_CPUS_IO: uart, udp, i2c and pipe threads (default RT_CPUS_CONTROL)
+ *  - RT_CPUS_VISION: camera capture and computer vision threads (default
+ *    the online cores not in RT_CPUS_CONTROL, if any)
+ *
+ * This header is included by arch files that don't see generated/airframe.h,
+ * so the masks and RT_LOCK_MEMORY are makefile variables passed on the command
+ * line by Makefile.linux, set with a configure option of the airframe (the
+ * board makefile may give defaults, e.g. bebop2), e.g. for a dual core board,
+ * with the control on core 0 and vision on core 1:
+ * @code
+ * <configure name="RT_CPUS_CONTROL" value="0x1"/>
+ * <configure name="RT_CPUS_VISION" value="0x2"/>
+ * @endcode
+ * The SCHED_FIFO priorities are set per thread (SYS_TIME_THREAD_PRIO,
+ * UART_THREAD_PRIO, ...), vision threads keep a nice level.
+ *
+ * Threads created by the main thread inherit its affinity, so threads not
+ * set up with rt_thread_setup() run on the control cores.
  */
 
 #ifndef RT_PRIORITY_H
 #define RT_PRIORITY_H
 
+#include "std.h"
 #include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#ifndef RT_CPUS_CONTROL
+#define RT_CPUS_CONTROL 0
+#endif
+
+#ifndef RT_CPUS_IO
+#define RT_CPUS_IO RT_CPUS_CONTROL
+#endif
+
+#ifndef RT_CPUS_VISION
+#define RT_CPUS_VISION rt_cpus_complement(RT_CPUS_CONTROL)
+#endif
+
+/**
+ * Lock the memory of the process at startup to avoid page faults.
+ * Future mappings are locked as well (thread stacks, video buffers),
+ * so only enable it on boards with enough memory.
+ */
+#ifndef RT_LOCK_MEMORY
+#define RT_LOCK_MEMORY FALSE
+#endif
+
+/** Stack size touched by each thread at setup, so it is resident */
+#ifndef RT_STACK_PREFAULT_SIZE
+#define RT_STACK_PREFAULT_SIZE (64 * 1024)
+#endif
 
 static inline int get_rt_prio(int prio)
 {
@@ -74,4 +128,107 @@ static inline int set_nice_level(int level)
   return setpriority(PRIO_PROCESS, tid, level);
 }
 
+/**
+ * Set the cores the calling thread can run on
+ * @param cpus bit mask of the cores, 0 to leave it unchanged
+ */
+static inline int rt_set_cpus(uint32_t cpus)
+{
+  if (cpus == 0) {
+    return 0;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  long nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  for (int i = 0; i < 32 && i < nb_cpus; i++) {
+    if (cpus & (1u << i)) {
+      CPU_SET(i, &set);
+    }
+  }
+  if (CPU_COUNT(&set) == 0) {
+    printf("[rt] No online core in mask 0x%x, affinity unchanged\n", cpus);
+    return -1;
+  }
+  int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (ret) {
+    printf("[rt] Could not set affinity 0x%x: %s\n", cpus, strerror(ret));
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Online cores not in a mask
+ * @param cpus bit mask of the cores
+ * @return the other online cores, 0 (affinity unchanged) if there are none
+ */
+static inline uint32_t rt_cpus_complement(uint32_t cpus)
+{
+  long nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  uint32_t online = nb_cpus >= 32 ? 0xFFFFFFFF : (1u << nb_cpus) - 1;
+  uint32_t others = online & ~cpus;
+  if (cpus != 0 && others == 0) {
+    printf("[rt] No core left out of 0x%x, vision threads share the control cores\n", cpus);
+  }
+  return cpus != 0 ? others : 0;
+}
+
+/** Touch the stack of the calling thread, so it doesn't fault later */
+static inline void rt_prefault_stack(void)
+{
+  volatile uint8_t stack[RT_STACK_PREFAULT_SIZE] __attribute__((unused));
+  const long page = sysconf(_SC_PAGESIZE);
+  for (long i = 0; i < RT_STACK_PREFAULT_SIZE; i += page) {
+    stack[i] = 0;
+  }
+}
+
+/**
+ * Set up the calling thread: SCHED_FIFO priority, cores and stack
+ * @param prio SCHED_FIFO priority, 0 to keep the current policy
+ * @param cpus bit mask of the cores (RT_CPUS_x), 0 to leave it unchanged
+ */
+static inline int rt_thread_setup(int prio, uint32_t cpus)
+{
+  int ret = 0;
+  if (prio > 0) {
+    ret = get_rt_prio(prio);
+  }
+  if (rt_set_cpus(cpus)) {
+    ret = -1;
+  }
+  rt_prefault_stack();
+  return ret;
+}
+
+/**
+ * Set up the calling thread with a nice level instead of a rt priority
+ * @param level nice level
+ * @param cpus bit mask of the cores (RT_CPUS_x), 0 to leave it unchanged
+ */
+static inline int rt_thread_setup_nice(int level, uint32_t cpus)
+{
+  int ret = set_nice_level(level);
+  if (rt_set_cpus(cpus)) {
+    ret = -1;
+  }
+  rt_prefault_stack();
+  return ret;
+}
+
+/**
+ * Set up the process, from the main thread before any other thread is created:
+ * lock the memory (RT_LOCK_MEMORY) and pin the main loop to the control cores
+ */
+static inline void rt_process_setup(void)
+{
+#if RT_LOCK_MEMORY
+  if (mlockall(MCL_CURRENT | MCL_FUTURE)) {
+    perror("[rt] mlockall failed");
+  }
+#endif
+  rt_set_cpus(RT_CPUS_CONTROL);
+  rt_prefault_stack();
+}
+
 #endif /* RT_PRIORITY_H */
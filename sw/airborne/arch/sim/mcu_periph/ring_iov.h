@@ -0,0 +1 @@
+../../linux/mcu_periph/ring_iov.h
\ No newline at end of file
@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/** @file filters/biquad_bank.h
+ *  @brief Multi-channel bank of cascaded biquad filters
+ *
+ * A bank filters up to BIQUAD_BANK_LANES channels (e.g. the 3 axis of a
+ * gyro) through the same cascade of second order sections (low pass,
+ * notches tracking motor RPM harmonics, ...).
+ *
+ * The coefficients are stored per stage and shared by all channels, the
+ * states are stored per stage with the channels contiguous, so that the
+ * inner loop over the channels has a fixed trip count and no dependency
+ * between iterations (mapped to SIMD instructions by the compiler when
+ * available). Stages use the transposed direct form II.
+ *
+ * Block processing (biquad_bank_update_block) runs each stage over all the
+ * samples of a block before the next stage, as in CMSIS-DSP, so that the
+ * coefficients of a stage stay in registers.
+ */
+
+#ifndef BIQUAD_BANK_H
+#define BIQUAD_BANK_H
+
+#include "std.h"
+#include <math.h>
+
+/** Number of channels of a bank, unused channels are processed but ignored */
+#ifndef BIQUAD_BANK_LANES
+#define BIQUAD_BANK_LANES 4
+#endif
+
+/** Max number of cascaded stages */
+#ifndef BIQUAD_BANK_MAX_STAGES
+#define BIQUAD_BANK_MAX_STAGES 16
+#endif
+
+struct BiquadBank {
+  uint8_t nb_stages;                                      ///< number of active stages
+  float b0[BIQUAD_BANK_MAX_STAGES];                       ///< numerator coefficients
+  float b1[BIQUAD_BANK_MAX_STAGES];
+  float b2[BIQUAD_BANK_MAX_STAGES];
+  float a1[BIQUAD_BANK_MAX_STAGES];                       ///< denominator coefficients (a0 = 1)
+  float a2[BIQUAD_BANK_MAX_STAGES];
+  float z1[BIQUAD_BANK_MAX_STAGES][BIQUAD_BANK_LANES];    ///< states
+  float z2[BIQUAD_BANK_MAX_STAGES][BIQUAD_BANK_LANES];
+};
+
+/** Set a stage as a pass-through
+ *
+ * @param bank filter bank
+ * @param stage stage index
+ */
+static inline void biquad_bank_set_bypass(struct BiquadBank *bank, uint8_t stage)
+{
+  bank->b0[stage] = 1.f;
+  bank->b1[stage] = 0.f;
+  bank->b2[stage] = 0.f;
+  bank->a1[stage] = 0.f;
+  bank->a2[stage] = 0.f;
+}
+
+/** Init a filter bank, all stages are pass-through and states are zero
+ *
+ * @param bank filter bank
+ * @param nb_stages number of cascaded stages (bounded to BIQUAD_BANK_MAX_STAGES)
+ */
+static inline void biquad_bank_init(struct BiquadBank *bank, uint8_t nb_stages)
+{
+  bank->nb_stages = Min(nb_stages, BIQUAD_BANK_MAX_STAGES);
+  for (uint8_t s = 0; s < BIQUAD_BANK_MAX_STAGES; s++) {
+    biquad_bank_set_bypass(bank, s);
+    for (uint8_t l = 0; l < BIQUAD_BANK_LANES; l++) {
+      bank->z1[s][l] = 0.f;
+      bank->z2[s][l] = 0.f;
+    }
+  }
+}
+
+/** Set a stage as a second order low pass
+ *
+ * @param bank filter bank
+ * @param stage stage index
+ * @param cut_off cut-off frequency [Hz]
+ * @param q quality factor (0.7071 for a Butterworth filter)
+ * @param sample_freq sampling frequency [Hz]
+ */
+static inline void biquad_bank_set_lowpass(struct BiquadBank *bank, uint8_t stage, float cut_off, float q,
+    float sample_freq)
+{
+  if (cut_off <= 0.f || cut_off >= 0.5f * sample_freq) {
+    biquad_bank_set_bypass(bank, stage);
+    return;
+  }
+  float w0 = 2.f * M_PI * cut_off / sample_freq;
+  float cs = cosf(w0);
+  float alpha = sinf(w0) / (2.f * q);
+  float a0_inv = 1.f / (1.f + alpha);
+  bank->b0[stage] = 0.5f * (1.f - cs) * a0_inv;
+  bank->b1[stage] = (1.f - cs) * a0_inv;
+  bank->b2[stage] = bank->b0[stage];
+  bank->a1[stage] = -2.f * cs * a0_inv;
+  bank->a2[stage] = (1.f - alpha) * a0_inv;
+}
+
+/** Set a stage as a notch
+ *
+ * Can be called at each sample to track a moving frequency (e.g. a motor
+ * RPM harmonic), the states are kept.
+ * The stage is a pass-through if the frequency is out of ]0, sample_freq/2[.
+ *
+ * @param bank filter bank
+ * @param stage stage index
+ * @param freq center frequency [Hz]
+ * @param q quality factor (center frequency / bandwidth)
+ * @param sample_freq sampling frequency [Hz]
+ */
+static inline void biquad_bank_set_notch(struct BiquadBank *bank, uint8_t stage, float freq, float q,
+    float sample_freq)
+{
+  if (freq <= 0.f || freq >= 0.5f * sample_freq) {
+    biquad_bank_set_bypass(bank, stage);
+    return;
+  }
+  float w0 = 2.f * M_PI * freq / sample_freq;
+  float cs = cosf(w0);
+  float alpha = sinf(w0) / (2.f * q);
+  float a0_inv = 1.f / (1.f + alpha);
+  bank->b0[stage] = a0_inv;
+  bank->b1[stage] = -2.f * cs * a0_inv;
+  bank->b2[stage] = a0_inv;
+  bank->a1[stage] = bank->b1[stage];
+  bank->a2[stage] = (1.f - alpha) * a0_inv;
+}
+
+/** Update a filter bank with a new sample of each channel
+ *
+ * @param bank filter bank
+ * @param in input samples (BIQUAD_BANK_LANES values)
+ * @param out filtered samples (BIQUAD_BANK_LANES values), can be the same as in
+ */
+static inline void biquad_bank_update(struct BiquadBank *bank, const float *in, float *out)
+{
+  float x[BIQUAD_BANK_LANES];
+  for (uint8_t l = 0; l < BIQUAD_BANK_LANES; l++) {
+    x[l] = in[l];
+  }
+  for (uint8_t s = 0; s < bank->nb_stages; s++) {
+    const float b0 = bank->b0[s], b1 = bank->b1[s], b2 = bank->b2[s];
+    const float a1 = bank->a1[s], a2 = bank->a2[s];
+    float *z1 = bank->z1[s];
+    float *z2 = bank->z2[s];
+    for (uint8_t l = 0; l < BIQUAD_BANK_LANES; l++) {
+      float y = b0 * x[l] + z1[l];
+      z1[l] = b1 * x[l] - a1 * y + z2[l];
+      z2[l] = b2 * x[l] - a2 * y;
+      x[l] = y;
+    }
+  }
+  for (uint8_t l = 0; l < BIQUAD_BANK_LANES; l++) {
+    out[l] = x[l];
+  }
+}
+
+/** Update a filter bank with a block of samples
+ *
+ * @param bank filter bank
+ * @param data nb samples of BIQUAD_BANK_LANES channels, filtered in place
+ * @param nb number of samples
+ */
+static inline void biquad_bank_update_block(struct BiquadBank *bank, float (*data)[BIQUAD_BANK_LANES], uint16_t nb)
+{
+  for (uint8_t s = 0; s < bank->nb_stages; s++) {
+    const float b0 = bank->b0[s], b1 = bank->b1[s], b2 = bank->b2[s];
+    const float a1 = bank->a1[s], a2 = bank->a2[s];
+    float z1[BIQUAD_BANK_LANES], z2[BIQUAD_BANK_LANES];
+    for (uint8_t l = 0; l < BIQUAD_BANK_LANES; l++) {
+      z1[l] = bank->z1[s][l];
+      z2[l] = bank->z2[s][l];
+    }
+    for (uint16_t n = 0; n < nb; n++) {
+      float *x = data[n];
+      for (uint8_t l = 0; l < BIQUAD_BANK_LANES; l++) {
+        float y = b0 * x[l] + z1[l];
+        z1[l] = b1 * x[l] - a1 * y + z2[l];
+        z2[l] = b2 * x[l] - a2 * y;
+        x[l] = y;
+      }
+    }
+    for (uint8_t l = 0; l < BIQUAD_BANK_LANES; l++) {
+      bank->z1[s][l] = z1[l];
+      bank->z2[s][l] = z2[l];
+    }
+  }
+}
+
+#endif /* BIQUAD_BANK_H */
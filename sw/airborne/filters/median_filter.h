@@ -29,7 +29,15 @@
 
 #include "std.h"
 #include "math/pprz_algebra_int.h"
-
+#include <math.h>
+
+/** Sliding median filter.
+ * sortData always holds the values of data sorted, so that each update
+ * only moves the oldest value to the position of the new one.
+ * An update is still O(size) (shift of the values in between), but
+ * instead of the O(size^2) sort of the whole window. With at most
+ * MAX_MEDIAN_DATASIZE values, a heap or tree would not be faster.
+ */
 struct MedianFilterInt {
   int32_t data[MAX_MEDIAN_DATASIZE], sortData[MAX_MEDIAN_DATASIZE];
   uint8_t dataIndex;
@@ -65,27 +73,44 @@ static inline int32_t get_median_filter_i(struct MedianFilterInt *filter)
   }
 }
 
+/** Replace the oldest value of the sorted window with a new one.
+ * The position of the oldest value is found by binary search, then the
+ * values between the old and new positions are shifted by one (O(size)).
+ */
 static inline int32_t update_median_filter_i(struct MedianFilterInt *filter, int32_t new_data)
 {
-  int temp, i, j; // used to sort array
+  int32_t old_data = filter->data[filter->dataIndex];
 
   // Insert new data into raw data array round robin style
   filter->data[filter->dataIndex] = new_data;
   filter->dataIndex = (filter->dataIndex + 1) % filter->size;
 
-  // Copy raw data to sort data array
-  memcpy(filter->sortData, filter->data, sizeof(int32_t) * filter->size);
+  // Find the oldest value in the sorted array
+  uint8_t lo = 0, hi = filter->size - 1;
+  while (lo < hi) {
+    uint8_t mid = (lo + hi) / 2;
+    if (filter->sortData[mid] < old_data) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
 
-  // Insertion Sort
-  for (i = 1; i < filter->size; i++) {
-    temp = filter->sortData[i];
-    j = i - 1;
-    while (j >= 0 && temp < filter->sortData[j]) {
-      filter->sortData[j + 1] = filter->sortData[j];
-      j = j - 1;
+  // Move it to the sorted position of the new value
+  uint8_t i = lo;
+  if (new_data > old_data) {
+    while (i + 1 < filter->size && filter->sortData[i + 1] < new_data) {
+      filter->sortData[i] = filter->sortData[i + 1];
+      i++;
+    }
+  } else {
+    while (i > 0 && filter->sortData[i - 1] > new_data) {
+      filter->sortData[i] = filter->sortData[i - 1];
+      i--;
     }
-    filter->sortData[j + 1] = temp;
   }
+  filter->sortData[i] = new_data;
+
   // return data value in middle of sorted array
   return get_median_filter_i(filter);
 }
@@ -172,28 +197,49 @@ static inline float get_median_filter_f(struct MedianFilterFloat *filter)
   }
 }
 
+/** Replace the oldest value of the sorted window with a new one.
+ * Non-finite values (NaN, inf) are rejected and the current median is
+ * returned, a NaN would not compare with the window and break its order.
+ * @see update_median_filter_i
+ */
 static inline float update_median_filter_f(struct MedianFilterFloat *filter, float new_data)
 {
-  float temp;
-  int i, j; // used to sort array
+  if (!isfinite(new_data)) {
+    return get_median_filter_f(filter);
+  }
+
+  float old_data = filter->data[filter->dataIndex];
 
   // Insert new data into raw data array round robin style
   filter->data[filter->dataIndex] = new_data;
   filter->dataIndex = (filter->dataIndex + 1) % filter->size;
 
-  // Copy raw data to sort data array
-  memcpy(filter->sortData, filter->data, sizeof(float) * filter->size);
+  // Find the oldest value in the sorted array
+  uint8_t lo = 0, hi = filter->size - 1;
+  while (lo < hi) {
+    uint8_t mid = (lo + hi) / 2;
+    if (filter->sortData[mid] < old_data) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
 
-  // Insertion Sort
-  for (i = 1; i < filter->size; i++) {
-    temp = filter->sortData[i];
-    j = i - 1;
-    while (j >= 0 && temp < filter->sortData[j]) {
-      filter->sortData[j + 1] = filter->sortData[j];
-      j = j - 1;
+  // Move it to the sorted position of the new value
+  uint8_t i = lo;
+  if (new_data > old_data) {
+    while (i + 1 < filter->size && filter->sortData[i + 1] < new_data) {
+      filter->sortData[i] = filter->sortData[i + 1];
+      i++;
+    }
+  } else {
+    while (i > 0 && filter->sortData[i - 1] > new_data) {
+      filter->sortData[i] = filter->sortData[i - 1];
+      i--;
     }
-    filter->sortData[j + 1] = temp;
   }
+  filter->sortData[i] = new_data;
+
   // return data value in middle of sorted array
   return get_median_filter_f(filter);
 }
@@ -48,6 +48,15 @@
 // Factor that the estimated G matrix is allowed to deviate from initial one
 #define INDI_ALLOWED_G_FACTOR 2.0
 
+/**
+ * Relative change of an element of G1+G2 since the last pseudo-inverse above
+ * which the adaptation computes it again, below it the update is skipped.
+ * The default 0 disables the skip
+ */
+#ifndef STABILIZATION_INDI_PINV_UPDATE_THRESHOLD
+#define STABILIZATION_INDI_PINV_UPDATE_THRESHOLD 0.f
+#endif
+
 float du_min[INDI_NUM_ACT];
 float du_max[INDI_NUM_ACT];
 float du_pref[INDI_NUM_ACT];
@@ -59,7 +68,9 @@ static void lms_estimation(void);
 static void get_actuator_state(void);
 static void calc_g1_element(float dx_error, int8_t i, int8_t j, float mu_extra);
 static void calc_g2_element(float dx_error, int8_t j, float mu_extra);
+static void calc_g1g2(float g[INDI_OUTPUTS][INDI_NUM_ACT]);
 static void calc_g1g2_pseudo_inv(void);
+static bool g1g2_changed(float threshold);
 static void bound_g_mat(void);
 
 int32_t stabilization_att_indi_cmd[COMMANDS_NB];
@@ -217,7 +228,8 @@ void stabilization_indi_init(void)
   float_vect_zero(estimation_rate_dd, INDI_NUM_ACT);
   float_vect_zero(actuator_state_filt_vect, INDI_NUM_ACT);
 
-  //Calculate G1G2_PSEUDO_INVERSE
+  //Calculate G1G2_PSEUDO_INVERSE, G1G2 is set even if it is singular (WLS)
+  calc_g1g2(g1g2);
   calc_g1g2_pseudo_inv();
 
   // Initialize the array of pointers to the rows of g1g2
@@ -346,7 +358,12 @@ void stabilization_indi_set_earth_cmd_i(struct Int32Vect2 *cmd, int32_t heading)
  */
 void stabilization_indi_rate_run(struct FloatRates rate_sp, bool in_flight)
 {
-  /* Propagate the filter on the gyroscopes */
+  /* Propagate the filter on the gyroscopes
+   * The rates are read from the state once per control step, the filters and
+   * the finite differences run at PERIODIC_FREQUENCY, in sync with the
+   * actuator filters. The samples of IMU_BATCH_INT32 are not used here: with
+   * AHRS_FC_USE_IMU_BATCH the state rates are already the mean over the batch.
+   */
   struct FloatRates *body_rates = stateGetBodyRates_f();
   float rate_vect[3] = {body_rates->p, body_rates->q, body_rates->r};
   int8_t i;
@@ -663,65 +680,74 @@ void lms_estimation(void)
   float_vect_copy(g2, g2_est, INDI_NUM_ACT);
 
 #if STABILIZATION_INDI_ALLOCATION_PSEUDO_INVERSE
-  // Calculate the inverse of (G1+G2)
-  calc_g1g2_pseudo_inv();
+  // Calculate the inverse of (G1+G2) if the estimation changed enough
+  if (g1g2_changed(STABILIZATION_INDI_PINV_UPDATE_THRESHOLD)) {
+    calc_g1g2_pseudo_inv();
+  }
 #endif
 }
 
 /**
- * Function that calculates the pseudo-inverse of (G1+G2).
+ * @param threshold relative change of an element
+ * @return true if an element of G1+G2 changed by more than threshold since
+ * the last call of calc_g1g2_pseudo_inv()
  */
-void calc_g1g2_pseudo_inv(void)
+bool g1g2_changed(float threshold)
 {
-
-  //sum of G1 and G2
   int8_t i;
   int8_t j;
   for (i = 0; i < INDI_OUTPUTS; i++) {
     for (j = 0; j < INDI_NUM_ACT; j++) {
-      if (i != 2) {
-        g1g2[i][j] = g1[i][j] / INDI_G_SCALING;
-      } else {
-        g1g2[i][j] = (g1[i][j] + g2[j]) / INDI_G_SCALING;
+      float g = (i != 2) ? g1[i][j] : g1[i][j] + g2[j];
+      g = g / INDI_G_SCALING;
+      if (fabsf(g - g1g2[i][j]) > threshold * fabsf(g1g2[i][j])) {
+        return true;
       }
     }
   }
+  return false;
+}
 
-  //G1G2*transpose(G1G2)
-  //calculate matrix multiplication of its transpose INDI_OUTPUTSxnum_act x num_actxINDI_OUTPUTS
-  float element = 0;
-  int8_t row;
-  int8_t col;
-  for (row = 0; row < INDI_OUTPUTS; row++) {
-    for (col = 0; col < INDI_OUTPUTS; col++) {
-      element = 0;
-      for (i = 0; i < INDI_NUM_ACT; i++) {
-        element = element + g1g2[row][i] * g1g2[col][i];
+/**
+ * Sum of G1 and G2, scaled
+ * @param g output matrix
+ */
+void calc_g1g2(float g[INDI_OUTPUTS][INDI_NUM_ACT])
+{
+  int8_t i;
+  int8_t j;
+  for (i = 0; i < INDI_OUTPUTS; i++) {
+    for (j = 0; j < INDI_NUM_ACT; j++) {
+      if (i != 2) {
+        g[i][j] = g1[i][j] / INDI_G_SCALING;
+      } else {
+        g[i][j] = (g1[i][j] + g2[j]) / INDI_G_SCALING;
       }
-      g1g2_trans_mult[row][col] = element;
     }
   }
+}
 
-  //there are numerical errors if the scaling is not right.
-  float_vect_scale(g1g2_trans_mult[0], 100.0, INDI_OUTPUTS * INDI_OUTPUTS);
+/**
+ * Function that calculates the pseudo-inverse of (G1+G2).
+ * If (G1+G2) is singular, G1G2 and its pseudo-inverse are left unchanged.
+ */
+void calc_g1g2_pseudo_inv(void)
+{
+  float g1g2_new[INDI_OUTPUTS][INDI_NUM_ACT];
+  calc_g1g2(g1g2_new);
 
-  //inverse of 4x4 matrix
-  float_mat_inv_4d(g1g2inv[0], g1g2_trans_mult[0]);
+  //G1G2*transpose(G1G2), symmetric INDI_OUTPUTSxINDI_OUTPUTS
+  float_mat_mul_transpose_4n(g1g2_trans_mult[0], g1g2_new[0], INDI_NUM_ACT);
 
-  //scale back
-  float_vect_scale(g1g2inv[0], 100.0, INDI_OUTPUTS * INDI_OUTPUTS);
+  //inverse of the 4x4 matrix, keep the previous pseudo-inverse if it is singular
+  if (!float_mat_sym_inv_4d(g1g2inv[0], g1g2_trans_mult[0])) {
+    return;
+  }
+  float_vect_copy(g1g2[0], g1g2_new[0], INDI_OUTPUTS * INDI_NUM_ACT);
 
   //G1G2'*G1G2inv
   //calculate matrix multiplication INDI_NUM_ACTxINDI_OUTPUTS x INDI_OUTPUTSxINDI_OUTPUTS
-  for (row = 0; row < INDI_NUM_ACT; row++) {
-    for (col = 0; col < INDI_OUTPUTS; col++) {
-      element = 0;
-      for (i = 0; i < INDI_OUTPUTS; i++) {
-        element = element + g1g2[i][row] * g1g2inv[col][i];
-      }
-      g1g2_pseudo_inv[row][col] = element;
-    }
-  }
+  float_mat_transpose_mul_4n(g1g2_pseudo_inv[0], g1g2[0], g1g2inv[0], INDI_NUM_ACT);
 }
 
 static void rpm_cb(uint8_t __attribute__((unused)) sender_id, uint16_t UNUSED *rpm, uint8_t UNUSED num_act)
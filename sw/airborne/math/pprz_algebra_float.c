@@ -838,6 +838,136 @@ bool float_mat_inv_4d(float invOut[16], float mat_in[16])
   return 0; //success
 }
 
+/**
+ * Inverse of a symmetric positive definite 4x4 matrix
+ *
+ * Uses the LDL^T decomposition, about a third of the operations of
+ * float_mat_inv_4d and no square root.
+ *
+ * @param inv_out output array, inverse of mat_in
+ * @param mat_in input array, only the lower half is used
+ * @return true on success, false if mat_in is not positive definite (inv_out is not modified)
+ */
+bool float_mat_sym_inv_4d(float *inv_out, float *mat_in)
+{
+  const float eps = 1e-6f;
+  const float *m = mat_in;
+
+  // decomposition m = L D L^T, L unit lower triangular,
+  // each pivot must be positive and not negligible against its diagonal element
+  float d0 = m[0];
+  if (!(d0 > 0.f)) { return false; }
+  float e0 = 1.f / d0;
+  float l10 = m[4] * e0;
+  float l20 = m[8] * e0;
+  float l30 = m[12] * e0;
+
+  float d1 = m[5] - l10 * m[4];
+  if (!(d1 > eps * m[5])) { return false; }
+  float e1 = 1.f / d1;
+  float l21 = (m[9] - l20 * m[4]) * e1;
+  float l31 = (m[13] - l30 * m[4]) * e1;
+
+  float d2 = m[10] - l20 * m[8] - l21 * l21 * d1;
+  if (!(d2 > eps * m[10])) { return false; }
+  float e2 = 1.f / d2;
+  float l32 = (m[14] - l30 * m[8] - l31 * l21 * d1) * e2;
+
+  float d3 = m[15] - l30 * m[12] - l31 * l31 * d1 - l32 * l32 * d2;
+  if (!(d3 > eps * m[15])) { return false; }
+  float e3 = 1.f / d3;
+
+  // U = L^-1
+  float u10 = -l10;
+  float u21 = -l21;
+  float u32 = -l32;
+  float u20 = -l20 - l21 * u10;
+  float u31 = -l31 - l32 * u21;
+  float u30 = -l30 - l31 * u10 - l32 * u20;
+
+  // inverse = U^T D^-1 U
+  float *o = inv_out;
+  o[15] = e3;
+  o[14] = o[11] = u32 * e3;
+  o[13] = o[7] = u31 * e3;
+  o[12] = o[3] = u30 * e3;
+  o[10] = e2 + u32 * u32 * e3;
+  o[9] = o[6] = u21 * e2 + u31 * u32 * e3;
+  o[8] = o[2] = u20 * e2 + u30 * u32 * e3;
+  o[5] = e1 + u21 * u21 * e2 + u31 * u31 * e3;
+  o[4] = o[1] = u10 * e1 + u20 * u21 * e2 + u30 * u31 * e3;
+  o[0] = e0 + u10 * u10 * e1 + u20 * u20 * e2 + u30 * u30 * e3;
+
+  return true;
+}
+
+/**
+ * Product of a 4 x n matrix by its transpose, o = a * a^T
+ *
+ * The 4 rows are unrolled and only the upper half of the symmetric
+ * result is accumulated, in a single pass over the columns.
+ *
+ * @param o output 4x4 matrix
+ * @param a input matrix [4 x n], row major
+ * @param n number of columns of a
+ */
+void float_mat_mul_transpose_4n(float *o, float *a, int n)
+{
+  const float *a0 = a, *a1 = a + n, *a2 = a + 2 * n, *a3 = a + 3 * n;
+  float m00 = 0.f, m01 = 0.f, m02 = 0.f, m03 = 0.f;
+  float m11 = 0.f, m12 = 0.f, m13 = 0.f;
+  float m22 = 0.f, m23 = 0.f;
+  float m33 = 0.f;
+  int j;
+  for (j = 0; j < n; j++) {
+    float x0 = a0[j], x1 = a1[j], x2 = a2[j], x3 = a3[j];
+    m00 += x0 * x0;
+    m01 += x0 * x1;
+    m02 += x0 * x2;
+    m03 += x0 * x3;
+    m11 += x1 * x1;
+    m12 += x1 * x2;
+    m13 += x1 * x3;
+    m22 += x2 * x2;
+    m23 += x2 * x3;
+    m33 += x3 * x3;
+  }
+  o[0] = m00;
+  o[1] = o[4] = m01;
+  o[2] = o[8] = m02;
+  o[3] = o[12] = m03;
+  o[5] = m11;
+  o[6] = o[9] = m12;
+  o[7] = o[13] = m13;
+  o[10] = m22;
+  o[11] = o[14] = m23;
+  o[15] = m33;
+}
+
+/**
+ * Product of the transpose of a 4 x n matrix by a 4x4 matrix, o = a^T * b
+ *
+ * @param o output matrix [n x 4]
+ * @param a input matrix [4 x n], row major
+ * @param b input 4x4 matrix
+ * @param n number of columns of a
+ */
+void float_mat_transpose_mul_4n(float *o, float *a, float *b, int n)
+{
+  const float b00 = b[0], b01 = b[1], b02 = b[2], b03 = b[3];
+  const float b10 = b[4], b11 = b[5], b12 = b[6], b13 = b[7];
+  const float b20 = b[8], b21 = b[9], b22 = b[10], b23 = b[11];
+  const float b30 = b[12], b31 = b[13], b32 = b[14], b33 = b[15];
+  int j;
+  for (j = 0; j < n; j++) {
+    float x0 = a[j], x1 = a[n + j], x2 = a[2 * n + j], x3 = a[3 * n + j];
+    o[4 * j + 0] = x0 * b00 + x1 * b10 + x2 * b20 + x3 * b30;
+    o[4 * j + 1] = x0 * b01 + x1 * b11 + x2 * b21 + x3 * b31;
+    o[4 * j + 2] = x0 * b02 + x1 * b12 + x2 * b22 + x3 * b32;
+    o[4 * j + 3] = x0 * b03 + x1 * b13 + x2 * b23 + x3 * b33;
+  }
+}
+
 /** Calculate inverse of any n x n matrix (passed as C array) o = mat^-1
 Algorithm verified with Matlab.
 Thanks to: https://www.quora.com/How-do-I-make-a-C++-program-to-get-the-inverse-of-a-matrix-100-X-100
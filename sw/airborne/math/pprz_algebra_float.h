@@ -862,6 +862,9 @@ static inline void float_mat_diagonal_scal(float **o, float v, int n)
 extern bool float_mat_inv_2d(float inv_out[4], float mat_in[4]);
 extern void float_mat2_mult(struct FloatVect2 *vect_out, float mat[4], struct FloatVect2 vect_in);
 extern bool float_mat_inv_4d(float invOut[16], float mat_in[16]);
+extern bool float_mat_sym_inv_4d(float *inv_out, float *mat_in);
+extern void float_mat_mul_transpose_4n(float *o, float *a, int n);
+extern void float_mat_transpose_mul_4n(float *o, float *a, float *b, int n);
 
 extern void vect_bound_in_2d(struct FloatVect3 *vect3, float bound);
 extern void vect_scale(struct FloatVect3 *vect3, float norm_des);
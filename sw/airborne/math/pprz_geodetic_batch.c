@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pprz_geodetic_batch.c
+ * @brief Paparazzi double-precision geodetic conversions over arrays of points.
+ *
+ * The loops have no branches and work on restrict pointers (this file is
+ * built with -O3 -fno-math-errno in the math library). The compiler
+ * vectorizes the linear ENU/NED transforms, the loops calling sin, cos,
+ * atan2 or cbrt stay scalar and are bound by the libm.
+ */
+
+#include "pprz_geodetic_batch.h"
+
+#include <math.h>
+#include "std.h"
+#include "math/pprz_geodetic_utm.h"
+
+/* WGS84 ellipsoid, same as pprz_geodetic_double.c */
+#define WGS84_A 6378137.0
+#define WGS84_F (1. / 298.257223563)
+
+void ecef_of_lla_batch_d(struct EcefCoorArray_d *ecef, struct LlaCoorArray_d *lla, size_t n)
+{
+  const double e2 = 2.*WGS84_F - (WGS84_F * WGS84_F);
+  const double *restrict lat = lla->lat;
+  const double *restrict lon = lla->lon;
+  const double *restrict alt = lla->alt;
+  double *restrict x = ecef->x;
+  double *restrict y = ecef->y;
+  double *restrict z = ecef->z;
+
+  for (size_t i = 0; i < n; i++) {
+    const double sin_lat = sin(lat[i]);
+    const double cos_lat = cos(lat[i]);
+    const double sin_lon = sin(lon[i]);
+    const double cos_lon = cos(lon[i]);
+    const double a_chi = WGS84_A / sqrt(1. - e2 * sin_lat * sin_lat);
+    x[i] = (a_chi + alt[i]) * cos_lat * cos_lon;
+    y[i] = (a_chi + alt[i]) * cos_lat * sin_lon;
+    z[i] = (a_chi * (1. - e2) + alt[i]) * sin_lat;
+  }
+}
+
+/**
+ * Closed form solution (Heikkinen), as lla_of_ecef_d()
+ */
+void lla_of_ecef_batch_d(struct LlaCoorArray_d *lla, struct EcefCoorArray_d *ecef, size_t n)
+{
+  const double a = WGS84_A;
+  const double f = WGS84_F;
+  const double b2 = (a * (1. - f)) * (a * (1. - f));
+  const double e2 = 2.*f - (f * f);
+  const double ep2 = f * (2. - f) / ((1. - f) * (1. - f));
+  const double E2 = a * a - b2;
+  const double *restrict x = ecef->x;
+  const double *restrict y = ecef->y;
+  const double *restrict z = ecef->z;
+  double *restrict lat = lla->lat;
+  double *restrict lon = lla->lon;
+  double *restrict alt = lla->alt;
+
+  for (size_t i = 0; i < n; i++) {
+    const double z2 = z[i] * z[i];
+    const double r2 = x[i] * x[i] + y[i] * y[i];
+    const double r = sqrt(r2);
+    const double F = 54.*b2 * z2;
+    const double G = r2 + (1 - e2) * z2 - e2 * E2;
+    const double c = (e2 * e2 * F * r2) / (G * G * G);
+    const double s = cbrt(1 + c + sqrt(c * c + 2 * c));
+    const double s1 = 1 + s + 1 / s;
+    const double P = F / (3 * s1 * s1 * G * G);
+    const double Q = sqrt(1 + 2 * e2 * e2 * P);
+    const double ro = -(e2 * P * r) / (1 + Q) + sqrt((a * a / 2) * (1 + 1 / Q) - ((1 - e2) * P * z2) / (Q *
+                      (1 + Q)) - P * r2 / 2);
+    const double tmp = (r - e2 * ro) * (r - e2 * ro);
+    const double U = sqrt(tmp + z2);
+    const double V = sqrt(tmp + (1 - e2) * z2);
+    const double zo = (b2 * z[i]) / (a * V);
+
+    alt[i] = U * (1 - b2 / (a * V));
+    lat[i] = atan((z[i] + ep2 * zo) / r);
+    lon[i] = atan2(y[i], x[i]);
+  }
+}
+
+void enu_of_ecef_point_batch_d(struct LtpCoorArray_d *enu, struct LtpDef_d *def,
+                               struct EcefCoorArray_d *ecef, size_t n)
+{
+  const double *m = def->ltp_of_ecef.m;
+  const double m0 = m[0], m1 = m[1], m2 = m[2], m3 = m[3], m4 = m[4], m5 = m[5], m6 = m[6], m7 = m[7], m8 = m[8];
+  const double ox = def->ecef.x, oy = def->ecef.y, oz = def->ecef.z;
+  const double *restrict x = ecef->x;
+  const double *restrict y = ecef->y;
+  const double *restrict z = ecef->z;
+  double *restrict e = enu->x;
+  double *restrict nn = enu->y;
+  double *restrict u = enu->z;
+
+  for (size_t i = 0; i < n; i++) {
+    const double dx = x[i] - ox;
+    const double dy = y[i] - oy;
+    const double dz = z[i] - oz;
+    e[i] = m0 * dx + m1 * dy + m2 * dz;
+    nn[i] = m3 * dx + m4 * dy + m5 * dz;
+    u[i] = m6 * dx + m7 * dy + m8 * dz;
+  }
+}
+
+void ned_of_ecef_point_batch_d(struct LtpCoorArray_d *ned, struct LtpDef_d *def,
+                               struct EcefCoorArray_d *ecef, size_t n)
+{
+  struct LtpCoorArray_d enu = { ned->y, ned->x, ned->z };
+  enu_of_ecef_point_batch_d(&enu, def, ecef, n);
+  double *restrict d = ned->z;
+  for (size_t i = 0; i < n; i++) {
+    d[i] = -d[i];
+  }
+}
+
+void ecef_of_enu_point_batch_d(struct EcefCoorArray_d *ecef, struct LtpDef_d *def,
+                               struct LtpCoorArray_d *enu, size_t n)
+{
+  const double *m = def->ltp_of_ecef.m;
+  const double m0 = m[0], m1 = m[1], m2 = m[2], m3 = m[3], m4 = m[4], m5 = m[5], m6 = m[6], m7 = m[7], m8 = m[8];
+  const double ox = def->ecef.x, oy = def->ecef.y, oz = def->ecef.z;
+  const double *restrict e = enu->x;
+  const double *restrict nn = enu->y;
+  const double *restrict u = enu->z;
+  double *restrict x = ecef->x;
+  double *restrict y = ecef->y;
+  double *restrict z = ecef->z;
+
+  for (size_t i = 0; i < n; i++) {
+    x[i] = m0 * e[i] + m3 * nn[i] + m6 * u[i] + ox;
+    y[i] = m1 * e[i] + m4 * nn[i] + m7 * u[i] + oy;
+    z[i] = m2 * e[i] + m5 * nn[i] + m8 * u[i] + oz;
+  }
+}
+
+void ecef_of_ned_point_batch_d(struct EcefCoorArray_d *ecef, struct LtpDef_d *def,
+                               struct LtpCoorArray_d *ned, size_t n)
+{
+  // same as ENU with east/north swapped and down = -up
+  const double *m = def->ltp_of_ecef.m;
+  const double m0 = m[0], m1 = m[1], m2 = m[2], m3 = m[3], m4 = m[4], m5 = m[5], m6 = m[6], m7 = m[7], m8 = m[8];
+  const double ox = def->ecef.x, oy = def->ecef.y, oz = def->ecef.z;
+  const double *restrict nn = ned->x;
+  const double *restrict e = ned->y;
+  const double *restrict d = ned->z;
+  double *restrict x = ecef->x;
+  double *restrict y = ecef->y;
+  double *restrict z = ecef->z;
+
+  for (size_t i = 0; i < n; i++) {
+    x[i] = m0 * e[i] + m3 * nn[i] - m6 * d[i] + ox;
+    y[i] = m1 * e[i] + m4 * nn[i] - m7 * d[i] + oy;
+    z[i] = m2 * e[i] + m5 * nn[i] - m8 * d[i] + oz;
+  }
+}
+
+void enu_of_lla_point_batch_d(struct LtpCoorArray_d *enu, struct LtpDef_d *def,
+                              struct LlaCoorArray_d *lla, size_t n)
+{
+  // the ECEF coordinates go through the output arrays
+  struct EcefCoorArray_d ecef = { enu->x, enu->y, enu->z };
+  ecef_of_lla_batch_d(&ecef, lla, n);
+
+  const double *m = def->ltp_of_ecef.m;
+  const double m0 = m[0], m1 = m[1], m2 = m[2], m3 = m[3], m4 = m[4], m5 = m[5], m6 = m[6], m7 = m[7], m8 = m[8];
+  const double ox = def->ecef.x, oy = def->ecef.y, oz = def->ecef.z;
+  double *restrict x = enu->x;
+  double *restrict y = enu->y;
+  double *restrict z = enu->z;
+  for (size_t i = 0; i < n; i++) {
+    const double dx = x[i] - ox;
+    const double dy = y[i] - oy;
+    const double dz = z[i] - oz;
+    x[i] = m0 * dx + m1 * dy + m2 * dz;
+    y[i] = m3 * dx + m4 * dy + m5 * dz;
+    z[i] = m6 * dx + m7 * dy + m8 * dz;
+  }
+}
+
+void ned_of_lla_point_batch_d(struct LtpCoorArray_d *ned, struct LtpDef_d *def,
+                              struct LlaCoorArray_d *lla, size_t n)
+{
+  struct LtpCoorArray_d enu = { ned->y, ned->x, ned->z };
+  enu_of_lla_point_batch_d(&enu, def, lla, n);
+  double *restrict d = ned->z;
+  for (size_t i = 0; i < n; i++) {
+    d[i] = -d[i];
+  }
+}
+
+/**
+ * Same series as utm_of_lla_d(), with the complex sines developed:
+ * sin(x + iy) = sin(x)cosh(y) + i cos(x)sinh(y)
+ */
+void utm_of_lla_batch_d(struct UtmCoorArray_d *utm, struct LlaCoorArray_d *lla, size_t n)
+{
+  if (n == 0) {
+    return;
+  }
+  if (utm->zone == 0) {
+    utm->zone = UtmZoneOfLlaLonRad(lla->lon[0]);
+  }
+  const double lambda_c = LambdaOfUtmZone(utm->zone);
+  const double c0 = serie_coeff_proj_mercator[0];
+  const double c1 = serie_coeff_proj_mercator[1];
+  const double c2 = serie_coeff_proj_mercator[2];
+  const double *restrict lat = lla->lat;
+  const double *restrict lon = lla->lon;
+  const double *restrict alt = lla->alt;
+  double *restrict north = utm->north;
+  double *restrict east = utm->east;
+  double *restrict u_alt = utm->alt;
+
+  for (size_t i = 0; i < n; i++) {
+    const double e_sin_lat = E * sin(lat[i]);
+    const double ll = log(tan(M_PI_4 + lat[i] / 2.0)) - E / 2.0 * log((1.0 + e_sin_lat) / (1.0 - e_sin_lat));
+    const double dl = lon[i] - lambda_c;
+    const double phi_ = asin(sin(dl) / cosh(ll));
+    const double ll_ = log(tan(M_PI_4 + phi_ / 2.0));
+    const double lambda_ = atan(sinh(ll) / cos(dl));
+    const double zx = c0 * lambda_
+                      + c1 * sin(2. * lambda_) * cosh(2. * ll_)
+                      + c2 * sin(4. * lambda_) * cosh(4. * ll_);
+    const double zy = c0 * ll_
+                      + c1 * cos(2. * lambda_) * sinh(2. * ll_)
+                      + c2 * cos(4. * lambda_) * sinh(4. * ll_);
+    east[i] = DELTA_EAST + N * zy;
+    north[i] = DELTA_NORTH + N * zx;
+    u_alt[i] = alt[i];
+  }
+}
+
+/**
+ * Same series as lla_of_utm_d(), the inverse isometric latitude runs a fixed
+ * number of iterations instead of stopping at convergence
+ */
+void lla_of_utm_batch_d(struct LlaCoorArray_d *lla, struct UtmCoorArray_d *utm, size_t n)
+{
+  const double lambda_c = LambdaOfUtmZone(utm->zone);
+  const double scale = 1 / N / serie_coeff_proj_mercator[0];
+  const double ci1 = serie_coeff_proj_mercator_inverse[1];
+  const double *restrict north = utm->north;
+  const double *restrict east = utm->east;
+  const double *restrict u_alt = utm->alt;
+  double *restrict lat = lla->lat;
+  double *restrict lon = lla->lon;
+  double *restrict alt = lla->alt;
+
+  for (size_t i = 0; i < n; i++) {
+    const double x0 = (north[i] - DELTA_NORTH) * scale;
+    const double y0 = (east[i] - DELTA_EAST) * scale;
+    const double zx = x0 - ci1 * sin(2. * x0) * cosh(2. * y0);
+    const double zy = y0 - ci1 * cos(2. * x0) * sinh(2. * y0);
+
+    lon[i] = lambda_c + atan(sinh(zy) / cos(zx));
+    const double phi = asin(sin(zx) / cosh(zy));
+    // exponential of the isometric latitude of phi
+    const double exp_l = tan(M_PI_4 + phi / 2.0);
+    double phi0 = 2 * atan(exp_l) - M_PI_2;
+    for (int k = 0; k < 3; k++) {
+      const double e_sin_phi = E * sin(phi0);
+      phi0 = 2 * atan(pow((1 + e_sin_phi) / (1. - e_sin_phi), E / 2.) * exp_l) - M_PI_2;
+    }
+    lat[i] = phi0;
+    alt[i] = u_alt[i];
+  }
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pprz_geodetic_batch.h
+ * @brief Paparazzi double-precision geodetic conversions over arrays of points.
+ *
+ * @addtogroup math_geodetic
+ * @{
+ * Batch conversions for ground tools and log processing.
+ *
+ * Points are given as structures of arrays (one array per coordinate), so
+ * the loops run over contiguous doubles without branches. The ENU/NED
+ * transforms of ECEF points are vectorized by the compiler, the geodetic
+ * and UTM conversions are bound by the libm calls. Results match the
+ * scalar functions of pprz_geodetic_double.h to the rounding of the
+ * transcendental functions.
+ *
+ * Input and output arrays must not overlap.
+ *
+ * @addtogroup math_geodetic_batch Batch Geodetic functions
+ * @{
+ */
+
+#ifndef PPRZ_GEODETIC_BATCH_H
+#define PPRZ_GEODETIC_BATCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pprz_geodetic_double.h"
+#include <stddef.h>
+
+/**
+ * @brief arrays of EarthCenteredEarthFixed coordinates
+ * Units: meters */
+struct EcefCoorArray_d {
+  double *x;
+  double *y;
+  double *z;
+};
+
+/**
+ * @brief arrays of Latitude, Longitude and Altitude
+ * Units: radians and meters above WGS84 reference ellipsoid */
+struct LlaCoorArray_d {
+  double *lat;
+  double *lon;
+  double *alt;
+};
+
+/**
+ * @brief arrays of local tangent plane coordinates (ENU or NED)
+ * Units: meters */
+struct LtpCoorArray_d {
+  double *x;
+  double *y;
+  double *z;
+};
+
+/**
+ * @brief arrays of UTM coordinates, all in the same zone
+ * Units: meters */
+struct UtmCoorArray_d {
+  double *north;
+  double *east;
+  double *alt;
+  uint8_t zone;   ///< UTM zone number, 0 to take the zone of the first point
+};
+
+extern void ecef_of_lla_batch_d(struct EcefCoorArray_d *ecef, struct LlaCoorArray_d *lla, size_t n);
+extern void lla_of_ecef_batch_d(struct LlaCoorArray_d *lla, struct EcefCoorArray_d *ecef, size_t n);
+
+extern void enu_of_ecef_point_batch_d(struct LtpCoorArray_d *enu, struct LtpDef_d *def,
+                                      struct EcefCoorArray_d *ecef, size_t n);
+extern void ned_of_ecef_point_batch_d(struct LtpCoorArray_d *ned, struct LtpDef_d *def,
+                                      struct EcefCoorArray_d *ecef, size_t n);
+extern void ecef_of_enu_point_batch_d(struct EcefCoorArray_d *ecef, struct LtpDef_d *def,
+                                      struct LtpCoorArray_d *enu, size_t n);
+extern void ecef_of_ned_point_batch_d(struct EcefCoorArray_d *ecef, struct LtpDef_d *def,
+                                      struct LtpCoorArray_d *ned, size_t n);
+
+extern void enu_of_lla_point_batch_d(struct LtpCoorArray_d *enu, struct LtpDef_d *def,
+                                     struct LlaCoorArray_d *lla, size_t n);
+extern void ned_of_lla_point_batch_d(struct LtpCoorArray_d *ned, struct LtpDef_d *def,
+                                     struct LlaCoorArray_d *lla, size_t n);
+
+extern void utm_of_lla_batch_d(struct UtmCoorArray_d *utm, struct LlaCoorArray_d *lla, size_t n);
+extern void lla_of_utm_batch_d(struct LlaCoorArray_d *lla, struct UtmCoorArray_d *utm, size_t n);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* PPRZ_GEODETIC_BATCH_H */
+/** @}*/
+/** @}*/
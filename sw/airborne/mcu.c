@@ -263,8 +263,19 @@ void mcu_event(void)
 #if USING_SOFTI2C
   softi2c_event();
 #endif
+#if USE_SPI && SPI_MASTER
+  spi_event();
+#endif
 
 #if USE_USB_SERIAL
   VCOM_event();
 #endif
+
+  /* write the output batched during this loop iteration */
+#if USING_UART
+  uart_event();
+#endif
+#if USE_UDP0 || USE_UDP1 || USE_UDP2
+  udp_event();
+#endif
 }
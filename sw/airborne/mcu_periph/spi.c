@@ -95,6 +95,10 @@ void spi_init(struct spi_periph *p)
   p->suspend = false;
 }
 
+void WEAK spi_event(void)
+{
+}
+
 #endif /* SPI_MASTER */
 
 
@@ -276,6 +276,11 @@ extern void spi_init_slaves(void);
  */
 extern bool spi_submit(struct spi_periph *p, struct spi_transaction *t);
 
+/** Periodic event of the spi peripherals.
+ * Transfer the queued transactions on archs where transactions are batched.
+ */
+extern void spi_event(void);
+
 /** Perform a spi transaction (blocking).
  * @param p spi peripheral to be used
  * @param t spi transaction
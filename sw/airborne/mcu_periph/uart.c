@@ -292,10 +292,30 @@ int WEAK uart_char_available(struct uart_periph *p)
   return available;
 }
 
+uint16_t WEAK uart_rx_span(struct uart_periph *p, uint8_t **data)
+{
+  uint16_t insert = p->rx_insert_idx;
+  uint16_t extract = p->rx_extract_idx;
+  *data = &p->rx_buf[extract];
+  if (insert >= extract) {
+    return insert - extract;
+  }
+  return UART_RX_BUFFER_SIZE - extract;
+}
+
+void WEAK uart_rx_consume(struct uart_periph *p, uint16_t len)
+{
+  p->rx_extract_idx = (p->rx_extract_idx + len) % UART_RX_BUFFER_SIZE;
+}
+
 void WEAK uart_arch_init(void)
 {
 }
 
+void WEAK uart_event(void)
+{
+}
+
 void WEAK uart_periph_invert_data_logic(struct uart_periph *p __attribute__((unused)), bool invert_rx __attribute__((unused)), bool invert_tx __attribute__((unused)))
 {
 }
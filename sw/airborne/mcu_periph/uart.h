@@ -110,6 +110,28 @@ extern uint8_t uart_getch(struct uart_periph *p);
  */
 extern int uart_char_available(struct uart_periph *p);
 
+/**
+ * Get the received data as a contiguous span, without copy.
+ * The span stays valid until it is released with uart_rx_consume().
+ * When the receive buffer wraps, the remaining bytes are returned by the next call.
+ * @param p uart peripheral
+ * @param data set to the first available byte
+ * @return number of contiguous bytes available
+ */
+extern uint16_t uart_rx_span(struct uart_periph *p, uint8_t **data);
+
+/**
+ * Release bytes of the receive buffer.
+ * @param p uart peripheral
+ * @param len number of bytes to release, at most the length of the last span
+ */
+extern void uart_rx_consume(struct uart_periph *p, uint16_t len);
+
+/**
+ * Periodic event of the uart peripherals.
+ * Flush the transmit buffers on archs where output is batched.
+ */
+extern void uart_event(void);
 
 extern void uart_arch_init(void);
 
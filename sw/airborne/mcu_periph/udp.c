@@ -110,3 +110,23 @@ void WEAK udp_put_buffer(struct udp_periph *p, long fd __attribute__((unused)),
   memcpy(&(p->tx_buf[p->tx_insert_idx]), data, len);
   p->tx_insert_idx += len;
 }
+
+uint16_t WEAK udp_rx_span(struct udp_periph *p, uint8_t **data)
+{
+  uint16_t insert = p->rx_insert_idx;
+  uint16_t extract = p->rx_extract_idx;
+  *data = &p->rx_buf[extract];
+  if (insert >= extract) {
+    return insert - extract;
+  }
+  return UDP_RX_BUFFER_SIZE - extract;
+}
+
+void WEAK udp_rx_consume(struct udp_periph *p, uint16_t len)
+{
+  p->rx_extract_idx = (p->rx_extract_idx + len) % UDP_RX_BUFFER_SIZE;
+}
+
+void WEAK udp_event(void)
+{
+}
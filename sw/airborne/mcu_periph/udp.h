@@ -32,8 +32,12 @@
 #include "mcu_periph/udp_arch.h"
 #include "pprzlink/pprzlink_device.h"
 
+#ifndef UDP_RX_BUFFER_SIZE
 #define UDP_RX_BUFFER_SIZE 256
+#endif
+#ifndef UDP_TX_BUFFER_SIZE
 #define UDP_TX_BUFFER_SIZE 256
+#endif
 
 struct udp_periph {
   /** Receive buffer */
@@ -60,6 +64,22 @@ extern void     udp_send_raw(struct udp_periph *p, long fd, uint8_t *buffer, uin
 extern void     udp_receive(struct udp_periph *p);
 extern void     udp_put_buffer(struct udp_periph *p, long fd, const uint8_t *data, uint16_t len);
 
+/**
+ * Get the received data as a contiguous span, without copy.
+ * The span stays valid until it is released with udp_rx_consume().
+ * @param p pointer to UDP peripheral
+ * @param data set to the first available byte
+ * @return number of contiguous bytes available
+ */
+extern uint16_t udp_rx_span(struct udp_periph *p, uint8_t **data);
+extern void     udp_rx_consume(struct udp_periph *p, uint16_t len);
+
+/**
+ * Periodic event of the UDP peripherals.
+ * Send the pending datagrams on archs where messages are batched.
+ */
+extern void     udp_event(void);
+
 #if USE_UDP0
 extern struct udp_periph udp0;
 
@@ -27,9 +27,11 @@
 
 #include <stdlib.h> // for malloc
 #include <stdio.h>
+#include <string.h>
 
 #include "cv.h"
 #include "rt_priority.h"
+#include "mcu_periph/sys_time.h"
 
 
 void cv_attach_listener(struct video_config_t *device, struct video_listener *new_listener);
@@ -55,6 +57,8 @@ struct video_listener *cv_add_to_device(struct video_config_t *device, cv_functi
   new_listener->async = NULL;
   new_listener->maximum_fps = fps;
   new_listener->id = id;
+  memset(&new_listener->stats, 0, sizeof(struct cv_listener_stats));
+  memset(&new_listener->stats_last, 0, sizeof(struct cv_listener_stats));
 
   // Initialise the device that we want our function to use
   add_video_device(device);
@@ -135,6 +139,7 @@ int8_t cv_async_function(struct cv_async *async, struct image_t *img)
   image_copy(img, &async->img_copy);
 
   // Inform thread of new image
+  async->img_queued_us = get_sys_time_usec();
   async->img_processed = false;
   pthread_cond_signal(&async->img_available);
   pthread_mutex_unlock(&async->img_mutex);
@@ -148,7 +153,7 @@ void *cv_async_thread(void *args)
   struct cv_async *async = listener->async;
   async->thread_running = true;
 
-  set_nice_level(async->thread_priority);
+  rt_thread_setup_nice(async->thread_priority, RT_CPUS_VISION);
 
   // Request new image from video thread
   pthread_mutex_lock(&async->img_mutex);
@@ -164,7 +169,13 @@ void *cv_async_thread(void *args)
     }
 
     // Execute vision function from this thread
+    uint32_t start = get_sys_time_usec();
+    cv_latency_add_since(&listener->stats.wait, async->img_queued_us, start);
     listener->func(&async->img_copy, listener->id);
+    uint32_t end = get_sys_time_usec();
+    cv_latency_add(&listener->stats.proc, end - start);
+    cv_latency_add_since(&listener->stats.total, async->img_copy.pprz_ts, end);
+    listener->stats.nb_processed++;
 
     // Mark image as processed
     async->img_processed = true;
@@ -178,6 +189,10 @@ void *cv_async_thread(void *args)
 void cv_run_device(struct video_config_t *device, struct image_t *img)
 {
   struct image_t *result;
+  uint32_t pipeline_start = get_sys_time_usec();
+
+  device->thread.stats.nb_frames++;
+  cv_latency_add_since(&device->thread.stats.capture, img->pprz_ts, pipeline_start);
 
   // Loop through computer vision pipeline
   for (struct video_listener *listener = device->cv_listener; listener != NULL; listener = listener->next) {
@@ -185,21 +200,33 @@ void cv_run_device(struct video_config_t *device, struct image_t *img)
     if (!listener->active) {
       continue;
     }
+    listener->stats.nb_frames++;
 
     // If the desired frame time for this listener is not reached, skip it
     if (listener->maximum_fps > 0 && timeval_diff(&listener->ts, &img->ts) < (1000000 / listener->maximum_fps)) {
+      listener->stats.nb_skipped_fps++;
       continue;
     }
 
     if (listener->async != NULL) {
       // Send image to asynchronous thread, only update listener if successful
+      uint32_t start = get_sys_time_usec();
       if (!cv_async_function(listener->async, img)) {
         // Store timestamp
         listener->ts = img->ts;
+        cv_latency_add(&listener->stats.copy, get_sys_time_usec() - start);
+      } else {
+        listener->stats.nb_dropped_busy++;
       }
     } else {
       // Execute the cvFunction and catch result
+      uint32_t start = get_sys_time_usec();
+      cv_latency_add(&listener->stats.wait, start - pipeline_start);
       result = listener->func(img, listener->id);
+      uint32_t end = get_sys_time_usec();
+      cv_latency_add(&listener->stats.proc, end - start);
+      cv_latency_add_since(&listener->stats.total, img->pprz_ts, end);
+      listener->stats.nb_processed++;
 
       // If result gives an image pointer, use it in the next stage
       if (result != NULL) {
@@ -209,4 +236,6 @@ void cv_run_device(struct video_config_t *device, struct image_t *img)
       listener->ts = img->ts;
     }
   }
+
+  cv_latency_add(&device->thread.stats.pipeline, get_sys_time_usec() - pipeline_start);
 }
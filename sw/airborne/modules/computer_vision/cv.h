@@ -46,6 +46,7 @@ struct cv_async {
   pthread_cond_t img_available;
   volatile bool img_processed;
   struct image_t img_copy;
+  uint32_t img_queued_us;         ///< time the copy was made available
 };
 
 struct video_listener {
@@ -55,6 +56,9 @@ struct video_listener {
   cv_function func;
   uint8_t id;
 
+  struct cv_listener_stats stats;       ///< Frame and latency statistics
+  struct cv_listener_stats stats_last;  ///< Statistics at the previous report
+
   // Can be set by user
   uint16_t maximum_fps;
   volatile bool active;
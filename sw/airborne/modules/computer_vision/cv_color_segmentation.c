@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of Paparazzi.
+ *
+ * Paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * Paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/computer_vision/cv_color_segmentation.c
+ * Multi-class color blob detection in a single pass over the frame
+ *
+ * All color classes are segmented together, the blobs and class statistics
+ * of the last frame are shared with other modules through
+ * cv_color_segmentation_get_blobs(), and the largest blob of each class is
+ * sent with the VISUAL_DETECTION ABI message (extra field is the class).
+ */
+
+#include "modules/computer_vision/cv_color_segmentation.h"
+#include "modules/computer_vision/cv.h"
+#include "subsystems/abi.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#ifndef COLOR_SEGMENTATION_FPS
+#define COLOR_SEGMENTATION_FPS 0 ///< Default FPS (zero means run at camera fps)
+#endif
+
+#ifndef COLOR_SEGMENTATION_NB_CLASSES
+#define COLOR_SEGMENTATION_NB_CLASSES 1
+#endif
+
+#ifndef COLOR_SEGMENTATION_MIN_PIXELS
+#define COLOR_SEGMENTATION_MIN_PIXELS 20
+#endif
+
+#ifndef COLOR_SEGMENTATION_DRAW
+#define COLOR_SEGMENTATION_DRAW FALSE
+#endif
+
+/** Class bounds { y_min, y_max, u_min, u_max, v_min, v_max } */
+#ifndef COLOR_SEGMENTATION_CLASS0
+#define COLOR_SEGMENTATION_CLASS0 { 0, 0, 0, 0, 0, 0 }
+#endif
+#ifndef COLOR_SEGMENTATION_CLASS1
+#define COLOR_SEGMENTATION_CLASS1 { 0, 0, 0, 0, 0, 0 }
+#endif
+#ifndef COLOR_SEGMENTATION_CLASS2
+#define COLOR_SEGMENTATION_CLASS2 { 0, 0, 0, 0, 0, 0 }
+#endif
+#ifndef COLOR_SEGMENTATION_CLASS3
+#define COLOR_SEGMENTATION_CLASS3 { 0, 0, 0, 0, 0, 0 }
+#endif
+#ifndef COLOR_SEGMENTATION_CLASS4
+#define COLOR_SEGMENTATION_CLASS4 { 0, 0, 0, 0, 0, 0 }
+#endif
+#ifndef COLOR_SEGMENTATION_CLASS5
+#define COLOR_SEGMENTATION_CLASS5 { 0, 0, 0, 0, 0, 0 }
+#endif
+#ifndef COLOR_SEGMENTATION_CLASS6
+#define COLOR_SEGMENTATION_CLASS6 { 0, 0, 0, 0, 0, 0 }
+#endif
+#ifndef COLOR_SEGMENTATION_CLASS7
+#define COLOR_SEGMENTATION_CLASS7 { 0, 0, 0, 0, 0, 0 }
+#endif
+
+uint8_t color_seg_bounds[COLOR_SEG_MAX_CLASSES][6] = {
+  COLOR_SEGMENTATION_CLASS0, COLOR_SEGMENTATION_CLASS1, COLOR_SEGMENTATION_CLASS2, COLOR_SEGMENTATION_CLASS3,
+  COLOR_SEGMENTATION_CLASS4, COLOR_SEGMENTATION_CLASS5, COLOR_SEGMENTATION_CLASS6, COLOR_SEGMENTATION_CLASS7
+};
+uint16_t color_seg_min_pixels = COLOR_SEGMENTATION_MIN_PIXELS;
+bool color_seg_draw = COLOR_SEGMENTATION_DRAW;
+
+static struct color_seg_lut lut;
+static volatile bool lut_update;
+
+/** video thread data */
+static struct color_seg seg;
+static struct color_seg_run *runs = NULL;
+static uint32_t runs_size = 0;
+static struct color_seg_blob seg_blobs[COLOR_SEGMENTATION_MAX_BLOBS];
+
+/** shared results */
+static pthread_mutex_t mutex;
+static struct color_seg_blob result_blobs[COLOR_SEGMENTATION_MAX_BLOBS];
+static struct color_seg_class result_classes[COLOR_SEG_MAX_CLASSES];
+static uint16_t result_nb_blobs;
+static uint16_t result_w, result_h;
+static bool result_updated;
+
+static void build_lut(void)
+{
+  color_seg_lut_init(&lut);
+  for (uint8_t c = 0; c < COLOR_SEGMENTATION_NB_CLASSES; c++) {
+    color_seg_lut_set_class(&lut, c, color_seg_bounds[c][0], color_seg_bounds[c][1], color_seg_bounds[c][2],
+                            color_seg_bounds[c][3], color_seg_bounds[c][4], color_seg_bounds[c][5]);
+  }
+}
+
+static int blob_size_cmp(const void *a, const void *b)
+{
+  const struct color_seg_blob *ba = (const struct color_seg_blob *)a;
+  const struct color_seg_blob *bb = (const struct color_seg_blob *)b;
+  return (ba->pixel_cnt < bb->pixel_cnt) - (ba->pixel_cnt > bb->pixel_cnt);
+}
+
+static struct image_t *color_segmentation_func(struct image_t *img, uint8_t camera_id __attribute__((unused)))
+{
+  if (img->type != IMAGE_YUV422) {
+    return img;
+  }
+
+  // a quarter of the pixels, more than enough for usual scenes
+  const uint32_t needed_runs = (uint32_t)img->w * img->h / 4;
+  if (runs_size != needed_runs) {
+    free(runs);
+    runs = malloc(needed_runs * sizeof(struct color_seg_run));
+    runs_size = runs ? needed_runs : 0;
+    color_seg_init(&seg, runs, runs_size, seg_blobs, COLOR_SEGMENTATION_MAX_BLOBS);
+  }
+  if (lut_update) {
+    build_lut();
+    lut_update = false;
+  }
+
+  uint16_t nb = color_seg_process(&seg, &lut, img, color_seg_min_pixels);
+  qsort(seg_blobs, nb, sizeof(struct color_seg_blob), blob_size_cmp);
+
+  if (color_seg_draw) {
+    static uint8_t color[4] = {255, 255, 255, 255};
+    for (uint16_t i = 0; i < nb; i++) {
+      image_draw_rectangle(img, seg_blobs[i].x_min, seg_blobs[i].x_max, seg_blobs[i].y_min, seg_blobs[i].y_max, color);
+    }
+  }
+
+  pthread_mutex_lock(&mutex);
+  memcpy(result_blobs, seg_blobs, nb * sizeof(struct color_seg_blob));
+  memcpy(result_classes, seg.classes, sizeof(result_classes));
+  result_nb_blobs = nb;
+  result_w = img->w;
+  result_h = img->h;
+  result_updated = true;
+  pthread_mutex_unlock(&mutex);
+
+  return img;
+}
+
+void cv_color_segmentation_init(void)
+{
+  pthread_mutex_init(&mutex, NULL);
+  build_lut();
+  cv_add_to_device(&COLOR_SEGMENTATION_CAMERA, color_segmentation_func, COLOR_SEGMENTATION_FPS, 0);
+}
+
+void cv_color_segmentation_update_lut(float unused __attribute__((unused)))
+{
+  // rebuilt in the video thread before the next frame
+  lut_update = true;
+}
+
+uint16_t cv_color_segmentation_get_blobs(struct color_seg_blob *blobs, uint16_t max_blobs,
+                                         struct color_seg_class *classes)
+{
+  pthread_mutex_lock(&mutex);
+  uint16_t nb = Min(max_blobs, result_nb_blobs);
+  memcpy(blobs, result_blobs, nb * sizeof(struct color_seg_blob));
+  if (classes != NULL) {
+    memcpy(classes, result_classes, sizeof(result_classes));
+  }
+  pthread_mutex_unlock(&mutex);
+  return nb;
+}
+
+/**
+ * Send the largest blob of each class
+ */
+void cv_color_segmentation_periodic(void)
+{
+  static struct color_seg_blob blobs[COLOR_SEGMENTATION_MAX_BLOBS];
+  uint16_t nb, w, h;
+
+  pthread_mutex_lock(&mutex);
+  if (!result_updated) {
+    pthread_mutex_unlock(&mutex);
+    return;
+  }
+  nb = result_nb_blobs;
+  memcpy(blobs, result_blobs, nb * sizeof(struct color_seg_blob));
+  w = result_w;
+  h = result_h;
+  result_updated = false;
+  pthread_mutex_unlock(&mutex);
+
+  uint8_t sent = 0;
+  for (uint16_t i = 0; i < nb; i++) {
+    const uint8_t bit = 1 << blobs[i].cls;
+    if (sent & bit) {
+      continue; // sorted by size, first one is the largest
+    }
+    sent |= bit;
+    AbiSendMsgVISUAL_DETECTION(COLOR_SEGMENTATION_ID,
+                               (int16_t)(blobs[i].x_c - w * 0.5f), (int16_t)(h * 0.5f - blobs[i].y_c),
+                               blobs[i].x_max - blobs[i].x_min + 1, blobs[i].y_max - blobs[i].y_min + 1,
+                               blobs[i].pixel_cnt, blobs[i].cls);
+  }
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of Paparazzi.
+ *
+ * Paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * Paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/computer_vision/cv_color_segmentation.h
+ * Multi-class color blob detection in a single pass over the frame
+ */
+
+#ifndef CV_COLOR_SEGMENTATION_H
+#define CV_COLOR_SEGMENTATION_H
+
+#include "std.h"
+#include "modules/computer_vision/lib/vision/color_segmentation.h"
+
+/** Maximum number of reported blobs */
+#ifndef COLOR_SEGMENTATION_MAX_BLOBS
+#define COLOR_SEGMENTATION_MAX_BLOBS 32
+#endif
+
+/** Color bounds of the classes (settings) */
+extern uint8_t color_seg_bounds[COLOR_SEG_MAX_CLASSES][6];
+extern uint16_t color_seg_min_pixels;
+extern bool color_seg_draw;
+
+extern void cv_color_segmentation_init(void);
+extern void cv_color_segmentation_periodic(void);
+extern void cv_color_segmentation_update_lut(float unused);
+
+/**
+ * Copy the blobs of the last frame, sorted by decreasing size
+ * @param[out] *blobs Output blobs
+ * @param[in] max_blobs Size of the output
+ * @param[out] *classes Class statistics (COLOR_SEG_MAX_CLASSES), can be NULL
+ * @return The number of blobs
+ */
+extern uint16_t cv_color_segmentation_get_blobs(struct color_seg_blob *blobs, uint16_t max_blobs,
+                                                struct color_seg_class *classes);
+
+#endif /* CV_COLOR_SEGMENTATION_H */
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of Paparazzi.
+ *
+ * Paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * Paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * @file modules/computer_vision/cv_stats.c
+ *
+ * Frame counters and latency histograms of the video pipeline
+ */
+
+#include "modules/computer_vision/cv_stats.h"
+#include "modules/computer_vision/cv.h"
+#include "std.h"
+
+#include "mcu_periph/sys_time.h"
+
+#include <stdio.h>
+
+#if VIDEO_THREAD_STATS_TELEMETRY
+#include "subsystems/datalink/downlink.h"
+#endif
+
+/** Number of periodic calls between two reports on stderr, 0 to disable */
+#ifndef VIDEO_THREAD_STATS_PRINT_PERIOD
+#define VIDEO_THREAD_STATS_PRINT_PERIOD 10
+#endif
+
+void cv_latency_summarize(struct cv_latency *lat, struct cv_latency *last, struct cv_latency_summary *sum)
+{
+  struct cv_latency cur = *lat;
+  lat->max_us = 0;
+
+  sum->count = cur.count - last->count;
+  sum->max_ms = cur.max_us * 1e-3f;
+  sum->mean_ms = sum->count ? (cur.sum_us - last->sum_us) * 1e-3f / sum->count : 0.f;
+  sum->p95_ms = 0.f;
+  if (sum->count > 0) {
+    const uint32_t p95 = sum->count - sum->count / 20;
+    uint32_t acc = 0;
+    for (uint8_t i = 0; i < CV_LATENCY_NB_BINS; i++) {
+      acc += cur.bins[i] - last->bins[i];
+      if (acc >= p95) {
+        sum->p95_ms = Min((128 << i) * 1e-3f, sum->max_ms);
+        break;
+      }
+    }
+  }
+  *last = cur;
+}
+
+/** Rate of a counter since the previous report */
+static inline float counter_rate(uint32_t cur, uint32_t *last, float dt)
+{
+  float rate = (cur - *last) / dt;
+  *last = cur;
+  return rate;
+}
+
+void cv_stats_report(struct video_config_t *device, uint8_t cam_idx, float dt, bool print)
+{
+  struct cv_device_stats *ds = &device->thread.stats;
+  struct cv_device_stats *dl = &device->thread.stats_last;
+  struct cv_latency_summary capture, pipeline;
+
+  if (dt <= 0.f) {
+    return;
+  }
+
+  float fps = counter_rate(ds->nb_frames, &dl->nb_frames, dt);
+  float slow = counter_rate(ds->nb_slow, &dl->nb_slow, dt);
+  cv_latency_summarize(&ds->capture, &dl->capture, &capture);
+  cv_latency_summarize(&ds->pipeline, &dl->pipeline, &pipeline);
+
+  if (print) {
+    fprintf(stderr, "[cv_stats] %s: %.1f fps, %.1f slow/s, capture %.1f/%.1f ms, pipeline %.1f/%.1f/%.1f ms (mean/p95/max)\n",
+            device->dev_name, fps, slow, capture.mean_ms, capture.p95_ms, pipeline.mean_ms, pipeline.p95_ms, pipeline.max_ms);
+  }
+
+  uint8_t idx = 0;
+  for (struct video_listener *listener = device->cv_listener; listener != NULL; listener = listener->next, idx++) {
+    struct cv_listener_stats *ls = &listener->stats;
+    struct cv_listener_stats *ll = &listener->stats_last;
+    struct cv_latency_summary copy, wait, proc, total;
+
+    float in = counter_rate(ls->nb_frames, &ll->nb_frames, dt);
+    float processed = counter_rate(ls->nb_processed, &ll->nb_processed, dt);
+    float skipped = counter_rate(ls->nb_skipped_fps, &ll->nb_skipped_fps, dt);
+    float dropped = counter_rate(ls->nb_dropped_busy, &ll->nb_dropped_busy, dt);
+    cv_latency_summarize(&ls->copy, &ll->copy, &copy);
+    cv_latency_summarize(&ls->wait, &ll->wait, &wait);
+    cv_latency_summarize(&ls->proc, &ll->proc, &proc);
+    cv_latency_summarize(&ls->total, &ll->total, &total);
+
+    if (print) {
+      fprintf(stderr, "[cv_stats]   listener %d (id %d%s): in %.1f fps, processed %.1f fps, skipped %.1f/s (max fps), "
+              "dropped %.1f/s (busy), copy %.1f, wait %.1f/%.1f, proc %.1f/%.1f/%.1f, total %.1f/%.1f ms\n",
+              idx, listener->id, listener->async ? ", async" : "", in, processed, skipped, dropped, copy.mean_ms,
+              wait.mean_ms, wait.p95_ms, proc.mean_ms, proc.p95_ms, proc.max_ms, total.mean_ms, total.p95_ms);
+    }
+
+#if VIDEO_THREAD_STATS_TELEMETRY
+    // [camera, listener, fps (in, processed, skipped, dropped), capture, wait, proc, total (mean, p95) in ms]
+    float data[14] = { cam_idx, idx, in, processed, skipped, dropped, capture.mean_ms, capture.p95_ms,
+                       wait.mean_ms, wait.p95_ms, proc.mean_ms, proc.p95_ms, total.mean_ms, total.p95_ms
+                     };
+    DOWNLINK_SEND_PAYLOAD_FLOAT(DefaultChannel, DefaultDevice, 14, data);
+#else
+    (void)cam_idx;
+#endif
+  }
+}
+
+void cv_stats_periodic(struct video_config_t **cameras, uint8_t nb)
+{
+  static uint32_t last_us = 0;
+  static uint16_t nb_calls = 0;
+
+  uint32_t now = get_sys_time_usec();
+  float dt = (now - last_us) * 1e-6f;
+  bool first = (last_us == 0);
+  last_us = now;
+  if (first) {
+    // only take the reference of the counters
+    dt = 1.f;
+  }
+
+  bool print = false;
+  if (VIDEO_THREAD_STATS_PRINT_PERIOD > 0 && ++nb_calls >= VIDEO_THREAD_STATS_PRINT_PERIOD) {
+    nb_calls = 0;
+    print = !first;
+  }
+
+  for (uint8_t i = 0; i < nb; i++) {
+    if (cameras[i] != NULL && cameras[i]->cv_listener != NULL) {
+      cv_stats_report(cameras[i], i, dt, print);
+    }
+  }
+}
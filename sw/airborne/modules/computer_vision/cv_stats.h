@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of Paparazzi.
+ *
+ * Paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * Paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * @file modules/computer_vision/cv_stats.h
+ *
+ * Frame counters and latency histograms of the video pipeline
+ *
+ * Each counter has a single writer (video thread or async cv thread) and only
+ * grows, wrapping around. The reporter keeps the values of the previous report
+ * and works on differences, so no lock is needed.
+ */
+
+#ifndef CV_STATS_H
+#define CV_STATS_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+struct video_config_t;
+
+/** Number of latency bins, bin 0 is below 128us, bin i is [64 << i, 128 << i[ us */
+#define CV_LATENCY_NB_BINS 16
+
+/** Latency histogram */
+struct cv_latency {
+  uint32_t count;                       ///< number of samples
+  uint32_t sum_us;                      ///< sum of the samples (wraps around)
+  uint32_t max_us;                      ///< max since last report (reset by the reporter)
+  uint32_t bins[CV_LATENCY_NB_BINS];    ///< number of samples per bin
+};
+
+/** Statistics of a video device */
+struct cv_device_stats {
+  uint32_t nb_frames;           ///< frames received from the driver
+  uint32_t nb_slow;             ///< frames later than the target fps
+  struct cv_latency capture;    ///< from capture to the video thread
+  struct cv_latency pipeline;   ///< run time of all listeners
+};
+
+/** Statistics of a video listener */
+struct cv_listener_stats {
+  uint32_t nb_frames;           ///< frames given to the listener
+  uint32_t nb_processed;        ///< frames processed
+  uint32_t nb_skipped_fps;      ///< frames skipped by maximum_fps
+  uint32_t nb_dropped_busy;     ///< frames dropped because the async thread was busy
+  struct cv_latency copy;       ///< image copy to the async thread
+  struct cv_latency wait;       ///< from image available to start of processing
+  struct cv_latency proc;       ///< processing time
+  struct cv_latency total;      ///< from capture to end of processing
+};
+
+/**
+ * Add a latency sample
+ * @param[in,out] *lat The histogram
+ * @param[in] us The latency in microseconds
+ */
+static inline void cv_latency_add(struct cv_latency *lat, uint32_t us)
+{
+  uint32_t b = us >> 6;
+  uint8_t bin = b ? (uint8_t)(32 - __builtin_clz(b)) - 1 : 0;
+  if (bin >= CV_LATENCY_NB_BINS) {
+    bin = CV_LATENCY_NB_BINS - 1;
+  }
+  lat->bins[bin]++;
+  lat->sum_us += us;
+  if (us > lat->max_us) {
+    lat->max_us = us;
+  }
+  lat->count++; // last, so a reader never sees a count without its sample
+}
+
+/**
+ * Latency from a capture timestamp
+ * @param[in] *lat The histogram
+ * @param[in] ts The capture timestamp (us since startup, 0 if unknown)
+ * @param[in] now The current time (us since startup)
+ */
+static inline void cv_latency_add_since(struct cv_latency *lat, uint32_t ts, uint32_t now)
+{
+  // a zero or future timestamp comes from a source without capture time
+  if (ts != 0 && (int32_t)(now - ts) >= 0) {
+    cv_latency_add(lat, now - ts);
+  }
+}
+
+/** Summary of a histogram over a report period */
+struct cv_latency_summary {
+  uint32_t count;
+  float mean_ms;
+  float p95_ms;     ///< upper edge of the bin holding the 95th percentile, bounded by max
+  float max_ms;
+};
+
+/**
+ * Summarize a histogram since the previous call and reset its max
+ * @param[in,out] *lat The histogram
+ * @param[in,out] *last Copy of the histogram at the previous call (updated)
+ * @param[out] *sum The summary
+ */
+extern void cv_latency_summarize(struct cv_latency *lat, struct cv_latency *last, struct cv_latency_summary *sum);
+
+/**
+ * Report the statistics of a device and its listeners since the previous report
+ * Sent as PAYLOAD_FLOAT (one per listener) when VIDEO_THREAD_STATS_TELEMETRY is set.
+ * @param[in,out] *device The video device
+ * @param[in] cam_idx Index of the camera
+ * @param[in] dt Time since the previous report in seconds
+ * @param[in] print Print the report on stderr
+ */
+extern void cv_stats_report(struct video_config_t *device, uint8_t cam_idx, float dt, bool print);
+
+/**
+ * Report the statistics of all cameras, to be called periodically
+ * Printed on stderr every VIDEO_THREAD_STATS_PRINT_PERIOD calls (0 to disable).
+ * @param[in] **cameras The camera array (NULL for unused slots)
+ * @param[in] nb Size of the array
+ */
+extern void cv_stats_periodic(struct video_config_t **cameras, uint8_t nb);
+
+#endif /* CV_STATS_H */
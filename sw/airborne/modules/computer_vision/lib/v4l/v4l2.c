@@ -42,6 +42,7 @@
 
 #include <sys/time.h>
 #include "mcu_periph/sys_time.h"
+#include "rt_priority.h"
 
 #define CLEAR(x) memset(&(x), 0, sizeof (x))
 static void *v4l2_capture_thread(void *data);
@@ -61,6 +62,8 @@ static void *v4l2_capture_thread(void *data)
   struct timeval tv;
   fd_set fds;
 
+  rt_set_cpus(RT_CPUS_VISION);
+
   while (TRUE) {
     FD_ZERO(&fds);
     FD_SET(dev->fd, &fds);
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of Paparazzi.
+ *
+ * Paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * Paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/computer_vision/lib/vision/color_segmentation.c
+ * Single pass multi-class color segmentation of YUV422 images
+ */
+
+#include "color_segmentation.h"
+#include <string.h>
+
+/**
+ * Clear all classes of a lookup table
+ * @param[out] *lut The lookup table
+ */
+void color_seg_lut_init(struct color_seg_lut *lut)
+{
+  memset(lut, 0, sizeof(struct color_seg_lut));
+}
+
+/**
+ * Set the YUV bounds of a color class
+ * When a pixel is in several classes, the lowest class index is kept.
+ * @param[out] *lut The lookup table
+ * @param[in] cls The class index (< COLOR_SEG_MAX_CLASSES)
+ * @param[in] y_m, y_M, u_m, u_M, v_m, v_M The bounds (included)
+ */
+void color_seg_lut_set_class(struct color_seg_lut *lut, uint8_t cls,
+                             uint8_t y_m, uint8_t y_M, uint8_t u_m, uint8_t u_M, uint8_t v_m, uint8_t v_M)
+{
+  if (cls >= COLOR_SEG_MAX_CLASSES) {
+    return;
+  }
+  const uint8_t bit = 1 << cls;
+  for (uint16_t i = 0; i < 256; i++) {
+    lut->y[i] = (i >= y_m && i <= y_M) ? (lut->y[i] | bit) : (lut->y[i] & ~bit);
+    lut->u[i] = (i >= u_m && i <= u_M) ? (lut->u[i] | bit) : (lut->u[i] & ~bit);
+    lut->v[i] = (i >= v_m && i <= v_M) ? (lut->v[i] | bit) : (lut->v[i] & ~bit);
+  }
+}
+
+/**
+ * Initialize the segmentation with user buffers
+ * A run buffer of w * h / 8 is usually enough, the worst case is w * h.
+ * @param[out] *seg The segmentation
+ * @param[in] *runs Run buffer
+ * @param[in] max_runs Size of the run buffer
+ * @param[in] *blobs Blob buffer
+ * @param[in] max_blobs Size of the blob buffer
+ */
+void color_seg_init(struct color_seg *seg, struct color_seg_run *runs, uint32_t max_runs,
+                    struct color_seg_blob *blobs, uint16_t max_blobs)
+{
+  memset(seg, 0, sizeof(struct color_seg));
+  seg->runs = runs;
+  seg->max_runs = max_runs;
+  seg->blobs = blobs;
+  seg->max_blobs = max_blobs;
+}
+
+/** Class of a pixel from its class bit mask, lowest index first */
+static inline uint8_t mask_to_class(uint8_t mask)
+{
+  return mask ? (uint8_t)__builtin_ctz(mask) : COLOR_SEG_NO_CLASS;
+}
+
+static uint32_t find_root(struct color_seg_run *runs, uint32_t i)
+{
+  uint32_t root = i;
+  while (runs[root].parent != root) {
+    root = runs[root].parent;
+  }
+  // path compression
+  while (runs[i].parent != root) {
+    uint32_t next = runs[i].parent;
+    runs[i].parent = root;
+    i = next;
+  }
+  return root;
+}
+
+static void merge(struct color_seg_run *runs, uint32_t a, uint32_t b)
+{
+  uint32_t ra = find_root(runs, a);
+  uint32_t rb = find_root(runs, b);
+  // keep the oldest run as root, so blobs are ordered by their first line
+  if (ra < rb) {
+    runs[rb].parent = ra;
+  } else if (rb < ra) {
+    runs[ra].parent = rb;
+  }
+}
+
+/** Add a run, returns false when the buffer is full */
+static inline bool add_run(struct color_seg *seg, uint16_t x0, uint16_t x1, uint16_t y, uint8_t cls)
+{
+  if (seg->nb_runs >= seg->max_runs) {
+    seg->runs_overflow = true;
+    return false;
+  }
+  struct color_seg_run *r = &seg->runs[seg->nb_runs];
+  r->x0 = x0;
+  r->x1 = x1;
+  r->y = y;
+  r->cls = cls;
+  r->parent = seg->nb_runs;
+  r->size = 0;
+  seg->nb_runs++;
+  return true;
+}
+
+/**
+ * Segment an image in one pass
+ * Class statistics are computed on all runs (all pixels unless runs_overflow is set),
+ * blobs smaller than min_pixels are discarded. If the blob buffer is too small, the
+ * first large enough blobs in scan order are kept.
+ * @param[in,out] *seg The segmentation (results in blobs and classes)
+ * @param[in] *lut The color lookup table
+ * @param[in] *img The YUV422 (UYVY) image
+ * @param[in] min_pixels Minimum number of pixels of a blob
+ * @return The number of blobs
+ */
+uint16_t color_seg_process(struct color_seg *seg, const struct color_seg_lut *lut,
+                           struct image_t *img, uint32_t min_pixels)
+{
+  uint32_t cls_cnt[COLOR_SEG_MAX_CLASSES] = {0};
+  uint64_t cls_x[COLOR_SEG_MAX_CLASSES] = {0};
+  uint64_t cls_y[COLOR_SEG_MAX_CLASSES] = {0};
+  const uint8_t *buf = (const uint8_t *)img->buf;
+
+  seg->nb_runs = 0;
+  seg->nb_blobs = 0;
+  seg->runs_overflow = false;
+
+  uint32_t prev_start = 0, prev_end = 0; // runs of the previous line
+  for (uint16_t y = 0; y < img->h; y++) {
+    const uint8_t *line = &buf[(uint32_t)y * img->w * 2];
+    const uint32_t line_start = seg->nb_runs;
+    uint8_t cur_cls = COLOR_SEG_NO_CLASS;
+    uint16_t cur_x0 = 0;
+
+    // run-length encoding, pixels by pairs sharing U and V
+    for (uint16_t x = 0; x + 1 < img->w; x += 2) {
+      const uint8_t uv = lut->u[line[2 * x]] & lut->v[line[2 * x + 2]];
+      const uint8_t c0 = mask_to_class(uv & lut->y[line[2 * x + 1]]);
+      const uint8_t c1 = mask_to_class(uv & lut->y[line[2 * x + 3]]);
+      if (c0 != cur_cls) {
+        if (cur_cls != COLOR_SEG_NO_CLASS) {
+          add_run(seg, cur_x0, x, y, cur_cls);
+        }
+        cur_cls = c0;
+        cur_x0 = x;
+      }
+      if (c1 != cur_cls) {
+        if (cur_cls != COLOR_SEG_NO_CLASS) {
+          add_run(seg, cur_x0, x + 1, y, cur_cls);
+        }
+        cur_cls = c1;
+        cur_x0 = x + 1;
+      }
+    }
+    if (cur_cls != COLOR_SEG_NO_CLASS) {
+      add_run(seg, cur_x0, img->w & ~1, y, cur_cls);
+    }
+    const uint32_t line_end = seg->nb_runs;
+
+    // class statistics and connection with the previous line
+    uint32_t p = prev_start;
+    for (uint32_t i = line_start; i < line_end; i++) {
+      struct color_seg_run *r = &seg->runs[i];
+      const uint32_t len = r->x1 - r->x0;
+      cls_cnt[r->cls] += len;
+      cls_x[r->cls] += (uint64_t)(r->x0 + r->x1 - 1) * len / 2;
+      cls_y[r->cls] += (uint64_t)y * len;
+
+      // skip previous runs ending before this one, runs are sorted by x
+      while (p < prev_end && seg->runs[p].x1 <= r->x0) {
+        p++;
+      }
+      for (uint32_t q = p; q < prev_end && seg->runs[q].x0 < r->x1; q++) {
+        if (seg->runs[q].cls == r->cls) {
+          merge(seg->runs, i, q);
+        }
+      }
+    }
+    prev_start = line_start;
+    prev_end = line_end;
+  }
+
+  for (uint8_t c = 0; c < COLOR_SEG_MAX_CLASSES; c++) {
+    seg->classes[c].pixel_cnt = cls_cnt[c];
+    seg->classes[c].x_c = cls_cnt[c] ? (float)cls_x[c] / cls_cnt[c] : 0.f;
+    seg->classes[c].y_c = cls_cnt[c] ? (float)cls_y[c] / cls_cnt[c] : 0.f;
+  }
+
+  // blob sizes first, so small blobs never take a slot of the blob buffer
+  for (uint32_t i = 0; i < seg->nb_runs; i++) {
+    struct color_seg_run *r = &seg->runs[i];
+    seg->runs[find_root(seg->runs, i)].size += r->x1 - r->x0;
+  }
+
+  // blob statistics, a new blob is created for each large enough root run
+  uint16_t nb_blobs = 0;
+  for (uint32_t i = 0; i < seg->nb_runs; i++) {
+    struct color_seg_run *r = &seg->runs[i];
+    const uint32_t root = r->parent; // fully compressed by the previous pass
+    struct color_seg_blob *b;
+    if (root == i) {
+      if (r->size < min_pixels || nb_blobs >= seg->max_blobs) {
+        r->blob = COLOR_SEG_NO_BLOB;
+        continue;
+      }
+      r->blob = nb_blobs;
+      b = &seg->blobs[nb_blobs++];
+      b->cls = r->cls;
+      b->pixel_cnt = 0;
+      b->x_min = r->x0;
+      b->x_max = r->x1 - 1;
+      b->y_min = r->y;
+      b->y_max = r->y;
+      b->x_sum = 0;
+      b->y_sum = 0;
+    } else {
+      // roots always come before the runs of their blob
+      if (seg->runs[root].blob == COLOR_SEG_NO_BLOB) {
+        continue;
+      }
+      b = &seg->blobs[seg->runs[root].blob];
+      b->x_min = Min(b->x_min, r->x0);
+      b->x_max = Max(b->x_max, r->x1 - 1);
+      b->y_max = Max(b->y_max, r->y);
+    }
+    const uint32_t len = r->x1 - r->x0;
+    b->pixel_cnt += len;
+    b->x_sum += (uint64_t)(r->x0 + r->x1 - 1) * len / 2;
+    b->y_sum += (uint64_t)r->y * len;
+  }
+
+  // centroids
+  for (uint16_t i = 0; i < nb_blobs; i++) {
+    struct color_seg_blob *b = &seg->blobs[i];
+    b->x_c = (float)b->x_sum / b->pixel_cnt;
+    b->y_c = (float)b->y_sum / b->pixel_cnt;
+  }
+  seg->nb_blobs = nb_blobs;
+  return nb_blobs;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of Paparazzi.
+ *
+ * Paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * Paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/computer_vision/lib/vision/color_segmentation.h
+ * Single pass multi-class color segmentation of YUV422 images
+ *
+ * Up to 8 color classes are tested at once with a lookup table holding one bit
+ * per class for each Y, U and V value. Each scanline is run-length encoded and
+ * runs of the same class are merged into blobs (4-connectivity) with a
+ * union-find.
+ */
+
+#ifndef COLOR_SEGMENTATION_H
+#define COLOR_SEGMENTATION_H
+
+#include "std.h"
+#include "image.h"
+
+#define COLOR_SEG_MAX_CLASSES 8
+#define COLOR_SEG_NO_CLASS 0xFF
+#define COLOR_SEG_NO_BLOB 0xFFFF
+
+/** Lookup table, a pixel is in class c if bit c is set in y[Y] & u[U] & v[V] */
+struct color_seg_lut {
+  uint8_t y[256];
+  uint8_t u[256];
+  uint8_t v[256];
+};
+
+/** Horizontal run of pixels of the same class */
+struct color_seg_run {
+  uint16_t x0;          ///< first pixel
+  uint16_t x1;          ///< last pixel + 1
+  uint16_t y;           ///< line
+  uint16_t blob;        ///< blob index (valid on root runs)
+  uint8_t cls;          ///< color class
+  uint32_t parent;      ///< union-find parent run
+  uint32_t size;        ///< number of pixels of the blob (valid on root runs)
+};
+
+/** Blob of connected pixels of the same class */
+struct color_seg_blob {
+  uint8_t cls;          ///< color class
+  uint32_t pixel_cnt;   ///< number of pixels
+  uint16_t x_min;       ///< bounding box
+  uint16_t x_max;
+  uint16_t y_min;
+  uint16_t y_max;
+  uint64_t x_sum;       ///< sum of the x coordinates
+  uint64_t y_sum;       ///< sum of the y coordinates
+  float x_c;            ///< centroid
+  float y_c;
+};
+
+/** Pixel statistics of a class over the full image */
+struct color_seg_class {
+  uint32_t pixel_cnt;
+  float x_c;            ///< centroid
+  float y_c;
+};
+
+/** Segmentation result and working memory */
+struct color_seg {
+  struct color_seg_run *runs;   ///< run buffer
+  uint32_t max_runs;
+  uint32_t nb_runs;
+  bool runs_overflow;           ///< run buffer was too small, some blobs are missing
+
+  struct color_seg_blob *blobs; ///< blob buffer
+  uint16_t max_blobs;
+  uint16_t nb_blobs;
+
+  struct color_seg_class classes[COLOR_SEG_MAX_CLASSES];
+};
+
+extern void color_seg_lut_init(struct color_seg_lut *lut);
+extern void color_seg_lut_set_class(struct color_seg_lut *lut, uint8_t cls,
+                                    uint8_t y_m, uint8_t y_M, uint8_t u_m, uint8_t u_M, uint8_t v_m, uint8_t v_M);
+extern void color_seg_init(struct color_seg *seg, struct color_seg_run *runs, uint32_t max_runs,
+                           struct color_seg_blob *blobs, uint16_t max_blobs);
+extern uint16_t color_seg_process(struct color_seg *seg, const struct color_seg_lut *lut,
+                                  struct image_t *img, uint32_t min_pixels);
+
+#endif /* COLOR_SEGMENTATION_H */
@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of Paparazzi.
+ *
+ * Paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * Paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/computer_vision/lib/vision/track_manager.c
+ * Persistent feature tracks for Lucas-Kanade tracking
+ */
+
+#include "track_manager.h"
+#include "fast_rosten.h"
+#include "lucas_kanade.h"
+
+#include <stdlib.h>
+
+/** Maximum number of cells per image side */
+#define TRACK_MANAGER_MAX_GRID 16
+
+/** Low pass factor of the lifetime of the lost tracks */
+#define TRACK_MANAGER_LIFETIME_FILTER 0.1f
+
+/**
+ * Initialize the track manager
+ * @param[out] *tm The track manager
+ * @param[in] size Maximum number of tracks
+ * @param[in] grid_size Number of detection cells per image side
+ */
+void track_manager_init(struct track_manager_t *tm, uint16_t size, uint8_t grid_size)
+{
+  tm->tracks = calloc(size, sizeof(struct track_t));
+  tm->size = tm->tracks ? size : 0;
+  tm->max_tracks = tm->size;
+  tm->grid_size = Clip(grid_size, 1, TRACK_MANAGER_MAX_GRID);
+  tm->next_id = 0;
+  tm->lost_lifetime = 0.f;
+  track_manager_reset(tm);
+}
+
+/**
+ * Drop all tracks
+ * @param[in,out] *tm The track manager
+ */
+void track_manager_reset(struct track_manager_t *tm)
+{
+  tm->nb_tracks = 0;
+  tm->nb_new = 0;
+  tm->nb_lost = 0;
+  tm->nb_rejected_fb = 0;
+  tm->mean_age = 0.f;
+}
+
+/** Check if a point is closer than min_distance to a track */
+static bool near_track(struct track_manager_t *tm, struct point_t *p, uint16_t min_distance)
+{
+  for (uint16_t i = 0; i < tm->nb_tracks; i++) {
+    if (abs((int32_t)p->x - (int32_t)tm->tracks[i].pt.x) < min_distance
+        && abs((int32_t)p->y - (int32_t)tm->tracks[i].pt.y) < min_distance) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Detect new corners in the cells of the grid without any track
+ * @param[in,out] *tm The track manager
+ * @param[in] *img The grayscale image the tracks are in
+ * @param[in] threshold FAST9 threshold
+ * @param[in] min_distance Minimum distance between corners in pixels
+ * @param[in] padding FAST9 padding
+ * @param[in,out] *corners_size Size of the corner buffer (can be reallocated)
+ * @param[in,out] **corners Corner buffer for the detection
+ * @return The number of new tracks
+ */
+uint16_t track_manager_detect(struct track_manager_t *tm, struct image_t *img, uint8_t threshold,
+                              uint16_t min_distance, uint16_t padding, uint16_t *corners_size, struct point_t **corners)
+{
+  bool occupied[TRACK_MANAGER_MAX_GRID * TRACK_MANAGER_MAX_GRID] = { false };
+  const uint8_t g = tm->grid_size;
+
+  tm->nb_new = 0;
+  tm->max_tracks = Min(tm->max_tracks, tm->size);
+  if (tm->nb_tracks >= tm->max_tracks) {
+    return 0;
+  }
+
+  for (uint16_t i = 0; i < tm->nb_tracks; i++) {
+    uint32_t cx = Min(tm->tracks[i].pt.x * g / img->w, g - 1U);
+    uint32_t cy = Min(tm->tracks[i].pt.y * g / img->h, g - 1U);
+    occupied[cy * g + cx] = true;
+  }
+
+  // spread the free slots over the cells
+  const uint16_t per_cell = Max(tm->max_tracks / (g * g), 1);
+  for (uint16_t c = 0; c < g * g && tm->nb_tracks < tm->max_tracks; c++) {
+    if (occupied[c]) {
+      continue;
+    }
+    uint16_t roi[4];
+    roi[0] = (c % g) * img->w / g;
+    roi[1] = (c / g) * img->h / g;
+    roi[2] = roi[0] + img->w / g;
+    roi[3] = roi[1] + img->h / g;
+
+    uint16_t nb_corners = 0;
+    fast9_detect(img, threshold, min_distance, padding, padding, &nb_corners, corners_size, corners, roi);
+
+    uint16_t added = 0;
+    for (uint16_t i = 0; i < nb_corners && added < per_cell && tm->nb_tracks < tm->max_tracks; i++) {
+      struct point_t *p = &(*corners)[i];
+      if (near_track(tm, p, min_distance)) {
+        continue;
+      }
+      struct track_t *t = &tm->tracks[tm->nb_tracks++];
+      t->pt.x = p->x;
+      t->pt.y = p->y;
+      t->pt.x_sub = 0;
+      t->pt.y_sub = 0;
+      t->pt.count = 0;
+      t->id = tm->next_id++;
+      added++;
+    }
+    tm->nb_new += added;
+  }
+  return tm->nb_new;
+}
+
+/**
+ * Get the track positions to track with opticFlowLK()
+ * @param[in] *tm The track manager
+ * @param[out] *points The points (at least nb_tracks)
+ * @return The number of points
+ */
+uint16_t track_manager_points(struct track_manager_t *tm, struct point_t *points)
+{
+  for (uint16_t i = 0; i < tm->nb_tracks; i++) {
+    points[i] = tm->tracks[i].pt;
+  }
+  return tm->nb_tracks;
+}
+
+/** Exact position of a track in subpixels */
+static inline int32_t track_pos_x(struct track_t *t, uint16_t subpixel_factor)
+{
+  return (int32_t)(t->pt.x * subpixel_factor + t->pt.x_sub);
+}
+
+static inline int32_t track_pos_y(struct track_t *t, uint16_t subpixel_factor)
+{
+  return (int32_t)(t->pt.y * subpixel_factor + t->pt.y_sub);
+}
+
+/**
+ * Get the end points of the flow of the tracks, to track them back
+ * @param[in] *tm The track manager
+ * @param[in] *vectors The flow vectors of the tracks
+ * @param[in] nb The number of vectors
+ * @param[in] subpixel_factor The subpixel factor of the vectors
+ * @param[out] *points The end points
+ */
+void track_manager_flow_ends(struct track_manager_t *tm, struct flow_t *vectors, uint16_t nb,
+                             uint16_t subpixel_factor, struct point_t *points)
+{
+  nb = Min(nb, tm->nb_tracks);
+  for (uint16_t i = 0; i < nb; i++) {
+    int32_t x = Max(track_pos_x(&tm->tracks[i], subpixel_factor) + vectors[i].flow_x, 0);
+    int32_t y = Max(track_pos_y(&tm->tracks[i], subpixel_factor) + vectors[i].flow_y, 0);
+    points[i].x = x / subpixel_factor;
+    points[i].y = y / subpixel_factor;
+    points[i].x_sub = x % subpixel_factor;
+    points[i].y_sub = y % subpixel_factor;
+    points[i].count = vectors[i].pos.count;
+  }
+}
+
+/**
+ * Move the tracks to the new image
+ * Vectors must match the points given by track_manager_points() (opticFlowLK with
+ * keep_bad_points). Tracks with a failed or inconsistent flow are dropped, as well
+ * as the youngest of two tracks closer than min_distance / 2.
+ * @param[in,out] *tm The track manager
+ * @param[in,out] *vectors The flow vectors, the good ones are moved to the front with their exact start
+ *                         position and pos.count set to the age
+ * @param[in] nb The number of vectors
+ * @param[in] *back_vectors The flow tracked back from the end points, NULL to skip the check
+ * @param[in] subpixel_factor The subpixel factor of the vectors
+ * @param[in] fb_threshold Maximum forward-backward error in pixels
+ * @param[in] min_distance Minimum distance between tracks in pixels
+ * @return The number of good vectors
+ */
+uint16_t track_manager_update(struct track_manager_t *tm, struct flow_t *vectors, uint16_t nb,
+                              struct flow_t *back_vectors, uint16_t subpixel_factor, float fb_threshold, uint16_t min_distance)
+{
+  const int32_t fb_thres = (int32_t)(fb_threshold * subpixel_factor);
+  const int32_t fb_thres_sq = fb_thres * fb_thres;
+  uint32_t lost_age = 0;
+  uint16_t good = 0;
+
+  tm->nb_lost = 0;
+  tm->nb_rejected_fb = 0;
+  nb = Min(nb, tm->nb_tracks);
+  for (uint16_t i = nb; i < tm->nb_tracks; i++) {
+    lost_age += tm->tracks[i].pt.count;
+    tm->nb_lost++;
+  }
+
+  for (uint16_t i = 0; i < nb; i++) {
+    struct flow_t *v = &vectors[i];
+    const int32_t sx = track_pos_x(&tm->tracks[i], subpixel_factor);
+    const int32_t sy = track_pos_y(&tm->tracks[i], subpixel_factor);
+    const int32_t ex = sx + v->flow_x;
+    const int32_t ey = sy + v->flow_y;
+    bool ok = (v->error < LARGE_FLOW_ERROR) && ex >= 0 && ey >= 0;
+    if (!ok) {
+      tm->nb_lost++;
+    } else if (back_vectors != NULL) {
+      // back tracked from the end point, so the sum of both flows is the error
+      struct flow_t *b = &back_vectors[i];
+      const int32_t dx = v->flow_x + b->flow_x;
+      const int32_t dy = v->flow_y + b->flow_y;
+      if (b->error >= LARGE_FLOW_ERROR || dx * dx + dy * dy > fb_thres_sq) {
+        ok = false;
+        tm->nb_rejected_fb++;
+      }
+    }
+
+    struct track_t t = tm->tracks[i];
+    if (!ok) {
+      lost_age += t.pt.count;
+      continue;
+    }
+    t.pt.x = ex / subpixel_factor;
+    t.pt.y = ey / subpixel_factor;
+    t.pt.x_sub = ex % subpixel_factor;
+    t.pt.y_sub = ey % subpixel_factor;
+    if (t.pt.count < UINT16_MAX) {
+      t.pt.count++;
+    }
+    tm->tracks[good] = t;
+    vectors[good] = *v;
+    vectors[good].pos.x = sx;
+    vectors[good].pos.y = sy;
+    vectors[good].pos.count = t.pt.count;
+    good++;
+  }
+
+  // tracks converging on the same feature, keep the oldest
+  const int32_t dist = min_distance / 2;
+  for (uint16_t i = 0; i < good; i++) {
+    for (uint16_t j = i + 1; j < good; j++) {
+      if (abs((int32_t)tm->tracks[i].pt.x - (int32_t)tm->tracks[j].pt.x) < dist
+          && abs((int32_t)tm->tracks[i].pt.y - (int32_t)tm->tracks[j].pt.y) < dist) {
+        uint16_t drop = (tm->tracks[j].pt.count > tm->tracks[i].pt.count) ? i : j;
+        lost_age += tm->tracks[drop].pt.count;
+        tm->nb_lost++;
+        good--;
+        tm->tracks[drop] = tm->tracks[good];
+        vectors[drop] = vectors[good];
+        // check the moved track again
+        if (drop == i) {
+          j = i;
+        } else {
+          j--;
+        }
+      }
+    }
+  }
+  tm->nb_tracks = good;
+
+  uint32_t age = 0;
+  for (uint16_t i = 0; i < good; i++) {
+    age += tm->tracks[i].pt.count;
+  }
+  tm->mean_age = good ? (float)age / good : 0.f;
+  const uint16_t ended = tm->nb_lost + tm->nb_rejected_fb;
+  if (ended > 0) {
+    tm->lost_lifetime += TRACK_MANAGER_LIFETIME_FILTER * ((float)lost_age / ended - tm->lost_lifetime);
+  }
+  return good;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of Paparazzi.
+ *
+ * Paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * Paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/computer_vision/lib/vision/track_manager.h
+ * Persistent feature tracks for Lucas-Kanade tracking
+ *
+ * Tracked points are carried from frame to frame with their subpixel
+ * position, an identifier and their age. The flow of a vector is added to the
+ * exact position of its track, so no precision is lost to the integer
+ * positions used by opticFlowLK(). New FAST9 corners are only detected
+ * in the cells of a grid that hold no track, and tracks failing a
+ * forward-backward consistency check are dropped.
+ *
+ * Usage per frame (tracks are in the previous image):
+ * - track_manager_detect() on the previous image,
+ * - track_manager_points() gives the points for opticFlowLK() (keep_bad_points = 1),
+ * - track_manager_flow_ends() gives the points for the backward tracking (same call),
+ * - track_manager_update() moves the tracks to the new image and keeps the good vectors.
+ */
+
+#ifndef TRACK_MANAGER_H
+#define TRACK_MANAGER_H
+
+#include "std.h"
+#include "image.h"
+
+/** A feature track */
+struct track_t {
+  struct point_t pt;    ///< position in pixels and subpixels, count is the age in frames
+  uint32_t id;          ///< unique identifier
+};
+
+struct track_manager_t {
+  struct track_t *tracks;       ///< active tracks
+  uint16_t nb_tracks;           ///< number of active tracks
+  uint16_t size;                ///< size of the track buffer
+  uint16_t max_tracks;          ///< maximum number of tracks, can be changed up to size
+  uint32_t next_id;             ///< identifier of the next new track
+  uint8_t grid_size;            ///< number of cells per image side for re-detection
+
+  // statistics of the last frame
+  uint16_t nb_new;              ///< tracks created by the last detection
+  uint16_t nb_lost;             ///< tracks lost by the last update (LK failure or too close)
+  uint16_t nb_rejected_fb;      ///< tracks rejected by the forward-backward check
+  float mean_age;               ///< mean age of the active tracks in frames
+  float lost_lifetime;          ///< mean age of the lost tracks (low pass over the frames)
+};
+
+extern void track_manager_init(struct track_manager_t *tm, uint16_t size, uint8_t grid_size);
+extern void track_manager_reset(struct track_manager_t *tm);
+extern uint16_t track_manager_detect(struct track_manager_t *tm, struct image_t *img, uint8_t threshold,
+                                     uint16_t min_distance, uint16_t padding, uint16_t *corners_size, struct point_t **corners);
+extern uint16_t track_manager_points(struct track_manager_t *tm, struct point_t *points);
+extern void track_manager_flow_ends(struct track_manager_t *tm, struct flow_t *vectors, uint16_t nb,
+                                    uint16_t subpixel_factor, struct point_t *points);
+extern uint16_t track_manager_update(struct track_manager_t *tm, struct flow_t *vectors, uint16_t nb,
+                                     struct flow_t *back_vectors, uint16_t subpixel_factor, float fb_threshold, uint16_t min_distance);
+
+#endif /* TRACK_MANAGER_H */
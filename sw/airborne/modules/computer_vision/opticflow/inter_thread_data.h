@@ -38,6 +38,8 @@ struct opticflow_result_t {
   float fps;              ///< Frames per second of the optical flow calculation
   uint16_t corner_cnt;    ///< The amount of coners found by FAST9
   uint16_t tracked_cnt;   ///< The amount of tracked corners
+  float track_age;        ///< Mean age of the tracks in frames (track manager only)
+  float track_lifetime;   ///< Mean lifetime of the lost tracks in frames (track manager only)
 
   // Camera frame with the origin in the top left corner of the image
   int16_t flow_x;         ///< Flow in x direction from the camera (in subpixels) with X positive to the right
@@ -39,6 +39,7 @@
 #include "lib/vision/image.h"
 #include "lib/vision/lucas_kanade.h"
 #include "lib/vision/fast_rosten.h"
+#include "lib/vision/track_manager.h"
 #include "lib/vision/act_fast.h"
 #include "lib/vision/edge_flow.h"
 #include "lib/vision/undistortion.h"
@@ -269,6 +270,42 @@ PRINT_CONFIG_VAR(OPTICFLOW_MEDIAN_FILTER_CAMERA2)
 PRINT_CONFIG_VAR(OPTICFLOW_FEATURE_MANAGEMENT)
 PRINT_CONFIG_VAR(OPTICFLOW_FEATURE_MANAGEMENT_CAMERA2)
 
+#ifndef OPTICFLOW_TRACK_MANAGER
+#define OPTICFLOW_TRACK_MANAGER FALSE
+#endif
+
+#ifndef OPTICFLOW_TRACK_MANAGER_CAMERA2
+#define OPTICFLOW_TRACK_MANAGER_CAMERA2 FALSE
+#endif
+PRINT_CONFIG_VAR(OPTICFLOW_TRACK_MANAGER)
+PRINT_CONFIG_VAR(OPTICFLOW_TRACK_MANAGER_CAMERA2)
+
+// Number of cells per image side in which new corners are detected when empty
+#ifndef OPTICFLOW_TRACK_GRID_SIZE
+#define OPTICFLOW_TRACK_GRID_SIZE 4
+#endif
+
+#ifndef OPTICFLOW_TRACK_GRID_SIZE_CAMERA2
+#define OPTICFLOW_TRACK_GRID_SIZE_CAMERA2 4
+#endif
+
+// Maximum forward-backward error of a track in pixels (0 to disable the check)
+#ifndef OPTICFLOW_TRACK_FB_THRESHOLD
+#define OPTICFLOW_TRACK_FB_THRESHOLD 1.0f
+#endif
+
+#ifndef OPTICFLOW_TRACK_FB_THRESHOLD_CAMERA2
+#define OPTICFLOW_TRACK_FB_THRESHOLD_CAMERA2 1.0f
+#endif
+
+// Outliers are removed by the forward-backward check, so the linear fit needs less iterations
+#ifndef OPTICFLOW_TRACK_RANSAC_ITERATIONS
+#define OPTICFLOW_TRACK_RANSAC_ITERATIONS 10
+#endif
+
+// opticFlowLK tracks at most 255 points
+#define OPTICFLOW_MAX_TRACKS 255
+
 #ifndef OPTICFLOW_FAST9_REGION_DETECT
 #define OPTICFLOW_FAST9_REGION_DETECT 1
 #endif
@@ -417,6 +454,9 @@ void opticflow_calc_init(struct opticflow_t opticflow[])
   opticflow[0].feature_management = OPTICFLOW_FEATURE_MANAGEMENT;
   opticflow[0].fast9_region_detect = OPTICFLOW_FAST9_REGION_DETECT;
   opticflow[0].fast9_num_regions = OPTICFLOW_FAST9_NUM_REGIONS;
+  opticflow[0].track_manager = OPTICFLOW_TRACK_MANAGER;
+  opticflow[0].track_fb_threshold = OPTICFLOW_TRACK_FB_THRESHOLD;
+  track_manager_init(&opticflow[0].tracks, OPTICFLOW_MAX_TRACKS, OPTICFLOW_TRACK_GRID_SIZE);
 
   opticflow[0].fast9_adaptive = OPTICFLOW_FAST9_ADAPTIVE;
   opticflow[0].fast9_threshold = OPTICFLOW_FAST9_THRESHOLD;
@@ -459,6 +499,9 @@ void opticflow_calc_init(struct opticflow_t opticflow[])
   opticflow[1].feature_management = OPTICFLOW_FEATURE_MANAGEMENT_CAMERA2;
   opticflow[1].fast9_region_detect = OPTICFLOW_FAST9_REGION_DETECT_CAMERA2;
   opticflow[1].fast9_num_regions = OPTICFLOW_FAST9_NUM_REGIONS_CAMERA2;
+  opticflow[1].track_manager = OPTICFLOW_TRACK_MANAGER_CAMERA2;
+  opticflow[1].track_fb_threshold = OPTICFLOW_TRACK_FB_THRESHOLD_CAMERA2;
+  track_manager_init(&opticflow[1].tracks, OPTICFLOW_MAX_TRACKS, OPTICFLOW_TRACK_GRID_SIZE_CAMERA2);
 
   opticflow[1].fast9_adaptive = OPTICFLOW_FAST9_ADAPTIVE_CAMERA2;
   opticflow[1].fast9_threshold = OPTICFLOW_FAST9_THRESHOLD_CAMERA2;
@@ -510,6 +553,7 @@ bool calc_fast9_lukas_kanade(struct opticflow_t *opticflow, struct image_t *img,
   if (!opticflow->got_first_img) {
     image_copy(&opticflow->img_gray, &opticflow->prev_img_gray);
     opticflow->got_first_img = true;
+    track_manager_reset(&opticflow->tracks);
     return false;
   }
 
@@ -530,8 +574,15 @@ bool calc_fast9_lukas_kanade(struct opticflow_t *opticflow, struct image_t *img,
   // Corner detection
   // *************************************************************************************
 
-  // if feature_management is selected and tracked corners drop below a threshold, redetect
-  if ((opticflow->feature_management) && (result->corner_cnt < opticflow->max_track_corners / 2)) {
+  if (opticflow->track_manager) {
+    // keep the tracks and only detect in the empty parts of the image
+    opticflow->tracks.max_tracks = Min(opticflow->max_track_corners, opticflow->tracks.size);
+    track_manager_detect(&opticflow->tracks, &opticflow->prev_img_gray, opticflow->fast9_threshold,
+                         opticflow->fast9_min_distance, opticflow->fast9_padding, &opticflow->fast9_rsize,
+                         &opticflow->fast9_ret_corners);
+    result->corner_cnt = track_manager_points(&opticflow->tracks, opticflow->fast9_ret_corners);
+  } else if ((opticflow->feature_management) && (result->corner_cnt < opticflow->max_track_corners / 2)) {
+    // if feature_management is selected and tracked corners drop below a threshold, redetect
     manage_flow_features(img, opticflow, result);
   } else if (!opticflow->feature_management) {
     // needs to be set to 0 because result is now static
@@ -604,14 +655,33 @@ bool calc_fast9_lukas_kanade(struct opticflow_t *opticflow, struct image_t *img,
 
   // Execute a Lucas Kanade optical flow
   result->tracked_cnt = result->corner_cnt;
-  uint8_t keep_bad_points = 0;
+  // tracks need one vector per point
+  uint8_t keep_bad_points = opticflow->track_manager ? 1 : 0;
+  uint8_t max_points = opticflow->track_manager ? OPTICFLOW_MAX_TRACKS : opticflow->max_track_corners;
   struct flow_t *vectors = opticFlowLK(&opticflow->img_gray, &opticflow->prev_img_gray, opticflow->fast9_ret_corners,
                                        &result->tracked_cnt,
                                        opticflow->window_size / 2, opticflow->subpixel_factor, opticflow->max_iterations,
-                                       opticflow->threshold_vec, opticflow->max_track_corners, opticflow->pyramid_level, keep_bad_points);
-
-
-  if (opticflow->track_back) {
+                                       opticflow->threshold_vec, max_points, opticflow->pyramid_level, keep_bad_points);
+
+
+  if (opticflow->track_manager) {
+    // forward-backward check, then move the tracks and only keep their good vectors
+    struct flow_t *back_vectors = NULL;
+    if (opticflow->track_fb_threshold > 0.f) {
+      track_manager_flow_ends(&opticflow->tracks, vectors, result->tracked_cnt, opticflow->subpixel_factor,
+                              opticflow->fast9_ret_corners);
+      uint16_t back_track_cnt = result->tracked_cnt;
+      back_vectors = opticFlowLK(&opticflow->prev_img_gray, &opticflow->img_gray, opticflow->fast9_ret_corners,
+                                 &back_track_cnt,
+                                 opticflow->window_size / 2, opticflow->subpixel_factor, opticflow->max_iterations,
+                                 opticflow->threshold_vec, max_points, opticflow->pyramid_level, keep_bad_points);
+    }
+    result->tracked_cnt = track_manager_update(&opticflow->tracks, vectors, result->tracked_cnt, back_vectors,
+                          opticflow->subpixel_factor, opticflow->track_fb_threshold, opticflow->fast9_min_distance);
+    free(back_vectors);
+    result->track_age = opticflow->tracks.mean_age;
+    result->track_lifetime = opticflow->tracks.lost_lifetime;
+  } else if (opticflow->track_back) {
     // TODO: Watch out!
     // We track the flow back and give badly back-tracked vectors a high error,
     // but we do not yet remove these vectors, nor use the errors in any other function than showing the flow.
@@ -670,7 +740,7 @@ bool calc_fast9_lukas_kanade(struct opticflow_t *opticflow, struct image_t *img,
   if (LINEAR_FIT) {
     // Linear flow fit (normally derotation should be performed before):
     error_threshold = 10.0f;
-    n_iterations_RANSAC = 20;
+    n_iterations_RANSAC = opticflow->track_manager ? OPTICFLOW_TRACK_RANSAC_ITERATIONS : 20;
     n_samples_RANSAC = 5;
     success_fit = analyze_linear_flow_field(vectors, result->tracked_cnt, error_threshold, n_iterations_RANSAC,
                                             n_samples_RANSAC, img->w, img->h, &fit_info);
@@ -797,7 +867,7 @@ bool calc_fast9_lukas_kanade(struct opticflow_t *opticflow, struct image_t *img,
   // *************************************************************************************
   // Next Loop Preparation
   // *************************************************************************************
-  if (opticflow->feature_management) {
+  if (opticflow->feature_management && !opticflow->track_manager) {
     result->corner_cnt = result->tracked_cnt;
     //get the new positions of the corners and the "residual" subpixel positions
     for (uint16_t i = 0; i < result->tracked_cnt; i++) {
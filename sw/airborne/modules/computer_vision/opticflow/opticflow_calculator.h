@@ -35,6 +35,7 @@
 #include "std.h"
 #include "inter_thread_data.h"
 #include "lib/vision/image.h"
+#include "lib/vision/track_manager.h"
 #include "lib/v4l/v4l2.h"
 
 struct opticflow_t {
@@ -74,6 +75,10 @@ struct opticflow_t {
   bool fast9_region_detect;       ///< Decides whether to detect fast9 corners in specific regions of interest or the whole image (only for feature management)
   uint8_t fast9_num_regions;      ///< The number of regions of interest the image is split into
 
+  bool track_manager;             ///< Keep persistent tracks, detect only in empty cells and check them forward-backward (replaces feature_management and track_back)
+  float track_fb_threshold;       ///< Maximum forward-backward error of a track in pixels (0 to disable)
+  struct track_manager_t tracks;  ///< The tracks
+
   float actfast_long_step;        ///< Step size to take when there is no texture
   float actfast_short_step;       ///< Step size to take when there is an edge to be followed
   int actfast_min_gradient;       ///< Threshold that decides when there is sufficient texture for edge following
@@ -0,0 +1,394 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of Paparazzi.
+ *
+ * Paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * Paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/computer_vision/video_playback.c
+ *
+ * Play back recorded frames as a simulated camera.
+ */
+
+#include "modules/computer_vision/video_playback.h"
+#include "modules/computer_vision/cv.h"
+#include "modules/computer_vision/lib/vision/image.h"
+#include "mcu_periph/sys_time.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <jpeglib.h>
+
+/** Folder recorded by video_usb_logger */
+#ifndef VIDEO_PLAYBACK_PATH
+#define VIDEO_PLAYBACK_PATH /data/video/usb/pprzvideo00000
+#endif
+
+/** Camera the frames are given to */
+#ifndef VIDEO_PLAYBACK_CAMERA
+#define VIDEO_PLAYBACK_CAMERA front_camera
+#endif
+
+#ifndef VIDEO_PLAYBACK_MODE
+#define VIDEO_PLAYBACK_MODE VIDEO_PLAYBACK_SIM_TIME
+#endif
+PRINT_CONFIG_VAR(VIDEO_PLAYBACK_MODE)
+
+/** Frame rate of recordings without timestamps */
+#ifndef VIDEO_PLAYBACK_FPS
+#define VIDEO_PLAYBACK_FPS 30
+#endif
+
+/** Start again at the end of the recording */
+#ifndef VIDEO_PLAYBACK_LOOP
+#define VIDEO_PLAYBACK_LOOP FALSE
+#endif
+
+/** Stop the simulation at the end of the recording (for benchmarks in CI) */
+#ifndef VIDEO_PLAYBACK_EXIT_AT_END
+#define VIDEO_PLAYBACK_EXIT_AT_END FALSE
+#endif
+
+/** Size of raw UYVY frames, the output size of the camera by default */
+#ifndef VIDEO_PLAYBACK_WIDTH
+#define VIDEO_PLAYBACK_WIDTH (VIDEO_PLAYBACK_CAMERA.output_size.w)
+#endif
+#ifndef VIDEO_PLAYBACK_HEIGHT
+#define VIDEO_PLAYBACK_HEIGHT (VIDEO_PLAYBACK_CAMERA.output_size.h)
+#endif
+
+/** A recorded frame */
+struct playback_frame {
+  uint32_t file_idx;            ///< number of the image file
+  uint32_t ts;                  ///< recording time in us
+  struct FloatEulers eulers;    ///< attitude at recording time
+};
+
+static struct playback_frame *frames = NULL;
+static uint32_t nb_frames = 0;
+static uint32_t next_frame = 0;
+static uint32_t start_time = 0;
+static uint32_t nb_played = 0;
+static uint32_t nb_skipped = 0;
+static bool started = false;
+
+/** Index of a column in the header of the csv, -1 if not found */
+static int csv_column(char *header, const char *name)
+{
+  char buf[512];
+  strncpy(buf, header, sizeof(buf) - 1);
+  buf[sizeof(buf) - 1] = '\0';
+  int idx = 0;
+  for (char *save, *tok = strtok_r(buf, ",\r\n", &save); tok != NULL; tok = strtok_r(NULL, ",\r\n", &save), idx++) {
+    if (strcmp(tok, name) == 0) {
+      return idx;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Read the frames from log.csv of video_usb_logger
+ * The image column is the number of the image file, the timestamp and attitude
+ * columns are optional.
+ */
+static bool load_index(void)
+{
+  char name[512];
+  snprintf(name, sizeof(name), "%s/log.csv", STRINGIFY(VIDEO_PLAYBACK_PATH));
+  FILE *fp = fopen(name, "r");
+  if (fp == NULL) {
+    fprintf(stderr, "[video_playback] Could not open %s\n", name);
+    return false;
+  }
+
+  char line[512];
+  if (fgets(line, sizeof(line), fp) == NULL) {
+    fclose(fp);
+    return false;
+  }
+  const int col_image = csv_column(line, "image");
+  const int col_ts = csv_column(line, "timestamp");
+  const int col_att[3] = { csv_column(line, "roll"), csv_column(line, "pitch"), csv_column(line, "yaw") };
+  if (col_image < 0) {
+    fprintf(stderr, "[video_playback] No image column in %s\n", name);
+    fclose(fp);
+    return false;
+  }
+
+  uint32_t size = 0;
+  while (fgets(line, sizeof(line), fp) != NULL) {
+    if (nb_frames == size) {
+      size = size ? 2 * size : 256;
+      struct playback_frame *f = realloc(frames, size * sizeof(struct playback_frame));
+      if (f == NULL) {
+        break;
+      }
+      frames = f;
+    }
+    double values[32] = { 0 };
+    int nb = 0;
+    for (char *save, *tok = strtok_r(line, ",\r\n", &save); tok != NULL && nb < 32; tok = strtok_r(NULL, ",\r\n", &save)) {
+      values[nb++] = strtod(tok, NULL);
+    }
+    if (col_image >= nb) {
+      continue;
+    }
+    struct playback_frame *f = &frames[nb_frames];
+    f->file_idx = (uint32_t)values[col_image];
+    f->ts = (col_ts >= 0 && col_ts < nb) ? (uint32_t)values[col_ts] : nb_frames * (1000000 / VIDEO_PLAYBACK_FPS);
+    f->eulers.phi = (col_att[0] >= 0 && col_att[0] < nb) ? values[col_att[0]] : 0.f;
+    f->eulers.theta = (col_att[1] >= 0 && col_att[1] < nb) ? values[col_att[1]] : 0.f;
+    f->eulers.psi = (col_att[2] >= 0 && col_att[2] < nb) ? values[col_att[2]] : 0.f;
+    nb_frames++;
+  }
+  fclose(fp);
+  fprintf(stderr, "[video_playback] %d frames in %s\n", nb_frames, STRINGIFY(VIDEO_PLAYBACK_PATH));
+  return nb_frames > 0;
+}
+
+/** libjpeg error handler returning to the decoder instead of exiting */
+struct playback_jpeg_error {
+  struct jpeg_error_mgr mgr;
+  jmp_buf jmp;
+};
+
+static void playback_jpeg_error_exit(j_common_ptr cinfo)
+{
+  struct playback_jpeg_error *err = (struct playback_jpeg_error *)cinfo->err;
+  (*cinfo->err->output_message)(cinfo);
+  longjmp(err->jmp, 1);
+}
+
+/** Decode a JPEG file to a new UYVY image */
+static bool load_jpeg(FILE *fp, struct image_t *img)
+{
+  struct jpeg_decompress_struct cinfo;
+  struct playback_jpeg_error err;
+  // modified after setjmp, so volatile to be valid after an error
+  uint8_t *volatile row = NULL;
+  volatile bool created = false;
+
+  cinfo.err = jpeg_std_error(&err.mgr);
+  err.mgr.error_exit = playback_jpeg_error_exit;
+  if (setjmp(err.jmp)) {
+    jpeg_destroy_decompress(&cinfo);
+    free(row);
+    if (created) {
+      image_free(img);
+    }
+    return false;
+  }
+  jpeg_create_decompress(&cinfo);
+  jpeg_stdio_src(&cinfo, fp);
+  jpeg_read_header(&cinfo, TRUE);
+  cinfo.out_color_space = JCS_YCbCr;
+  jpeg_start_decompress(&cinfo);
+
+  const uint16_t w = cinfo.output_width & ~1U;
+  image_create(img, w, cinfo.output_height, IMAGE_YUV422);
+  created = true;
+  row = malloc(cinfo.output_width * 3);
+  uint8_t *out = img->buf;
+  while (cinfo.output_scanline < cinfo.output_height) {
+    JSAMPROW rows[1] = { row };
+    jpeg_read_scanlines(&cinfo, rows, 1);
+    // YCbCr to UYVY, chroma averaged over pixel pairs
+    for (uint16_t x = 0; x < w; x += 2, out += 4) {
+      const uint8_t *p = &row[x * 3];
+      out[0] = (p[1] + p[4] + 1) / 2;
+      out[1] = p[0];
+      out[2] = (p[2] + p[5] + 1) / 2;
+      out[3] = p[3];
+    }
+  }
+  jpeg_finish_decompress(&cinfo);
+  jpeg_destroy_decompress(&cinfo);
+  free(row);
+  return true;
+}
+
+/** Read a raw UYVY file to a new image */
+static bool load_raw(FILE *fp, struct image_t *img)
+{
+  const uint16_t w = VIDEO_PLAYBACK_WIDTH;
+  const uint16_t h = VIDEO_PLAYBACK_HEIGHT;
+  image_create(img, w, h, IMAGE_YUV422);
+  if (fread(img->buf, 1, img->buf_size, fp) != img->buf_size) {
+    image_free(img);
+    return false;
+  }
+  return true;
+}
+
+/** Load the image of a frame, raw if available, else JPEG */
+static bool load_frame(struct playback_frame *f, struct image_t *img)
+{
+  char name[512];
+  bool ok = false;
+  snprintf(name, sizeof(name), "%s/img_%05d.yuv", STRINGIFY(VIDEO_PLAYBACK_PATH), f->file_idx);
+  FILE *fp = fopen(name, "rb");
+  if (fp != NULL) {
+    ok = load_raw(fp, img);
+  } else {
+    snprintf(name, sizeof(name), "%s/img_%05d.jpg", STRINGIFY(VIDEO_PLAYBACK_PATH), f->file_idx);
+    fp = fopen(name, "rb");
+    if (fp != NULL) {
+      ok = load_jpeg(fp, img);
+    }
+  }
+  if (fp != NULL) {
+    fclose(fp);
+  }
+  if (!ok) {
+    fprintf(stderr, "[video_playback] Could not read %s\n", name);
+  }
+  return ok;
+}
+
+/** Give a frame to the listeners of the camera */
+static void play_frame(struct playback_frame *f)
+{
+  struct image_t img;
+  if (!load_frame(f, &img)) {
+    nb_skipped++;
+    return;
+  }
+  img.eulers = f->eulers;
+  gettimeofday(&img.ts, NULL);
+  img.pprz_ts = get_sys_time_usec();
+  img.buf_idx = 0;
+  cv_run_device(&VIDEO_PLAYBACK_CAMERA, &img);
+  image_free(&img);
+  nb_played++;
+}
+
+/** Go to the next frame, return false at the end of the recording */
+static bool next(void)
+{
+  next_frame++;
+  if (next_frame < nb_frames) {
+    return true;
+  }
+  if (VIDEO_PLAYBACK_LOOP) {
+    next_frame = 0;
+    start_time = get_sys_time_usec();
+    return true;
+  }
+  return false;
+}
+
+/** Wait until the async listeners have processed the last frame,
+ * else they drop the next ones and the throughput would be overstated
+ */
+static void wait_async_listeners(void)
+{
+  for (struct video_listener *l = VIDEO_PLAYBACK_CAMERA.cv_listener; l != NULL; l = l->next) {
+    while (l->async != NULL && l->async->thread_running && !l->async->img_processed) {
+      usleep(100);
+    }
+  }
+}
+
+/** Print the frames played and the frames actually processed by each listener */
+static void end_of_playback(float duration)
+{
+  fprintf(stderr, "[video_playback] End of recording: %d frames played, %d skipped in %.2f s (%.1f fps)\n",
+          nb_played, nb_skipped, duration, duration > 0.f ? nb_played / duration : 0.f);
+  uint8_t idx = 0;
+  for (struct video_listener *l = VIDEO_PLAYBACK_CAMERA.cv_listener; l != NULL; l = l->next, idx++) {
+    struct cv_listener_stats *ls = &l->stats;
+    fprintf(stderr, "[video_playback]   listener %d (id %d%s): %d processed (%.1f fps), %d skipped (max fps), "
+            "%d dropped (busy), proc %.1f ms mean\n", idx, l->id, l->async ? ", async" : "", ls->nb_processed,
+            duration > 0.f ? ls->nb_processed / duration : 0.f, ls->nb_skipped_fps, ls->nb_dropped_busy,
+            ls->proc.count ? ls->proc.sum_us * 1e-3f / ls->proc.count : 0.f);
+  }
+  if (VIDEO_PLAYBACK_EXIT_AT_END) {
+    exit(0);
+  }
+}
+
+/** Play all frames as fast as the listeners process them */
+static void *playback_thread(void *data __attribute__((unused)))
+{
+  struct timeval t0, t1;
+  gettimeofday(&t0, NULL);
+  do {
+    play_frame(&frames[next_frame]);
+    wait_async_listeners();
+  } while (next());
+  gettimeofday(&t1, NULL);
+  end_of_playback((t1.tv_sec - t0.tv_sec) + (t1.tv_usec - t0.tv_usec) * 1e-6f);
+  return NULL;
+}
+
+void video_playback_init(void)
+{
+  if (!load_index()) {
+    nb_frames = 0;
+  }
+}
+
+/**
+ * Start the playback on the first call, when all listeners are registered,
+ * then play the frames in simulation time
+ */
+void video_playback_periodic(void)
+{
+  if (nb_frames == 0 || (started && VIDEO_PLAYBACK_MODE == VIDEO_PLAYBACK_FAST)) {
+    return;
+  }
+  if (next_frame >= nb_frames) {
+    return;
+  }
+
+  if (!started) {
+    started = true;
+    start_time = get_sys_time_usec();
+    if (VIDEO_PLAYBACK_MODE == VIDEO_PLAYBACK_FAST) {
+      pthread_t tid;
+      if (pthread_create(&tid, NULL, playback_thread, NULL) != 0) {
+        fprintf(stderr, "[video_playback] Could not create the playback thread\n");
+        nb_frames = 0;
+        return;
+      }
+      pthread_setname_np(tid, "video_playback");
+      pthread_detach(tid);
+      return;
+    }
+  }
+
+  // latest frame due, late frames are skipped as a camera would drop them
+  const uint32_t elapsed = get_sys_time_usec() - start_time;
+  const uint32_t ts0 = frames[0].ts;
+  if (frames[next_frame].ts - ts0 > elapsed) {
+    return;
+  }
+  while (next_frame + 1 < nb_frames && frames[next_frame + 1].ts - ts0 <= elapsed) {
+    next_frame++;
+    nb_skipped++;
+  }
+  play_frame(&frames[next_frame]);
+  if (!next()) {
+    end_of_playback(elapsed * 1e-6f);
+  }
+}
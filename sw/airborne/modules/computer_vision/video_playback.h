@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of Paparazzi.
+ *
+ * Paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * Paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/computer_vision/video_playback.h
+ *
+ * Play back recorded frames as a simulated camera.
+ *
+ * Reads a folder recorded by video_usb_logger (log.csv and img_xxxxx.jpg or
+ * raw UYVY img_xxxxx.yuv files) and gives the frames to the listeners of a
+ * camera with cv_run_device(), as the Gazebo camera does. The recorded
+ * attitude is set in the eulers of the image.
+ *
+ * Frames are either played at their recorded rate in simulation time, or as
+ * fast as possible in a separate thread to measure the throughput of the
+ * vision modules.
+ */
+
+#ifndef VIDEO_PLAYBACK_H
+#define VIDEO_PLAYBACK_H
+
+#include "std.h"
+
+/** Playback modes */
+#define VIDEO_PLAYBACK_SIM_TIME 0   ///< at the recorded rate in simulation time
+#define VIDEO_PLAYBACK_FAST     1   ///< as fast as possible
+
+extern void video_playback_init(void);
+extern void video_playback_periodic(void);
+
+#endif /* VIDEO_PLAYBACK_H */
@@ -80,7 +80,7 @@ static void stop_video_thread(struct video_config_t *device);;
 
 void video_thread_periodic(void)
 {
-  /* currently no direct periodic functionality */
+  cv_stats_periodic(cameras, VIDEO_THREAD_MAX_CAMERAS);
 }
 
 /**
@@ -117,7 +117,7 @@ static void *video_thread_function(void *data)
 #endif
 
   // Be nice to the more important stuff
-  set_nice_level(VIDEO_THREAD_NICE_LEVEL);
+  rt_thread_setup_nice(VIDEO_THREAD_NICE_LEVEL, RT_CPUS_VISION);
   fprintf(stdout, "[%s] Set nice level to %i.\n", print_tag, VIDEO_THREAD_NICE_LEVEL);
 
   // Initialize timing
@@ -155,6 +155,7 @@ static void *video_thread_function(void *data)
     if (vid->fps > 0) {
       uint32_t fps_period_us = 1000000 / vid->fps;
       if (frame_dt_us > fps_period_us + 10000) {
+        vid->thread.stats.nb_slow++;
         fprintf(stderr, "[%s] desired %i fps, only managing %.1f fps\n", print_tag, vid->fps, 1000000.f / frame_dt_us);
       }
       computation_dt_us = get_sys_time_usec() - time_begin;
@@ -89,7 +89,7 @@ void video_thread_init(void)
 }
 void video_thread_periodic(void)
 {
-
+  cv_stats_periodic(cameras, VIDEO_THREAD_MAX_CAMERAS);
 }
 
 void video_thread_start(void)
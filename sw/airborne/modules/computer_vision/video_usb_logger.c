@@ -27,7 +27,7 @@
 #include "video_usb_logger.h"
 
 #include <stdio.h>
-#include "state.h"
+#include "modules/core/state_snapshot.h"
 #include "viewvideo.h"
 #include "cv.h"
 #include <unistd.h>
@@ -43,6 +43,11 @@
 #define VIDEO_USB_LOGGER_PATH /data/video/usb
 #endif
 
+/** Save raw UYVY frames instead of JPEG */
+#ifndef VIDEO_USB_LOGGER_RAW
+#define VIDEO_USB_LOGGER_RAW FALSE
+#endif
+
 #ifndef VIDEO_USB_LOGGER_FPS
 #define VIDEO_USB_LOGGER_FPS 0       ///< Default FPS (zero means run at camera fps)
 #endif
@@ -61,9 +66,21 @@ static void save_shot_on_disk(struct image_t *img, struct image_t *img_jpeg)
   // Search for a file where we can write to
   char save_name[128];
 
-  snprintf(save_name, sizeof(save_name), "%s/img_%05d.jpg", foldername, shotNumber);
+  const int shot = shotNumber++;
+#if VIDEO_USB_LOGGER_RAW
+  // raw UYVY frame, lossless for video_playback
+  snprintf(save_name, sizeof(save_name), "%s/img_%05d.yuv", foldername, shot);
+  if (access(save_name, F_OK) == -1) {
+    FILE *fp = fopen(save_name, "w");
+    if (fp == NULL) {
+      printf("[video_thread-thread] Could not write shot %s.\n", save_name);
+    } else {
+      fwrite(img->buf, sizeof(uint8_t), img->buf_size, fp);
+      fclose(fp);
+    }
+#else
+  snprintf(save_name, sizeof(save_name), "%s/img_%05d.jpg", foldername, shot);
 
-  shotNumber++;
   // Check if file exists or not
   if (access(save_name, F_OK) == -1) {
 
@@ -83,6 +100,7 @@ static void save_shot_on_disk(struct image_t *img, struct image_t *img_jpeg)
       printf("Wrote image\n");
     }
 #endif
+#endif
 
 
 
@@ -93,19 +111,22 @@ static void save_shot_on_disk(struct image_t *img, struct image_t *img_jpeg)
 
     static uint32_t counter = 0;
     struct pose_t pose = get_rotation_at_timestamp(img->pprz_ts);
-    struct NedCoor_i *ned = stateGetPositionNed_i();
-    struct NedCoor_i *accel = stateGetAccelNed_i();
+    // video thread, read the state from the snapshot
+    struct StateSnapshot snapshot = { 0 };
+    state_snapshot_get(&snapshot);
+    struct NedCoor_i *ned = &snapshot.ned_pos_i;
+    struct NedCoor_i *accel = &snapshot.ned_accel_i;
     static uint32_t sonar = 0;
 
 
     // Save current information to a file
-    fprintf(video_usb_logger, "%d,%d,%f,%f,%f,%d,%d,%d,%d,%d,%d,%f,%f,%f,%d\n", counter,
-            shotNumber,
+    fprintf(video_usb_logger, "%d,%d,%f,%f,%f,%d,%d,%d,%d,%d,%d,%f,%f,%f,%d,%u\n", counter,
+            shot,
             pose.eulers.phi, pose.eulers.theta, pose.eulers.psi,
             ned->x, ned->y, ned->z,
             accel->x, accel->y, accel->z,
             pose.rates.p, pose.rates.q, pose.rates.r,
-            sonar);
+            sonar, img->pprz_ts);
     counter++;
   }
 
@@ -144,7 +165,7 @@ void video_usb_logger_start(void)
   video_usb_logger = fopen(filename, "w");
 
   if (video_usb_logger != NULL) {
-    fprintf(video_usb_logger, "counter,image,roll,pitch,yaw,x,y,z,accelx,accely,accelz,ratep,rateq,rater,sonar\n");
+    fprintf(video_usb_logger, "counter,image,roll,pitch,yaw,x,y,z,accelx,accely,accelz,ratep,rateq,rater,sonar,timestamp\n");
   }
 
   // Subscribe to a camera
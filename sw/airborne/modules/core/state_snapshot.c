@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/core/state_snapshot.c
+ *
+ * Consistent copy of the state for other threads.
+ */
+
+#include "modules/core/state_snapshot.h"
+#include "state.h"
+#include "mcu_periph/sys_time.h"
+
+#include <string.h>
+
+/** A published snapshot, odd sequence while being written */
+struct state_snapshot_slot {
+  uint32_t seq;
+  struct StateSnapshot data;
+};
+
+static struct state_snapshot_slot slots[2];
+
+/** Number of published snapshots, the last one is in slots[latest & 1] */
+static uint32_t latest;
+
+/** Snapshot under construction, only used by the autopilot thread */
+static struct StateSnapshot current;
+
+void state_snapshot_init(void)
+{
+  memset(slots, 0, sizeof(slots));
+  latest = 0;
+}
+
+/** Fill the snapshot, the getters compute the missing representations */
+static void state_snapshot_fill(struct StateSnapshot *s)
+{
+  memset(s, 0, sizeof(struct StateSnapshot));
+  s->timestamp = get_sys_time_usec();
+
+  if (stateIsLocalCoordinateValid()) {
+    s->valid |= STATE_SNAPSHOT_LOCAL_POS;
+    s->ned_pos_f = *stateGetPositionNed_f();
+    s->enu_pos_f = *stateGetPositionEnu_f();
+    s->ned_pos_i = *stateGetPositionNed_i();
+    s->ned_speed_f = *stateGetSpeedNed_f();
+    s->enu_speed_f = *stateGetSpeedEnu_f();
+    s->ned_speed_i = *stateGetSpeedNed_i();
+    s->h_speed_norm_f = stateGetHorizontalSpeedNorm_f();
+    s->h_speed_dir_f = stateGetHorizontalSpeedDir_f();
+    s->alt_agl_f = state.alt_agl_f;
+  }
+  if (stateIsGlobalCoordinateValid()) {
+    s->valid |= STATE_SNAPSHOT_GLOBAL_POS;
+    s->lla_pos_f = *stateGetPositionLla_f();
+  }
+  if (stateIsAccelValid()) {
+    s->valid |= STATE_SNAPSHOT_ACCEL;
+    s->ned_accel_f = *stateGetAccelNed_f();
+    s->ned_accel_i = *stateGetAccelNed_i();
+  }
+  if (stateIsAttitudeValid()) {
+    s->valid |= STATE_SNAPSHOT_ATTITUDE;
+    s->ned_to_body_quat_f = *stateGetNedToBodyQuat_f();
+    s->ned_to_body_eulers_f = *stateGetNedToBodyEulers_f();
+    s->ned_to_body_rmat_f = *stateGetNedToBodyRMat_f();
+    s->ned_to_body_rmat_i = *stateGetNedToBodyRMat_i();
+  }
+  if (stateIsRateValid()) {
+    s->valid |= STATE_SNAPSHOT_RATES;
+    s->body_rates_f = *stateGetBodyRates_f();
+  }
+  // stateIsAirspeedValid() and stateIsWindspeedValid() clear the status, test the bits
+  if (state.wind_air_status & ((1 << AIRSPEED_I) | (1 << AIRSPEED_F))) {
+    s->valid |= STATE_SNAPSHOT_AIRSPEED;
+    s->airspeed_f = stateGetAirspeed_f();
+  }
+  if (state.wind_air_status & ((1 << WINDSPEED_I) | (1 << WINDSPEED_F))) {
+    s->valid |= STATE_SNAPSHOT_WINDSPEED;
+    s->windspeed_f = *stateGetWindspeed_f();
+  }
+}
+
+void state_snapshot_publish(void)
+{
+  state_snapshot_fill(&current);
+
+  uint32_t next = latest + 1;
+  struct state_snapshot_slot *slot = &slots[next & 1];
+  current.counter = next;
+
+  // readers of this slot retry while the sequence is odd or has changed
+  __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy(&slot->data, &current, sizeof(struct StateSnapshot));
+  __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELEASE);
+
+  __atomic_store_n(&latest, next, __ATOMIC_RELEASE);
+}
+
+bool state_snapshot_get(struct StateSnapshot *snapshot)
+{
+  for (;;) {
+    uint32_t n = __atomic_load_n(&latest, __ATOMIC_ACQUIRE);
+    if (n == 0) {
+      return false;
+    }
+    struct state_snapshot_slot *slot = &slots[n & 1];
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (seq & 1) {
+      // the writer already went past this one, take the newer snapshot
+      continue;
+    }
+    memcpy(snapshot, &slot->data, sizeof(struct StateSnapshot));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq) {
+      return true;
+    }
+  }
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/core/state_snapshot.h
+ *
+ * Consistent copy of the state for other threads.
+ *
+ * The state interface computes missing representations on the fly and writes
+ * them back into the shared state struct, so it must only be used from the
+ * autopilot thread. This module copies the commonly used representations
+ * into an immutable snapshot once per control cycle (all lazy conversions
+ * happen there, in the autopilot thread) and publishes it with a sequence
+ * lock over two slots.
+ *
+ * Readers from any thread (video, companion bridges, loggers) never block
+ * the autopilot and never see a torn snapshot. A read only retries if the
+ * writer went through both slots during the copy, i.e. a reader slower than
+ * a full control period.
+ */
+
+#ifndef STATE_SNAPSHOT_H
+#define STATE_SNAPSHOT_H
+
+#include "std.h"
+#include "math/pprz_algebra_int.h"
+#include "math/pprz_algebra_float.h"
+#include "math/pprz_geodetic_int.h"
+#include "math/pprz_geodetic_float.h"
+
+/** Validity flags of a snapshot */
+#define STATE_SNAPSHOT_LOCAL_POS  (1 << 0)  ///< local position and speed are valid
+#define STATE_SNAPSHOT_GLOBAL_POS (1 << 1)  ///< global position is valid
+#define STATE_SNAPSHOT_ATTITUDE   (1 << 2)  ///< attitude is valid
+#define STATE_SNAPSHOT_RATES      (1 << 3)  ///< body rates are valid
+#define STATE_SNAPSHOT_ACCEL      (1 << 4)  ///< accelerations are valid
+#define STATE_SNAPSHOT_AIRSPEED   (1 << 5)  ///< airspeed is valid
+#define STATE_SNAPSHOT_WINDSPEED  (1 << 6)  ///< wind speed is valid
+
+struct StateSnapshot {
+  uint32_t timestamp;               ///< time of the copy (us since startup)
+  uint32_t counter;                 ///< number of the snapshot
+  uint8_t valid;                    ///< validity flags (STATE_SNAPSHOT_x)
+
+  /* position */
+  struct NedCoor_f ned_pos_f;
+  struct EnuCoor_f enu_pos_f;
+  struct LlaCoor_f lla_pos_f;
+  struct NedCoor_i ned_pos_i;
+  float alt_agl_f;                  ///< altitude above ground level
+
+  /* speed */
+  struct NedCoor_f ned_speed_f;
+  struct EnuCoor_f enu_speed_f;
+  struct NedCoor_i ned_speed_i;
+  float h_speed_norm_f;
+  float h_speed_dir_f;
+
+  /* acceleration */
+  struct NedCoor_f ned_accel_f;
+  struct NedCoor_i ned_accel_i;
+
+  /* attitude */
+  struct FloatQuat ned_to_body_quat_f;
+  struct FloatEulers ned_to_body_eulers_f;
+  struct FloatRMat ned_to_body_rmat_f;
+  struct Int32RMat ned_to_body_rmat_i;
+  struct FloatRates body_rates_f;
+
+  /* air data */
+  float airspeed_f;
+  struct FloatVect3 windspeed_f;
+};
+
+extern void state_snapshot_init(void);
+
+/**
+ * Copy the state and publish it, must be called from the autopilot thread
+ */
+extern void state_snapshot_publish(void);
+
+/**
+ * Get the last published snapshot, can be called from any thread
+ * @param[out] *snapshot The copy of the state
+ * @return false if nothing was published yet
+ */
+extern bool state_snapshot_get(struct StateSnapshot *snapshot);
+
+#endif /* STATE_SNAPSHOT_H */
@@ -0,0 +1,384 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file "modules/imu/filter_rpm_notch_imu.c"
+ * Prefiltering for IMU data with notch filters tracking the motor RPM harmonics
+ *
+ * Gyro and accel are filtered by a cascade of one notch per motor and
+ * harmonic, optional dynamic notches placed on the peaks of the measured
+ * vibration spectrum (VIBRATION_PEAKS message), and an optional low pass.
+ * All axis are processed together by a biquad filter bank.
+ *
+ * Bursts of samples (IMU_BATCH_INT32 message) are filtered block per block,
+ * the sample frequency then follows the sampling period of the batches.
+ */
+
+#include "modules/imu/filter_rpm_notch_imu.h"
+#include "filters/biquad_bank.h"
+#include "math/pprz_algebra_int.h"
+#include "math/pprz_algebra_float.h"
+#include "subsystems/abi.h"
+#include "generated/airframe.h"
+#include <string.h>
+#include <math.h>
+
+/** Enable by default */
+#ifndef FILTER_RPM_NOTCH_ENABLED
+#define FILTER_RPM_NOTCH_ENABLED TRUE
+#endif
+
+/** Number of motors */
+#ifndef FILTER_RPM_NOTCH_NB_MOTORS
+#define FILTER_RPM_NOTCH_NB_MOTORS 4
+#endif
+
+/** Number of harmonics per motor */
+#ifndef FILTER_RPM_NOTCH_NB_HARMONICS
+#define FILTER_RPM_NOTCH_NB_HARMONICS 3
+#endif
+
+/** Number of dynamic notches following the vibration peaks, 0 to disable */
+#ifndef FILTER_RPM_NOTCH_NB_DYN
+#define FILTER_RPM_NOTCH_NB_DYN 0
+#endif
+
+#if (FILTER_RPM_NOTCH_NB_MOTORS * FILTER_RPM_NOTCH_NB_HARMONICS + FILTER_RPM_NOTCH_NB_DYN + 1) > BIQUAD_BANK_MAX_STAGES
+#error "FILTER_RPM_NOTCH: too many notches, increase BIQUAD_BANK_MAX_STAGES"
+#endif
+
+/** Default quality factor of the notches */
+#ifndef FILTER_RPM_NOTCH_Q
+#define FILTER_RPM_NOTCH_Q 3.f
+#endif
+
+/** Default min notch frequency (Hz) */
+#ifndef FILTER_RPM_NOTCH_MIN_FREQ
+#define FILTER_RPM_NOTCH_MIN_FREQ 40.f
+#endif
+
+/** Default low pass cut-off frequency (Hz), 0 to disable */
+#ifndef FILTER_RPM_NOTCH_LOWPASS_FREQ
+#define FILTER_RPM_NOTCH_LOWPASS_FREQ 0.f
+#endif
+
+/** IMU sample frequency, until the sampling period of a batch is received */
+#ifndef FILTER_RPM_NOTCH_FREQ
+#if defined AHRS_PROPAGATE_FREQUENCY
+#define FILTER_RPM_NOTCH_FREQ AHRS_PROPAGATE_FREQUENCY
+#elif defined INS_PROPAGATE_FREQUENCY
+#define FILTER_RPM_NOTCH_FREQ INS_PROPAGATE_FREQUENCY
+#else
+#define FILTER_RPM_NOTCH_FREQ PERIODIC_FREQUENCY
+#endif
+#endif
+PRINT_CONFIG_VAR(FILTER_RPM_NOTCH_FREQ)
+
+/** Max number of samples filtered in one block, larger batches are split */
+#ifndef FILTER_RPM_NOTCH_BATCH_MAX
+#define FILTER_RPM_NOTCH_BATCH_MAX 32
+#endif
+
+/** index of the first dynamic notch stage, after the RPM notches */
+#define FILTER_RPM_NOTCH_DYN_STAGE (FILTER_RPM_NOTCH_NB_MOTORS * FILTER_RPM_NOTCH_NB_HARMONICS)
+
+/** index of the low pass stage, after the notches */
+#define FILTER_RPM_NOTCH_LP_STAGE (FILTER_RPM_NOTCH_DYN_STAGE + FILTER_RPM_NOTCH_NB_DYN)
+
+/**
+ * configuration structure
+ */
+struct FilterRpmNotchImu filter_rpm_notch_imu;
+
+/**
+ * filter banks for gyrometer and accelerometer, same coefficients
+ */
+static struct BiquadBank gyro_bank;
+static struct BiquadBank accel_bank;
+
+/** current sample frequency [Hz] */
+static float sample_freq;
+
+/** last notch frequencies, to recompute the coefficients on a sample frequency change */
+static uint16_t last_rpm[FILTER_RPM_NOTCH_NB_MOTORS];
+static uint8_t last_nb_rpm;
+#if FILTER_RPM_NOTCH_NB_DYN
+static float last_peaks[FILTER_RPM_NOTCH_NB_DYN];
+static uint8_t last_nb_peaks;
+#endif
+
+/** sender of the batches and its latest filtered sample,
+ * sent again instead of filtering the copy in IMU_GYRO_INT32 and IMU_ACCEL_INT32
+ */
+static uint8_t batch_sender;
+static struct Int32Rates batch_gyro;
+static struct Int32Vect3 batch_accel;
+
+/**
+ * ABI bindings
+ *
+ * by default bind to all IMU raw data and send filtered data
+ * receivers (AHRS, INS) should bind to this prefilter module
+ */
+/** IMU (gyro, accel) */
+#ifndef IMU_RPM_NOTCH_BIND_ID
+#define IMU_RPM_NOTCH_BIND_ID ABI_BROADCAST
+#endif
+PRINT_CONFIG_VAR(IMU_RPM_NOTCH_BIND_ID)
+
+/** RPM */
+#ifndef IMU_RPM_NOTCH_RPM_ID
+#define IMU_RPM_NOTCH_RPM_ID ABI_BROADCAST
+#endif
+PRINT_CONFIG_VAR(IMU_RPM_NOTCH_RPM_ID)
+
+/** Vibration peaks */
+#ifndef IMU_RPM_NOTCH_PEAKS_ID
+#define IMU_RPM_NOTCH_PEAKS_ID ABI_BROADCAST
+#endif
+
+static abi_event gyro_ev;
+static abi_event accel_ev;
+static abi_event batch_ev;
+static abi_event mag_ev; // only passthrough
+static abi_event rpm_ev;
+#if FILTER_RPM_NOTCH_NB_DYN
+static abi_event peaks_ev;
+#endif
+
+static void copy_coefficients(void)
+{
+  memcpy(accel_bank.b0, gyro_bank.b0, sizeof(gyro_bank.b0));
+  memcpy(accel_bank.b1, gyro_bank.b1, sizeof(gyro_bank.b1));
+  memcpy(accel_bank.b2, gyro_bank.b2, sizeof(gyro_bank.b2));
+  memcpy(accel_bank.a1, gyro_bank.a1, sizeof(gyro_bank.a1));
+  memcpy(accel_bank.a2, gyro_bank.a2, sizeof(gyro_bank.a2));
+}
+
+static void update_rpm_notches(void)
+{
+  for (uint8_t m = 0; m < last_nb_rpm; m++) {
+    float f0 = last_rpm[m] / 60.f;
+    for (uint8_t h = 0; h < FILTER_RPM_NOTCH_NB_HARMONICS; h++) {
+      uint8_t stage = m * FILTER_RPM_NOTCH_NB_HARMONICS + h;
+      float f = f0 * (h + 1);
+      if (f < filter_rpm_notch_imu.min_freq) {
+        biquad_bank_set_bypass(&gyro_bank, stage);
+      } else {
+        biquad_bank_set_notch(&gyro_bank, stage, f, filter_rpm_notch_imu.q, sample_freq);
+      }
+    }
+  }
+}
+
+static void rpm_cb(uint8_t sender_id __attribute__((unused)), uint16_t *rpm, uint8_t num_act)
+{
+  last_nb_rpm = Min(num_act, FILTER_RPM_NOTCH_NB_MOTORS);
+  memcpy(last_rpm, rpm, last_nb_rpm * sizeof(uint16_t));
+  update_rpm_notches();
+  copy_coefficients();
+}
+
+#if FILTER_RPM_NOTCH_NB_DYN
+static void update_dyn_notches(void)
+{
+  for (uint8_t i = 0; i < FILTER_RPM_NOTCH_NB_DYN; i++) {
+    uint8_t stage = FILTER_RPM_NOTCH_DYN_STAGE + i;
+    if (i >= last_nb_peaks || last_peaks[i] < filter_rpm_notch_imu.min_freq) {
+      biquad_bank_set_bypass(&gyro_bank, stage);
+    } else {
+      biquad_bank_set_notch(&gyro_bank, stage, last_peaks[i], filter_rpm_notch_imu.q, sample_freq);
+    }
+  }
+}
+
+static void peaks_cb(uint8_t sender_id __attribute__((unused)), float *freq, float *amp __attribute__((unused)),
+                     uint8_t nb)
+{
+  last_nb_peaks = Min(nb, FILTER_RPM_NOTCH_NB_DYN);
+  memcpy(last_peaks, freq, last_nb_peaks * sizeof(float));
+  update_dyn_notches();
+  copy_coefficients();
+}
+#endif
+
+/** Follow the sampling period of the batches, all stages are recomputed
+ * when the sample frequency changes by more than 1%
+ */
+static void update_sample_freq(float dt)
+{
+  if (dt <= 0.f || fabsf(1.f - dt * sample_freq) < 0.01f) {
+    return;
+  }
+  sample_freq = 1.f / dt;
+  update_rpm_notches();
+#if FILTER_RPM_NOTCH_NB_DYN
+  update_dyn_notches();
+#endif
+  filter_rpm_notch_imu_update_lowpass(filter_rpm_notch_imu.lowpass_freq);
+}
+
+static void batch_cb(uint8_t sender_id, uint32_t stamp, struct Int32Rates *gyro, struct Int32Vect3 *accel,
+                     uint8_t nb, float dt)
+{
+  static float gyro_block[FILTER_RPM_NOTCH_BATCH_MAX][BIQUAD_BANK_LANES];
+  static float accel_block[FILTER_RPM_NOTCH_BATCH_MAX][BIQUAD_BANK_LANES];
+  static struct Int32Rates gyro_out[FILTER_RPM_NOTCH_BATCH_MAX];
+  static struct Int32Vect3 accel_out[FILTER_RPM_NOTCH_BATCH_MAX];
+
+  if (sender_id == IMU_RPM_NOTCH_ID || nb == 0) {
+    return; // don't process own data
+  }
+  batch_sender = sender_id;
+  update_sample_freq(dt);
+
+  for (uint8_t start = 0; start < nb; start += FILTER_RPM_NOTCH_BATCH_MAX) {
+    uint8_t n = Min(nb - start, FILTER_RPM_NOTCH_BATCH_MAX);
+    struct Int32Rates *g = &gyro[start];
+    struct Int32Vect3 *a = &accel[start];
+    if (filter_rpm_notch_imu.enabled) {
+      for (uint8_t i = 0; i < n; i++) {
+        gyro_block[i][0] = RATE_FLOAT_OF_BFP(g[i].p);
+        gyro_block[i][1] = RATE_FLOAT_OF_BFP(g[i].q);
+        gyro_block[i][2] = RATE_FLOAT_OF_BFP(g[i].r);
+        accel_block[i][0] = ACCEL_FLOAT_OF_BFP(a[i].x);
+        accel_block[i][1] = ACCEL_FLOAT_OF_BFP(a[i].y);
+        accel_block[i][2] = ACCEL_FLOAT_OF_BFP(a[i].z);
+      }
+      biquad_bank_update_block(&gyro_bank, gyro_block, n);
+      biquad_bank_update_block(&accel_bank, accel_block, n);
+      for (uint8_t i = 0; i < n; i++) {
+        RATES_ASSIGN(gyro_out[i], RATE_BFP_OF_REAL(gyro_block[i][0]), RATE_BFP_OF_REAL(gyro_block[i][1]),
+                     RATE_BFP_OF_REAL(gyro_block[i][2]));
+        VECT3_ASSIGN(accel_out[i], ACCEL_BFP_OF_REAL(accel_block[i][0]), ACCEL_BFP_OF_REAL(accel_block[i][1]),
+                     ACCEL_BFP_OF_REAL(accel_block[i][2]));
+      }
+      g = gyro_out;
+      a = accel_out;
+    }
+    // stamp of the latest sample of this block
+    uint32_t block_stamp = stamp - (uint32_t)((nb - start - n) * dt * 1e6f);
+    AbiSendMsgIMU_BATCH_INT32(IMU_RPM_NOTCH_ID, block_stamp, g, a, n, dt);
+    RATES_COPY(batch_gyro, g[n - 1]);
+    VECT3_COPY(batch_accel, a[n - 1]);
+  }
+}
+
+static void gyro_cb(uint8_t sender_id, uint32_t stamp, struct Int32Rates *gyro)
+{
+  if (sender_id == IMU_RPM_NOTCH_ID) {
+    return; // don't process own data
+  }
+  if (sender_id == batch_sender) {
+    // latest sample of the batch, already filtered
+    AbiSendMsgIMU_GYRO_INT32(IMU_RPM_NOTCH_ID, stamp, &batch_gyro);
+    return;
+  }
+
+  if (filter_rpm_notch_imu.enabled) {
+    float v[BIQUAD_BANK_LANES] = { RATE_FLOAT_OF_BFP(gyro->p), RATE_FLOAT_OF_BFP(gyro->q), RATE_FLOAT_OF_BFP(gyro->r) };
+    biquad_bank_update(&gyro_bank, v, v);
+    // send filtered data
+    struct Int32Rates gyro_i = { RATE_BFP_OF_REAL(v[0]), RATE_BFP_OF_REAL(v[1]), RATE_BFP_OF_REAL(v[2]) };
+    AbiSendMsgIMU_GYRO_INT32(IMU_RPM_NOTCH_ID, stamp, &gyro_i);
+  } else {
+    AbiSendMsgIMU_GYRO_INT32(IMU_RPM_NOTCH_ID, stamp, gyro);
+  }
+}
+
+static void accel_cb(uint8_t sender_id, uint32_t stamp, struct Int32Vect3 *accel)
+{
+  if (sender_id == IMU_RPM_NOTCH_ID) {
+    return; // don't process own data
+  }
+  if (sender_id == batch_sender) {
+    // latest sample of the batch, already filtered
+    AbiSendMsgIMU_ACCEL_INT32(IMU_RPM_NOTCH_ID, stamp, &batch_accel);
+    return;
+  }
+
+  if (filter_rpm_notch_imu.enabled) {
+    float v[BIQUAD_BANK_LANES] = { ACCEL_FLOAT_OF_BFP(accel->x), ACCEL_FLOAT_OF_BFP(accel->y), ACCEL_FLOAT_OF_BFP(accel->z) };
+    biquad_bank_update(&accel_bank, v, v);
+    // send filtered data
+    struct Int32Vect3 accel_i = { ACCEL_BFP_OF_REAL(v[0]), ACCEL_BFP_OF_REAL(v[1]), ACCEL_BFP_OF_REAL(v[2]) };
+    AbiSendMsgIMU_ACCEL_INT32(IMU_RPM_NOTCH_ID, stamp, &accel_i);
+  } else {
+    AbiSendMsgIMU_ACCEL_INT32(IMU_RPM_NOTCH_ID, stamp, accel);
+  }
+}
+
+static void mag_cb(uint8_t sender_id, uint32_t stamp, struct Int32Vect3 *mag)
+{
+  if (sender_id == IMU_RPM_NOTCH_ID) {
+    return; // don't process own data
+  }
+
+  AbiSendMsgIMU_MAG_INT32(IMU_RPM_NOTCH_ID, stamp, mag);
+}
+
+/**
+ * Init and bindings
+ */
+void filter_rpm_notch_imu_init(void)
+{
+  filter_rpm_notch_imu.enabled = FILTER_RPM_NOTCH_ENABLED;
+  filter_rpm_notch_imu.q = FILTER_RPM_NOTCH_Q;
+  filter_rpm_notch_imu.min_freq = FILTER_RPM_NOTCH_MIN_FREQ;
+  sample_freq = FILTER_RPM_NOTCH_FREQ;
+  last_nb_rpm = 0;
+  batch_sender = IMU_RPM_NOTCH_ID;
+
+  // notches are disabled until RPM are received
+  biquad_bank_init(&gyro_bank, FILTER_RPM_NOTCH_LP_STAGE + 1);
+  biquad_bank_init(&accel_bank, FILTER_RPM_NOTCH_LP_STAGE + 1);
+  filter_rpm_notch_imu_update_lowpass(FILTER_RPM_NOTCH_LOWPASS_FREQ);
+
+  AbiBindMsgIMU_GYRO_INT32(IMU_RPM_NOTCH_BIND_ID, &gyro_ev, gyro_cb);
+  AbiBindMsgIMU_ACCEL_INT32(IMU_RPM_NOTCH_BIND_ID, &accel_ev, accel_cb);
+  AbiBindMsgIMU_BATCH_INT32(IMU_RPM_NOTCH_BIND_ID, &batch_ev, batch_cb);
+  AbiBindMsgIMU_MAG_INT32(IMU_RPM_NOTCH_BIND_ID, &mag_ev, mag_cb);
+  AbiBindMsgRPM(IMU_RPM_NOTCH_RPM_ID, &rpm_ev, rpm_cb);
+#if FILTER_RPM_NOTCH_NB_DYN
+  AbiBindMsgVIBRATION_PEAKS(IMU_RPM_NOTCH_PEAKS_ID, &peaks_ev, peaks_cb);
+#endif
+}
+
+/**
+ * settings handlers
+ */
+
+void filter_rpm_notch_imu_reset(float enabled)
+{
+  filter_rpm_notch_imu.enabled = enabled;
+  for (uint8_t s = 0; s < BIQUAD_BANK_MAX_STAGES; s++) {
+    for (uint8_t l = 0; l < BIQUAD_BANK_LANES; l++) {
+      gyro_bank.z1[s][l] = gyro_bank.z2[s][l] = 0.f;
+      accel_bank.z1[s][l] = accel_bank.z2[s][l] = 0.f;
+    }
+  }
+}
+
+void filter_rpm_notch_imu_update_lowpass(float freq)
+{
+  filter_rpm_notch_imu.lowpass_freq = freq;
+  // bypass if 0 or above Nyquist
+  biquad_bank_set_lowpass(&gyro_bank, FILTER_RPM_NOTCH_LP_STAGE, freq, 0.7071f, sample_freq);
+  copy_coefficients();
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file "modules/imu/filter_rpm_notch_imu.h"
+ * Prefiltering for IMU data with notch filters tracking the motor RPM harmonics
+ */
+
+#ifndef FILTER_RPM_NOTCH_IMU_H
+#define FILTER_RPM_NOTCH_IMU_H
+
+#include "std.h"
+
+struct FilterRpmNotchImu {
+  bool enabled;
+  float q;              ///< quality factor of the notches
+  float min_freq;       ///< notches below this frequency [Hz] are disabled
+  float lowpass_freq;   ///< cut-off frequency of the low pass stage [Hz], 0 to disable
+};
+
+extern struct FilterRpmNotchImu filter_rpm_notch_imu;
+
+extern void filter_rpm_notch_imu_init(void);
+
+/**
+ * settings handlers
+ */
+extern void filter_rpm_notch_imu_reset(float enabled);
+extern void filter_rpm_notch_imu_update_lowpass(float freq);
+
+#endif
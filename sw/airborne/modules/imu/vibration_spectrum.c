@@ -0,0 +1,361 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file "modules/imu/vibration_spectrum.c"
+ * On-board vibration spectrum of the IMU data
+ *
+ * Welch method: the samples of the 3 axis are cut in segments of
+ * VIBRATION_SPECTRUM_FFT_LEN samples with 50% overlap, each segment is
+ * detrended, multiplied by a Hann window and transformed with a radix-2
+ * float FFT. The power spectra of the 3 axis are summed and averaged over
+ * VIBRATION_SPECTRUM_AVERAGES segments.
+ *
+ * Samples are only stored by the ABI callback, the FFTs are computed in
+ * the event loop, one axis at a time, to spread the load.
+ * With the default 256 points at 1kHz, about 24 FFTs per second are
+ * computed (7.8 segments per second on 3 axis).
+ */
+
+#include "modules/imu/vibration_spectrum.h"
+#include "math/pprz_algebra_int.h"
+#include "math/pprz_algebra_float.h"
+#include "subsystems/abi.h"
+#include "subsystems/datalink/downlink.h"
+#include "generated/airframe.h"
+#include <math.h>
+#include <string.h>
+
+/** Enable by default */
+#ifndef VIBRATION_SPECTRUM_ENABLED
+#define VIBRATION_SPECTRUM_ENABLED TRUE
+#endif
+
+/** Analyzed signal */
+#ifndef VIBRATION_SPECTRUM_SOURCE
+#define VIBRATION_SPECTRUM_SOURCE VIBRATION_SPECTRUM_ACCEL
+#endif
+
+/** FFT length, power of 2 */
+#ifndef VIBRATION_SPECTRUM_FFT_LEN
+#define VIBRATION_SPECTRUM_FFT_LEN 256
+#endif
+
+#if (VIBRATION_SPECTRUM_FFT_LEN & (VIBRATION_SPECTRUM_FFT_LEN - 1)) != 0
+#error "VIBRATION_SPECTRUM_FFT_LEN should be a power of 2"
+#endif
+
+/** Number of averaged segments per spectrum */
+#ifndef VIBRATION_SPECTRUM_AVERAGES
+#define VIBRATION_SPECTRUM_AVERAGES 8
+#endif
+
+/** Peaks below this frequency are ignored [Hz] */
+#ifndef VIBRATION_SPECTRUM_MIN_FREQ
+#define VIBRATION_SPECTRUM_MIN_FREQ 20.f
+#endif
+
+/** Publish the peaks with the VIBRATION_PEAKS ABI message (notch tuning) */
+#ifndef VIBRATION_SPECTRUM_SEND_PEAKS
+#define VIBRATION_SPECTRUM_SEND_PEAKS FALSE
+#endif
+
+/** IMU sample frequency */
+#ifndef VIBRATION_SPECTRUM_FREQ
+#if defined AHRS_PROPAGATE_FREQUENCY
+#define VIBRATION_SPECTRUM_FREQ AHRS_PROPAGATE_FREQUENCY
+#elif defined INS_PROPAGATE_FREQUENCY
+#define VIBRATION_SPECTRUM_FREQ INS_PROPAGATE_FREQUENCY
+#else
+#define VIBRATION_SPECTRUM_FREQ PERIODIC_FREQUENCY
+#endif
+#endif
+PRINT_CONFIG_VAR(VIBRATION_SPECTRUM_FREQ)
+
+/** ABI binding for IMU data
+ * with ABI_BROADCAST, the output of the prefilter modules is ignored so that
+ * only the raw samples are analyzed, the notches must not see their own effect
+ */
+#ifndef VIBRATION_SPECTRUM_IMU_ID
+#define VIBRATION_SPECTRUM_IMU_ID ABI_BROADCAST
+#endif
+PRINT_CONFIG_VAR(VIBRATION_SPECTRUM_IMU_ID)
+
+static inline bool vs_sender_ok(uint8_t sender_id)
+{
+#if VIBRATION_SPECTRUM_IMU_ID == ABI_BROADCAST
+  return sender_id != IMU_F1E_ID && sender_id != IMU_RPM_NOTCH_ID;
+#else
+  (void)sender_id;
+  return true;
+#endif
+}
+
+#define VS_N VIBRATION_SPECTRUM_FFT_LEN
+#define VS_NB_BINS (VS_N / 2 + 1)
+
+struct VibrationSpectrum vibration_spectrum;
+
+/** sample history of the 3 axis */
+static float vs_samples[3][VS_N];
+static uint16_t vs_idx;         ///< next sample position in history
+static uint16_t vs_nb_samples;  ///< number of samples in history (up to VS_N)
+static uint16_t vs_hop_cnt;     ///< samples since the last segment
+
+/** segment being transformed */
+static float vs_re[3][VS_N];
+static float vs_im[VS_N];
+static volatile uint8_t vs_pending;  ///< axis of the segment left to transform (bit field)
+
+/** Welch accumulation */
+static float vs_power[VS_NB_BINS];
+static uint8_t vs_nb_segments;
+
+/** precomputed tables */
+static float vs_window[VS_N];
+static float vs_window_sum;
+static float vs_cos[VS_N / 2];
+static float vs_sin[VS_N / 2];
+static uint16_t vs_bitrev[VS_N];
+
+static abi_event gyro_ev;
+static abi_event accel_ev;
+
+/** In place radix-2 decimation in time FFT */
+static void vs_fft(float *re, float *im)
+{
+  for (uint16_t i = 0; i < VS_N; i++) {
+    uint16_t j = vs_bitrev[i];
+    if (j > i) {
+      float t = re[i]; re[i] = re[j]; re[j] = t;
+      t = im[i]; im[i] = im[j]; im[j] = t;
+    }
+  }
+  for (uint16_t len = 2; len <= VS_N; len <<= 1) {
+    uint16_t half = len >> 1;
+    uint16_t step = VS_N / len;
+    for (uint16_t i = 0; i < VS_N; i += len) {
+      for (uint16_t k = 0; k < half; k++) {
+        float wr = vs_cos[k * step];
+        float wi = -vs_sin[k * step];
+        uint16_t a = i + k, b = a + half;
+        float tr = re[b] * wr - im[b] * wi;
+        float ti = re[b] * wi + im[b] * wr;
+        re[b] = re[a] - tr;
+        im[b] = im[a] - ti;
+        re[a] += tr;
+        im[a] += ti;
+      }
+    }
+  }
+}
+
+/** Amplitude of a sinusoid from the averaged power of its bin */
+static inline float vs_amplitude(float power)
+{
+  return 2.f * sqrtf(power / VIBRATION_SPECTRUM_AVERAGES) / vs_window_sum;
+}
+
+/** Averaged spectrum complete: find peaks and bands */
+static void vs_finalize(void)
+{
+  const float df = (float)VIBRATION_SPECTRUM_FREQ / VS_N;
+  uint16_t k_min = Max(1, (uint16_t)(VIBRATION_SPECTRUM_MIN_FREQ / df));
+
+  float freq[VIBRATION_SPECTRUM_NB_PEAKS];
+  float amp[VIBRATION_SPECTRUM_NB_PEAKS];
+  uint8_t nb_peaks = 0;
+  for (uint16_t k = k_min; k < VS_NB_BINS - 1; k++) {
+    if (vs_power[k] > vs_power[k - 1] && vs_power[k] >= vs_power[k + 1]) {
+      float a = vs_amplitude(vs_power[k]);
+      // insert in the sorted peak list
+      int8_t i = nb_peaks < VIBRATION_SPECTRUM_NB_PEAKS ? nb_peaks++ : VIBRATION_SPECTRUM_NB_PEAKS;
+      while (i > 0 && amp[i - 1] < a) {
+        if (i < VIBRATION_SPECTRUM_NB_PEAKS) {
+          amp[i] = amp[i - 1];
+          freq[i] = freq[i - 1];
+        }
+        i--;
+      }
+      if (i < VIBRATION_SPECTRUM_NB_PEAKS) {
+        // parabolic interpolation of the peak position
+        float l = vs_amplitude(vs_power[k - 1]);
+        float r = vs_amplitude(vs_power[k + 1]);
+        float den = l - 2.f * a + r;
+        float delta = (den < 0.f) ? 0.5f * (l - r) / den : 0.f;
+        amp[i] = a;
+        freq[i] = (k + delta) * df;
+      }
+    }
+  }
+  for (uint8_t i = 0; i < VIBRATION_SPECTRUM_NB_PEAKS; i++) {
+    vibration_spectrum.peak_freq[i] = i < nb_peaks ? freq[i] : 0.f;
+    vibration_spectrum.peak_amp[i] = i < nb_peaks ? amp[i] : 0.f;
+  }
+
+  // decimated spectrum, DC excluded
+  uint16_t bins_per_band = Max(1, (VS_NB_BINS - 1) / VIBRATION_SPECTRUM_NB_BANDS);
+  vibration_spectrum.band_width = bins_per_band * df;
+  for (uint8_t b = 0; b < VIBRATION_SPECTRUM_NB_BANDS; b++) {
+    float max = 0.f;
+    for (uint16_t k = 1 + b * bins_per_band; k < 1 + (b + 1) * bins_per_band && k < VS_NB_BINS; k++) {
+      if (vs_power[k] > max) {
+        max = vs_power[k];
+      }
+    }
+    vibration_spectrum.bands[b] = vs_amplitude(max);
+  }
+
+  vibration_spectrum.nb_spectra++;
+#if VIBRATION_SPECTRUM_SEND_PEAKS
+  if (nb_peaks > 0) {
+    AbiSendMsgVIBRATION_PEAKS(IMU_VIBRATION_SPECTRUM_ID, freq, amp, nb_peaks);
+  }
+#endif
+}
+
+static void vs_add_sample(float x, float y, float z)
+{
+  vs_samples[0][vs_idx] = x;
+  vs_samples[1][vs_idx] = y;
+  vs_samples[2][vs_idx] = z;
+  vs_idx = (vs_idx + 1) % VS_N;
+  if (vs_nb_samples < VS_N) {
+    vs_nb_samples++;
+  }
+  if (++vs_hop_cnt < VS_N / 2 || vs_nb_samples < VS_N) {
+    return;
+  }
+  vs_hop_cnt = 0;
+  if (vs_pending) {
+    vibration_spectrum.nb_overruns++;
+    return;
+  }
+  // copy the segment, oldest sample first, without mean and windowed
+  for (uint8_t a = 0; a < 3; a++) {
+    float mean = 0.f;
+    for (uint16_t i = 0; i < VS_N; i++) {
+      mean += vs_samples[a][i];
+    }
+    mean /= VS_N;
+    for (uint16_t i = 0; i < VS_N; i++) {
+      vs_re[a][i] = (vs_samples[a][(vs_idx + i) % VS_N] - mean) * vs_window[i];
+    }
+  }
+  vs_pending = 0x7;
+}
+
+static void gyro_cb(uint8_t sender_id, uint32_t stamp __attribute__((unused)), struct Int32Rates *gyro)
+{
+  if (vibration_spectrum.enabled && vibration_spectrum.source == VIBRATION_SPECTRUM_GYRO && vs_sender_ok(sender_id)) {
+    vs_add_sample(RATE_FLOAT_OF_BFP(gyro->p), RATE_FLOAT_OF_BFP(gyro->q), RATE_FLOAT_OF_BFP(gyro->r));
+  }
+}
+
+static void accel_cb(uint8_t sender_id, uint32_t stamp __attribute__((unused)), struct Int32Vect3 *accel)
+{
+  if (vibration_spectrum.enabled && vibration_spectrum.source == VIBRATION_SPECTRUM_ACCEL && vs_sender_ok(sender_id)) {
+    vs_add_sample(ACCEL_FLOAT_OF_BFP(accel->x), ACCEL_FLOAT_OF_BFP(accel->y), ACCEL_FLOAT_OF_BFP(accel->z));
+  }
+}
+
+void vibration_spectrum_init(void)
+{
+  vibration_spectrum.enabled = VIBRATION_SPECTRUM_ENABLED;
+  vibration_spectrum.nb_spectra = 0;
+  vibration_spectrum.nb_overruns = 0;
+
+  // Hann window
+  vs_window_sum = 0.f;
+  for (uint16_t i = 0; i < VS_N; i++) {
+    vs_window[i] = 0.5f - 0.5f * cosf(2.f * M_PI * i / VS_N);
+    vs_window_sum += vs_window[i];
+  }
+  // twiddle factors
+  for (uint16_t i = 0; i < VS_N / 2; i++) {
+    vs_cos[i] = cosf(2.f * M_PI * i / VS_N);
+    vs_sin[i] = sinf(2.f * M_PI * i / VS_N);
+  }
+  // bit reversal permutation
+  uint8_t bits = 0;
+  while ((1 << bits) < VS_N) {
+    bits++;
+  }
+  for (uint16_t i = 0; i < VS_N; i++) {
+    uint16_t r = 0;
+    for (uint8_t b = 0; b < bits; b++) {
+      if (i & (1 << b)) {
+        r |= 1 << (bits - 1 - b);
+      }
+    }
+    vs_bitrev[i] = r;
+  }
+
+  vibration_spectrum_reset(VIBRATION_SPECTRUM_SOURCE);
+
+  AbiBindMsgIMU_GYRO_INT32(VIBRATION_SPECTRUM_IMU_ID, &gyro_ev, gyro_cb);
+  AbiBindMsgIMU_ACCEL_INT32(VIBRATION_SPECTRUM_IMU_ID, &accel_ev, accel_cb);
+}
+
+void vibration_spectrum_event(void)
+{
+  if (vs_pending == 0) {
+    return;
+  }
+  // one axis per call
+  uint8_t a = (vs_pending & 0x1) ? 0 : ((vs_pending & 0x2) ? 1 : 2);
+  memset(vs_im, 0, sizeof(vs_im));
+  vs_fft(vs_re[a], vs_im);
+  for (uint16_t k = 0; k < VS_NB_BINS; k++) {
+    vs_power[k] += vs_re[a][k] * vs_re[a][k] + vs_im[k] * vs_im[k];
+  }
+  vs_pending &= ~(1 << a);
+
+  if (vs_pending == 0 && ++vs_nb_segments >= VIBRATION_SPECTRUM_AVERAGES) {
+    vs_finalize();
+    memset(vs_power, 0, sizeof(vs_power));
+    vs_nb_segments = 0;
+  }
+}
+
+/** Send the last spectrum with a PAYLOAD_FLOAT message:
+ * [ source, band width, peak freqs (NB_PEAKS), peak amps (NB_PEAKS), bands (NB_BANDS) ]
+ */
+void vibration_spectrum_report(void)
+{
+#define VS_REPORT_SIZE (2 + 2 * VIBRATION_SPECTRUM_NB_PEAKS + VIBRATION_SPECTRUM_NB_BANDS)
+  float data[VS_REPORT_SIZE];
+  data[0] = vibration_spectrum.source;
+  data[1] = vibration_spectrum.band_width;
+  memcpy(&data[2], vibration_spectrum.peak_freq, sizeof(vibration_spectrum.peak_freq));
+  memcpy(&data[2 + VIBRATION_SPECTRUM_NB_PEAKS], vibration_spectrum.peak_amp, sizeof(vibration_spectrum.peak_amp));
+  memcpy(&data[2 + 2 * VIBRATION_SPECTRUM_NB_PEAKS], vibration_spectrum.bands, sizeof(vibration_spectrum.bands));
+  DOWNLINK_SEND_PAYLOAD_FLOAT(DefaultChannel, DefaultDevice, VS_REPORT_SIZE, data);
+}
+
+void vibration_spectrum_reset(float source)
+{
+  vibration_spectrum.source = (uint8_t)source;
+  vs_idx = 0;
+  vs_nb_samples = 0;
+  vs_hop_cnt = 0;
+  vs_pending = 0;
+  vs_nb_segments = 0;
+  memset(vs_power, 0, sizeof(vs_power));
+}
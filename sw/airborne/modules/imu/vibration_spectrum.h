@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file "modules/imu/vibration_spectrum.h"
+ * On-board vibration spectrum of the IMU data
+ */
+
+#ifndef VIBRATION_SPECTRUM_H
+#define VIBRATION_SPECTRUM_H
+
+#include "std.h"
+
+/** Number of reported peaks */
+#ifndef VIBRATION_SPECTRUM_NB_PEAKS
+#define VIBRATION_SPECTRUM_NB_PEAKS 3
+#endif
+
+/** Number of frequency bands of the decimated spectrum */
+#ifndef VIBRATION_SPECTRUM_NB_BANDS
+#define VIBRATION_SPECTRUM_NB_BANDS 16
+#endif
+
+enum VibrationSpectrumSource {
+  VIBRATION_SPECTRUM_GYRO = 0,
+  VIBRATION_SPECTRUM_ACCEL = 1
+};
+
+struct VibrationSpectrum {
+  bool enabled;
+  uint8_t source;                                 ///< analyzed signal (VibrationSpectrumSource)
+  float peak_freq[VIBRATION_SPECTRUM_NB_PEAKS];   ///< frequency of the main peaks [Hz], strongest first
+  float peak_amp[VIBRATION_SPECTRUM_NB_PEAKS];    ///< amplitude of the main peaks (rad/s or m/s^2)
+  float bands[VIBRATION_SPECTRUM_NB_BANDS];       ///< max amplitude per frequency band (rad/s or m/s^2)
+  float band_width;                               ///< width of a band [Hz]
+  uint32_t nb_spectra;                            ///< number of computed spectra
+  uint32_t nb_overruns;                           ///< segments dropped because the previous one was not processed
+};
+
+extern struct VibrationSpectrum vibration_spectrum;
+
+extern void vibration_spectrum_init(void);
+extern void vibration_spectrum_event(void);
+extern void vibration_spectrum_report(void);
+
+/**
+ * settings handlers
+ */
+extern void vibration_spectrum_reset(float source);
+
+#endif
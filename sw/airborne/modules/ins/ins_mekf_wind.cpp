@@ -127,7 +127,7 @@ struct InsMekfWindPrivate {
   struct MekfWindInputs inputs;
   struct MekfWindMeasurements measurements;
 
-  MEKFWCov P;
+  MEKFWCov P;       ///< covariance, upper triangle only
   MEKFWPNoise Q;
   MEKFWMNoise R;
 
@@ -302,6 +302,169 @@ static Matrix3f skew_sym(const Vector3f& v) {
   return m;
 }
 
+
+/**
+ * Covariance kernels
+ *
+ * P is symmetric, only its upper triangle is stored and updated, the
+ * strictly lower triangle is never read.
+ *
+ * The state transition matrix A is the identity plus a few 3x3 blocks
+ * in the attitude, speed and position rows, which are the first 9 states,
+ * so A * P * At only changes these rows and columns, instead of two
+ * dense 19x19 products. All sizes are fixed at compile time, nothing
+ * is allocated.
+ */
+
+#define MEKF_WIND_QVP_SIZE (MEKF_WIND_px + 3)
+
+/** Column j of P, read from the upper triangle */
+static Matrix<float, MEKF_WIND_COV_SIZE, 1> cov_col(const MEKFWCov &P, int j)
+{
+  Matrix<float, MEKF_WIND_COV_SIZE, 1> c;
+  c.head(j + 1) = P.col(j).head(j + 1);
+  c.tail(MEKF_WIND_COV_SIZE - j - 1) = P.row(j).tail(MEKF_WIND_COV_SIZE - j - 1).transpose();
+  return c;
+}
+
+/** Columns j to j+2 of P, read from the upper triangle */
+static Matrix<float, MEKF_WIND_COV_SIZE, 3> cov_cols3(const MEKFWCov &P, int j)
+{
+  Matrix<float, MEKF_WIND_COV_SIZE, 3> c;
+  for (int k = 0; k < 3; k++) {
+    c.col(k) = cov_col(P, j + k);
+  }
+  return c;
+}
+
+/** Add process noise An * Q * Ant * dt
+ *
+ * Only the attitude and speed noises are rotated, the other ones are
+ * directly on the diagonal.
+ */
+static void cov_add_process_noise(MEKFWCov &P, const MEKFWPNoise &Q, const Matrix3f &Rq, float dt, bool ahrs_only)
+{
+  const Matrix3f Qg = Q.diagonal().segment<3>(MEKF_WIND_qgp).asDiagonal();
+  P.block<3,3>(MEKF_WIND_qx,MEKF_WIND_qx) += Rq * Qg * Rq.transpose() * dt;
+  P.block<3,3>(MEKF_WIND_rbp,MEKF_WIND_rbp).diagonal() += Q.diagonal().segment<3>(MEKF_WIND_qrbp) * dt;
+  if (ahrs_only) {
+    return;
+  }
+  const Matrix3f Qa = Q.diagonal().segment<3>(MEKF_WIND_qax).asDiagonal();
+  P.block<3,3>(MEKF_WIND_vx,MEKF_WIND_vx) += Rq * Qa * Rq.transpose() * dt;
+  P.block<3,3>(MEKF_WIND_abx,MEKF_WIND_abx).diagonal() += Q.diagonal().segment<3>(MEKF_WIND_qabx) * dt;
+  P(MEKF_WIND_bb,MEKF_WIND_bb) += Q(MEKF_WIND_qbb,MEKF_WIND_qbb) * dt;
+  P.block<3,3>(MEKF_WIND_wx,MEKF_WIND_wx).diagonal() += Q.diagonal().segment<3>(MEKF_WIND_qwx) * dt;
+}
+
+/** Full INS covariance propagation P = A * P * At + An * Q * Ant * dt
+ *
+ * With A = I + E, A * P * At = P + G + Gt + E * G where G = P * Et only
+ * has non zero q, v and p columns. Non identity blocks of A:
+ *   q,rb = F1    v,q = F2    v,rb = F3    v,ab = F1
+ *   p,q  = F4    p,v = I*dt  p,rb = F5    p,ab = F6
+ */
+static void cov_propagate(MEKFWCov &P, const MEKFWPNoise &Q, const Matrix3f &Rq,
+                          const Matrix3f &RqA, float dt)
+{
+  const Matrix3f F1 = -Rq * dt;
+  const Matrix3f F2 = -RqA * dt;
+  const Matrix3f F3 = RqA * dt * dt;
+  const Matrix3f F4 = -F3;
+  const Matrix3f F5 = F3 * dt;
+  const Matrix3f F6 = F1 * dt;
+
+  typedef Matrix<float, MEKF_WIND_COV_SIZE, 3> Cols;
+  const Cols Pq = cov_cols3(P, MEKF_WIND_qx);
+  const Cols Pv = cov_cols3(P, MEKF_WIND_vx);
+  const Cols Prb = cov_cols3(P, MEKF_WIND_rbp);
+  const Cols Pab = cov_cols3(P, MEKF_WIND_abx);
+
+  // G = P * Et, q, v and p columns
+  Matrix<float, MEKF_WIND_COV_SIZE, MEKF_WIND_QVP_SIZE> G;
+  G.block<MEKF_WIND_COV_SIZE,3>(0,MEKF_WIND_qx) = Prb * F1.transpose();
+  G.block<MEKF_WIND_COV_SIZE,3>(0,MEKF_WIND_vx) = Pq * F2.transpose() + Prb * F3.transpose() + Pab * F1.transpose();
+  G.block<MEKF_WIND_COV_SIZE,3>(0,MEKF_WIND_px) = Pq * F4.transpose() + dt * Pv + Prb * F5.transpose() + Pab * F6.transpose();
+
+  // E * G, q, v and p rows and columns
+  typedef Matrix<float, 3, MEKF_WIND_QVP_SIZE> Rows;
+  const Rows Gq = G.block<3,MEKF_WIND_QVP_SIZE>(MEKF_WIND_qx,0);
+  const Rows Gv = G.block<3,MEKF_WIND_QVP_SIZE>(MEKF_WIND_vx,0);
+  const Rows Grb = G.block<3,MEKF_WIND_QVP_SIZE>(MEKF_WIND_rbp,0);
+  const Rows Gab = G.block<3,MEKF_WIND_QVP_SIZE>(MEKF_WIND_abx,0);
+  Matrix<float, MEKF_WIND_QVP_SIZE, MEKF_WIND_QVP_SIZE> EG;
+  EG.block<3,MEKF_WIND_QVP_SIZE>(MEKF_WIND_qx,0) = F1 * Grb;
+  EG.block<3,MEKF_WIND_QVP_SIZE>(MEKF_WIND_vx,0) = F2 * Gq + F3 * Grb + F1 * Gab;
+  EG.block<3,MEKF_WIND_QVP_SIZE>(MEKF_WIND_px,0) = F4 * Gq + dt * Gv + F5 * Grb + F6 * Gab;
+
+  // upper triangle of the q, v and p rows
+  const Matrix<float, MEKF_WIND_QVP_SIZE, MEKF_WIND_QVP_SIZE> Gqvp = G.topRows<MEKF_WIND_QVP_SIZE>();
+  P.topLeftCorner<MEKF_WIND_QVP_SIZE,MEKF_WIND_QVP_SIZE>() += Gqvp + Gqvp.transpose() + EG;
+  P.topRightCorner<MEKF_WIND_QVP_SIZE,MEKF_WIND_COV_SIZE-MEKF_WIND_QVP_SIZE>() +=
+    G.bottomRows<MEKF_WIND_COV_SIZE-MEKF_WIND_QVP_SIZE>().transpose();
+
+  cov_add_process_noise(P, Q, Rq, dt, false);
+}
+
+/** AHRS only covariance propagation
+ *
+ * A only keeps the attitude and gyro bias blocks, all the other
+ * covariances are reset to zero as in the dense formulation.
+ */
+static void cov_propagate_ahrs(MEKFWCov &P, const MEKFWPNoise &Q, const Matrix3f &Rq, float dt)
+{
+  const Matrix3f F1 = -Rq * dt;
+  const Matrix3f Pqq = P.block<3,3>(MEKF_WIND_qx,MEKF_WIND_qx).selfadjointView<Upper>();
+  const Matrix3f Pqb = P.block<3,3>(MEKF_WIND_qx,MEKF_WIND_rbp);
+  const Matrix3f Pbb = P.block<3,3>(MEKF_WIND_rbp,MEKF_WIND_rbp).selfadjointView<Upper>();
+  const Matrix3f F1Pbb = F1 * Pbb;
+  P.setZero();
+  P.block<3,3>(MEKF_WIND_qx,MEKF_WIND_qx) = Pqq + F1 * Pqb.transpose() + Pqb * F1.transpose() + F1Pbb * F1.transpose();
+  P.block<3,3>(MEKF_WIND_qx,MEKF_WIND_rbp) = Pqb + F1Pbb;
+  P.block<3,3>(MEKF_WIND_rbp,MEKF_WIND_rbp) = Pbb;
+  cov_add_process_noise(P, Q, Rq, dt, true);
+}
+
+/** Kalman gain and covariance update for a measurement of size M
+ *
+ * H is given by its C non zero columns, col[i] being the state index of
+ * column i, so that P * Ht only reads these columns of P.
+ *
+ * S = H * P * Ht + R is inverted through its Cholesky factorization,
+ * and P is updated in Joseph form, expanded as
+ *   P = (I - K*H) * P * (I - K*H)t + K * R * Kt
+ *     = P - K * PHtt - PHt * Kt + K * S * Kt
+ *     = P + [K*S - PHt, -K] * [K, PHt]t
+ * which is evaluated on the upper triangle only: a single N x 2M x N/2
+ * product, the cost of the short form P - K * PHtt on the full matrix.
+ *
+ * @param[in,out] P covariance
+ * @param[in] H non zero columns of the observation matrix
+ * @param[in] col state index of each column of H
+ * @param[in] R measurement noise
+ * @param[out] K Kalman gain
+ */
+template <int M, int C>
+static void cov_update(MEKFWCov &P, const Matrix<float, M, C> &H, const int (&col)[C],
+                       const Matrix<float, M, M> &R, Matrix<float, MEKF_WIND_COV_SIZE, M> &K)
+{
+  Matrix<float, MEKF_WIND_COV_SIZE, M> PHt = Matrix<float, MEKF_WIND_COV_SIZE, M>::Zero();
+  for (int i = 0; i < C; i++) {
+    PHt.noalias() += cov_col(P, col[i]) * H.col(i).transpose();
+  }
+  Matrix<float, M, M> S = R;
+  for (int i = 0; i < C; i++) {
+    S.noalias() += H.col(i) * PHt.row(col[i]);
+  }
+  const LLT<Matrix<float, M, M> > llt(S);
+  K = llt.solve(PHt.transpose()).transpose();
+
+  Matrix<float, MEKF_WIND_COV_SIZE, 2 * M> L, Rt;
+  L << K * S - PHt, -K;
+  Rt << K, PHt;
+  P.triangularView<Upper>() += L.lazyProduct(Rt.transpose());
+}
+
 /**
  * Init function
  */
@@ -376,36 +539,8 @@ void ins_mekf_wind_propagate(struct FloatRates *gyro, struct FloatVect3 *acc, fl
 
   // propagate covariance
   const Matrix3f Rq = mwp.state.quat.toRotationMatrix();
-  const Matrix3f Rqdt = Rq * dt;
   const Matrix3f RqA = skew_sym(Rq * accel_unbiased);
-  const Matrix3f RqAdt = RqA * dt;
-  const Matrix3f RqAdt2 = RqAdt * dt;
-
-  MEKFWCov A = MEKFWCov::Identity();
-  A.block<3,3>(MEKF_WIND_qx,MEKF_WIND_rbp) = -Rqdt;
-  A.block<3,3>(MEKF_WIND_vx,MEKF_WIND_qx) = -RqAdt;
-  A.block<3,3>(MEKF_WIND_vx,MEKF_WIND_rbp) = RqAdt2;
-  A.block<3,3>(MEKF_WIND_vx,MEKF_WIND_abx) = -Rqdt;
-  A.block<3,3>(MEKF_WIND_px,MEKF_WIND_qx) = -RqAdt2;
-  A.block<3,3>(MEKF_WIND_px,MEKF_WIND_vx) = Matrix3f::Identity() * dt;
-  A.block<3,3>(MEKF_WIND_px,MEKF_WIND_rbp) = RqAdt2 * dt;
-  A.block<3,3>(MEKF_WIND_px,MEKF_WIND_abx) = -Rqdt * dt;
-
-  Matrix<float, MEKF_WIND_COV_SIZE, MEKF_WIND_PROC_NOISE_SIZE> An;
-  An.setZero();
-  An.block<3,3>(MEKF_WIND_qx,MEKF_WIND_qgp) = Rq;
-  An.block<3,3>(MEKF_WIND_vx,MEKF_WIND_qax) = Rq;
-  An.block<3,3>(MEKF_WIND_rbp,MEKF_WIND_qrbp) = Matrix3f::Identity();
-  An.block<3,3>(MEKF_WIND_abx,MEKF_WIND_qabx) = Matrix3f::Identity();
-  An(MEKF_WIND_bb,MEKF_WIND_qbb) = 1.0f;
-  An.block<3,3>(MEKF_WIND_wx,MEKF_WIND_qwx) = Matrix3f::Identity();
-
-  MEKFWCov At(A);
-  At.transposeInPlace();
-  Matrix<float, MEKF_WIND_PROC_NOISE_SIZE, MEKF_WIND_COV_SIZE> Ant;
-  Ant = An.transpose();
-
-  mwp.P = A * mwp.P * At + An * mwp.Q * Ant * dt;
+  cov_propagate(mwp.P, mwp.Q, Rq, RqA, dt);
 
   if (ins_mekf_wind_params.disable_wind) {
     mwp.P.block<3,MEKF_WIND_COV_SIZE>(MEKF_WIND_wx,0) = Matrix<float,3,MEKF_WIND_COV_SIZE>::Zero();
@@ -442,34 +577,17 @@ void ins_mekf_wind_propagate_ahrs(struct FloatRates *gyro, struct FloatVect3 *ac
 
   // propagate covariance
   const Matrix3f Rq = mwp.state.quat.toRotationMatrix();
-  const Matrix3f Rqdt = Rq * dt;
-
-  MEKFWCov A = MEKFWCov::Zero();
-  A.block<3,3>(MEKF_WIND_qx,MEKF_WIND_qx) = Matrix3f::Identity();
-  A.block<3,3>(MEKF_WIND_qx,MEKF_WIND_rbp) = -Rqdt;
-  A.block<3,3>(MEKF_WIND_rbp,MEKF_WIND_rbp) = Matrix3f::Identity();
-
-  Matrix<float, MEKF_WIND_COV_SIZE, MEKF_WIND_PROC_NOISE_SIZE> An;
-  An.setZero();
-  An.block<3,3>(MEKF_WIND_qx,MEKF_WIND_qgp) = Rq;
-  An.block<3,3>(MEKF_WIND_rbp,MEKF_WIND_qrbp) = Matrix3f::Identity(); // TODO check index
-
-  MEKFWCov At(A);
-  At.transposeInPlace();
-  Matrix<float, MEKF_WIND_PROC_NOISE_SIZE, MEKF_WIND_COV_SIZE> Ant;
-  Ant = An.transpose();
-
-  mwp.P = A * mwp.P * At + An * mwp.Q * Ant * dt;
+  cov_propagate_ahrs(mwp.P, mwp.Q, Rq, dt);
 
   // correction from accel measurements
   const Matrix3f Rqt = Rq.transpose();
-  Matrix<float, 3, MEKF_WIND_COV_SIZE> H = Matrix<float, 3, MEKF_WIND_COV_SIZE>::Zero();
-  H.block<3,3>(0,0) = - Rqt * skew_sym(gravity);
-  Matrix<float, MEKF_WIND_COV_SIZE, 3> Ht = H.transpose();
+  const Matrix3f H = - Rqt * skew_sym(gravity);
+  static const int H_col[3] = { MEKF_WIND_qx, MEKF_WIND_qy, MEKF_WIND_qz };
   // S = H*P*Ht + Hn*N*Hnt
-  Matrix3f S = H * mwp.P * Ht + mwp.R.block<3,3>(MEKF_WIND_rmx,MEKF_WIND_rmx); // FIXME currently abusing mag noise ????
   // K = P*Ht*S^-1
-  Matrix<float, MEKF_WIND_COV_SIZE, 3> K = mwp.P * Ht * S.inverse();
+  const Matrix3f R = mwp.R.block<3,3>(MEKF_WIND_rmx,MEKF_WIND_rmx); // FIXME currently abusing mag noise ????
+  Matrix<float, MEKF_WIND_COV_SIZE, 3> K;
+  cov_update(mwp.P, H, H_col, R, K);
   // Residual z_a - h(z)
   Vector3f res = accel_unbiased + (Rqt * gravity);
   // Update state
@@ -479,8 +597,6 @@ void ins_mekf_wind_propagate_ahrs(struct FloatRates *gyro, struct FloatVect3 *ac
   mwp.state.quat = q_tmp * mwp.state.quat;
   mwp.state.quat.normalize();
   mwp.state.rates_bias  += K.block<3,3>(MEKF_WIND_rbp,0) * res;
-  // Update covariance
-  mwp.P = (MEKFWCov::Identity() - K * H) * mwp.P;
 }
 
 
@@ -504,15 +620,15 @@ void ins_mekf_wind_update_mag(struct FloatVect3* mag, bool attitude_only)
   mwp.measurements.mag(1) = mag->y;
   mwp.measurements.mag(2) = mag->z;
 
-  // H and Ht matrices
+  // H matrix
   const Matrix3f Rqt = mwp.state.quat.toRotationMatrix().transpose();
-  Matrix<float, 3, MEKF_WIND_COV_SIZE> H = Matrix<float, 3, MEKF_WIND_COV_SIZE>::Zero();
-  H.block<3,3>(0,0) = Rqt * skew_sym(mwp.mag_h);
-  Matrix<float, MEKF_WIND_COV_SIZE, 3> Ht = H.transpose();
+  const Matrix3f H = Rqt * skew_sym(mwp.mag_h);
+  static const int H_col[3] = { MEKF_WIND_qx, MEKF_WIND_qy, MEKF_WIND_qz };
   // S = H*P*Ht + Hn*N*Hnt
-  Matrix3f S = H * mwp.P * Ht + mwp.R.block<3,3>(MEKF_WIND_rmx,MEKF_WIND_rmx);
   // K = P*Ht*S^-1
-  Matrix<float, MEKF_WIND_COV_SIZE, 3> K = mwp.P * Ht * S.inverse();
+  const Matrix3f R = mwp.R.block<3,3>(MEKF_WIND_rmx,MEKF_WIND_rmx);
+  Matrix<float, MEKF_WIND_COV_SIZE, 3> K;
+  cov_update(mwp.P, H, H_col, R, K);
   // Residual z_m - h(z)
   Vector3f res = mwp.measurements.mag - (Rqt * mwp.mag_h);
   // Update state
@@ -534,23 +650,20 @@ void ins_mekf_wind_update_mag(struct FloatVect3* mag, bool attitude_only)
       mwp.state.wind        += K.block<3,3>(MEKF_WIND_wx,0) * res;
     }
   }
-  // Update covariance
-  mwp.P = (MEKFWCov::Identity() - K * H) * mwp.P;
 }
 
 void ins_mekf_wind_update_baro(float baro_alt)
 {
   mwp.measurements.baro_alt = baro_alt;
 
-  // H and Ht matrices
-  Matrix<float, 1, MEKF_WIND_COV_SIZE> H = Matrix<float, 1, MEKF_WIND_COV_SIZE>::Zero();
-  H(0,MEKF_WIND_pz) = 1.0f; // TODO check index
-  H(0,MEKF_WIND_bb) = -1.0f;
-  Matrix<float, MEKF_WIND_COV_SIZE, 1> Ht = H.transpose();
-  // S = H*P*Ht + Hn*N*Hnt -> only pos.z component
-  float S = mwp.P(MEKF_WIND_pz,MEKF_WIND_pz) - mwp.P(MEKF_WIND_bb,MEKF_WIND_bb) + mwp.R(MEKF_WIND_rb,MEKF_WIND_rb);
+  // H matrix
+  const Matrix<float, 1, 2> H(1.0f, -1.0f);
+  static const int H_col[2] = { MEKF_WIND_pz, MEKF_WIND_bb };
+  // S = H*P*Ht + Hn*N*Hnt
   // K = P*Ht*S^-1
-  Matrix<float, MEKF_WIND_COV_SIZE, 1> K = mwp.P * Ht / S;
+  const Matrix<float, 1, 1> R(mwp.R(MEKF_WIND_rb,MEKF_WIND_rb));
+  Matrix<float, MEKF_WIND_COV_SIZE, 1> K;
+  cov_update(mwp.P, H, H_col, R, K);
   // Residual z_m - h(z)
   float res = mwp.measurements.baro_alt - (mwp.state.pos(2) - mwp.state.baro_bias);
   // Update state
@@ -568,8 +681,6 @@ void ins_mekf_wind_update_baro(float baro_alt)
   if (!ins_mekf_wind_params.disable_wind) {
     mwp.state.wind        += K.block<3,1>(MEKF_WIND_wx,0) * res;
   }
-  // Update covariance
-  mwp.P = (MEKFWCov::Identity() - K * H) * mwp.P;
 }
 
 void ins_mekf_wind_update_pos_speed(struct FloatVect3 *pos, struct FloatVect3 *speed)
@@ -581,14 +692,14 @@ void ins_mekf_wind_update_pos_speed(struct FloatVect3 *pos, struct FloatVect3 *s
   mwp.measurements.speed(1) = speed->y;
   mwp.measurements.speed(2) = speed->z;
 
-  // H and Ht matrices
-  Matrix<float, 6, MEKF_WIND_COV_SIZE> H = Matrix<float, 6, MEKF_WIND_COV_SIZE>::Zero();
-  H.block<6,6>(0,MEKF_WIND_vx) = Matrix<float,6,6>::Identity();
-  Matrix<float, MEKF_WIND_COV_SIZE, 6> Ht = H.transpose();
+  // H matrix
+  const Matrix<float, 6, 6> H = Matrix<float, 6, 6>::Identity();
+  static const int H_col[6] = { MEKF_WIND_vx, MEKF_WIND_vy, MEKF_WIND_vz, MEKF_WIND_px, MEKF_WIND_py, MEKF_WIND_pz };
   // S = H*P*Ht + Hn*N*Hnt
-  Matrix<float, 6, 6> S = mwp.P.block<6,6>(MEKF_WIND_vx,MEKF_WIND_vx) + mwp.R.block<6,6>(MEKF_WIND_rvx,MEKF_WIND_rvx);
   // K = P*Ht*S^-1
-  Matrix<float, MEKF_WIND_COV_SIZE, 6> K = mwp.P * Ht * S.inverse();
+  const Matrix<float, 6, 6> R = mwp.R.block<6,6>(MEKF_WIND_rvx,MEKF_WIND_rvx);
+  Matrix<float, MEKF_WIND_COV_SIZE, 6> K;
+  cov_update(mwp.P, H, H_col, R, K);
   // Residual z_m - h(z)
   Matrix<float, 6, 1> res = Matrix<float, 6, 1>::Zero();
   res.block<3,1>(0,0) = mwp.measurements.speed - mwp.state.speed;
@@ -607,8 +718,6 @@ void ins_mekf_wind_update_pos_speed(struct FloatVect3 *pos, struct FloatVect3 *s
   if (!ins_mekf_wind_params.disable_wind) {
     mwp.state.wind        += K.block<3,6>(MEKF_WIND_wx,0) * res;
   }
-  // Update covariance
-  mwp.P = (MEKFWCov::Identity() - K * H) * mwp.P;
 }
 
 void ins_mekf_wind_update_airspeed(float airspeed)
@@ -616,18 +725,19 @@ void ins_mekf_wind_update_airspeed(float airspeed)
   mwp.measurements.airspeed = airspeed;
 
   if (ins_mekf_wind_params.disable_wind) return;
-  // H and Ht matrices
+  // H matrix
   const RowVector3f IuRqt = mwp.state.quat.toRotationMatrix().transpose().block<1,3>(0,0);
   const Vector3f va = mwp.state.speed - mwp.state.wind;
-  Matrix<float, 1, MEKF_WIND_COV_SIZE> H = Matrix<float, 1, MEKF_WIND_COV_SIZE>::Zero();
-  H.block<1,3>(0,MEKF_WIND_qx) = IuRqt * skew_sym(va);
-  H.block<1,3>(0,MEKF_WIND_vx) = IuRqt;
-  H.block<1,3>(0,MEKF_WIND_wx) = -IuRqt;
-  Matrix<float, MEKF_WIND_COV_SIZE, 1> Ht = H.transpose();
+  Matrix<float, 1, 9> H;
+  H << IuRqt * skew_sym(va), IuRqt, -IuRqt;
+  static const int H_col[9] = { MEKF_WIND_qx, MEKF_WIND_qy, MEKF_WIND_qz,
+                                MEKF_WIND_vx, MEKF_WIND_vy, MEKF_WIND_vz,
+                                MEKF_WIND_wx, MEKF_WIND_wy, MEKF_WIND_wz };
   // S = H*P*Ht + Hn*N*Hnt
-  float S = H * mwp.P * Ht + mwp.R(MEKF_WIND_ras,MEKF_WIND_ras);
   // K = P*Ht*S^-1
-  Matrix<float, MEKF_WIND_COV_SIZE, 1> K = mwp.P * Ht / S;
+  const Matrix<float, 1, 1> R(mwp.R(MEKF_WIND_ras,MEKF_WIND_ras));
+  Matrix<float, MEKF_WIND_COV_SIZE, 1> K;
+  cov_update(mwp.P, H, H_col, R, K);
   // Residual z_m - h(z)
   float res = mwp.measurements.airspeed - IuRqt * va;
   // Update state
@@ -645,8 +755,6 @@ void ins_mekf_wind_update_airspeed(float airspeed)
   if (!ins_mekf_wind_params.disable_wind) {
     mwp.state.wind        += K.block<3,1>(MEKF_WIND_wx,0) * res;
   }
-  // Update covariance
-  mwp.P = (MEKFWCov::Identity() - K * H) * mwp.P;
 }
 
 void ins_mekf_wind_update_incidence(float aoa, float aos)
@@ -655,7 +763,7 @@ void ins_mekf_wind_update_incidence(float aoa, float aos)
   mwp.measurements.aos = aos;
 
   if (ins_mekf_wind_params.disable_wind) return;
-  // H and Ht matrices
+  // H matrix
   const Matrix3f Rqt = mwp.state.quat.toRotationMatrix().transpose();
   const Vector3f va = Rqt * (mwp.state.speed - mwp.state.wind); // airspeed in body frame
   // check if data in valid range
@@ -674,14 +782,12 @@ void ins_mekf_wind_update_incidence(float aoa, float aos)
   const float c_aos = cosf(aos);
   const Matrix3f B = Vector3f(s_aos * s_aos, - c_aos * c_aos, 0.f).asDiagonal();
   const RowVector3f vBRqt = 2.f * va.transpose() * B * Rqt;
-  Matrix<float, 2, MEKF_WIND_COV_SIZE> H = Matrix<float, 2, MEKF_WIND_COV_SIZE>::Zero();
-  H.block<1,3>(0,MEKF_WIND_qx) = CRqt * skew_sym(mwp.state.speed - mwp.state.wind);
-  H.block<1,3>(0,MEKF_WIND_vx) = CRqt;
-  H.block<1,3>(0,MEKF_WIND_wx) = -CRqt;
-  H.block<1,3>(1,MEKF_WIND_qx) = vBRqt * skew_sym(mwp.state.speed - mwp.state.wind);
-  H.block<1,3>(1,MEKF_WIND_vx) = vBRqt;
-  H.block<1,3>(1,MEKF_WIND_wx) = -vBRqt;
-  Matrix<float, MEKF_WIND_COV_SIZE, 2> Ht = H.transpose();
+  Matrix<float, 2, 9> H;
+  H << CRqt * skew_sym(mwp.state.speed - mwp.state.wind), CRqt, -CRqt,
+       vBRqt * skew_sym(mwp.state.speed - mwp.state.wind), vBRqt, -vBRqt;
+  static const int H_col[9] = { MEKF_WIND_qx, MEKF_WIND_qy, MEKF_WIND_qz,
+                                MEKF_WIND_vx, MEKF_WIND_vy, MEKF_WIND_vz,
+                                MEKF_WIND_wx, MEKF_WIND_wy, MEKF_WIND_wz };
   // Hn and Hnt matrices
   Matrix2f Hn = Matrix2f::Identity();
   Hn(0,0) = C(2) * va(0) - C(0) * va(2);
@@ -689,9 +795,10 @@ void ins_mekf_wind_update_incidence(float aoa, float aos)
   Hn(1,1) = (RowVector3f(-s_2aos, 0.f, s_2aos) * va.asDiagonal()) * va;
   Matrix2f Hnt = Hn.transpose();
   // S = H*P*Ht + Hn*N*Hnt
-  Matrix2f S = H * mwp.P * Ht + Hn * mwp.R.block<2,2>(MEKF_WIND_raoa,MEKF_WIND_raoa) * Hnt;
   // K = P*Ht*S^-1
-  Matrix<float, MEKF_WIND_COV_SIZE, 2> K = mwp.P * Ht * S.inverse();
+  const Matrix2f R = Hn * mwp.R.block<2,2>(MEKF_WIND_raoa,MEKF_WIND_raoa) * Hnt;
+  Matrix<float, MEKF_WIND_COV_SIZE, 2> K;
+  cov_update(mwp.P, H, H_col, R, K);
   // Residual z_m - h(z)
   Vector2f res = Vector2f::Zero();
   res(0) = - C * va;
@@ -711,8 +818,6 @@ void ins_mekf_wind_update_incidence(float aoa, float aos)
   if (!ins_mekf_wind_params.disable_wind) {
     mwp.state.wind        += K.block<3,2>(MEKF_WIND_wx,0) * res;
   }
-  // Update covariance
-  mwp.P = (MEKFWCov::Identity() - K * H) * mwp.P;
 }
 
 /**
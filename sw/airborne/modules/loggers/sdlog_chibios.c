@@ -57,6 +57,11 @@
 #define SDLOG_CONTIGUOUS_STORAGE_MEM 50
 #endif
 
+// Preallocate the contiguous storage when opening the log
+#ifndef SDLOG_PREALLOCATE
+#define SDLOG_PREALLOCATE LOG_PREALLOCATION_DISABLED
+#endif
+
 #if (!defined USE_ADC_WATCHDOG) || (USE_ADC_WATCHDOG == 0)
 #error sdlog_chibios need USE_ADC_WATCHDOG in order to properly close files when power is unplugged
 #endif
@@ -126,6 +131,34 @@ static void send_sdlog_status(struct transport_tx *trans, struct link_device *de
 
 
 // Functions for the generic device API
+#ifdef SDLOG_NEED_DIRECT
+// messages are serialized directly in the sdlog write buffers
+static int sdlog_check_free_space(struct chibios_sdlog *p, long *fd, uint16_t len)
+{
+  if (sdLogReserve(*(p->file), len, &p->direct_buf) != SDLOG_OK) {
+    return 0;
+  }
+  p->direct_len = 0;
+  *fd = 0;
+  return 1;
+}
+
+static void sdlog_transmit(struct chibios_sdlog *p, long fd __attribute__((unused)), uint8_t byte)
+{
+  p->direct_buf[p->direct_len++] = byte;
+}
+
+static void sdlog_transmit_buffer(struct chibios_sdlog *p, long fd __attribute__((unused)), uint8_t *data, uint16_t len)
+{
+  memcpy(&p->direct_buf[p->direct_len], data, len);
+  p->direct_len += len;
+}
+
+static void sdlog_send(struct chibios_sdlog *p, long fd __attribute__((unused)))
+{
+  sdLogCommit(*(p->file), p->direct_len);
+}
+#else
 static int sdlog_check_free_space(struct chibios_sdlog *p __attribute__((unused)), long *fd, uint16_t len)
 {
   SdLogBuffer *sdb;
@@ -158,6 +191,7 @@ static void sdlog_send(struct chibios_sdlog *p, long fd)
   SdLogBuffer *sdb = (SdLogBuffer *) fd;
   sdLogWriteSDB(*(p->file), sdb);
 }
+#endif
 
 static int null_function(struct chibios_sdlog *p __attribute__((unused))) { return 0; }
 static uint8_t null_byte_function(struct chibios_sdlog *p __attribute__((unused))) { return 0; }
@@ -247,7 +281,7 @@ static void thd_startlog(void *arg)
     removeEmptyLogs(PPRZ_LOG_DIR, PPRZ_LOG_NAME, 50);
     if (sdLogOpenLog(&pprzLogFile, PPRZ_LOG_DIR,
 		     PPRZ_LOG_NAME, SDLOG_AUTO_FLUSH_PERIOD, LOG_APPEND_TAG_AT_CLOSE_DISABLED,
-		     SDLOG_CONTIGUOUS_STORAGE_MEM, LOG_PREALLOCATION_DISABLED, tmpFilename, sizeof(tmpFilename)) != SDLOG_OK) {
+		     SDLOG_CONTIGUOUS_STORAGE_MEM, SDLOG_PREALLOCATE, tmpFilename, sizeof(tmpFilename)) != SDLOG_OK) {
       sdOk = false;
     }
     chsnprintf(chibios_sdlog_filenames, sizeof(chibios_sdlog_filenames), "%s", tmpFilename);
@@ -255,7 +289,7 @@ static void thd_startlog(void *arg)
     removeEmptyLogs(FR_LOG_DIR, FLIGHTRECORDER_LOG_NAME, 50);
     if (sdLogOpenLog(&flightRecorderLogFile, FR_LOG_DIR, FLIGHTRECORDER_LOG_NAME,
 		     SDLOG_AUTO_FLUSH_PERIOD, LOG_APPEND_TAG_AT_CLOSE_DISABLED,
-		      SDLOG_CONTIGUOUS_STORAGE_MEM, LOG_PREALLOCATION_DISABLED, tmpFilename, sizeof(tmpFilename)) != SDLOG_OK) {
+		      SDLOG_CONTIGUOUS_STORAGE_MEM, SDLOG_PREALLOCATE, tmpFilename, sizeof(tmpFilename)) != SDLOG_OK) {
       sdOk = false;
     }
     chsnprintf(chibios_sdlog_filenames, sizeof(chibios_sdlog_filenames), "%s, %s", chibios_sdlog_filenames, tmpFilename);
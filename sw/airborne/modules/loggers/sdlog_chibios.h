@@ -53,6 +53,10 @@ extern void sdlog_chibios_finish(bool flush);
  */
 struct chibios_sdlog {
   FileDes *file;
+#ifdef SDLOG_NEED_DIRECT
+  uint8_t *direct_buf;  ///< area reserved in the sdlog buffers for the current message
+  uint16_t direct_len;  ///< number of bytes serialized in the reserved area
+#endif
   /** Generic device interface */
   struct link_device device;
 };
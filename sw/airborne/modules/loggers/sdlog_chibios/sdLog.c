@@ -97,6 +97,15 @@
 #error SDLOG_ALL_BUFFERS_SIZE / SDLOG_NUM_FILES should be a POWER OF 2
 #endif
 
+#ifdef SDLOG_NEED_DIRECT
+#if (SDLOG_DIRECT_BUFFER_SIZE % 512) != 0
+#error SDLOG_DIRECT_BUFFER_SIZE should be a multiple of 512
+#endif
+#if SDLOG_DIRECT_NB_BUFFERS < 2
+#error SDLOG_DIRECT_NB_BUFFERS should be at least 2
+#endif
+#endif
+
 #ifdef SDLOG_NEED_QUEUE
 #include "modules/loggers/sdlog_chibios/msg_queue.h"
 
@@ -125,8 +134,8 @@ static MsgQueue messagesQueue;
 #define WRITE_BYTE_CACHE_SIZE 15 // limit overhead :
 // malloc (15+1) occupies 20bytes
 typedef struct {
-  uint8_t fcntl: 2;
-  uint8_t fd: 6;
+  uint8_t fcntl: 3;
+  uint8_t fd: 5;
 } FileOp;
 
 struct LogMessage {
@@ -157,10 +166,11 @@ static volatile size_t nbBytesWritten = 0;
 static SdioError storageStatus = SDLOG_OK;
 
 typedef enum {
-  FCNTL_WRITE = 0b00,
-  FCNTL_FLUSH = 0b01,
-  FCNTL_CLOSE = 0b10,
-  FCNTL_EXIT =  0b11
+  FCNTL_WRITE = 0b000,
+  FCNTL_FLUSH = 0b001,
+  FCNTL_CLOSE = 0b010,
+  FCNTL_EXIT =  0b011,
+  FCNTL_WRITE_DIRECT = 0b100
 } FileFcntl;
 
 struct  _SdLogBuffer {
@@ -171,6 +181,42 @@ struct  _SdLogBuffer {
 
 
 #define LOG_MESSAGE_PREBUF_LEN (SDLOG_MAX_MESSAGE_LEN+sizeof(LogMessage))
+
+#ifdef SDLOG_NEED_DIRECT
+/*
+  Zero copy path : messages are serialized in place in large buffers. A message crossing
+  the end of a buffer is written in the extra room at the end, then moved to the start of
+  the next buffer, so that all writes are exactly SDLOG_DIRECT_BUFFER_SIZE long and
+  sector aligned : fatfs then write them directly from the buffer with multi-sectors
+  DMA transfers, bypassing its own cache.
+ */
+struct DirectBuffer {
+  ALIGNED_VAR(32) uint8_t data[SDLOG_DIRECT_BUFFER_SIZE + SDLOG_MAX_MESSAGE_LEN];
+  uint32_t size;      // number of bytes to write
+  volatile bool busy; // queued for writing, owned by the worker thread
+};
+
+struct DirectLog {
+  struct DirectBuffer buffers[SDLOG_DIRECT_NB_BUFFERS];
+  uint32_t fill;      // number of bytes in the current buffer
+  size_t reserved;    // length of the pending reservation
+  uint8_t cur;        // index of the current buffer
+};
+
+static IN_DMA_SECTION_CLEAR(struct DirectLog directLogs[SDLOG_NUM_FILES]);
+static volatile uint32_t nbDirectDrops = 0;
+/*
+  protects fill, cur and reserved : held from sdLogReserve to sdLogCommit by the
+  logging thread, and taken by directFlush, which can be called from any thread
+  (e.g. sdLogCloseAllLogs from the battery survey thread)
+ */
+static MUTEX_DECL(directMtx);
+
+static void directReset(const FileDes fd);
+static SdioError directQueueBuffer(const FileDes fd, const uint8_t idx, const uint32_t size);
+static SdioError directFlush(const FileDes fd);
+#endif // SDLOG_NEED_DIRECT
+
 #endif //  SDLOG_NEED_QUEUE
 
 /* File system object */
@@ -316,6 +362,9 @@ SdioError sdLogOpenLog(FileDes *fd, const char *directoryName, const char *prefi
     fileDes[ldf].tagAtClose = appendTagAtClose;
     fileDes[ldf].autoFlushPeriod = autoFlushPeriod;
     fileDes[ldf].lastFlushTs = 0;
+#ifdef SDLOG_NEED_DIRECT
+    directReset(ldf);
+#endif
     sde = sdLogExpandLogFile(ldf, sizeInMo, preallocate);
   }
   
@@ -472,6 +521,10 @@ SdioError sdLogFlushLog(const FileDes fd)
     return status;
   }
 
+#ifdef SDLOG_NEED_DIRECT
+  directFlush(fd);
+#endif
+
   // give room to send a flush order if the queue is full
   cleanQueue(false);
 
@@ -494,6 +547,10 @@ SdioError sdLogCloseLog(const FileDes fd)
 {
   FD_CHECK(fd);
 
+#ifdef SDLOG_NEED_DIRECT
+  directFlush(fd);
+#endif
+
   cleanQueue(false);
   LogMessage *lm =  tlsf_malloc_r(&HEAP_DEFAULT, sizeof(LogMessage));
   if (lm == NULL) {
@@ -631,6 +688,115 @@ exit:
 
 
 
+#ifdef SDLOG_NEED_DIRECT
+SdioError sdLogReserve(const FileDes fd, const size_t len, uint8_t **buffer)
+{
+  FD_CHECK(fd);
+
+  if (len > SDLOG_MAX_MESSAGE_LEN) {
+    return storageStatus = SDLOG_INTERNAL_ERROR;
+  }
+
+  chMtxLock(&directMtx);
+  struct DirectLog *dl = &directLogs[fd];
+  // current buffer is still being written, or message will cross the end of the
+  // buffer and the next one is not free : all buffers are in use, drop message
+  if (dl->buffers[dl->cur].busy ||
+      ((dl->fill + len >= SDLOG_DIRECT_BUFFER_SIZE) &&
+       dl->buffers[(dl->cur + 1) % SDLOG_DIRECT_NB_BUFFERS].busy)) {
+    nbDirectDrops++;
+    chMtxUnlock(&directMtx);
+    return storageStatus = SDLOG_QUEUEFULL;
+  }
+
+  // the lock is kept until sdLogCommit, so that a flush does not move the buffers
+  dl->reserved = len;
+  *buffer = &dl->buffers[dl->cur].data[dl->fill];
+  return storageStatus = SDLOG_OK;
+}
+
+SdioError sdLogCommit(const FileDes fd, const size_t len)
+{
+  // fd was valid for sdLogReserve, the file may have been closed since
+  struct DirectLog *dl = &directLogs[fd];
+  SdioError status = SDLOG_OK;
+  if (len > dl->reserved || fileDes[fd].inUse == false) {
+    status = SDLOG_INTERNAL_ERROR;
+  } else {
+    dl->fill += len;
+    if (dl->fill >= SDLOG_DIRECT_BUFFER_SIZE) {
+      // buffer is full, move the overflow to the next one (checked free by sdLogReserve)
+      const uint8_t full = dl->cur;
+      const uint32_t overflow = dl->fill - SDLOG_DIRECT_BUFFER_SIZE;
+      dl->cur = (uint8_t)((dl->cur + 1) % SDLOG_DIRECT_NB_BUFFERS);
+      memcpy(dl->buffers[dl->cur].data, &dl->buffers[full].data[SDLOG_DIRECT_BUFFER_SIZE], overflow);
+      dl->fill = overflow;
+      status = directQueueBuffer(fd, full, SDLOG_DIRECT_BUFFER_SIZE);
+    }
+  }
+  dl->reserved = 0;
+  chMtxUnlock(&directMtx);
+  return storageStatus = status;
+}
+
+uint32_t sdLogGetNbDirectDrops(void)
+{
+  return nbDirectDrops;
+}
+
+static void directReset(const FileDes fd)
+{
+  struct DirectLog *dl = &directLogs[fd];
+  for (uint8_t i = 0; i < SDLOG_DIRECT_NB_BUFFERS; i++) {
+    dl->buffers[i].busy = false;
+    dl->buffers[i].size = 0;
+  }
+  dl->fill = 0;
+  dl->reserved = 0;
+  dl->cur = 0;
+}
+
+static SdioError directQueueBuffer(const FileDes fd, const uint8_t idx, const uint32_t size)
+{
+  struct DirectBuffer *db = &directLogs[fd].buffers[idx];
+  // only the buffer index is sent, data stay in place
+  uint8_t raw[sizeof(LogMessage) + 1];
+  LogMessage *lm = (LogMessage *) raw;
+  lm->op.fcntl = FCNTL_WRITE_DIRECT;
+  lm->op.fd = fd & 0x1f;
+  lm->mess[0] = idx;
+
+  db->size = size;
+  db->busy = true;
+  if (msgqueue_copy_send(&messagesQueue, lm, sizeof(raw), MsgQueue_REGULAR) < 0) {
+    db->busy = false;
+    nbDirectDrops++;
+    return SDLOG_QUEUEFULL;
+  }
+  return SDLOG_OK;
+}
+
+/*
+  send the partially filled current buffer, next writes won't be sector aligned
+  so this should only be done when flushing or closing
+ */
+static SdioError directFlush(const FileDes fd)
+{
+  struct DirectLog *dl = &directLogs[fd];
+  SdioError status = SDLOG_OK;
+  chMtxLock(&directMtx);
+  if (dl->fill != 0 && !dl->buffers[dl->cur].busy) {
+    const uint8_t idx = dl->cur;
+    const uint32_t size = dl->fill;
+    dl->cur = (uint8_t)((dl->cur + 1) % SDLOG_DIRECT_NB_BUFFERS);
+    dl->fill = 0;
+    status = directQueueBuffer(fd, idx, size);
+  }
+  chMtxUnlock(&directMtx);
+  return status;
+}
+#endif
+
 SdioError sdLogWriteByte(const FileDes fd, const uint8_t value)
 {
   FD_CHECK(fd);
@@ -911,6 +1077,12 @@ static void removeFromQueue(const size_t nbMsgToRFemove)
     if (retLen < 0) {
       break;
     }
+#ifdef SDLOG_NEED_DIRECT
+    // release direct buffer that won't be written
+    if (lm->op.fcntl == FCNTL_WRITE_DIRECT) {
+      directLogs[lm->op.fd].buffers[(uint8_t) lm->mess[0]].busy = false;
+    }
+#endif
     tlsf_free_r(&HEAP_DEFAULT, lm);
   }
 
@@ -924,6 +1096,22 @@ static void removeFromQueue(const size_t nbMsgToRFemove)
 }
 
 
+/*
+  if there an autoflush period specified, flush to the mass storage media
+  if timer has expired and rearm.
+ */
+static void autoFlush(const FileDes fd)
+{
+  if (fileDes[fd].autoFlushPeriod) {
+    const systime_t now = chVTGetSystemTimeX();
+    if ((now - fileDes[fd].lastFlushTs) >
+        (fileDes[fd].autoFlushPeriod * CH_CFG_ST_FREQUENCY)) {
+      f_sync(&fileDes[fd].fil);
+      fileDes[fd].lastFlushTs = now;
+    }
+  }
+}
+
 #if (CH_KERNEL_MAJOR > 2)
 static void thdSdLog(void *arg)
 #else
@@ -994,16 +1182,7 @@ static msg_t thdSdLog(void *arg)
               memcpy(&(perfBuffer[curBufFill]), lm->mess, (size_t)(stayLen));
               FRESULT rc = f_write(fo, perfBuffer, SDLOG_WRITE_BUFFER_SIZE, &bw);
               nbBytesWritten += bw;
-              // if there an autoflush period specified, flush to the mass storage media
-              // if timer has expired and rearm.
-              if (fileDes[lm->op.fd].autoFlushPeriod) {
-                const systime_t now = chVTGetSystemTimeX();
-                if ((now - fileDes[lm->op.fd].lastFlushTs) >
-                    (fileDes[lm->op.fd].autoFlushPeriod * CH_CFG_ST_FREQUENCY)) {
-                  f_sync(fo);
-                  fileDes[lm->op.fd].lastFlushTs = now;
-                }
-              }
+              autoFlush(lm->op.fd);
               if (rc) {
                 //chThdExit(storageStatus = SDLOG_FATFS_ERROR);
 		storageStatus = SDLOG_FATFS_ERROR;
@@ -1016,6 +1195,37 @@ static msg_t thdSdLog(void *arg)
             }
           }
         }
+        break;
+
+#ifdef SDLOG_NEED_DIRECT
+        case FCNTL_WRITE_DIRECT: {
+          struct DirectBuffer *db = &directLogs[lm->op.fd].buffers[(uint8_t) lm->mess[0]];
+          if (fileDes[lm->op.fd].inUse) {
+            // keep order with data written with the regular API
+            const uint16_t curBufFill = perfBuffers[lm->op.fd].size;
+            if (curBufFill) {
+              f_write(fo, perfBuffer, curBufFill, &bw);
+              nbBytesWritten += bw;
+              perfBuffers[lm->op.fd].size = 0;
+            }
+            // written directly from the log buffer
+            const FRESULT rc = f_write(fo, db->data, db->size, &bw);
+            nbBytesWritten += bw;
+            autoFlush(lm->op.fd);
+            if (rc) {
+              storageStatus = SDLOG_FATFS_ERROR;
+            } else if (bw != db->size) {
+              db->busy = false;
+              chThdExit(storageStatus = SDLOG_FSFULL);
+            }
+          }
+          db->busy = false;
+        }
+        break;
+#endif
+
+        default:
+          break;
       }
       tlsf_free_r(&HEAP_DEFAULT, lm);
     } else {
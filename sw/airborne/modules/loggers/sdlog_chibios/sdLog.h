@@ -54,11 +54,19 @@ extern "C" {
  ° SDLOG_QUEUE_BUCKETS    : number of entries in bufering queue
  ° SDLOG_NUM_FILES     : number of simultaneous opened log files
 
+ optional, for the zero copy API (sdLogReserve / sdLogCommit) :
+ ° SDLOG_DIRECT_BUFFER_SIZE : (in bytes) size of the direct write buffers, multiple of 512,
+          ideally the cluster size. 0 (default) disable the zero copy API
+ ° SDLOG_DIRECT_NB_BUFFERS : number of direct write buffers per file (default 2)
+          memory used in DMA capable ram is :
+          SDLOG_NUM_FILES * SDLOG_DIRECT_NB_BUFFERS * (SDLOG_DIRECT_BUFFER_SIZE + SDLOG_MAX_MESSAGE_LEN)
+
  EXAMPLE:
  #define SDLOG_QUEUE_BUCKETS  1024
  #define SDLOG_MAX_MESSAGE_LEN 252
  #define SDLOG_NUM_FILES 1
  #define SDLOG_ALL_BUFFERS_SIZE (SDLOG_NUM_FILES*4096)
+ #define SDLOG_DIRECT_BUFFER_SIZE (16*1024)
 
 
 
@@ -66,6 +74,7 @@ extern "C" {
  sdLogInit (initialize peripheral,  verify sdCard availibility)
  sdLogOpenLog : open file
  sdLogWriteXXX : write log using one off the many function of the API
+   or sdLogReserve + sdLogCommit : serialize message directly in the write buffers
  sdLogCloseLog : close log
  sdLogFinish : terminate logging thread
 
@@ -99,6 +108,18 @@ extern "C" {
 #define SDLOG_NEED_QUEUE
 #endif
 
+#ifndef SDLOG_DIRECT_BUFFER_SIZE
+#define SDLOG_DIRECT_BUFFER_SIZE 0
+#endif
+
+#ifndef SDLOG_DIRECT_NB_BUFFERS
+#define SDLOG_DIRECT_NB_BUFFERS 2
+#endif
+
+#if defined SDLOG_NEED_QUEUE && SDLOG_DIRECT_BUFFER_SIZE
+#define SDLOG_NEED_DIRECT
+#endif
+
 #define LOG_PREALLOCATION_ENABLED true
 #define LOG_PREALLOCATION_DISABLED false
 #define LOG_APPEND_TAG_AT_CLOSE_ENABLED true
@@ -324,6 +345,40 @@ size_t sdLogGetBufferLenFromSDB(SdLogBuffer *sdb);
 SdioError sdLogWriteSDB(const FileDes fd, SdLogBuffer *sdb);
 
 
+#ifdef SDLOG_NEED_DIRECT
+/**
+ * @brief reserve room for a message directly in the write buffer of a file (zero copy)
+ * @details the message is serialized in place, then validated with sdLogCommit.
+ *          Full buffers are written by the worker thread with SDLOG_DIRECT_BUFFER_SIZE
+ *          long writes, without any intermediate copy.
+ *          Only one reservation can be pending per file, and a file written with this
+ *          API should not be written with the sdLogWriteXXX functions (order between the
+ *          two paths is not guaranteed).
+ *          On success, the direct buffers are locked until sdLogCommit, which must be
+ *          called by the same thread; flush and close from other threads wait for it.
+ * @param[in] fileObject : file descriptor returned by sdLogOpenLog
+ * @param[in] len : maximum length of the message, at most SDLOG_MAX_MESSAGE_LEN
+ * @param[out] buffer : pointer to the reserved area
+ * @return  status, SDLOG_QUEUEFULL if no buffer is free (message should be dropped)
+ */
+SdioError sdLogReserve(const FileDes fileObject, const size_t len, uint8_t **buffer);
+
+/**
+ * @brief validate the message serialized in the area given by sdLogReserve
+ * @details only after a successful sdLogReserve, releases the lock it took
+ * @param[in] fileObject : file descriptor returned by sdLogOpenLog
+ * @param[in] len : actual length of the message, less or equal to the reserved length
+ * @return  status (always check status)
+ */
+SdioError sdLogCommit(const FileDes fileObject, const size_t len);
+
+/**
+ * @brief return number of messages dropped by sdLogReserve because no buffer was free
+ * @return  number of dropped messages
+ */
+uint32_t sdLogGetNbDirectDrops(void);
+#endif
+
 /**
  * @brief log one byte of binary data
  * @param[in] fileObject : file descriptor returned by sdLogOpenLog
@@ -0,0 +1,352 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/** @file modules/loggers/signal_recorder.c
+ *  @brief Columnar binary recorder for Linux based autopilots
+ *
+ *  The recorded signals are declared in the airframe file with the
+ *  SIGNAL_RECORDER_SIGNALS define, a list of SR_SIGNAL(name, type, expression).
+ *  The periodic function only copies the values into a preallocated ring of
+ *  rows. A background thread takes blocks of SIGNAL_RECORDER_BLOCK_ROWS rows,
+ *  stores them by column (with the bytes of each value shuffled), compresses
+ *  them in the LZ4 block format and writes each block with a single call.
+ *
+ *  File format (little endian):
+ *  - header: "SREC", uint16 version, uint16 nb columns,
+ *    then per column: uint8 type, uint8 name length, name
+ *  - blocks: "SRBK", uint16 nb rows, uint16 flags (bit 0: compressed),
+ *    uint32 raw size, uint32 data size, data
+ *  The first column is always the time in microseconds (time_us).
+ *  Files can be converted with sw/logalizer/signal_recorder_decode.py
+ */
+
+#include "modules/loggers/signal_recorder.h"
+#include "modules/loggers/signal_recorder/lz4_block.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mcu_periph/sys_time.h"
+#include "state.h"
+#include "generated/airframe.h"
+
+/** Optional header needed by the signal expressions */
+#ifdef SIGNAL_RECORDER_HEADER
+#include SIGNAL_RECORDER_HEADER
+#endif
+
+/** Set the default path to the USB drive */
+#ifndef SIGNAL_RECORDER_PATH
+#define SIGNAL_RECORDER_PATH /data/video/usb
+#endif
+
+/** Recorded signals: SR_SIGNAL(name, type, expression) */
+#ifndef SIGNAL_RECORDER_SIGNALS
+#define SIGNAL_RECORDER_SIGNALS \
+  SR_SIGNAL(pos_x, float, stateGetPositionNed_f()->x) \
+  SR_SIGNAL(pos_y, float, stateGetPositionNed_f()->y) \
+  SR_SIGNAL(pos_z, float, stateGetPositionNed_f()->z) \
+  SR_SIGNAL(vel_x, float, stateGetSpeedNed_f()->x) \
+  SR_SIGNAL(vel_y, float, stateGetSpeedNed_f()->y) \
+  SR_SIGNAL(vel_z, float, stateGetSpeedNed_f()->z) \
+  SR_SIGNAL(att_phi, float, stateGetNedToBodyEulers_f()->phi) \
+  SR_SIGNAL(att_theta, float, stateGetNedToBodyEulers_f()->theta) \
+  SR_SIGNAL(att_psi, float, stateGetNedToBodyEulers_f()->psi) \
+  SR_SIGNAL(rate_p, float, stateGetBodyRates_f()->p) \
+  SR_SIGNAL(rate_q, float, stateGetBodyRates_f()->q) \
+  SR_SIGNAL(rate_r, float, stateGetBodyRates_f()->r)
+#endif
+
+/** Number of rows per written block */
+#ifndef SIGNAL_RECORDER_BLOCK_ROWS
+#define SIGNAL_RECORDER_BLOCK_ROWS 256
+#endif
+
+/** Number of rows in the ring, power of 2 */
+#ifndef SIGNAL_RECORDER_RING_ROWS
+#define SIGNAL_RECORDER_RING_ROWS 4096
+#endif
+
+#if (SIGNAL_RECORDER_RING_ROWS & (SIGNAL_RECORDER_RING_ROWS - 1)) != 0
+#error "SIGNAL_RECORDER_RING_ROWS should be a power of 2"
+#endif
+
+#if SIGNAL_RECORDER_BLOCK_ROWS > SIGNAL_RECORDER_RING_ROWS / 2
+#error "SIGNAL_RECORDER_BLOCK_ROWS should be at most half of SIGNAL_RECORDER_RING_ROWS"
+#endif
+
+/** Compress the blocks */
+#ifndef SIGNAL_RECORDER_COMPRESS
+#define SIGNAL_RECORDER_COMPRESS TRUE
+#endif
+
+/** Polling period of the writing thread (ms) */
+#ifndef SIGNAL_RECORDER_POLL_MS
+#define SIGNAL_RECORDER_POLL_MS 20
+#endif
+
+/** Column types, same codes in the decoder */
+enum SignalRecorderType {
+  SR_TYPE_uint8_t = 0,
+  SR_TYPE_int8_t = 1,
+  SR_TYPE_uint16_t = 2,
+  SR_TYPE_int16_t = 3,
+  SR_TYPE_uint32_t = 4,
+  SR_TYPE_int32_t = 5,
+  SR_TYPE_float = 6,
+  SR_TYPE_double = 7
+};
+
+/** One snapshot of all signals */
+struct SignalRecorderRow {
+  uint32_t time_us;
+#define SR_SIGNAL(_name, _type, _expr) _type _name;
+  SIGNAL_RECORDER_SIGNALS
+#undef SR_SIGNAL
+};
+
+struct SignalRecorderColumn {
+  const char *name;
+  uint8_t type;
+  uint8_t size;
+  uint16_t offset;
+};
+
+static const struct SignalRecorderColumn sr_columns[] = {
+  { "time_us", SR_TYPE_uint32_t, sizeof(uint32_t), offsetof(struct SignalRecorderRow, time_us) },
+#define SR_SIGNAL(_name, _type, _expr) { #_name, SR_TYPE_##_type, sizeof(_type), offsetof(struct SignalRecorderRow, _name) },
+  SIGNAL_RECORDER_SIGNALS
+#undef SR_SIGNAL
+};
+
+#define SR_NB_COLUMNS (sizeof(sr_columns) / sizeof(sr_columns[0]))
+#define SR_BLOCK_HEADER_LEN 16
+#define SR_BLOCK_RAW_LEN (SIGNAL_RECORDER_BLOCK_ROWS * sizeof(struct SignalRecorderRow))
+
+struct SignalRecorder signal_recorder;
+
+/** ring of rows, written by the periodic function (head), read by the thread (tail) */
+static struct SignalRecorderRow sr_ring[SIGNAL_RECORDER_RING_ROWS];
+static uint32_t sr_head;
+static uint32_t sr_tail;
+static bool sr_stop;
+
+/** thread buffers */
+static uint8_t sr_columns_buf[SR_BLOCK_RAW_LEN];
+static uint8_t sr_out_buf[SR_BLOCK_HEADER_LEN + LZ4_BLOCK_BOUND(SR_BLOCK_RAW_LEN)];
+static struct Lz4Block sr_lz;
+
+static int sr_fd = -1;
+static pthread_t sr_thread;
+
+static bool sr_write(const uint8_t *buf, size_t len)
+{
+  while (len > 0) {
+    ssize_t n = write(sr_fd, buf, len);
+    if (n <= 0) {
+      return false;
+    }
+    buf += n;
+    len -= n;
+    signal_recorder.bytes_written += n;
+  }
+  return true;
+}
+
+static bool sr_write_header(void)
+{
+  uint8_t buf[8 + SR_NB_COLUMNS * 258];
+  uint32_t pos = 0;
+  const uint16_t version = 1;
+  const uint16_t nb = SR_NB_COLUMNS;
+  memcpy(&buf[pos], "SREC", 4); pos += 4;
+  memcpy(&buf[pos], &version, 2); pos += 2;
+  memcpy(&buf[pos], &nb, 2); pos += 2;
+  for (uint16_t c = 0; c < SR_NB_COLUMNS; c++) {
+    uint8_t len = (uint8_t)Min(strlen(sr_columns[c].name), 255);
+    buf[pos++] = sr_columns[c].type;
+    buf[pos++] = len;
+    memcpy(&buf[pos], sr_columns[c].name, len);
+    pos += len;
+  }
+  return sr_write(buf, pos);
+}
+
+/** Transpose, compress and write nb rows starting at ring index first */
+static bool sr_write_block(uint32_t first, uint16_t nb)
+{
+  // by column, bytes of each value shuffled (all first bytes, then all second bytes...)
+  uint32_t pos = 0;
+  for (uint16_t c = 0; c < SR_NB_COLUMNS; c++) {
+    for (uint8_t b = 0; b < sr_columns[c].size; b++) {
+      const uint16_t offset = sr_columns[c].offset + b;
+      for (uint16_t r = 0; r < nb; r++) {
+        const uint8_t *row = (const uint8_t *)&sr_ring[(first + r) % SIGNAL_RECORDER_RING_ROWS];
+        sr_columns_buf[pos++] = row[offset];
+      }
+    }
+  }
+
+  uint16_t flags = 0;
+  uint32_t size = pos;
+#if SIGNAL_RECORDER_COMPRESS
+  size = lz4_block_compress(&sr_lz, sr_columns_buf, pos, &sr_out_buf[SR_BLOCK_HEADER_LEN]);
+  flags = 1;
+  if (size >= pos) {
+    // not compressible, store raw
+    size = pos;
+    flags = 0;
+  }
+#endif
+  if (flags == 0) {
+    memcpy(&sr_out_buf[SR_BLOCK_HEADER_LEN], sr_columns_buf, pos);
+  }
+
+  memcpy(&sr_out_buf[0], "SRBK", 4);
+  memcpy(&sr_out_buf[4], &nb, 2);
+  memcpy(&sr_out_buf[6], &flags, 2);
+  memcpy(&sr_out_buf[8], &pos, 4);
+  memcpy(&sr_out_buf[12], &size, 4);
+  return sr_write(sr_out_buf, SR_BLOCK_HEADER_LEN + size);
+}
+
+static void *sr_thread_function(void *arg __attribute__((unused)))
+{
+  while (true) {
+    const uint32_t head = __atomic_load_n(&sr_head, __ATOMIC_ACQUIRE);
+    const bool stop = __atomic_load_n(&sr_stop, __ATOMIC_ACQUIRE);
+    const uint32_t available = head - sr_tail;
+    if (available >= SIGNAL_RECORDER_BLOCK_ROWS || (stop && available > 0)) {
+      const uint16_t nb = Min(available, SIGNAL_RECORDER_BLOCK_ROWS);
+      if (!sr_write_block(sr_tail, nb)) {
+        printf("[signal_recorder] ERROR writing block\n");
+      }
+      __atomic_store_n(&sr_tail, sr_tail + nb, __ATOMIC_RELEASE);
+    } else if (stop) {
+      break;
+    } else {
+      usleep(SIGNAL_RECORDER_POLL_MS * 1000);
+    }
+  }
+  return NULL;
+}
+
+/** Start the recorder and open a new file */
+void signal_recorder_start(void)
+{
+  if (signal_recorder.running) {
+    return;
+  }
+
+  // Create output folder if necessary
+  if (access(STRINGIFY(SIGNAL_RECORDER_PATH), F_OK)) {
+    char save_dir_cmd[256];
+    sprintf(save_dir_cmd, "mkdir -p %s", STRINGIFY(SIGNAL_RECORDER_PATH));
+    if (system(save_dir_cmd) != 0) {
+      printf("[signal_recorder] Could not create log file directory %s.\n", STRINGIFY(SIGNAL_RECORDER_PATH));
+      return;
+    }
+  }
+
+  // Get current date/time for filename
+  char date_time[80];
+  time_t now = time(0);
+  struct tm tstruct = *localtime(&now);
+  strftime(date_time, sizeof(date_time), "%Y%m%d-%H%M%S", &tstruct);
+
+  char filename[512];
+  uint32_t counter = 0;
+  sprintf(filename, "%s/%s.srec", STRINGIFY(SIGNAL_RECORDER_PATH), date_time);
+  while (access(filename, F_OK) == 0) {
+    sprintf(filename, "%s/%s_%05d.srec", STRINGIFY(SIGNAL_RECORDER_PATH), date_time, counter);
+    counter++;
+  }
+
+  sr_fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (sr_fd < 0) {
+    printf("[signal_recorder] ERROR opening log file %s!\n", filename);
+    return;
+  }
+
+  signal_recorder.nb_rows = 0;
+  signal_recorder.nb_dropped = 0;
+  signal_recorder.bytes_written = 0;
+  if (!sr_write_header()) {
+    printf("[signal_recorder] ERROR writing header to %s!\n", filename);
+    close(sr_fd);
+    sr_fd = -1;
+    return;
+  }
+
+  sr_head = 0;
+  sr_tail = 0;
+  sr_stop = false;
+  if (pthread_create(&sr_thread, NULL, sr_thread_function, NULL) != 0) {
+    printf("[signal_recorder] ERROR creating thread\n");
+    close(sr_fd);
+    sr_fd = -1;
+    return;
+  }
+
+  printf("[signal_recorder] Start logging %d columns to %s...\n", (int)SR_NB_COLUMNS, filename);
+  signal_recorder.running = true;
+}
+
+/** Stop the recorder, write the remaining rows and close the file */
+void signal_recorder_stop(void)
+{
+  if (!signal_recorder.running) {
+    return;
+  }
+  signal_recorder.running = false;
+  __atomic_store_n(&sr_stop, true, __ATOMIC_RELEASE);
+  pthread_join(sr_thread, NULL);
+  close(sr_fd);
+  sr_fd = -1;
+}
+
+/** Snapshot of the signals, no system call */
+void signal_recorder_periodic(void)
+{
+  if (!signal_recorder.running) {
+    return;
+  }
+
+  const uint32_t head = sr_head;
+  if (head - __atomic_load_n(&sr_tail, __ATOMIC_ACQUIRE) >= SIGNAL_RECORDER_RING_ROWS) {
+    signal_recorder.nb_dropped++;
+    return;
+  }
+
+  struct SignalRecorderRow *row = &sr_ring[head % SIGNAL_RECORDER_RING_ROWS];
+  row->time_us = get_sys_time_usec();
+#define SR_SIGNAL(_name, _type, _expr) row->_name = (_type)(_expr);
+  SIGNAL_RECORDER_SIGNALS
+#undef SR_SIGNAL
+
+  __atomic_store_n(&sr_head, head + 1, __ATOMIC_RELEASE);
+  signal_recorder.nb_rows++;
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/** @file modules/loggers/signal_recorder.h
+ *  @brief Columnar binary recorder for Linux based autopilots
+ */
+
+#ifndef SIGNAL_RECORDER_H_
+#define SIGNAL_RECORDER_H_
+
+#include "std.h"
+
+struct SignalRecorder {
+  bool running;
+  uint32_t nb_rows;         ///< number of recorded rows
+  uint32_t nb_dropped;      ///< number of rows dropped because the ring was full
+  uint32_t bytes_written;   ///< number of bytes written to the file
+};
+
+extern struct SignalRecorder signal_recorder;
+
+extern void signal_recorder_start(void);
+extern void signal_recorder_stop(void);
+extern void signal_recorder_periodic(void);
+
+#endif /* SIGNAL_RECORDER_H_ */
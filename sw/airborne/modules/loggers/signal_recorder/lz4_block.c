@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/** @file modules/loggers/signal_recorder/lz4_block.c
+ *  @brief Minimal compressor for the LZ4 block format
+ *
+ *  Greedy parsing with a single hash table, same rules as the reference
+ *  implementation: matches of at least 4 bytes, offsets below 64k, the last
+ *  match starts at least 12 bytes before the end and the last 5 bytes are
+ *  literals.
+ */
+
+#include "modules/loggers/signal_recorder/lz4_block.h"
+#include <string.h>
+
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MF_LIMIT 12
+#define LZ4_MAX_OFFSET 65535
+
+static inline uint32_t read32(const uint8_t *p)
+{
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint32_t hash32(uint32_t v)
+{
+  return (v * 2654435761U) >> (32 - LZ4_BLOCK_HASH_LOG);
+}
+
+/** write a length extension (after a token field of 15) */
+static inline uint8_t *write_length(uint8_t *op, uint32_t len)
+{
+  while (len >= 255) {
+    *op++ = 255;
+    len -= 255;
+  }
+  *op++ = (uint8_t)len;
+  return op;
+}
+
+/** write a sequence: literals from anchor, then an optional match */
+static uint8_t *write_sequence(uint8_t *op, const uint8_t *anchor, uint32_t lit_len,
+                               uint32_t offset, uint32_t match_len)
+{
+  uint8_t *token = op++;
+  *token = (uint8_t)(Min(lit_len, 15) << 4);
+  if (lit_len >= 15) {
+    op = write_length(op, lit_len - 15);
+  }
+  memcpy(op, anchor, lit_len);
+  op += lit_len;
+  if (match_len > 0) {
+    *op++ = (uint8_t)(offset & 0xFF);
+    *op++ = (uint8_t)(offset >> 8);
+    uint32_t ml = match_len - LZ4_MIN_MATCH;
+    *token |= (uint8_t)Min(ml, 15);
+    if (ml >= 15) {
+      op = write_length(op, ml - 15);
+    }
+  }
+  return op;
+}
+
+uint32_t lz4_block_compress(struct Lz4Block *lz, const uint8_t *src, uint32_t len, uint8_t *dst)
+{
+  uint8_t *op = dst;
+  uint32_t anchor = 0;
+
+  if (len > LZ4_MF_LIMIT) {
+    // table stores position + 1, 0 is empty
+    memset(lz->table, 0, sizeof(lz->table));
+    const uint32_t limit = len - LZ4_MF_LIMIT;
+    const uint32_t match_limit = len - LZ4_LAST_LITERALS;
+    uint32_t ip = 0;
+    while (ip < limit) {
+      const uint32_t seq = read32(src + ip);
+      const uint32_t h = hash32(seq);
+      const uint32_t ref1 = lz->table[h];
+      lz->table[h] = ip + 1;
+      if (ref1 == 0 || ip - (ref1 - 1) > LZ4_MAX_OFFSET || read32(src + ref1 - 1) != seq) {
+        ip++;
+        continue;
+      }
+      uint32_t ref = ref1 - 1;
+      // extend backward into the pending literals
+      while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+        ip--;
+        ref--;
+      }
+      uint32_t match_len = LZ4_MIN_MATCH;
+      while (ip + match_len < match_limit && src[ip + match_len] == src[ref + match_len]) {
+        match_len++;
+      }
+      op = write_sequence(op, src + anchor, ip - anchor, ip - ref, match_len);
+      ip += match_len;
+      anchor = ip;
+    }
+  }
+
+  // last literals
+  op = write_sequence(op, src + anchor, len - anchor, 0, 0);
+  return (uint32_t)(op - dst);
+}
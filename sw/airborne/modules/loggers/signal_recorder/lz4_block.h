@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/** @file modules/loggers/signal_recorder/lz4_block.h
+ *  @brief Minimal compressor for the LZ4 block format
+ *
+ *  Output can be decoded by any LZ4 block decoder (e.g. lz4.block.decompress
+ *  in python with the uncompressed size).
+ */
+
+#ifndef LZ4_BLOCK_H
+#define LZ4_BLOCK_H
+
+#include "std.h"
+
+/** Worst case compressed size of n bytes */
+#define LZ4_BLOCK_BOUND(_n) ((_n) + (_n) / 255 + 16)
+
+/** Size of the hash table (log2) */
+#define LZ4_BLOCK_HASH_LOG 12
+
+/** Compressor working memory */
+struct Lz4Block {
+  uint32_t table[1 << LZ4_BLOCK_HASH_LOG];
+};
+
+/**
+ * Compress a buffer in the LZ4 block format
+ * @param lz working memory
+ * @param src input data
+ * @param len input length
+ * @param dst output buffer, at least LZ4_BLOCK_BOUND(len) long
+ * @return compressed length
+ */
+extern uint32_t lz4_block_compress(struct Lz4Block *lz, const uint8_t *src, uint32_t len, uint8_t *dst);
+
+#endif /* LZ4_BLOCK_H */
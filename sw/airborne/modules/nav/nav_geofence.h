@@ -26,6 +26,7 @@
  * 1) GEOFENCE_DATALINK_LOST_TIME: go to HOME mode if datalink lost for GEOFENCE_DATALINK_LOST_TIME
  * 2) GEOFENCE_MAX_ALTITUDE: go HOME if airplane higher than the max altitude
  * 3) GEOFENCE_MAX_HEIGHT: go HOME if airplane higher than the max height
+ *    (above the terrain below the aircraft when the terrain module is loaded)
  *
  * home_mode_max_alt is (optionally) defined in the flight plan
  * GEOFENCE_DATALINK_LOST_TIME is defined in the airframe config file
@@ -49,6 +50,10 @@ static inline bool datalink_lost(void)
 #endif /* GEOFENCE_DATALINK_LOST_TIME */
 
 
+#if USE_TERRAIN
+#include "modules/terrain/terrain.h"
+#endif
+
 #if defined GEOFENCE_MAX_ALTITUDE || defined GEOFENCE_MAX_HEIGHT// user defined geofence_max_altitude (or AGL) in the flight plan
 static inline bool higher_than_max_altitude(void)
 {
@@ -58,7 +63,11 @@ static inline bool higher_than_max_altitude(void)
 #endif /* GEOFENCE_MAX_ALTITUDE */
 
 #ifdef GEOFENCE_MAX_HEIGHT
+#if USE_TERRAIN
+  above_max_alt = above_max_alt || (GetPosAlt() > (TerrainAltRef() + GEOFENCE_MAX_HEIGHT));
+#else
   above_max_alt = above_max_alt || (GetPosAlt() > ( GetAltRef() + GEOFENCE_MAX_HEIGHT));
+#endif
 #endif /* GEOFENCE_MAX_HEIGHT */
   return above_max_alt;
 }
@@ -0,0 +1,640 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/terrain/terrain.c
+ *
+ * Onboard terrain elevation from SRTM/DEM tiles (Linux only).
+ *
+ * Tile format (little endian), written by sw/tools/terrain/srtm2terrain.py:
+ *  - header, see struct terrain_file_header
+ *  - offsets of the blocks from the start of the file, nb_blocks^2 + 1
+ *    uint32, blocks by rows from the north-west corner
+ *  - blocks: int16 base, uint8 number of bits, uint8 padding, then the
+ *    (TERRAIN_BLOCK_SIZE + 1)^2 heights minus base, packed LSB first.
+ *    Blocks share their last row and column with their neighbours, so an
+ *    interpolation never needs two blocks.
+ */
+
+#include "modules/terrain/terrain.h"
+#include "state.h"
+#include "rt_priority.h"
+#include "generated/flight_plan.h"
+#if defined(FIXEDWING_FIRMWARE)
+#include "nav.h"
+#else
+#include "navigation.h"
+#endif
+
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** Directory of the tiles */
+#ifndef TERRAIN_PATH
+#define TERRAIN_PATH /data/terrain
+#endif
+PRINT_CONFIG_VAR(TERRAIN_PATH)
+
+/** Number of decompressed blocks kept in memory (8.4kB each) */
+#ifndef TERRAIN_CACHE_BLOCKS
+#define TERRAIN_CACHE_BLOCKS 64
+#endif
+PRINT_CONFIG_VAR(TERRAIN_CACHE_BLOCKS)
+
+/** Maximum number of tiles, present or missing */
+#ifndef TERRAIN_MAX_TILES
+#define TERRAIN_MAX_TILES 9
+#endif
+PRINT_CONFIG_VAR(TERRAIN_MAX_TILES)
+
+/** Half width of the corridor paged in along the flight plan (m) */
+#ifndef TERRAIN_PREFETCH_WIDTH
+#define TERRAIN_PREFETCH_WIDTH 500.f
+#endif
+PRINT_CONFIG_VAR(TERRAIN_PREFETCH_WIDTH)
+
+/** Distance between the samples of the corridor (m) */
+#ifndef TERRAIN_PREFETCH_STEP
+#define TERRAIN_PREFETCH_STEP 200.f
+#endif
+
+/** Maximum number of blocks in the corridor */
+#ifndef TERRAIN_PREFETCH_MAX_BLOCKS
+#define TERRAIN_PREFETCH_MAX_BLOCKS 1024
+#endif
+
+/** Nice level of the prefetch thread */
+#ifndef TERRAIN_PREFETCH_NICE_LEVEL
+#define TERRAIN_PREFETCH_NICE_LEVEL 10
+#endif
+PRINT_CONFIG_VAR(TERRAIN_PREFETCH_NICE_LEVEL)
+
+#define TERRAIN_MAGIC "PPTR"
+#define TERRAIN_VERSION 1
+#define TERRAIN_BLOCK_SIDE (TERRAIN_BLOCK_SIZE + 1)
+#define TERRAIN_NO_BLOCK 0xFFFFFFFF
+
+struct terrain_file_header {
+  char magic[4];          ///< TERRAIN_MAGIC
+  uint16_t version;       ///< TERRAIN_VERSION
+  uint16_t block_size;    ///< cells per block side
+  uint16_t samples;       ///< samples per tile side (1201 for 3 arc-seconds, 3601 for 1 arc-second)
+  uint16_t nb_blocks;     ///< blocks per tile side
+  int16_t lat;            ///< south edge (deg)
+  int16_t lon;            ///< west edge (deg)
+  uint8_t reserved[16];
+} __attribute__((packed));
+
+struct terrain_tile {
+  int16_t lat;            ///< south edge (deg)
+  int16_t lon;            ///< west edge (deg)
+  bool present;           ///< false if there is no file for this tile
+  const uint8_t *map;
+  size_t size;
+  uint16_t samples;
+  uint16_t nb_blocks;
+  const uint32_t *offsets;
+};
+
+struct terrain_block {
+  uint32_t key;           ///< tile index << 16 | block index
+  uint32_t used;          ///< last use, for the LRU
+  int16_t h[TERRAIN_BLOCK_SIDE * TERRAIN_BLOCK_SIDE];
+};
+
+struct Terrain terrain;
+
+static struct terrain_tile tiles[TERRAIN_MAX_TILES];
+static struct terrain_tile *last_tile;            ///< last tile of the autopilot thread
+static struct terrain_tile *prefetch_last_tile;   ///< last tile of the prefetch thread
+static pthread_mutex_t tiles_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct terrain_block *blocks;
+static struct terrain_block *last_block;
+static uint32_t use_counter;
+
+/* Local frame, from the LTP or the UTM origin */
+struct terrain_frame {
+  bool ltp;
+  struct LtpDef_f ltp_def;
+  struct UtmCoor_f utm_origin;
+};
+
+/* Corridor paged in by the prefetch thread */
+struct terrain_range {
+  const uint8_t *start;
+  size_t len;
+};
+
+/* Request of the autopilot thread: frame and waypoints when it was set */
+static struct terrain_frame prefetch_frame;
+static struct FloatVect2 prefetch_wps[NB_WAYPOINT];
+static bool prefetch_pending;
+/* Tile of the autopilot thread not loaded yet, opened by the prefetch thread */
+static struct {
+  int16_t lat;
+  int16_t lon;
+  bool pending;
+} tile_request;
+static pthread_mutex_t prefetch_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t prefetch_cond = PTHREAD_COND_INITIALIZER;
+
+/**
+ * Open and map a tile
+ * @return false if the file is missing or invalid
+ */
+static bool tile_open(struct terrain_tile *t)
+{
+  char path[256];
+  snprintf(path, sizeof(path), "%s/%c%02d%c%03d.ter", STRINGIFY(TERRAIN_PATH), t->lat >= 0 ? 'N' : 'S', abs(t->lat),
+           t->lon >= 0 ? 'E' : 'W', abs(t->lon));
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(struct terrain_file_header)) {
+    close(fd);
+    return false;
+  }
+  void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    return false;
+  }
+
+  const struct terrain_file_header *hdr = map;
+  const size_t nb = (size_t)hdr->nb_blocks * hdr->nb_blocks;
+  if (memcmp(hdr->magic, TERRAIN_MAGIC, 4) != 0 || hdr->version != TERRAIN_VERSION
+      || hdr->block_size != TERRAIN_BLOCK_SIZE || hdr->samples < 2
+      || hdr->nb_blocks * TERRAIN_BLOCK_SIZE < hdr->samples - 1
+      || hdr->lat != t->lat || hdr->lon != t->lon
+      || sizeof(struct terrain_file_header) + (nb + 1) * sizeof(uint32_t) > (size_t)st.st_size) {
+    printf("[terrain] invalid tile %s\n", path);
+    munmap(map, st.st_size);
+    return false;
+  }
+
+  t->map = map;
+  t->size = st.st_size;
+  t->samples = hdr->samples;
+  t->nb_blocks = hdr->nb_blocks;
+  t->offsets = (const uint32_t *)(t->map + sizeof(struct terrain_file_header));
+  if (t->offsets[nb] > t->size) {
+    printf("[terrain] truncated tile %s\n", path);
+    munmap(map, st.st_size);
+    return false;
+  }
+  printf("[terrain] opened %s\n", path);
+  return true;
+}
+
+/**
+ * Find a tile in the table.
+ * The table is shared by the autopilot and prefetch threads, entries are
+ * only added by the prefetch thread and never change once added.
+ * @param last last tile of the calling thread
+ * @return the entry, or NULL if the tile was never loaded
+ */
+static struct terrain_tile *tile_find(int16_t lat, int16_t lon, struct terrain_tile **last)
+{
+  if (*last != NULL && (*last)->lat == lat && (*last)->lon == lon) {
+    return *last;
+  }
+  struct terrain_tile *t = NULL;
+  pthread_mutex_lock(&tiles_mutex);
+  for (uint8_t i = 0; i < terrain.nb_tiles; i++) {
+    if (tiles[i].lat == lat && tiles[i].lon == lon) {
+      t = &tiles[i];
+      break;
+    }
+  }
+  pthread_mutex_unlock(&tiles_mutex);
+  if (t != NULL) {
+    *last = t;
+  }
+  return t;
+}
+
+/**
+ * Get the tile of a position, opening it the first time.
+ * Only called by the prefetch thread: the file is opened and mapped
+ * outside of the lock, so the autopilot thread never waits for the storage.
+ * @return NULL if there is no tile
+ */
+static struct terrain_tile *tile_load(int16_t lat, int16_t lon)
+{
+  struct terrain_tile *t = tile_find(lat, lon, &prefetch_last_tile);
+  if (t == NULL) {
+    // only the prefetch thread adds tiles, nb_tiles can't change meanwhile
+    if (terrain.nb_tiles == TERRAIN_MAX_TILES) {
+      return NULL;
+    }
+    // also remember missing tiles, to only try to open them once
+    struct terrain_tile new_tile = { .lat = lat, .lon = lon };
+    new_tile.present = tile_open(&new_tile);
+    pthread_mutex_lock(&tiles_mutex);
+    t = &tiles[terrain.nb_tiles];
+    *t = new_tile;
+    terrain.nb_tiles++;
+    pthread_mutex_unlock(&tiles_mutex);
+    prefetch_last_tile = t;
+  }
+  return t->present ? t : NULL;
+}
+
+/**
+ * Get the tile of a position for the autopilot thread.
+ * A tile which was never loaded is requested to the prefetch thread and
+ * there is no height until it is opened.
+ * @return NULL if there is no tile or if it isn't loaded yet
+ */
+static struct terrain_tile *tile_get(int16_t lat, int16_t lon)
+{
+  struct terrain_tile *t = tile_find(lat, lon, &last_tile);
+  if (t == NULL) {
+    pthread_mutex_lock(&prefetch_mutex);
+    tile_request.lat = lat;
+    tile_request.lon = lon;
+    tile_request.pending = true;
+    pthread_cond_signal(&prefetch_cond);
+    pthread_mutex_unlock(&prefetch_mutex);
+    return NULL;
+  }
+  return t->present ? t : NULL;
+}
+
+/** Compressed data of a block */
+static const uint8_t *block_data(struct terrain_tile *t, uint16_t idx, size_t *len)
+{
+  uint32_t start = t->offsets[idx], end = t->offsets[idx + 1];
+  if (start > end || end > t->size || end - start < 4) {
+    return NULL;
+  }
+  *len = end - start;
+  return t->map + start;
+}
+
+/** Unpack a block */
+static bool block_decompress(int16_t *h, const uint8_t *data, size_t len)
+{
+  int16_t base;
+  memcpy(&base, data, sizeof(base));
+  const uint8_t bits = data[2];
+  const uint32_t n = TERRAIN_BLOCK_SIDE * TERRAIN_BLOCK_SIDE;
+  if (bits > 16 || 4 + (n * bits + 7) / 8 > len) {
+    return false;
+  }
+  if (bits == 0) {
+    for (uint32_t i = 0; i < n; i++) {
+      h[i] = base;
+    }
+    return true;
+  }
+
+  const uint8_t *p = data + 4;
+  const uint32_t mask = (1u << bits) - 1;
+  uint32_t acc = 0;
+  uint8_t acc_bits = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    while (acc_bits < bits) {
+      acc |= (uint32_t)(*p++) << acc_bits;
+      acc_bits += 8;
+    }
+    h[i] = base + (int16_t)(acc & mask);
+    acc >>= bits;
+    acc_bits -= bits;
+  }
+  return true;
+}
+
+/**
+ * Get a decompressed block from the cache, or decompress it in the least
+ * recently used slot
+ * @return NULL if the block is invalid
+ */
+static const int16_t *block_get(struct terrain_tile *t, uint16_t idx)
+{
+  const uint32_t key = ((uint32_t)(t - tiles) << 16) | idx;
+  use_counter++;
+  if (last_block != NULL && last_block->key == key) {
+    last_block->used = use_counter;
+    return last_block->h;
+  }
+
+  struct terrain_block *lru = &blocks[0];
+  for (uint16_t i = 0; i < TERRAIN_CACHE_BLOCKS; i++) {
+    if (blocks[i].key == key) {
+      blocks[i].used = use_counter;
+      last_block = &blocks[i];
+      return last_block->h;
+    }
+    if (blocks[i].used < lru->used) {
+      lru = &blocks[i];
+    }
+  }
+
+  terrain.nb_misses++;
+  size_t len;
+  const uint8_t *data = block_data(t, idx, &len);
+  if (data == NULL || !block_decompress(lru->h, data, len)) {
+    lru->key = TERRAIN_NO_BLOCK;
+    return NULL;
+  }
+  lru->key = key;
+  lru->used = use_counter;
+  last_block = lru;
+  return lru->h;
+}
+
+bool terrain_get_height(float *height, double lat, double lon)
+{
+  if (blocks == NULL) {
+    return false;
+  }
+  terrain.nb_queries++;
+
+  const double lat0 = floor(lat), lon0 = floor(lon);
+  struct terrain_tile *t = tile_get((int16_t)lat0, (int16_t)lon0);
+  if (t == NULL) {
+    return false;
+  }
+
+  // cell of the point, rows from the north edge
+  const double cells = t->samples - 1;
+  const double fy = (lat0 + 1. - lat) * cells;
+  const double fx = (lon - lon0) * cells;
+  const int iy = Min((int)fy, t->samples - 2);
+  const int ix = Min((int)fx, t->samples - 2);
+  const int by = iy / TERRAIN_BLOCK_SIZE;
+  const int bx = ix / TERRAIN_BLOCK_SIZE;
+
+  const int16_t *h = block_get(t, by * t->nb_blocks + bx);
+  if (h == NULL) {
+    return false;
+  }
+
+  // bilinear interpolation in the block
+  const int16_t *p = &h[(iy - by * TERRAIN_BLOCK_SIZE) * TERRAIN_BLOCK_SIDE + ix - bx * TERRAIN_BLOCK_SIZE];
+  const float ax = fx - ix, ay = fy - iy;
+  const float top = p[0] + ax * (p[1] - p[0]);
+  const float bottom = p[TERRAIN_BLOCK_SIDE] + ax * (p[TERRAIN_BLOCK_SIDE + 1] - p[TERRAIN_BLOCK_SIDE]);
+  *height = top + ay * (bottom - top);
+  return true;
+}
+
+bool terrain_get_height_lla_i(float *height, struct LlaCoor_i *lla)
+{
+  return terrain_get_height(height, lla->lat * 1e-7, lla->lon * 1e-7);
+}
+
+/** Current local frame
+ * @return false if it isn't set yet
+ */
+static bool frame_of_state(struct terrain_frame *f)
+{
+  if (state.ned_initialized_i || state.ned_initialized_f) {
+    f->ltp = true;
+    f->ltp_def = state.ned_origin_f;
+    return true;
+  } else if (state.utm_initialized_f) {
+    f->ltp = false;
+    f->utm_origin = state.utm_origin_f;
+    return true;
+  }
+  return false;
+}
+
+/** Position of a point of a local frame */
+static void lla_of_frame(struct LlaCoor_f *lla, struct terrain_frame *f, float x, float y)
+{
+  if (f->ltp) {
+    struct EnuCoor_f enu = { x, y, 0.f };
+    struct EcefCoor_f ecef;
+    ecef_of_enu_point_f(&ecef, &f->ltp_def, &enu);
+    lla_of_ecef_f(lla, &ecef);
+  } else {
+    struct UtmCoor_f utm = f->utm_origin;
+    utm.east += x;
+    utm.north += y;
+    lla_of_utm_f(lla, &utm);
+  }
+}
+
+bool terrain_get_height_enu(float *height, float x, float y)
+{
+  struct terrain_frame f;
+  if (!frame_of_state(&f)) {
+    return false;
+  }
+  struct LlaCoor_f lla;
+  lla_of_frame(&lla, &f, x, y);
+  return terrain_get_height(height, DegOfRad(lla.lat), DegOfRad(lla.lon));
+}
+
+float terrain_get_height_enu_or(float x, float y, float fallback)
+{
+  float h;
+  return terrain_get_height_enu(&h, x, y) ? h : fallback;
+}
+
+/*
+ * Prefetch
+ */
+
+/** Add the block of a point of the local frame to the corridor */
+static void prefetch_add(struct terrain_range *ranges, uint16_t *nb, struct terrain_frame *f,
+                         float x, float y)
+{
+  if (*nb == TERRAIN_PREFETCH_MAX_BLOCKS) {
+    return;
+  }
+  struct LlaCoor_f lla;
+  lla_of_frame(&lla, f, x, y);
+  const double lat = DegOfRad(lla.lat), lon = DegOfRad(lla.lon);
+  const double lat0 = floor(lat), lon0 = floor(lon);
+  struct terrain_tile *t = tile_load((int16_t)lat0, (int16_t)lon0);
+  if (t == NULL) {
+    return;
+  }
+  const double cells = t->samples - 1;
+  const int iy = Min((int)((lat0 + 1. - lat) * cells), t->samples - 2);
+  const int ix = Min((int)((lon - lon0) * cells), t->samples - 2);
+  const uint16_t idx = (iy / TERRAIN_BLOCK_SIZE) * t->nb_blocks + ix / TERRAIN_BLOCK_SIZE;
+
+  struct terrain_range r;
+  r.start = block_data(t, idx, &r.len);
+  if (r.start == NULL) {
+    return;
+  }
+  for (uint16_t i = 0; i < *nb; i++) {
+    if (ranges[i].start == r.start) {
+      return;
+    }
+  }
+  ranges[(*nb)++] = r;
+}
+
+/**
+ * Blocks around the segments between consecutive waypoints
+ * @return number of ranges
+ */
+static uint16_t prefetch_corridor(struct terrain_range *ranges, struct terrain_frame *f,
+                                  const struct FloatVect2 *wps)
+{
+  uint16_t nb = 0;
+
+  // waypoint 0 is a dummy waypoint
+  for (uint8_t wp = 1; wp < NB_WAYPOINT; wp++) {
+    const float x0 = wps[wp].x, y0 = wps[wp].y;
+    const uint8_t next = (wp + 1 < NB_WAYPOINT) ? wp + 1 : wp;
+    const float dx = wps[next].x - x0, dy = wps[next].y - y0;
+    const float len = sqrtf(dx * dx + dy * dy);
+    const int steps = Min((int)(len / TERRAIN_PREFETCH_STEP), 1000) + 1;
+    // unit vector across the segment
+    const float nx = len > 1.f ? -dy / len : 0.f;
+    const float ny = len > 1.f ? dx / len : 1.f;
+    for (int s = 0; s <= steps; s++) {
+      const float x = x0 + dx * s / steps, y = y0 + dy * s / steps;
+      for (float w = -TERRAIN_PREFETCH_WIDTH; w <= TERRAIN_PREFETCH_WIDTH; w += TERRAIN_PREFETCH_STEP) {
+        prefetch_add(ranges, &nb, f, x + w * nx, y + w * ny);
+      }
+    }
+  }
+  return nb;
+}
+
+/**
+ * Open the tiles requested by the autopilot thread, compute the corridor and
+ * page in its blocks, so that decompressing them later in the autopilot
+ * thread doesn't wait for the storage. Tiles are never unmapped, the ranges
+ * stay valid.
+ */
+static void *prefetch_thread(void *arg __attribute__((unused)))
+{
+  static struct terrain_range ranges[TERRAIN_PREFETCH_MAX_BLOCKS];
+  static struct FloatVect2 wps[NB_WAYPOINT];
+  struct terrain_frame frame;
+  const long page = sysconf(_SC_PAGESIZE);
+
+  rt_thread_setup_nice(TERRAIN_PREFETCH_NICE_LEVEL, RT_CPUS_IO);
+
+  while (true) {
+    pthread_mutex_lock(&prefetch_mutex);
+    while (!prefetch_pending && !tile_request.pending) {
+      pthread_cond_wait(&prefetch_cond, &prefetch_mutex);
+    }
+    const bool corridor = prefetch_pending;
+    const bool tile = tile_request.pending;
+    const int16_t lat = tile_request.lat, lon = tile_request.lon;
+    if (corridor) {
+      frame = prefetch_frame;
+      memcpy(wps, prefetch_wps, sizeof(wps));
+    }
+    prefetch_pending = false;
+    tile_request.pending = false;
+    pthread_mutex_unlock(&prefetch_mutex);
+
+    if (tile) {
+      tile_load(lat, lon);
+    }
+    if (!corridor) {
+      continue;
+    }
+
+    uint16_t nb = prefetch_corridor(ranges, &frame, wps);
+
+    for (uint16_t i = 0; i < nb; i++) {
+      uintptr_t start = (uintptr_t)ranges[i].start & ~(uintptr_t)(page - 1);
+      madvise((void *)start, (uintptr_t)ranges[i].start + ranges[i].len - start, MADV_WILLNEED);
+      for (const volatile uint8_t *p = ranges[i].start; p < ranges[i].start + ranges[i].len; p += page) {
+        (void)*p;
+      }
+    }
+    printf("[terrain] paged in %d blocks along the flight plan\n", nb);
+  }
+  return NULL;
+}
+
+void terrain_init(void)
+{
+  terrain.valid = false;
+  terrain.ground_alt = 0.f;
+  terrain.prefetch = true;
+  terrain.nb_queries = 0;
+  terrain.nb_misses = 0;
+  terrain.nb_tiles = 0;
+  last_tile = NULL;
+  prefetch_last_tile = NULL;
+  prefetch_pending = false;
+  tile_request.pending = false;
+  last_block = NULL;
+  use_counter = 0;
+
+  blocks = malloc(TERRAIN_CACHE_BLOCKS * sizeof(struct terrain_block));
+  if (blocks == NULL) {
+    printf("[terrain] could not allocate the cache\n");
+    return;
+  }
+  for (uint16_t i = 0; i < TERRAIN_CACHE_BLOCKS; i++) {
+    blocks[i].key = TERRAIN_NO_BLOCK;
+    blocks[i].used = 0;
+  }
+
+  pthread_t tid;
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  if (pthread_create(&tid, &attr, prefetch_thread, NULL) != 0) {
+    printf("[terrain] could not create the prefetch thread\n");
+  }
+  pthread_attr_destroy(&attr);
+}
+
+void terrain_periodic(void)
+{
+  if (stateIsGlobalCoordinateValid()) {
+    terrain.valid = terrain_get_height_lla_i(&terrain.ground_alt, stateGetPositionLla_i());
+  } else {
+    terrain.valid = false;
+  }
+
+  // only copy the request, the corridor is computed by the prefetch thread
+  if (terrain.prefetch) {
+    pthread_mutex_lock(&prefetch_mutex);
+    if (frame_of_state(&prefetch_frame)) {
+      for (uint8_t wp = 0; wp < NB_WAYPOINT; wp++) {
+        prefetch_wps[wp].x = WaypointX(wp);
+        prefetch_wps[wp].y = WaypointY(wp);
+      }
+      prefetch_pending = true;
+      terrain.prefetch = false;
+      pthread_cond_signal(&prefetch_cond);
+    }
+    pthread_mutex_unlock(&prefetch_mutex);
+  }
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/terrain/terrain.h
+ *
+ * Onboard terrain elevation from SRTM/DEM tiles (Linux only).
+ *
+ * Tiles of one degree are converted on the ground by
+ * sw/tools/terrain/srtm2terrain.py and copied to TERRAIN_PATH. A tile is
+ * split in blocks of TERRAIN_BLOCK_SIZE x TERRAIN_BLOCK_SIZE cells, each
+ * stored as a base height and bit-packed offsets. The files are mmapped and
+ * the last used blocks are kept decompressed in an LRU cache, so a query is
+ * a bilinear interpolation in a cached block most of the time.
+ *
+ * Heights are above mean sea level, like GetPosAlt() and GetAltRef().
+ *
+ * The blocks along the flight plan (segments between consecutive waypoints)
+ * are selected and paged in by a low priority thread once the local frame is
+ * set, and again when terrain.prefetch is set from the settings after
+ * waypoints moved. The tiles are only opened by this thread: a query in a
+ * tile which isn't opened yet returns false and requests the tile.
+ */
+
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include "std.h"
+#include "math/pprz_geodetic_int.h"
+#include "math/pprz_geodetic_float.h"
+
+/** Number of cells per block side, must match the tiles */
+#define TERRAIN_BLOCK_SIZE 64
+
+struct Terrain {
+  bool valid;               ///< ground_alt is valid at the current position
+  float ground_alt;         ///< terrain height at the current position (m above MSL)
+  bool prefetch;            ///< set to page in the flight plan corridor again
+  uint32_t nb_queries;      ///< number of height queries
+  uint32_t nb_misses;       ///< number of queries that had to decompress a block
+  uint8_t nb_tiles;         ///< number of opened tiles
+};
+
+extern struct Terrain terrain;
+
+extern void terrain_init(void);
+extern void terrain_periodic(void);
+
+/**
+ * Terrain height at a position
+ * @param[out] *height The height above mean sea level (m)
+ * @param[in] lat, lon The position (deg)
+ * @return false if no tile covers the position or if it isn't opened yet
+ */
+extern bool terrain_get_height(float *height, double lat, double lon);
+
+/**
+ * Terrain height at a position
+ * @param[out] *height The height above mean sea level (m)
+ * @param[in] *lla The position (1e7 deg)
+ * @return false if no tile covers the position or if it isn't opened yet
+ */
+extern bool terrain_get_height_lla_i(float *height, struct LlaCoor_i *lla);
+
+/**
+ * Terrain height at a position of the local frame
+ * @param[out] *height The height above mean sea level (m)
+ * @param[in] x, y The position east and north of the local origin (m)
+ * @return false if the local frame isn't set or no tile covers the position
+ */
+extern bool terrain_get_height_enu(float *height, float x, float y);
+
+/**
+ * Terrain height below the current position, falls back to the
+ * flight plan ground altitude when there is no terrain data
+ */
+#define TerrainAltRef() (terrain.valid ? terrain.ground_alt : GetAltRef())
+
+/**
+ * Terrain height at a position of the local frame, or a default value
+ * @param[in] x, y The position east and north of the local origin (m)
+ * @param[in] fallback The height returned when there is no terrain data (m)
+ * @return The height above mean sea level (m)
+ */
+extern float terrain_get_height_enu_or(float x, float y, float fallback);
+
+/**
+ * Altitude above MSL for a height above the terrain at a point of the
+ * local frame, e.g. for terrain following in the flight plan:
+ * @code
+ * <go wp="P" alt="TerrainFollowAlt(WaypointX(WP_P), WaypointY(WP_P), 50.)"/>
+ * @endcode
+ */
+#define TerrainFollowAlt(_x, _y, _h) (terrain_get_height_enu_or(_x, _y, TerrainAltRef()) + (_h))
+
+#endif /* TERRAIN_H */
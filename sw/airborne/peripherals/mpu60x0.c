@@ -79,6 +79,25 @@ void mpu60x0_set_default_config(struct Mpu60x0Config *c)
   c->i2c_bypass = false;
 }
 
+float mpu60x0_get_sample_rate(struct Mpu60x0Config *c)
+{
+  // 8kHz internal sampling without DLPF, 1kHz otherwise
+  float internal = (c->dlpf_cfg == MPU60X0_DLPF_256HZ) ? 8000.f : 1000.f;
+  return internal / (1.f + c->smplrt_div);
+}
+
+uint16_t mpu60x0_get_fifo_size(struct Mpu60x0Config *c)
+{
+  switch (c->type) {
+    case MPU60X0:
+      return 1024;
+    case ICM20602:
+      return 1008;
+    default:
+      return 512;
+  }
+}
+
 void mpu60x0_send_config(Mpu60x0ConfigSet mpu_set, void *mpu, struct Mpu60x0Config *config)
 {
   switch (config->init_status) {
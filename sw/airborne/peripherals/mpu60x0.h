@@ -162,6 +162,12 @@ struct Mpu60x0Config {
 
 extern void mpu60x0_set_default_config(struct Mpu60x0Config *c);
 
+/// Gyro output (and FIFO) sample rate in Hz of a configuration
+extern float mpu60x0_get_sample_rate(struct Mpu60x0Config *c);
+
+/// FIFO size in bytes of the sensor type
+extern uint16_t mpu60x0_get_fifo_size(struct Mpu60x0Config *c);
+
 /// Configuration sequence called once before normal use
 extern void mpu60x0_send_config(Mpu60x0ConfigSet mpu_set, void *mpu, struct Mpu60x0Config *config);
 
@@ -34,9 +34,33 @@
 
 /* Include common MPU60X0 options and definitions */
 #include "peripherals/mpu60x0.h"
+#include "peripherals/mpu_fifo.h"
 
 
+/** FIFO burst mode support, enlarges the read buffer and the driver structure.
+ * Must be the same in all the files including this header, so it is set on
+ * the command line by the IMU module (IMU FIFO configure option).
+ */
+#ifndef MPU60X0_SPI_FIFO
+#define MPU60X0_SPI_FIFO FALSE
+#endif
+
+#if MPU60X0_SPI_FIFO
+/// Max number of samples read from the FIFO in one transaction
+#ifndef MPU60X0_FIFO_MAX_SAMPLES
+#define MPU60X0_FIFO_MAX_SAMPLES 16
+#endif
+
+/// Period divider of the ext (I2C slaves) data reads in FIFO mode
+#ifndef MPU60X0_FIFO_EXT_DIV
+#define MPU60X0_FIFO_EXT_DIV 10
+#endif
+
+/// Read buffer, large enough for a register read or a FIFO burst
+#define MPU60X0_BUFFER_LEN MPU_FIFO_BUFFER_LEN(MPU60X0_FIFO_MAX_SAMPLES, 32)
+#else
 #define MPU60X0_BUFFER_LEN 32
+#endif
 #define MPU60X0_BUFFER_EXT_LEN 16
 
 enum Mpu60x0SpiSlaveInitStatus {
@@ -48,6 +72,21 @@ enum Mpu60x0SpiSlaveInitStatus {
   MPU60X0_SPI_CONF_DONE
 };
 
+/// FIFO mode status
+enum Mpu60x0SpiFifoStatus {
+  MPU60X0_SPI_FIFO_UNINIT,      ///< FIFO sources not configured
+  MPU60X0_SPI_FIFO_RESET,       ///< FIFO to be (re)started
+  MPU60X0_SPI_FIFO_RUNNING
+};
+
+/// Type of the current transaction
+enum Mpu60x0SpiRead {
+  MPU60X0_SPI_READ_REGS,        ///< registers from INT_STATUS
+  MPU60X0_SPI_READ_FIFO_COUNT,  ///< number of bytes in the FIFO
+  MPU60X0_SPI_READ_FIFO_DATA,   ///< FIFO burst
+  MPU60X0_SPI_WRITE_FIFO_CONF   ///< FIFO configuration write
+};
+
 struct Mpu60x0_Spi {
   struct spi_periph *spi_p;
   struct spi_transaction spi_trans;
@@ -66,6 +105,22 @@ struct Mpu60x0_Spi {
   uint8_t data_ext[MPU60X0_BUFFER_EXT_LEN];
   struct Mpu60x0Config config;
   enum Mpu60x0SpiSlaveInitStatus slave_init_status;
+  enum Mpu60x0SpiRead read_type;      ///< type of the current transaction
+
+#if MPU60X0_SPI_FIFO
+  /** FIFO burst mode.
+   * When enabled (before the configuration), all the samples stored by the MPU
+   * since the last read are read in a single burst and stored in fifo[].
+   * data_accel and data_rates hold the latest sample.
+   */
+  bool fifo_enable;
+  volatile bool data_ext_available;   ///< new temperature and slaves data in FIFO mode
+  enum Mpu60x0SpiFifoStatus fifo_status;
+  struct MpuFifoSample fifo[MPU60X0_FIFO_MAX_SAMPLES];
+  uint8_t fifo_nb;                    ///< number of samples in fifo[]
+  uint8_t fifo_ext_cnt;               ///< counter of ext data reads in FIFO mode
+  uint16_t fifo_overflow;             ///< FIFO overflow counter
+#endif
 };
 
 // Functions
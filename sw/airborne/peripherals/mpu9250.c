@@ -78,6 +78,13 @@ void mpu9250_set_default_config(struct Mpu9250Config *c)
   c->i2c_bypass = false;
 }
 
+float mpu9250_get_sample_rate(struct Mpu9250Config *c)
+{
+  // 8kHz internal sampling without DLPF, 1kHz otherwise
+  float internal = (c->dlpf_gyro_cfg == MPU9250_DLPF_GYRO_250HZ) ? 8000.f : 1000.f;
+  return internal / (1.f + c->smplrt_div);
+}
+
 void mpu9250_send_config(Mpu9250ConfigSet mpu_set, void *mpu, struct Mpu9250Config *config)
 {
   switch (config->init_status) {
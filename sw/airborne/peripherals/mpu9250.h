@@ -149,6 +149,12 @@ struct Mpu9250Config {
 
 extern void mpu9250_set_default_config(struct Mpu9250Config *c);
 
+/// FIFO size in bytes
+#define MPU9250_FIFO_SIZE 512
+
+/// Gyro output (and FIFO) sample rate in Hz of a configuration
+extern float mpu9250_get_sample_rate(struct Mpu9250Config *c);
+
 /// Configuration sequence called once before normal use
 extern void mpu9250_send_config(Mpu9250ConfigSet mpu_set, void *mpu, struct Mpu9250Config *config);
 
@@ -131,6 +131,13 @@
 #define MPU9250_I2C_MST_EN          5
 #define MPU9250_FIFO_EN             6
 
+// in MPU9250_REG_FIFO_EN
+#define MPU9250_ACCEL_FIFO_EN       3
+#define MPU9250_ZG_FIFO_EN          4
+#define MPU9250_YG_FIFO_EN          5
+#define MPU9250_XG_FIFO_EN          6
+#define MPU9250_TEMP_FIFO_EN        7
+
 // in MPU9250_REG_I2C_MST_STATUS
 #define MPU9250_I2C_SLV4_DONE       6
 
@@ -60,6 +60,25 @@ void mpu9250_spi_init(struct Mpu9250_Spi *mpu, struct spi_periph *spi_p, uint8_t
   mpu->config.init_status = MPU9250_CONF_UNINIT;
 
   mpu->slave_init_status = MPU9250_SPI_CONF_UNINIT;
+
+  mpu->read_type = MPU9250_SPI_READ_REGS;
+#if MPU9250_SPI_FIFO
+  mpu->fifo_enable = false;
+  mpu->data_ext_available = false;
+  mpu->fifo_status = MPU9250_SPI_FIFO_UNINIT;
+  mpu->fifo_nb = 0;
+  mpu->fifo_ext_cnt = 0;
+  mpu->fifo_overflow = 0;
+#endif
+}
+
+static inline bool mpu9250_spi_fifo_enabled(struct Mpu9250_Spi *mpu __attribute__((unused)))
+{
+#if MPU9250_SPI_FIFO
+  return mpu->fifo_enable;
+#else
+  return false;
+#endif
 }
 
 
@@ -93,9 +112,51 @@ void mpu9250_spi_start_configure(struct Mpu9250_Spi *mpu)
   }
 }
 
+#if MPU9250_SPI_FIFO
+/** select the FIFO sources, then enable and reset the FIFO */
+static void mpu9250_spi_fifo_config(struct Mpu9250_Spi *mpu)
+{
+  mpu->read_type = MPU9250_SPI_WRITE_FIFO_CONF;
+  if (mpu->fifo_status == MPU9250_SPI_FIFO_UNINIT) {
+    mpu->fifo_status = MPU9250_SPI_FIFO_RESET;
+    mpu9250_spi_write_to_reg(mpu, MPU9250_REG_FIFO_EN, ((1 << MPU9250_XG_FIFO_EN) |
+                             (1 << MPU9250_YG_FIFO_EN) |
+                             (1 << MPU9250_ZG_FIFO_EN) |
+                             (1 << MPU9250_ACCEL_FIFO_EN)));
+  } else {
+    // keep the internal I2C master running if slaves are used
+    uint8_t user_ctrl = (1 << MPU9250_FIFO_EN) | (1 << MPU9250_FIFO_RESET);
+    if (mpu->config.nb_slaves > 0) {
+      user_ctrl |= (1 << MPU9250_I2C_IF_DIS) | (1 << MPU9250_I2C_MST_EN);
+    }
+    mpu->fifo_status = MPU9250_SPI_FIFO_RUNNING;
+    mpu9250_spi_write_to_reg(mpu, MPU9250_REG_USER_CTRL, user_ctrl);
+  }
+}
+#endif
+
 void mpu9250_spi_read(struct Mpu9250_Spi *mpu)
 {
   if (mpu->config.initialized && mpu->spi_trans.status == SPITransDone) {
+#if MPU9250_SPI_FIFO
+    if (mpu->fifo_enable) {
+      if (mpu->fifo_status != MPU9250_SPI_FIFO_RUNNING) {
+        mpu9250_spi_fifo_config(mpu);
+        return;
+      }
+      // slaves data are not in the FIFO, read the registers from time to time
+      if (mpu->config.nb_slaves == 0 || ++mpu->fifo_ext_cnt < MPU9250_FIFO_EXT_DIV) {
+        mpu->read_type = MPU9250_SPI_READ_FIFO_COUNT;
+        mpu->spi_trans.output_length = 1;
+        mpu->spi_trans.input_length = 3;
+        mpu->tx_buf[0] = MPU9250_REG_FIFO_COUNT_H | MPU9250_SPI_READ;
+        spi_submit(mpu->spi_p, &(mpu->spi_trans));
+        return;
+      }
+      mpu->fifo_ext_cnt = 0;
+    }
+#endif
+    mpu->read_type = MPU9250_SPI_READ_REGS;
     mpu->spi_trans.output_length = 1;
     mpu->spi_trans.input_length = 1 + mpu->config.nb_bytes;
     /* set read bit and multiple byte bit, then address */
@@ -106,34 +167,107 @@ void mpu9250_spi_read(struct Mpu9250_Spi *mpu)
 
 #define Int16FromBuf(_buf,_idx) ((int16_t)((_buf[_idx]<<8) | _buf[_idx+1]))
 
+#if MPU9250_SPI_FIFO
+/** FIFO count received, start the burst read of the complete samples
+ * @return true if a read was started
+ */
+static bool mpu9250_spi_fifo_count(struct Mpu9250_Spi *mpu)
+{
+  uint16_t count = (uint16_t)((mpu->rx_buf[1] << 8) | mpu->rx_buf[2]);
+  int nb = mpu_fifo_nb_samples(count, MPU9250_FIFO_SIZE, MPU9250_FIFO_MAX_SAMPLES);
+  if (nb < 0) {
+    mpu->fifo_overflow++;
+    mpu->fifo_status = MPU9250_SPI_FIFO_RESET;
+    return false;
+  }
+  if (nb == 0) {
+    return false;
+  }
+  mpu->read_type = MPU9250_SPI_READ_FIFO_DATA;
+  mpu->spi_trans.output_length = 1;
+  mpu->spi_trans.input_length = 1 + nb * MPU_FIFO_SAMPLE_LEN;
+  mpu->tx_buf[0] = MPU9250_REG_FIFO_R_W | MPU9250_SPI_READ;
+  spi_submit(mpu->spi_p, &(mpu->spi_trans));
+  return true;
+}
+
+/** FIFO burst received */
+static void mpu9250_spi_fifo_data(struct Mpu9250_Spi *mpu)
+{
+  mpu->fifo_nb = (mpu->spi_trans.input_length - 1) / MPU_FIFO_SAMPLE_LEN;
+  mpu_fifo_unpack(mpu->fifo, &mpu->rx_buf[1], mpu->fifo_nb, mpu->data_accel.value, mpu->data_rates.value);
+  if (mpu->fifo_nb > 0) {
+    mpu->data_available = true;
+  }
+}
+#endif
+
+/** registers read from INT_STATUS */
+static void mpu9250_spi_regs_data(struct Mpu9250_Spi *mpu)
+{
+  // in FIFO mode, only slaves data are used
+  bool fifo = mpu9250_spi_fifo_enabled(mpu);
+  if (!bit_is_set(mpu->rx_buf[1], 0) && !fifo) {
+    return;
+  }
+  if (!fifo) {
+    // new data
+    mpu->data_accel.vect.x = Int16FromBuf(mpu->rx_buf, 2);
+    mpu->data_accel.vect.y = Int16FromBuf(mpu->rx_buf, 4);
+    mpu->data_accel.vect.z = Int16FromBuf(mpu->rx_buf, 6);
+    mpu->data_rates.rates.p = Int16FromBuf(mpu->rx_buf, 10);
+    mpu->data_rates.rates.q = Int16FromBuf(mpu->rx_buf, 12);
+    mpu->data_rates.rates.r = Int16FromBuf(mpu->rx_buf, 14);
+  }
+
+  // if we are reading slaves, copy the ext_sens_data
+  if (mpu->config.nb_slaves > 0) {
+    /* the buffer is volatile, since filled from ISR
+     * but we know it's ok to use it here so we silence the warning
+     */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-qual"
+    memcpy(mpu->data_ext, (uint8_t *) & (mpu->rx_buf[16]), mpu->config.nb_bytes - 15);
+#pragma GCC diagnostic pop
+  }
+
+#if MPU9250_SPI_FIFO
+  if (fifo) {
+    mpu->data_ext_available = true;
+    return;
+  }
+#endif
+  mpu->data_available = true;
+}
+
 void mpu9250_spi_event(struct Mpu9250_Spi *mpu)
 {
   if (mpu->config.initialized) {
     if (mpu->spi_trans.status == SPITransFailed) {
+#if MPU9250_SPI_FIFO
+      if (mpu->read_type == MPU9250_SPI_WRITE_FIFO_CONF) {
+        mpu->fifo_status = MPU9250_SPI_FIFO_UNINIT;
+      }
+#endif
       mpu->spi_trans.status = SPITransDone;
     } else if (mpu->spi_trans.status == SPITransSuccess) {
       // Successfull reading
-      if (bit_is_set(mpu->rx_buf[1], 0)) {
-        // new data
-        mpu->data_accel.vect.x = Int16FromBuf(mpu->rx_buf, 2);
-        mpu->data_accel.vect.y = Int16FromBuf(mpu->rx_buf, 4);
-        mpu->data_accel.vect.z = Int16FromBuf(mpu->rx_buf, 6);
-        mpu->data_rates.rates.p = Int16FromBuf(mpu->rx_buf, 10);
-        mpu->data_rates.rates.q = Int16FromBuf(mpu->rx_buf, 12);
-        mpu->data_rates.rates.r = Int16FromBuf(mpu->rx_buf, 14);
-
-        // if we are reading slaves, copy the ext_sens_data
-        if (mpu->config.nb_slaves > 0) {
-          /* the buffer is volatile, since filled from ISR
-           * but we know it's ok to use it here so we silence the warning
-           */
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wcast-qual"
-          memcpy(mpu->data_ext, (uint8_t *) & (mpu->rx_buf[16]), mpu->config.nb_bytes - 15);
-#pragma GCC diagnostic pop
-        }
-
-        mpu->data_available = true;
+      switch (mpu->read_type) {
+        case MPU9250_SPI_READ_REGS:
+          mpu9250_spi_regs_data(mpu);
+          break;
+#if MPU9250_SPI_FIFO
+        case MPU9250_SPI_READ_FIFO_COUNT:
+          if (mpu9250_spi_fifo_count(mpu)) {
+            return; // burst read started
+          }
+          break;
+        case MPU9250_SPI_READ_FIFO_DATA:
+          mpu9250_spi_fifo_data(mpu);
+          break;
+#endif
+        default:
+          break;
       }
       mpu->spi_trans.status = SPITransDone;
     }
@@ -34,9 +34,33 @@
 
 /* Include common MPU9250 options and definitions */
 #include "peripherals/mpu9250.h"
+#include "peripherals/mpu_fifo.h"
 
 
+/** FIFO burst mode support, enlarges the read buffer and the driver structure.
+ * Must be the same in all the files including this header, so it is set on
+ * the command line by the IMU module (IMU FIFO configure option).
+ */
+#ifndef MPU9250_SPI_FIFO
+#define MPU9250_SPI_FIFO FALSE
+#endif
+
+#if MPU9250_SPI_FIFO
+/// Max number of samples read from the FIFO in one transaction
+#ifndef MPU9250_FIFO_MAX_SAMPLES
+#define MPU9250_FIFO_MAX_SAMPLES 16
+#endif
+
+/// Period divider of the ext (I2C slaves) data reads in FIFO mode
+#ifndef MPU9250_FIFO_EXT_DIV
+#define MPU9250_FIFO_EXT_DIV 10
+#endif
+
+/// Read buffer, large enough for a register read or a FIFO burst
+#define MPU9250_BUFFER_LEN MPU_FIFO_BUFFER_LEN(MPU9250_FIFO_MAX_SAMPLES, 32)
+#else
 #define MPU9250_BUFFER_LEN 32
+#endif
 #define MPU9250_BUFFER_EXT_LEN 16
 
 enum Mpu9250SpiSlaveInitStatus {
@@ -48,6 +72,21 @@ enum Mpu9250SpiSlaveInitStatus {
   MPU9250_SPI_CONF_DONE
 };
 
+/// FIFO mode status
+enum Mpu9250SpiFifoStatus {
+  MPU9250_SPI_FIFO_UNINIT,      ///< FIFO sources not configured
+  MPU9250_SPI_FIFO_RESET,       ///< FIFO to be (re)started
+  MPU9250_SPI_FIFO_RUNNING
+};
+
+/// Type of the current transaction
+enum Mpu9250SpiRead {
+  MPU9250_SPI_READ_REGS,        ///< registers from INT_STATUS
+  MPU9250_SPI_READ_FIFO_COUNT,  ///< number of bytes in the FIFO
+  MPU9250_SPI_READ_FIFO_DATA,   ///< FIFO burst
+  MPU9250_SPI_WRITE_FIFO_CONF   ///< FIFO configuration write
+};
+
 struct Mpu9250_Spi {
   struct spi_periph *spi_p;
   struct spi_transaction spi_trans;
@@ -65,6 +104,22 @@ struct Mpu9250_Spi {
   uint8_t data_ext[MPU9250_BUFFER_EXT_LEN];
   struct Mpu9250Config config;
   enum Mpu9250SpiSlaveInitStatus slave_init_status;
+  enum Mpu9250SpiRead read_type;      ///< type of the current transaction
+
+#if MPU9250_SPI_FIFO
+  /** FIFO burst mode.
+   * When enabled (before the configuration), all the samples stored by the MPU
+   * since the last read are read in a single burst and stored in fifo[].
+   * data_accel and data_rates hold the latest sample.
+   */
+  bool fifo_enable;
+  volatile bool data_ext_available;   ///< new slaves data in FIFO mode
+  enum Mpu9250SpiFifoStatus fifo_status;
+  struct MpuFifoSample fifo[MPU9250_FIFO_MAX_SAMPLES];
+  uint8_t fifo_nb;                    ///< number of samples in fifo[]
+  uint8_t fifo_ext_cnt;               ///< counter of ext data reads in FIFO mode
+  uint16_t fifo_overflow;             ///< FIFO overflow counter
+#endif
 };
 
 // Functions
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file peripherals/mpu_fifo.h
+ *
+ * FIFO burst helpers shared by the MPU-60X0 and MPU-9250 SPI drivers.
+ * Both store accel then gyro samples (3 axis, 16 bits big endian) when
+ * only these sources are enabled in FIFO_EN.
+ */
+
+#ifndef MPU_FIFO_H
+#define MPU_FIFO_H
+
+#include "std.h"
+
+/// Bytes of a FIFO sample (accel and gyro, 3 axis, 16 bits each)
+#define MPU_FIFO_SAMPLE_LEN 12
+
+/// Read buffer for a burst of _nb samples, at least _min bytes (register reads)
+#define MPU_FIFO_BUFFER_LEN(_nb, _min) \
+  ((1 + (_nb) * MPU_FIFO_SAMPLE_LEN) > (_min) ? (1 + (_nb) * MPU_FIFO_SAMPLE_LEN) : (_min))
+
+/// One FIFO sample, values accessible by channel index
+struct MpuFifoSample {
+  int16_t accel[3];
+  int16_t rates[3];
+};
+
+/** Number of complete samples to read from the FIFO byte count
+ * @param count FIFO_COUNT register value
+ * @param fifo_size FIFO size in bytes
+ * @param max_nb max number of samples read in one burst
+ * @return -1 if the FIFO is (nearly) full, samples were lost and the
+ *         sample boundary is unknown so it must be reset,
+ *         else the number of samples of the next burst (at most max_nb,
+ *         the others are read next time)
+ */
+static inline int mpu_fifo_nb_samples(uint16_t count, uint16_t fifo_size, uint16_t max_nb)
+{
+  if (count >= fifo_size - MPU_FIFO_SAMPLE_LEN) {
+    return -1;
+  }
+  uint16_t nb = count / MPU_FIFO_SAMPLE_LEN;
+  return nb > max_nb ? max_nb : nb;
+}
+
+/** Unpack a FIFO burst
+ * @param samples output samples, oldest first
+ * @param buf burst data (after the register address byte)
+ * @param nb number of samples in buf
+ * @param accel latest accel sample, unchanged if nb is 0
+ * @param rates latest gyro sample, unchanged if nb is 0
+ */
+static inline void mpu_fifo_unpack(struct MpuFifoSample *samples, volatile uint8_t *buf, uint8_t nb,
+                                   int16_t accel[3], int16_t rates[3])
+{
+  for (uint8_t i = 0; i < nb; i++) {
+    volatile uint8_t *b = &buf[i * MPU_FIFO_SAMPLE_LEN];
+    for (uint8_t j = 0; j < 3; j++) {
+      samples[i].accel[j] = (int16_t)((b[2 * j] << 8) | b[2 * j + 1]);
+      samples[i].rates[j] = (int16_t)((b[6 + 2 * j] << 8) | b[6 + 2 * j + 1]);
+    }
+  }
+  if (nb > 0) {
+    for (uint8_t j = 0; j < 3; j++) {
+      accel[j] = samples[nb - 1].accel[j];
+      rates[j] = samples[nb - 1].rates[j];
+    }
+  }
+}
+
+#endif /* MPU_FIFO_H */
@@ -29,6 +29,7 @@
 #include <stdbool.h>
 #include <inttypes.h>
 #include "modules/computer_vision/lib/vision/image.h"
+#include "modules/computer_vision/cv_stats.h"
 
 /* Different video filters */
 #define VIDEO_FILTER_DEBAYER  (0x1 << 0)  ///<Enable software debayer
@@ -38,6 +39,8 @@
 struct video_thread_t {
   volatile bool is_running;       ///< When the device is running
   struct v4l2_device *dev;        ///< The V4L2 device that is used for the video stream
+  struct cv_device_stats stats;   ///< Frame and latency statistics
+  struct cv_device_stats stats_last; ///< Statistics at the previous report
 };
 
 // camera intrinsics: capture lens properties that determine how world points are projected to image points
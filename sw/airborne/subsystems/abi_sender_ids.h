@@ -352,6 +352,11 @@
 #define IMU_F1E_ID 30
 #endif
 
+// prefiltering with RPM tracking notch filters
+#ifndef IMU_RPM_NOTCH_ID
+#define IMU_RPM_NOTCH_ID 31
+#endif
+
 /*
  * IDs of OPTICFLOW estimates (message 11)
  */
@@ -504,6 +509,10 @@
 #define COLOR_OBJECT_DETECTION2_ID 2
 #endif
 
+#ifndef COLOR_SEGMENTATION_ID
+#define COLOR_SEGMENTATION_ID 3
+#endif
+
 /*
  * JOYSTICK message (used for payload or control, but not as a RC)
  */
@@ -511,4 +520,11 @@
 #define JOYSTICK_ID 1
 #endif
 
+/*
+ * IDs of VIBRATION_PEAKS messages
+ */
+#ifndef IMU_VIBRATION_SPECTRUM_ID
+#define IMU_VIBRATION_SPECTRUM_ID 1
+#endif
+
 #endif /* ABI_SENDER_IDS_H */
@@ -127,8 +127,19 @@ PRINT_CONFIG_VAR(AHRS_FC_MAG_ID)
 #define AHRS_FC_GPS_ID GPS_MULTI_ID
 #endif
 PRINT_CONFIG_VAR(AHRS_FC_GPS_ID)
+/** Propagate from the IMU_BATCH_INT32 messages of IMUs reading a FIFO
+ * (coning corrected delta angle of the batch) instead of the latest gyro sample,
+ * and correct with the mean specific force of the batch (sculling corrected
+ * delta velocity) instead of the latest accel sample.
+ */
+#ifndef AHRS_FC_USE_IMU_BATCH
+#define AHRS_FC_USE_IMU_BATCH FALSE
+#endif
+PRINT_CONFIG_VAR(AHRS_FC_USE_IMU_BATCH)
 static abi_event gyro_ev;
+#if !AHRS_FC_USE_IMU_BATCH
 static abi_event accel_ev;
+#endif
 static abi_event mag_ev;
 static abi_event aligner_ev;
 static abi_event body_to_imu_ev;
@@ -136,6 +147,44 @@ static abi_event geo_mag_ev;
 static abi_event gps_ev;
 
 
+#if AHRS_FC_USE_IMU_BATCH
+#include "subsystems/imu/imu_batch.h"
+
+/** The batch gives the actual integration time (nb * dt), it is used in
+ * place of the gyro and accel stamps or of the fixed AHRS_PROPAGATE_FREQUENCY
+ * and AHRS_CORRECT_FREQUENCY of gyro_cb and accel_cb.
+ */
+static void imu_batch_cb(uint8_t __attribute__((unused)) sender_id,
+                         uint32_t stamp, struct Int32Rates *gyro, struct Int32Vect3 *accel,
+                         uint8_t nb, float dt)
+{
+  ahrs_fc_last_stamp = stamp;
+  if (nb == 0 || dt <= 0.f) {
+    return;
+  }
+  struct FloatVect3 delta_angle, delta_vel;
+  imu_batch_integrate(gyro, accel, nb, dt, &delta_angle, &delta_vel);
+  // equivalent constant rate and specific force over the batch
+  const float dt_batch = nb * dt;
+  struct FloatRates gyro_f = {
+    delta_angle.x / dt_batch,
+    delta_angle.y / dt_batch,
+    delta_angle.z / dt_batch
+  };
+  struct FloatVect3 accel_f;
+  VECT3_SDIV(accel_f, delta_vel, dt_batch);
+
+#if USE_AUTO_AHRS_FREQ || !defined(AHRS_PROPAGATE_FREQUENCY)
+  if (ahrs_fc.is_aligned) {
+#else
+  if (ahrs_fc.status == AHRS_FC_RUNNING) {
+#endif
+    ahrs_fc_propagate(&gyro_f, dt_batch);
+    ahrs_fc_update_accel(&accel_f, dt_batch);
+    compute_body_orientation_and_rates();
+  }
+}
+#else
 static void gyro_cb(uint8_t __attribute__((unused)) sender_id,
                     uint32_t stamp, struct Int32Rates *gyro)
 {
@@ -164,7 +213,9 @@ static void gyro_cb(uint8_t __attribute__((unused)) sender_id,
   }
 #endif
 }
+#endif
 
+#if !AHRS_FC_USE_IMU_BATCH
 static void accel_cb(uint8_t __attribute__((unused)) sender_id,
                      uint32_t __attribute__((unused)) stamp,
                      struct Int32Vect3 *accel)
@@ -189,6 +240,7 @@ static void accel_cb(uint8_t __attribute__((unused)) sender_id,
   }
 #endif
 }
+#endif
 
 static void mag_cb(uint8_t __attribute__((unused)) sender_id,
                    uint32_t __attribute__((unused)) stamp,
@@ -289,8 +341,12 @@ void ahrs_fc_register(void)
   /*
    * Subscribe to scaled IMU measurements and attach callbacks
    */
+#if AHRS_FC_USE_IMU_BATCH
+  AbiBindMsgIMU_BATCH_INT32(AHRS_FC_IMU_ID, &gyro_ev, imu_batch_cb);
+#else
   AbiBindMsgIMU_GYRO_INT32(AHRS_FC_IMU_ID, &gyro_ev, gyro_cb);
   AbiBindMsgIMU_ACCEL_INT32(AHRS_FC_IMU_ID, &accel_ev, accel_cb);
+#endif
   AbiBindMsgIMU_MAG_INT32(AHRS_FC_MAG_ID, &mag_ev, mag_cb);
   AbiBindMsgIMU_LOWPASSED(ABI_BROADCAST, &aligner_ev, aligner_cb);
   AbiBindMsgBODY_TO_IMU_QUAT(ABI_BROADCAST, &body_to_imu_ev, body_to_imu_cb);
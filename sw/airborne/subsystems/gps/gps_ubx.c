@@ -105,7 +105,24 @@ void gps_ubx_init(void)
   gps_ubx.state.comp_id = GPS_UBX_ID;
 }
 
-void gps_ubx_event(void)
+/** Read a uart link directly in its receive buffer */
+static void __attribute__((unused)) gps_ubx_read_uart(struct uart_periph *p)
+{
+  uint8_t *data;
+  uint16_t len;
+  while ((len = uart_rx_span(p, &data)) > 0) {
+    for (uint16_t i = 0; i < len; i++) {
+      gps_ubx_parse(data[i]);
+      if (gps_ubx.msg_available) {
+        gps_ubx_msg();
+      }
+    }
+    uart_rx_consume(p, len);
+  }
+}
+
+/** Read any other link byte by byte */
+static void __attribute__((unused)) gps_ubx_read_device(void *periph __attribute__((unused)))
 {
   struct link_device *dev = &((UBX_GPS_LINK).device);
 
@@ -117,6 +134,13 @@ void gps_ubx_event(void)
   }
 }
 
+void gps_ubx_event(void)
+{
+  _Generic(&(UBX_GPS_LINK),
+           struct uart_periph *: gps_ubx_read_uart,
+           default: gps_ubx_read_device)(&(UBX_GPS_LINK));
+}
+
 static void gps_ubx_parse_nav_pvt(void)
 {
   uint8_t flags             = UBX_NAV_PVT_flags(gps_ubx.msg_buf);
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file subsystems/imu/imu_batch.h
+ *
+ * Integration of a burst of IMU samples (IMU_BATCH_INT32 ABI message).
+ *
+ * The samples of a batch are integrated into a delta angle and a delta
+ * velocity over the batch duration, with the usual coning and sculling
+ * corrections (recursive form, e.g. Savage, Strapdown Inertial Navigation
+ * Integration Algorithm Design). Filters running slower than the sensor can
+ * then propagate once per batch with the equivalent rate and acceleration
+ * instead of using only the latest sample.
+ */
+
+#ifndef IMU_BATCH_H
+#define IMU_BATCH_H
+
+#include "std.h"
+#include "math/pprz_algebra_int.h"
+#include "math/pprz_algebra_float.h"
+
+/**
+ * Integrate a batch of samples.
+ * @param gyro nb gyro samples (oldest first)
+ * @param accel nb accel samples (oldest first)
+ * @param nb number of samples
+ * @param dt sampling period in seconds
+ * @param delta_angle output rotation vector over the batch in the frame of the first sample (rad)
+ * @param delta_vel output velocity increment over the batch in the frame of the first sample (m/s)
+ */
+static inline void imu_batch_integrate(struct Int32Rates *gyro, struct Int32Vect3 *accel, uint8_t nb, float dt,
+                                       struct FloatVect3 *delta_angle, struct FloatVect3 *delta_vel)
+{
+  struct FloatVect3 alpha = { 0.f, 0.f, 0.f };   // sum of the angle increments
+  struct FloatVect3 beta = { 0.f, 0.f, 0.f };    // coning correction
+  struct FloatVect3 nu = { 0.f, 0.f, 0.f };      // sum of the velocity increments
+  struct FloatVect3 scul = { 0.f, 0.f, 0.f };    // sculling correction
+  struct FloatVect3 tmp1, tmp2;
+
+  for (uint8_t i = 0; i < nb; i++) {
+    struct FloatVect3 da = {
+      RATE_FLOAT_OF_BFP(gyro[i].p) * dt,
+      RATE_FLOAT_OF_BFP(gyro[i].q) * dt,
+      RATE_FLOAT_OF_BFP(gyro[i].r) * dt
+    };
+    struct FloatVect3 dv = {
+      ACCEL_FLOAT_OF_BFP(accel[i].x) * dt,
+      ACCEL_FLOAT_OF_BFP(accel[i].y) * dt,
+      ACCEL_FLOAT_OF_BFP(accel[i].z) * dt
+    };
+    // coning: 1/2 alpha_{k-1} x da_k
+    VECT3_CROSS_PRODUCT(tmp1, alpha, da);
+    VECT3_ADD_SCALED(beta, tmp1, 0.5f);
+    // sculling: 1/2 (alpha_{k-1} x dv_k + nu_{k-1} x da_k)
+    VECT3_CROSS_PRODUCT(tmp1, alpha, dv);
+    VECT3_CROSS_PRODUCT(tmp2, nu, da);
+    VECT3_ADD(tmp1, tmp2);
+    VECT3_ADD_SCALED(scul, tmp1, 0.5f);
+
+    VECT3_ADD(alpha, da);
+    VECT3_ADD(nu, dv);
+  }
+
+  VECT3_SUM(*delta_angle, alpha, beta);
+  // rotation compensation 1/2 alpha x nu
+  VECT3_CROSS_PRODUCT(tmp1, alpha, nu);
+  VECT3_SUM(*delta_vel, nu, scul);
+  VECT3_ADD_SCALED(*delta_vel, tmp1, 0.5f);
+}
+
+#endif /* IMU_BATCH_H */
@@ -102,6 +102,15 @@ PRINT_CONFIG_VAR(IMU_MPU_Y_SIGN)
 #endif
 PRINT_CONFIG_VAR(IMU_MPU_Z_SIGN)
 
+/** Read all the samples from the MPU FIFO and publish them with IMU_BATCH_INT32 */
+#ifndef IMU_MPU_FIFO
+#define IMU_MPU_FIFO FALSE
+#endif
+PRINT_CONFIG_VAR(IMU_MPU_FIFO)
+#if IMU_MPU_FIFO && !MPU60X0_SPI_FIFO
+#error "IMU_MPU_FIFO needs the FIFO support of the driver, set IMU_MPU_FIFO as a configure option"
+#endif
+
 
 struct ImuMpu6000 imu_mpu_spi;
 
@@ -114,6 +123,9 @@ void imu_mpu_spi_init(void)
   imu_mpu_spi.mpu.config.dlpf_cfg_acc = IMU_MPU_ACCEL_LOWPASS_FILTER; // only for ICM sensors
   imu_mpu_spi.mpu.config.gyro_range = IMU_MPU_GYRO_RANGE;
   imu_mpu_spi.mpu.config.accel_range = IMU_MPU_ACCEL_RANGE;
+#if IMU_MPU_FIFO
+  imu_mpu_spi.mpu.fifo_enable = TRUE;
+#endif
 }
 
 
@@ -122,12 +134,44 @@ void imu_mpu_spi_periodic(void)
   mpu60x0_spi_periodic(&imu_mpu_spi.mpu);
 }
 
+#if IMU_MPU_FIFO
+/** scale the samples of the FIFO burst and send them as a batch,
+ * imu.gyro and imu.accel are left with the latest sample
+ */
+static void imu_mpu_spi_send_batch(uint32_t now_ts)
+{
+  static struct Int32Rates gyro[MPU60X0_FIFO_MAX_SAMPLES];
+  static struct Int32Vect3 accel[MPU60X0_FIFO_MAX_SAMPLES];
+  uint8_t nb = imu_mpu_spi.mpu.fifo_nb;
+
+  for (uint8_t i = 0; i < nb; i++) {
+    struct MpuFifoSample *s = &imu_mpu_spi.mpu.fifo[i];
+    imu.accel_unscaled.x = IMU_MPU_X_SIGN * (int32_t)(s->accel[IMU_MPU_CHAN_X]);
+    imu.accel_unscaled.y = IMU_MPU_Y_SIGN * (int32_t)(s->accel[IMU_MPU_CHAN_Y]);
+    imu.accel_unscaled.z = IMU_MPU_Z_SIGN * (int32_t)(s->accel[IMU_MPU_CHAN_Z]);
+    imu.gyro_unscaled.p = IMU_MPU_X_SIGN * (int32_t)(s->rates[IMU_MPU_CHAN_X]);
+    imu.gyro_unscaled.q = IMU_MPU_Y_SIGN * (int32_t)(s->rates[IMU_MPU_CHAN_Y]);
+    imu.gyro_unscaled.r = IMU_MPU_Z_SIGN * (int32_t)(s->rates[IMU_MPU_CHAN_Z]);
+    imu_scale_gyro(&imu);
+    imu_scale_accel(&imu);
+    RATES_COPY(gyro[i], imu.gyro);
+    VECT3_COPY(accel[i], imu.accel);
+  }
+  float dt = 1.f / mpu60x0_get_sample_rate(&imu_mpu_spi.mpu.config);
+  AbiSendMsgIMU_BATCH_INT32(IMU_MPU6000_ID, now_ts, gyro, accel, nb, dt);
+}
+#endif
+
 void imu_mpu_spi_event(void)
 {
   mpu60x0_spi_event(&imu_mpu_spi.mpu);
   if (imu_mpu_spi.mpu.data_available) {
     uint32_t now_ts = get_sys_time_usec();
+    imu_mpu_spi.mpu.data_available = false;
 
+#if IMU_MPU_FIFO
+    imu_mpu_spi_send_batch(now_ts);
+#else
     // set channel order
     struct Int32Vect3 accel = {
       IMU_MPU_X_SIGN * (int32_t)(imu_mpu_spi.mpu.data_accel.value[IMU_MPU_CHAN_X]),
@@ -143,11 +187,10 @@ void imu_mpu_spi_event(void)
     VECT3_COPY(imu.accel_unscaled, accel);
     RATES_COPY(imu.gyro_unscaled, rates);
 
-    imu_mpu_spi.mpu.data_available = false;
-
     // Scale the gyro and accelerometer
     imu_scale_gyro(&imu);
     imu_scale_accel(&imu);
+#endif
 
     // Send the scaled values over ABI
     AbiSendMsgIMU_GYRO_INT32(IMU_MPU6000_ID, now_ts, &imu.gyro);
@@ -101,6 +101,15 @@ PRINT_CONFIG_VAR(IMU_MPU9250_Z_SIGN)
 #define IMU_MPU9250_READ_MAG TRUE
 #endif
 
+/** Read all the samples from the MPU FIFO and publish them with IMU_BATCH_INT32 */
+#ifndef IMU_MPU9250_FIFO
+#define IMU_MPU9250_FIFO FALSE
+#endif
+PRINT_CONFIG_VAR(IMU_MPU9250_FIFO)
+#if IMU_MPU9250_FIFO && !MPU9250_SPI_FIFO
+#error "IMU_MPU9250_FIFO needs the FIFO support of the driver, set IMU_MPU9250_FIFO as a configure option"
+#endif
+
 #ifndef IMU_MPU9250_MAG_STARTUP_DELAY
 #define IMU_MPU9250_MAG_STARTUP_DELAY 1
 #endif
@@ -121,7 +130,9 @@ void imu_mpu9250_init(void)
   imu_mpu9250.mpu.config.dlpf_accel_cfg = IMU_MPU9250_ACCEL_LOWPASS_FILTER;
   imu_mpu9250.mpu.config.gyro_range = IMU_MPU9250_GYRO_RANGE;
   imu_mpu9250.mpu.config.accel_range = IMU_MPU9250_ACCEL_RANGE;
-
+#if IMU_MPU9250_FIFO
+  imu_mpu9250.mpu.fifo_enable = TRUE;
+#endif
 
   /* "internal" ak8963 magnetometer as I2C slave */
 #if IMU_MPU9250_READ_MAG
@@ -164,6 +175,51 @@ void imu_mpu9250_periodic(void)
 }
 
 #define Int16FromBuf(_buf,_idx) ((int16_t)(_buf[_idx] | (_buf[_idx+1] << 8)))
+
+#if IMU_MPU9250_READ_MAG
+static void imu_mpu9250_send_mag(uint32_t now_ts)
+{
+  if (!bit_is_set(imu_mpu9250.mpu.data_ext[6], 3)) { //mag valid just HOFL == 0
+    /** FIXME: assumes that we get new mag data each time instead of reading drdy bit */
+    struct Int32Vect3 mag;
+    mag.x =  (IMU_MPU9250_X_SIGN) * Int16FromBuf(imu_mpu9250.mpu.data_ext, 2 * IMU_MPU9250_CHAN_Y);
+    mag.y =  (IMU_MPU9250_Y_SIGN) * Int16FromBuf(imu_mpu9250.mpu.data_ext, 2 * IMU_MPU9250_CHAN_X);
+    mag.z = -(IMU_MPU9250_Z_SIGN) * Int16FromBuf(imu_mpu9250.mpu.data_ext, 2 * IMU_MPU9250_CHAN_Z);
+    VECT3_COPY(imu.mag_unscaled, mag);
+    imu_scale_mag(&imu);
+    AbiSendMsgIMU_MAG_INT32(IMU_MPU9250_ID, now_ts, &imu.mag);
+  }
+}
+#endif
+
+#if IMU_MPU9250_FIFO
+/** scale the samples of the FIFO burst and send them as a batch,
+ * imu.gyro and imu.accel are left with the latest sample
+ */
+static void imu_mpu9250_send_batch(uint32_t now_ts)
+{
+  static struct Int32Rates gyro[MPU9250_FIFO_MAX_SAMPLES];
+  static struct Int32Vect3 accel[MPU9250_FIFO_MAX_SAMPLES];
+  uint8_t nb = imu_mpu9250.mpu.fifo_nb;
+
+  for (uint8_t i = 0; i < nb; i++) {
+    struct MpuFifoSample *s = &imu_mpu9250.mpu.fifo[i];
+    imu.accel_unscaled.x = IMU_MPU9250_X_SIGN * (int32_t)(s->accel[IMU_MPU9250_CHAN_X]);
+    imu.accel_unscaled.y = IMU_MPU9250_Y_SIGN * (int32_t)(s->accel[IMU_MPU9250_CHAN_Y]);
+    imu.accel_unscaled.z = IMU_MPU9250_Z_SIGN * (int32_t)(s->accel[IMU_MPU9250_CHAN_Z]);
+    imu.gyro_unscaled.p = IMU_MPU9250_X_SIGN * (int32_t)(s->rates[IMU_MPU9250_CHAN_X]);
+    imu.gyro_unscaled.q = IMU_MPU9250_Y_SIGN * (int32_t)(s->rates[IMU_MPU9250_CHAN_Y]);
+    imu.gyro_unscaled.r = IMU_MPU9250_Z_SIGN * (int32_t)(s->rates[IMU_MPU9250_CHAN_Z]);
+    imu_scale_gyro(&imu);
+    imu_scale_accel(&imu);
+    RATES_COPY(gyro[i], imu.gyro);
+    VECT3_COPY(accel[i], imu.accel);
+  }
+  float dt = 1.f / mpu9250_get_sample_rate(&imu_mpu9250.mpu.config);
+  AbiSendMsgIMU_BATCH_INT32(IMU_MPU9250_ID, now_ts, gyro, accel, nb, dt);
+}
+#endif
+
 void imu_mpu9250_event(void)
 {
   uint32_t now_ts = get_sys_time_usec();
@@ -171,7 +227,22 @@ void imu_mpu9250_event(void)
   // If the MPU9250 SPI transaction has succeeded: convert the data
   mpu9250_spi_event(&imu_mpu9250.mpu);
 
+#if IMU_MPU9250_FIFO
+  // in FIFO mode, the slaves data are read independently from the samples
+  if (imu_mpu9250.mpu.data_ext_available) {
+    imu_mpu9250.mpu.data_ext_available = false;
+#if IMU_MPU9250_READ_MAG
+    imu_mpu9250_send_mag(now_ts);
+#endif
+  }
+#endif
+
   if (imu_mpu9250.mpu.data_available) {
+    imu_mpu9250.mpu.data_available = false;
+
+#if IMU_MPU9250_FIFO
+    imu_mpu9250_send_batch(now_ts);
+#else
     // set channel order
     struct Int32Vect3 accel = {
       IMU_MPU9250_X_SIGN * (int32_t)(imu_mpu9250.mpu.data_accel.value[IMU_MPU9250_CHAN_X]),
@@ -188,22 +259,12 @@ void imu_mpu9250_event(void)
     RATES_COPY(imu.gyro_unscaled, rates);
 
 #if IMU_MPU9250_READ_MAG
-    if (!bit_is_set(imu_mpu9250.mpu.data_ext[6], 3)) { //mag valid just HOFL == 0
-      /** FIXME: assumes that we get new mag data each time instead of reading drdy bit */
-      struct Int32Vect3 mag;
-      mag.x =  (IMU_MPU9250_X_SIGN) * Int16FromBuf(imu_mpu9250.mpu.data_ext, 2 * IMU_MPU9250_CHAN_Y);
-      mag.y =  (IMU_MPU9250_Y_SIGN) * Int16FromBuf(imu_mpu9250.mpu.data_ext, 2 * IMU_MPU9250_CHAN_X);
-      mag.z = -(IMU_MPU9250_Z_SIGN) * Int16FromBuf(imu_mpu9250.mpu.data_ext, 2 * IMU_MPU9250_CHAN_Z);
-      VECT3_COPY(imu.mag_unscaled, mag);
-      imu_scale_mag(&imu);
-      AbiSendMsgIMU_MAG_INT32(IMU_MPU9250_ID, now_ts, &imu.mag);
-    }
+    imu_mpu9250_send_mag(now_ts);
 #endif
 
-    imu_mpu9250.mpu.data_available = false;
-
     imu_scale_gyro(&imu);
     imu_scale_accel(&imu);
+#endif
     AbiSendMsgIMU_GYRO_INT32(IMU_MPU9250_ID, now_ts, &imu.gyro);
     AbiSendMsgIMU_ACCEL_INT32(IMU_MPU9250_ID, now_ts, &imu.accel);
   }
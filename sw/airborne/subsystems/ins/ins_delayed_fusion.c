@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file subsystems/ins/ins_delayed_fusion.c
+ *
+ * Fusion of delayed (out-of-sequence) measurements for INS filters.
+ */
+
+#include "subsystems/ins/ins_delayed_fusion.h"
+#include <string.h>
+
+#if INS_DF_QUEUE_LEN > 255
+#error "INS_DF_QUEUE_LEN should be lower than 256"
+#endif
+
+/** wrap-around safe comparison of usec timestamps */
+#define STAMP_BEFORE(_a, _b) ((int32_t)((_a) - (_b)) < 0)
+
+#define HISTORY_NEXT(_df, _i) (((_i) + 1) % (_df)->history_len)
+#define HISTORY_OLDEST(_df) (((_df)->head + (_df)->history_len + 1 - (_df)->nb) % (_df)->history_len)
+
+/** filter state after history entry _i */
+#define STATE(_df, _i) ((_df)->states + (size_t)(_i) * (_df)->ops->state_size)
+#define PAST_STATE(_df) STATE(_df, (_df)->history_len)
+#define LIVE_STATE(_df) STATE(_df, (_df)->history_len + 1)
+
+void ins_df_init(struct InsDelayedFusion *df, const struct InsDfOps *ops,
+                 struct InsDfHistory *history, uint16_t history_len, void *states)
+{
+  df->ops = ops;
+  df->history = history;
+  df->states = (uint8_t *)states;
+  df->history_len = history_len;
+  df->max_steps = INS_DF_MAX_STEPS;
+  df->nb_fused = 0;
+  df->nb_dropped = 0;
+  df->nb_restarts = 0;
+  ins_df_reset(df);
+}
+
+void ins_df_reset(struct InsDelayedFusion *df)
+{
+  df->head = df->history_len - 1;
+  df->nb = 0;
+  df->queue_nb = 0;
+  df->queue_next = 0;
+  df->catching_up = false;
+}
+
+/** remove the measurements already fused by the catch-up */
+static void queue_pop_fused(struct InsDelayedFusion *df)
+{
+  if (df->queue_next == 0) {
+    return;
+  }
+  df->nb_fused += df->queue_next;
+  df->queue_nb -= df->queue_next;
+  memmove(&df->queue[0], &df->queue[df->queue_next], df->queue_nb * sizeof(struct InsDfMeas));
+  df->queue_next = 0;
+}
+
+/** fuse the queued measurements valid before the end of the next propagation step */
+static void fuse_until(struct InsDelayedFusion *df, uint16_t idx)
+{
+  while (df->queue_next < df->queue_nb) {
+    if (idx != df->head &&
+        !STAMP_BEFORE(df->queue[df->queue_next].stamp, df->history[HISTORY_NEXT(df, idx)].stamp)) {
+      break;
+    }
+    df->ops->update(&df->queue[df->queue_next]);
+    df->queue_next++;
+  }
+}
+
+void ins_df_push_imu(struct InsDelayedFusion *df, uint32_t stamp, struct InsDfImu *imu)
+{
+  df->head = HISTORY_NEXT(df, df->head);
+  if (df->nb < df->history_len) {
+    df->nb++;
+  }
+  struct InsDfHistory *h = &df->history[df->head];
+  h->stamp = stamp;
+  h->imu = *imu;
+  df->ops->save(STATE(df, df->head));
+
+  if (df->catching_up && df->head == df->cursor) {
+    // catch-up is too slow and the history has been overwritten,
+    // drop the measurements it was fusing
+    df->nb_dropped += df->queue_nb;
+    df->nb_restarts++;
+    df->queue_nb = 0;
+    df->queue_next = 0;
+    df->catching_up = false;
+  }
+}
+
+bool ins_df_push_measurement(struct InsDelayedFusion *df, uint32_t stamp, uint8_t type,
+                             const void *data, uint16_t size)
+{
+  if (size > INS_DF_MEAS_SIZE) {
+    df->nb_dropped++;
+    return false;
+  }
+
+  struct InsDfMeas meas;
+  meas.stamp = stamp;
+  meas.type = type;
+  memcpy(meas.data, data, size);
+
+  // no history or not delayed, fuse now
+  // (unless a catch-up is running, it would overwrite the live state)
+  if (df->nb == 0 ||
+      (!df->catching_up && !STAMP_BEFORE(stamp, df->history[df->head].stamp))) {
+    df->ops->update(&meas);
+    return true;
+  }
+
+  if (STAMP_BEFORE(stamp, df->history[HISTORY_OLDEST(df)].stamp) || df->queue_nb == INS_DF_QUEUE_LEN) {
+    df->nb_dropped++;
+    return false;
+  }
+
+  // insert sorted, after measurements with the same stamp
+  uint8_t i = df->queue_nb;
+  while (i > 0 && STAMP_BEFORE(stamp, df->queue[i - 1].stamp)) {
+    df->queue[i] = df->queue[i - 1];
+    i--;
+  }
+  df->queue[i] = meas;
+  df->queue_nb++;
+
+  // older than the state currently re-propagated, start again from it
+  if (df->catching_up && i < df->queue_next) {
+    df->catching_up = false;
+    df->queue_next = 0;
+    df->nb_restarts++;
+  }
+  return true;
+}
+
+bool ins_df_run(struct InsDelayedFusion *df)
+{
+  if (df->queue_nb == 0) {
+    return false;
+  }
+
+  df->ops->save(LIVE_STATE(df));
+
+  if (!df->catching_up) {
+    // rewind to the newest entry before the oldest measurement
+    uint16_t idx = HISTORY_OLDEST(df);
+    while (idx != df->head &&
+           !STAMP_BEFORE(df->queue[0].stamp, df->history[HISTORY_NEXT(df, idx)].stamp)) {
+      idx = HISTORY_NEXT(df, idx);
+    }
+    df->cursor = idx;
+    df->queue_next = 0;
+    df->catching_up = true;
+    df->ops->restore(STATE(df, idx));
+  } else {
+    df->ops->restore(PAST_STATE(df));
+  }
+
+  uint16_t steps = 0;
+  fuse_until(df, df->cursor);
+  while (df->cursor != df->head && steps < df->max_steps) {
+    df->cursor = HISTORY_NEXT(df, df->cursor);
+    struct InsDfHistory *h = &df->history[df->cursor];
+    df->ops->propagate(&h->imu);
+    df->ops->save(STATE(df, df->cursor));
+    fuse_until(df, df->cursor);
+    steps++;
+  }
+
+  if (df->cursor == df->head) {
+    // caught up, corrected state becomes the live one
+    queue_pop_fused(df);
+    df->catching_up = false;
+    return true;
+  }
+
+  df->ops->save(PAST_STATE(df));
+  df->ops->restore(LIVE_STATE(df));
+  return false;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file subsystems/ins/ins_delayed_fusion.h
+ *
+ * Fusion of delayed (out-of-sequence) measurements for INS filters.
+ *
+ * The filter state and IMU input of each propagation step are kept in a
+ * history ring provided by the filter, which should cover its largest
+ * latency. Older measurements are dropped and counted in nb_dropped.
+ * A delayed measurement is queued with its true timestamp (reception time
+ * minus latency). The filter is then rewound to
+ * the history entry just before that timestamp, the measurement is applied
+ * and the IMU inputs are propagated again up to the present.
+ *
+ * Re-propagation is spread over several cycles with at most
+ * #INS_DF_MAX_STEPS steps per call to ins_df_run(), the live filter keeps
+ * running meanwhile and is replaced by the corrected one once it has
+ * caught up.
+ *
+ * The filter is only accessed through the callbacks of #InsDfOps, the
+ * history stores an opaque copy of the filter state, of InsDfOps.state_size
+ * bytes, in a storage provided by the filter (see #INS_DF_STATES_LEN).
+ */
+
+#ifndef INS_DELAYED_FUSION_H
+#define INS_DELAYED_FUSION_H
+
+#include "std.h"
+#include "math/pprz_algebra_float.h"
+
+/** max size in bytes of a measurement */
+#ifndef INS_DF_MEAS_SIZE
+#define INS_DF_MEAS_SIZE 64
+#endif
+
+/** number of delayed measurements waiting to be fused */
+#ifndef INS_DF_QUEUE_LEN
+#define INS_DF_QUEUE_LEN 8
+#endif
+
+/** max number of propagation steps redone per call to ins_df_run() */
+#ifndef INS_DF_MAX_STEPS
+#define INS_DF_MAX_STEPS 8
+#endif
+
+/** IMU input of one propagation step */
+struct InsDfImu {
+  struct FloatRates gyro;
+  struct FloatVect3 accel;
+  float dt;
+};
+
+/** Timestamped measurement, content is filter specific */
+struct InsDfMeas {
+  uint32_t stamp;             ///< time of validity in usec
+  uint8_t type;               ///< filter specific measurement type
+  uint8_t data[INS_DF_MEAS_SIZE] __attribute__((aligned(4)));
+};
+
+/** Filter callbacks */
+struct InsDfOps {
+  uint16_t state_size;                        ///< size of the state snapshot
+  void (*save)(void *state);                  ///< copy current filter state
+  void (*restore)(const void *state);         ///< set current filter state
+  void (*propagate)(struct InsDfImu *imu);    ///< propagate current filter state
+  void (*update)(struct InsDfMeas *meas);     ///< fuse a measurement in current filter state
+};
+
+struct InsDfHistory {
+  uint32_t stamp;                             ///< time of the propagation step in usec
+  struct InsDfImu imu;                        ///< input of the propagation step
+};
+
+/** Number of filter states in the storage of a history of _len entries:
+ * the state after each step, plus the re-propagated and the live states
+ */
+#define INS_DF_STATES_LEN(_len) ((_len) + 2)
+
+struct InsDelayedFusion {
+  const struct InsDfOps *ops;
+
+  struct InsDfHistory *history;
+  uint8_t *states;          ///< state after each history entry, then past and live states
+  uint16_t history_len;     ///< number of entries of history
+  uint16_t head;            ///< index of newest history entry
+  uint16_t nb;              ///< number of valid history entries
+
+  struct InsDfMeas queue[INS_DF_QUEUE_LEN]; ///< measurements sorted by timestamp
+  uint8_t queue_nb;         ///< number of queued measurements
+  uint8_t queue_next;       ///< next measurement to fuse during catch-up
+
+  bool catching_up;         ///< re-propagation in progress
+  uint16_t cursor;          ///< history index of the re-propagated state
+
+  uint16_t max_steps;       ///< max propagation steps per run
+  uint32_t nb_fused;        ///< number of delayed measurements fused
+  uint32_t nb_dropped;      ///< measurements dropped (too old or queue full)
+  uint32_t nb_restarts;     ///< catch-up restarted or aborted
+};
+
+/** Init delayed fusion for a filter
+ * @param df delayed fusion structure
+ * @param ops filter callbacks
+ * @param history history storage, should cover the largest latency
+ * @param history_len number of entries of history
+ * @param states storage of INS_DF_STATES_LEN(history_len) filter states,
+ *               e.g. an array of the filter state structure
+ */
+extern void ins_df_init(struct InsDelayedFusion *df, const struct InsDfOps *ops,
+                        struct InsDfHistory *history, uint16_t history_len, void *states);
+
+/** Clear history and queue, to be called when the filter is reset */
+extern void ins_df_reset(struct InsDelayedFusion *df);
+
+/** Store a propagation step, to be called right after the filter propagation
+ * @param df delayed fusion structure
+ * @param stamp time of the propagation in usec
+ * @param imu input used for the propagation
+ */
+extern void ins_df_push_imu(struct InsDelayedFusion *df, uint32_t stamp, struct InsDfImu *imu);
+
+/** Queue a delayed measurement
+ * Measurements newer than the last propagation are fused immediately.
+ * @param df delayed fusion structure
+ * @param stamp time of validity of the measurement in usec
+ * @param type filter specific measurement type
+ * @param data measurement content
+ * @param size size of the content, <= INS_DF_MEAS_SIZE
+ * @return false if the measurement was dropped
+ */
+extern bool ins_df_push_measurement(struct InsDelayedFusion *df, uint32_t stamp, uint8_t type,
+                                    const void *data, uint16_t size);
+
+/** Run re-propagation for the queued measurements, with bounded cost.
+ * To be called before the filter propagation.
+ * @param df delayed fusion structure
+ * @return true if the filter state was replaced by the corrected one
+ */
+extern bool ins_df_run(struct InsDelayedFusion *df);
+
+#endif /* INS_DELAYED_FUSION_H */
@@ -336,8 +336,6 @@ void ins_float_invariant_align(struct FloatRates *lp_gyro,
 
 void ins_float_invariant_propagate(struct FloatRates* gyro, struct FloatVect3* accel, float dt)
 {
-  struct FloatRates body_rates;
-
   // realign all the filter if needed
   // a complete init cycle is required
   if (ins_float_inv.reset) {
@@ -346,15 +344,17 @@ void ins_float_invariant_propagate(struct FloatRates* gyro, struct FloatVect3* a
     init_invariant_state();
   }
 
+  ins_float_invariant_propagate_filter(gyro, accel, dt);
+  ins_float_invariant_publish();
+}
+
+void ins_float_invariant_propagate_filter(struct FloatRates* gyro, struct FloatVect3* accel, float dt)
+{
   // fill command vector in body frame
   struct FloatRMat *body_to_imu_rmat = orientationGetRMat_f(&ins_float_inv.body_to_imu);
   float_rmat_transp_ratemult(&ins_float_inv.cmd.rates, body_to_imu_rmat, gyro);
   float_rmat_transp_vmult(&ins_float_inv.cmd.accel, body_to_imu_rmat, accel);
 
-  struct Int32Vect3 body_accel_i;
-  ACCELS_BFP_OF_REAL(body_accel_i, ins_float_inv.cmd.accel);
-  stateSetAccelBody_i(&body_accel_i);
-
   // update correction gains
   error_output(&ins_float_inv);
 
@@ -368,6 +368,15 @@ void ins_float_invariant_propagate(struct FloatRates* gyro, struct FloatVect3* a
 
   // normalize quaternion
   float_quat_normalize(&ins_float_inv.state.quat);
+}
+
+void ins_float_invariant_publish(void)
+{
+  struct FloatRates body_rates;
+
+  struct Int32Vect3 body_accel_i;
+  ACCELS_BFP_OF_REAL(body_accel_i, ins_float_inv.cmd.accel);
+  stateSetAccelBody_i(&body_accel_i);
 
   // set global state
   stateSetNedToBodyQuat_f(&ins_float_inv.state.quat);
@@ -128,6 +128,13 @@ extern void ins_float_invariant_align(struct FloatRates *lp_gyro,
                                       struct FloatVect3 *lp_mag);
 extern void ins_float_invariant_propagate(struct FloatRates* gyro,
                                           struct FloatVect3* accel, float dt);
+/** Propagation of the filter state only, without setting the global state
+ * nor sending or logging it (re-propagation of past steps)
+ */
+extern void ins_float_invariant_propagate_filter(struct FloatRates* gyro,
+                                                 struct FloatVect3* accel, float dt);
+/** Set the global state from the filter state, send and log it */
+extern void ins_float_invariant_publish(void);
 extern void ins_float_invariant_update_mag(struct FloatVect3* mag);
 extern void ins_float_invariant_update_baro(float pressure);
 extern void ins_float_invariant_update_gps(struct GpsState *gps_s);
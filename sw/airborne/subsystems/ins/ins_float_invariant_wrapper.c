@@ -43,6 +43,126 @@ static struct FloatVect3 ins_finv_accel;
 /** last gyro msg timestamp */
 static uint32_t ins_finv_last_stamp = 0;
 
+/** GPS latency compensation.
+ * If INS_FINV_GPS_LATENCY_MS is defined (in milliseconds), GPS measurements are
+ * fused at their time of validity by re-propagating the filter from the
+ * stored history (see ins_delayed_fusion.h).
+ */
+#ifdef INS_FINV_GPS_LATENCY_MS
+#include "subsystems/ins/ins_delayed_fusion.h"
+PRINT_CONFIG_VAR(INS_FINV_GPS_LATENCY_MS)
+
+#define INS_FINV_DF_GPS 0
+
+/** propagation frequency used to size the history */
+#ifdef INS_PROPAGATE_FREQUENCY
+#define INS_FINV_DF_FREQUENCY INS_PROPAGATE_FREQUENCY
+#else
+#define INS_FINV_DF_FREQUENCY PERIODIC_FREQUENCY
+#endif
+
+/** number of propagation steps kept in history, 250 ms by default,
+ * should cover the GPS latency (checked at compile time with a 10% margin)
+ */
+#ifndef INS_FINV_DF_HISTORY_LEN
+#define INS_FINV_DF_HISTORY_LEN (INS_FINV_DF_FREQUENCY / 4 + 2)
+#endif
+PRINT_CONFIG_VAR(INS_FINV_DF_HISTORY_LEN)
+
+/** filter state saved in history, mag and baro measurements stay live */
+struct ins_finv_df_state {
+  struct inv_state state;
+  struct NedCoor_f pos_gps;
+  struct NedCoor_f speed_gps;
+};
+
+/** part of the GPS state used by the filter */
+struct ins_finv_df_gps {
+#if INS_FINV_USE_UTM
+  struct UtmCoor_i utm_pos;
+  struct LlaCoor_i lla_pos;
+  struct NedCoor_i ned_vel;
+  int32_t hmsl;
+#else
+  struct EcefCoor_i ecef_pos;
+  struct EcefCoor_i ecef_vel;
+#endif
+  uint8_t valid_fields;
+  uint8_t fix;
+};
+
+static struct InsDelayedFusion ins_finv_df;
+static struct InsDfHistory ins_finv_df_history[INS_FINV_DF_HISTORY_LEN];
+static struct ins_finv_df_state ins_finv_df_states[INS_DF_STATES_LEN(INS_FINV_DF_HISTORY_LEN)];
+
+/** last GPS measurement was too old for the history, or the queue was full */
+static bool ins_finv_gps_dropped = false;
+
+static void ins_finv_df_save(void *s)
+{
+  struct ins_finv_df_state *df_state = (struct ins_finv_df_state *)s;
+  df_state->state = ins_float_inv.state;
+  df_state->pos_gps = ins_float_inv.meas.pos_gps;
+  df_state->speed_gps = ins_float_inv.meas.speed_gps;
+}
+
+static void ins_finv_df_restore(const void *s)
+{
+  const struct ins_finv_df_state *df_state = (const struct ins_finv_df_state *)s;
+  ins_float_inv.state = df_state->state;
+  ins_float_inv.meas.pos_gps = df_state->pos_gps;
+  ins_float_inv.meas.speed_gps = df_state->speed_gps;
+}
+
+/** re-propagation of a past step, the global state is only set by the live one */
+static void ins_finv_df_propagate(struct InsDfImu *imu)
+{
+  ins_float_invariant_propagate_filter(&imu->gyro, &imu->accel, imu->dt);
+}
+
+static void ins_finv_df_update(struct InsDfMeas *meas)
+{
+  if (meas->type == INS_FINV_DF_GPS) {
+    static struct GpsState gps_s;
+    struct ins_finv_df_gps *g = (struct ins_finv_df_gps *)meas->data;
+#if INS_FINV_USE_UTM
+    gps_s.utm_pos = g->utm_pos;
+    gps_s.lla_pos = g->lla_pos;
+    gps_s.ned_vel = g->ned_vel;
+    gps_s.hmsl = g->hmsl;
+#else
+    gps_s.ecef_pos = g->ecef_pos;
+    gps_s.ecef_vel = g->ecef_vel;
+#endif
+    gps_s.valid_fields = g->valid_fields;
+    gps_s.fix = g->fix;
+    ins_float_invariant_update_gps(&gps_s);
+  }
+}
+
+static const struct InsDfOps ins_finv_df_ops = {
+  .state_size = sizeof(struct ins_finv_df_state),
+  .save = ins_finv_df_save,
+  .restore = ins_finv_df_restore,
+  .propagate = ins_finv_df_propagate,
+  .update = ins_finv_df_update,
+};
+
+/** propagate and store the step in history */
+static void ins_finv_propagate(uint32_t stamp, struct FloatRates *gyro, struct FloatVect3 *accel, float dt)
+{
+  if (ins_float_inv.reset) {
+    ins_df_reset(&ins_finv_df);
+  }
+  ins_df_run(&ins_finv_df);
+  ins_float_invariant_propagate(gyro, accel, dt);
+  struct InsDfImu imu = { .gyro = *gyro, .accel = *accel, .dt = dt };
+  ins_df_push_imu(&ins_finv_df, stamp, &imu);
+}
+#else
+#define ins_finv_propagate(_stamp, _gyro, _accel, _dt) ins_float_invariant_propagate(_gyro, _accel, _dt)
+#endif
+
 #if PERIODIC_TELEMETRY && !INS_FINV_USE_UTM
 #include "subsystems/datalink/telemetry.h"
 #include "state.h"
@@ -64,6 +184,11 @@ static void send_filter_status(struct transport_tx *trans, struct link_device *d
   uint8_t mde = 3;
   uint16_t val = 0;
   if (!ins_float_inv.is_aligned) { mde = 2; }
+#ifdef INS_FINV_GPS_LATENCY_MS
+  /* report dropped delayed GPS measurements, GPS lost if the last one was dropped */
+  val = Min(ins_finv_df.nb_dropped, UINT16_MAX);
+  if (ins_finv_gps_dropped) { mde = 4; }
+#endif
   uint32_t t_diff = get_sys_time_usec() - ins_finv_last_stamp;
   /* set lost if no new gyro measurements for 50ms */
   if (t_diff > 50000) { mde = 5; }
@@ -143,14 +268,14 @@ static void gyro_cb(uint8_t sender_id __attribute__((unused)),
 
   if (last_stamp > 0) {
     float dt = (float)(stamp - last_stamp) * 1e-6;
-    ins_float_invariant_propagate(&gyro_f, &ins_finv_accel, dt);
+    ins_finv_propagate(stamp, &gyro_f, &ins_finv_accel, dt);
   }
   last_stamp = stamp;
 #else
   PRINT_CONFIG_MSG("Using fixed INS_PROPAGATE_FREQUENCY for INS float_invariant propagation.")
   PRINT_CONFIG_VAR(INS_PROPAGATE_FREQUENCY)
   const float dt = 1. / (INS_PROPAGATE_FREQUENCY);
-  ins_float_invariant_propagate(&gyro_f, &ins_finv_accel, dt);
+  ins_finv_propagate(stamp, &gyro_f, &ins_finv_accel, dt);
 #endif
 
   ins_finv_last_stamp = stamp;
@@ -208,7 +333,24 @@ static void gps_cb(uint8_t sender_id __attribute__((unused)),
                    uint32_t stamp __attribute__((unused)),
                    struct GpsState *gps_s)
 {
+#ifdef INS_FINV_GPS_LATENCY_MS
+  struct ins_finv_df_gps g;
+#if INS_FINV_USE_UTM
+  g.utm_pos = gps_s->utm_pos;
+  g.lla_pos = gps_s->lla_pos;
+  g.ned_vel = gps_s->ned_vel;
+  g.hmsl = gps_s->hmsl;
+#else
+  g.ecef_pos = gps_s->ecef_pos;
+  g.ecef_vel = gps_s->ecef_vel;
+#endif
+  g.valid_fields = gps_s->valid_fields;
+  g.fix = gps_s->fix;
+  uint32_t meas_stamp = stamp - (uint32_t)INS_FINV_GPS_LATENCY_MS * 1000;
+  ins_finv_gps_dropped = !ins_df_push_measurement(&ins_finv_df, meas_stamp, INS_FINV_DF_GPS, &g, sizeof(g));
+#else
   ins_float_invariant_update_gps(gps_s);
+#endif
 }
 
 
@@ -221,6 +363,14 @@ void ins_float_invariant_wrapper_init(void)
 
   ins_float_invariant_init();
 
+#ifdef INS_FINV_GPS_LATENCY_MS
+  _Static_assert(sizeof(struct ins_finv_df_gps) <= INS_DF_MEAS_SIZE, "INS_DF_MEAS_SIZE too small");
+  _Static_assert(INS_FINV_GPS_LATENCY_MS * INS_FINV_DF_FREQUENCY * 11 < INS_FINV_DF_HISTORY_LEN * 10000,
+                 "INS_FINV_DF_HISTORY_LEN does not cover INS_FINV_GPS_LATENCY_MS, increase it");
+  ins_df_init(&ins_finv_df, &ins_finv_df_ops, ins_finv_df_history, INS_FINV_DF_HISTORY_LEN,
+              ins_finv_df_states);
+#endif
+
  // Bind to ABI messages
   AbiBindMsgBARO_ABS(INS_FINV_BARO_ID, &baro_ev, baro_cb);
   AbiBindMsgIMU_GYRO_INT32(INS_FINV_IMU_ID, &gyro_ev, gyro_cb);
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file subsystems/navigation/nav_sector.h
+ * Containment and distance queries on flight plan sectors.
+ *
+ * For static sectors, the flight plan generator splits the polygon in
+ * horizontal slabs between the y coordinates of its corners. The edges
+ * crossing a slab don't intersect inside it, so they are stored sorted by x.
+ * A point is then inside if the number of edges on its left in its slab is
+ * odd, with a binary search for the slab and one for the edges: O(log n)
+ * for any simple polygon, convex or not.
+ *
+ * The generator also emits SectorDistance<Name>(x, y), the signed distance
+ * to the boundary (positive inside), and GeofenceSectorDistance(x, y) for
+ * the geofence sector. For static sectors, a grid over the polygon lists
+ * the edges that can be the nearest one from each cell, so only a few edges
+ * are tested in the grid and all of them outside. Exceptions can use it to act before the breach, e.g.
+ * @code
+ * <exception cond="GeofenceSectorPredictedDistance(3.) < 0." deroute="Holding point"/>
+ * @endcode
+ */
+
+#ifndef NAV_SECTOR_H
+#define NAV_SECTOR_H
+
+#include "std.h"
+#include "math/pprz_algebra_float.h"
+#include <float.h>
+
+/** An edge crossing a slab */
+struct NavSectorEdge {
+  float x;        ///< x at the bottom of the slab
+  float slope;    ///< dx/dy
+};
+
+/** Slab decomposition of a sector */
+struct NavSector {
+  uint16_t nb_slabs;
+  const float *ys;                      ///< slab boundaries (nb_slabs + 1), increasing
+  const uint16_t *first;                ///< index of the first edge of each slab (nb_slabs + 1)
+  const struct NavSectorEdge *edges;    ///< edges of each slab, sorted by x
+};
+
+/**
+ * Check if a point is inside a sector
+ * @param[in] *s The slab decomposition of the sector
+ * @param[in] x, y The point
+ * @return true if inside
+ */
+static inline bool nav_sector_inside(const struct NavSector *s, float x, float y)
+{
+  if (s->nb_slabs == 0 || y < s->ys[0] || y >= s->ys[s->nb_slabs]) {
+    return false;
+  }
+  // slab with ys[lo] <= y < ys[lo + 1]
+  uint16_t lo = 0, hi = s->nb_slabs;
+  while (hi - lo > 1) {
+    uint16_t mid = (lo + hi) / 2;
+    if (s->ys[mid] <= y) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  // number of edges on the left of the point
+  const float dy = y - s->ys[lo];
+  uint16_t a = s->first[lo], b = s->first[lo + 1];
+  while (a < b) {
+    uint16_t mid = (a + b) / 2;
+    if (s->edges[mid].x + dy * s->edges[mid].slope < x) {
+      a = mid + 1;
+    } else {
+      b = mid;
+    }
+  }
+  return ((a - s->first[lo]) & 1) != 0;
+}
+
+/** Squared distance from a point to a segment */
+static inline float nav_sector_segment_dist2(float x, float y, float ax, float ay, float bx, float by)
+{
+  const float ux = bx - ax, uy = by - ay;
+  const float l2 = ux * ux + uy * uy;
+  float t = 0.f;
+  if (l2 > 0.f) {
+    t = ((x - ax) * ux + (y - ay) * uy) / l2;
+    t = Clip(t, 0.f, 1.f);
+  }
+  const float dx = ax + t * ux - x;
+  const float dy = ay + t * uy - y;
+  return dx * dx + dy * dy;
+}
+
+/**
+ * Signed distance from a point to the boundary of a sector
+ * @param[in] *pts The corners of the sector
+ * @param[in] nb The number of corners
+ * @param[in] inside If the point is inside the sector
+ * @param[in] x, y The point
+ * @return The distance, positive inside and negative outside
+ */
+static inline float nav_sector_distance(const struct FloatVect2 *pts, uint16_t nb, bool inside, float x, float y)
+{
+  float d2 = FLT_MAX;
+  for (uint16_t i = 0, j = nb - 1; i < nb; j = i++) {
+    float e2 = nav_sector_segment_dist2(x, y, pts[j].x, pts[j].y, pts[i].x, pts[i].y);
+    if (e2 < d2) {
+      d2 = e2;
+    }
+  }
+  const float d = sqrtf(d2);
+  return inside ? d : -d;
+}
+
+/** Grid of the candidate nearest edges of a static sector */
+struct NavSectorGrid {
+  float x0, y0;                 ///< corner of the grid
+  float dx, dy;                 ///< size of a cell
+  uint8_t nx, ny;               ///< number of cells
+  const uint16_t *first;        ///< index of the first edge of each cell (nx * ny + 1)
+  const uint16_t *edges;        ///< candidate edges of each cell, edge i from corner i to i + 1
+};
+
+/**
+ * Signed distance from a point to the boundary of a static sector
+ * @param[in] *g The grid of candidate edges
+ * @param[in] *pts The corners of the sector
+ * @param[in] nb The number of corners
+ * @param[in] inside If the point is inside the sector
+ * @param[in] x, y The point
+ * @return The distance, positive inside and negative outside
+ */
+static inline float nav_sector_grid_distance(const struct NavSectorGrid *g, const struct FloatVect2 *pts, uint16_t nb,
+    bool inside, float x, float y)
+{
+  const float fx = (x - g->x0) / g->dx;
+  const float fy = (y - g->y0) / g->dy;
+  if (fx < 0.f || fy < 0.f || fx >= g->nx || fy >= g->ny) {
+    return nav_sector_distance(pts, nb, inside, x, y);
+  }
+  const uint16_t c = (uint16_t)fy * g->nx + (uint16_t)fx;
+  float d2 = FLT_MAX;
+  for (uint16_t k = g->first[c]; k < g->first[c + 1]; k++) {
+    const uint16_t i = g->edges[k];
+    const uint16_t j = i + 1 < nb ? i + 1 : 0;
+    float e2 = nav_sector_segment_dist2(x, y, pts[i].x, pts[i].y, pts[j].x, pts[j].y);
+    if (e2 < d2) {
+      d2 = e2;
+    }
+  }
+  const float d = sqrtf(d2);
+  return inside ? d : -d;
+}
+
+/**
+ * Signed distance to the geofence sector of the position predicted in _t seconds
+ * at the current ground speed
+ */
+#define GeofenceSectorPredictedDistance(_t) \
+  GeofenceSectorDistance(stateGetPositionEnu_f()->x + (_t) * stateGetSpeedEnu_f()->x, \
+                         stateGetPositionEnu_f()->y + (_t) * stateGetSpeedEnu_f()->y)
+
+#endif /* NAV_SECTOR_H */
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test/ins_replay/bench_mekf_wind.c
+ *
+ * Timing of the ins_mekf_wind propagation and update steps on a
+ * synthetic trajectory.
+ *
+ * The same source is linked against modules/ins/ins_mekf_wind.cpp and
+ * against ins_mekf_wind_ref.cpp, the implementation before the sparse
+ * covariance kernels, see "make bench". The final state is printed so
+ * that both versions can be compared.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "std.h"
+#include "modules/ins/ins_mekf_wind.h"
+
+#define BENCH_FREQ 500
+#define BENCH_MAG_DIV 10
+#define BENCH_GPS_DIV 100
+
+static inline double bench_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+  int nb_steps = argc > 1 ? atoi(argv[1]) : 100000;
+  const float dt = 1.f / BENCH_FREQ;
+
+  ins_mekf_wind_init();
+  ins_mekf_wind_params.disable_wind = false;
+  ins_mekf_wind_update_params();
+  const struct FloatVect3 mag_h = { 0.5156f, -0.0571f, 0.8549f };
+  ins_mekf_wind_set_mag_h(&mag_h);
+  struct FloatRates bias = { 0.f, 0.f, 0.f };
+  struct FloatQuat quat = { 1.f, 0.f, 0.f, 0.f };
+  ins_mekf_wind_align(&bias, &quat);
+
+  double t_prop = 0., t_mag = 0., t_gps = 0., t_baro = 0.;
+  int nb_mag = 0, nb_gps = 0;
+
+  for (int i = 0; i < nb_steps; i++) {
+    /* slow coordinated turn at 15 m/s with some attitude oscillations */
+    float t = i * dt;
+    struct FloatRates gyro = { 0.1f * sinf(t), 0.05f * cosf(0.7f * t), 0.2f };
+    struct FloatVect3 accel = { 0.2f * sinf(0.3f * t), 3.f, -9.81f };
+    double t0 = bench_now();
+    ins_mekf_wind_propagate(&gyro, &accel, dt);
+    t_prop += bench_now() - t0;
+
+    if (i % BENCH_MAG_DIV == 0) {
+      struct FloatQuat q = ins_mekf_wind_get_quat();
+      struct FloatVect3 mag;
+      float_quat_vmult(&mag, &q, &mag_h);
+      t0 = bench_now();
+      ins_mekf_wind_update_mag(&mag, false);
+      t_mag += bench_now() - t0;
+      nb_mag++;
+    }
+    if (i % BENCH_GPS_DIV == 0) {
+      struct FloatVect3 pos = { 75.f * cosf(0.2f * t), 75.f * sinf(0.2f * t), -50.f };
+      struct FloatVect3 speed = { -15.f * sinf(0.2f * t), 15.f * cosf(0.2f * t), 0.f };
+      t0 = bench_now();
+      ins_mekf_wind_update_pos_speed(&pos, &speed);
+      t_gps += bench_now() - t0;
+      t0 = bench_now();
+      ins_mekf_wind_update_baro(-pos.z);
+      ins_mekf_wind_update_airspeed(15.f);
+      t_baro += bench_now() - t0;
+      nb_gps++;
+    }
+  }
+
+  printf("propagate:       %8.1f ns\n", 1e9 * t_prop / nb_steps);
+  printf("mag update:      %8.1f ns\n", 1e9 * t_mag / nb_mag);
+  printf("pos/speed update:%8.1f ns\n", 1e9 * t_gps / nb_gps);
+  printf("baro+airspeed:   %8.1f ns\n", 1e9 * t_baro / nb_gps);
+  printf("total per step:  %8.1f ns\n", 1e9 * (t_prop + t_mag + t_gps + t_baro) / nb_steps);
+
+  struct FloatQuat q = ins_mekf_wind_get_quat();
+  struct NedCoor_f p = ins_mekf_wind_get_pos_ned();
+  struct NedCoor_f v = ins_mekf_wind_get_speed_ned();
+  struct NedCoor_f w = ins_mekf_wind_get_wind_ned();
+  struct FloatRates rb = ins_mekf_wind_get_rates_bias();
+  printf("quat %f %f %f %f\n", q.qi, q.qx, q.qy, q.qz);
+  printf("pos %f %f %f speed %f %f %f\n", p.x, p.y, p.z, v.x, v.y, v.z);
+  printf("wind %f %f %f rates_bias %f %f %f\n", w.x, w.y, w.z, rb.p, rb.q, rb.r);
+  return 0;
+}
@@ -0,0 +1,13 @@
+/* fake generated airframe file for the estimator replay */
+
+#ifndef AIRFRAME_H
+#define AIRFRAME_H
+
+#define AC_ID 1
+
+#define SECTION_IMU 1
+#define IMU_BODY_TO_IMU_PHI 0.
+#define IMU_BODY_TO_IMU_THETA 0.
+#define IMU_BODY_TO_IMU_PSI 0.
+
+#endif // AIRFRAME_H
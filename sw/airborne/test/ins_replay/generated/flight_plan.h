@@ -0,0 +1,14 @@
+/* fake generated flight plan file for the estimator replay
+ * the local origin is reset at the first GPS fix of the log
+ */
+
+#ifndef FLIGHT_PLAN_H
+#define FLIGHT_PLAN_H
+
+#define NAV_LAT0 436052765
+#define NAV_LON0 14427764
+#define NAV_ALT0 180000
+#define NAV_MSL0 51850
+#define GROUND_ALT 180.
+
+#endif // FLIGHT_PLAN_H
@@ -0,0 +1,363 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test/ins_replay/ins_replay.c
+ *
+ * Offline replay of AHRS/INS filters on a flight log, as fast as possible.
+ *
+ * The log is decoded once, then each parameter set is replayed in its own
+ * forked process: the filters keep their state in globals and function
+ * statics, so a process per run is the only way to get a clean filter
+ * without touching the airborne code. Up to -j runs are active at the same
+ * time, the decoded log is shared between them by copy-on-write.
+ *
+ * Usage:
+ *   ins_replay -f invariant -l 21_05_12__10_00_00.data -p params.txt -j 8 -o out
+ *
+ * Each line of the parameter file is one run, as space separated
+ * name=value pairs (empty line for the default tuning). Run N writes
+ * out_N.txt with one line per propagation step:
+ *   time qi qx qy qz phi theta psi bp bq br x y z vx vy vz wx wy wz
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+
+#include "std.h"
+#include "math/pprz_algebra_float.h"
+#include "replay_log.h"
+#include "replay_filter.h"
+
+#define REPLAY_MAX_PARAMS_LEN 1024
+#define REPLAY_OUT_BUF_SIZE (1 << 20)
+
+/** Replay options */
+struct ReplayOptions {
+  const struct ReplayFilter *filter;
+  const char *log_file;
+  const char *params_file;
+  const char *out_prefix;
+  int ac_id;
+  int jobs;
+  int decimation;       ///< write one output line every N propagations
+  float align_time;     ///< averaging time before alignment in seconds
+  float max_dt;         ///< propagation steps longer than this are skipped
+};
+
+static struct ReplayOptions opts = {
+  .filter = NULL,
+  .log_file = NULL,
+  .params_file = NULL,
+  .out_prefix = "replay",
+  .ac_id = -1,
+  .jobs = 1,
+  .decimation = 1,
+  .align_time = 2.f,
+  .max_dt = 0.5f
+};
+
+static struct ReplayLog replay_log;
+
+static double get_time(void)
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+/** apply a "name=value name=value" parameter line, return false on error */
+static bool apply_params(const struct ReplayFilter *f, char *line)
+{
+  char *save = NULL;
+  for (char *tok = strtok_r(line, " \t\n", &save); tok != NULL; tok = strtok_r(NULL, " \t\n", &save)) {
+    char *eq = strchr(tok, '=');
+    if (eq == NULL) {
+      fprintf(stderr, "malformed parameter '%s'\n", tok);
+      return false;
+    }
+    *eq = '\0';
+    if (!f->set_param(tok, strtof(eq + 1, NULL))) {
+      fprintf(stderr, "unknown parameter '%s' for filter %s\n", tok, f->name);
+      return false;
+    }
+  }
+  return true;
+}
+
+static void write_output(FILE *out, double time, struct ReplayOutput *o)
+{
+  struct FloatEulers e;
+  float_eulers_of_quat(&e, &o->quat);
+  fprintf(out, "%.6f\t%f %f %f %f\t%f %f %f\t%f %f %f\t%f %f %f\t%f %f %f\t%f %f %f\n",
+          time, o->quat.qi, o->quat.qx, o->quat.qy, o->quat.qz,
+          e.phi, e.theta, e.psi,
+          o->gyro_bias.p, o->gyro_bias.q, o->gyro_bias.r,
+          o->pos.x, o->pos.y, o->pos.z,
+          o->speed.x, o->speed.y, o->speed.z,
+          o->wind.x, o->wind.y, o->wind.z);
+}
+
+/** replay the whole log with one parameter set */
+static int replay_run(int run, char *params)
+{
+  const struct ReplayFilter *f = opts.filter;
+
+  char filename[256];
+  snprintf(filename, sizeof(filename), "%s_%d.txt", opts.out_prefix, run);
+  FILE *out = fopen(filename, "w");
+  if (out == NULL) {
+    perror(filename);
+    return -1;
+  }
+  setvbuf(out, NULL, _IOFBF, REPLAY_OUT_BUF_SIZE);
+  fprintf(out, "# filter %s params: %s", f->name, params);
+  fprintf(out, "# time qi qx qy qz phi theta psi bp bq br x y z vx vy vz wx wy wz\n");
+
+  f->init();
+  if (!apply_params(f, params)) {
+    fclose(out);
+    return -1;
+  }
+
+  struct FloatRates gyro_sum, gyro = { 0.f, 0.f, 0.f };
+  struct FloatVect3 accel_sum, mag_sum;
+  struct FloatVect3 accel = { 0.f, 0.f, -9.81f };
+  struct FloatVect3 mag = { 1.f, 0.f, 0.f };
+  FLOAT_RATES_ZERO(gyro_sum);
+  FLOAT_VECT3_ZERO(accel_sum);
+  FLOAT_VECT3_ZERO(mag_sum);
+  int nb_gyro = 0, nb_accel = 0, nb_mag = 0;
+  double t_start = -1., t_gyro = -1.;
+  bool aligned = false;
+  int nb_prop = 0;
+  struct ReplayOutput o;
+
+  for (int i = 0; i < replay_log.nb_samples; i++) {
+    struct ReplaySample *s = &replay_log.samples[i];
+    if (t_start < 0.) {
+      t_start = s->time;
+    }
+
+    switch (s->type) {
+      case REPLAY_GYRO:
+        gyro = s->u.gyro;
+        if (!aligned) {
+          RATES_ADD(gyro_sum, gyro);
+          nb_gyro++;
+        } else if (t_gyro >= 0.) {
+          float dt = (float)(s->time - t_gyro);
+          if (dt > 0.f && dt < opts.max_dt) {
+            f->propagate(&gyro, &accel, dt);
+            if (++nb_prop % opts.decimation == 0) {
+              f->get_output(&o);
+              write_output(out, s->time, &o);
+            }
+          }
+        }
+        t_gyro = s->time;
+        break;
+      case REPLAY_ACCEL:
+        accel = s->u.accel;
+        if (!aligned) {
+          VECT3_ADD(accel_sum, accel);
+          nb_accel++;
+        } else if (f->update_accel) {
+          f->update_accel(&accel);
+        }
+        break;
+      case REPLAY_MAG:
+        mag = s->u.mag;
+        if (!aligned) {
+          VECT3_ADD(mag_sum, mag);
+          nb_mag++;
+        } else if (f->update_mag) {
+          f->update_mag(&mag);
+        }
+        break;
+      case REPLAY_GPS:
+        if (aligned && f->update_gps) {
+          f->update_gps(&s->u.gps);
+        }
+        break;
+      case REPLAY_BARO:
+        if (f->update_baro) {
+          f->update_baro(s->u.pressure);
+        }
+        break;
+      default:
+        break;
+    }
+
+    if (!aligned && s->time - t_start > opts.align_time && nb_gyro > 0 && nb_accel > 0) {
+      RATES_SDIV(gyro_sum, gyro_sum, nb_gyro);
+      VECT3_SDIV(accel_sum, accel_sum, nb_accel);
+      if (nb_mag > 0) {
+        VECT3_SDIV(mag_sum, mag_sum, nb_mag);
+      } else {
+        mag_sum = mag;
+      }
+      f->align(&gyro_sum, &accel_sum, &mag_sum);
+      aligned = true;
+    }
+  }
+
+  fclose(out);
+  return nb_prop;
+}
+
+static int read_param_sets(const char *filename, char ***sets)
+{
+  int nb = 0;
+  *sets = NULL;
+  if (filename == NULL) {
+    *sets = malloc(sizeof(char *));
+    (*sets)[nb++] = strdup("\n");
+    return nb;
+  }
+  FILE *fd = fopen(filename, "r");
+  if (fd == NULL) {
+    perror(filename);
+    return -1;
+  }
+  char line[REPLAY_MAX_PARAMS_LEN];
+  while (fgets(line, sizeof(line), fd) != NULL) {
+    if (line[0] == '#') {
+      continue;
+    }
+    *sets = realloc(*sets, (nb + 1) * sizeof(char *));
+    (*sets)[nb++] = strdup(line);
+  }
+  fclose(fd);
+  return nb;
+}
+
+static void print_help(const char *name)
+{
+  printf("Usage: %s -f <filter> -l <log.data> [options]\n", name);
+  printf("  -f <filter>   filter to replay:");
+  for (int i = 0; replay_filters[i] != NULL; i++) {
+    printf(" %s", replay_filters[i]->name);
+  }
+  printf("\n");
+  printf("  -l <file>     .data flight log\n");
+  printf("  -a <ac_id>    aircraft id (default: first one in the log)\n");
+  printf("  -p <file>     parameter sets, one run per line (default: one run with default tuning)\n");
+  printf("  -j <jobs>     number of parallel runs (default: 1, 0 for number of cores)\n");
+  printf("  -o <prefix>   output file prefix (default: replay)\n");
+  printf("  -d <n>        output decimation (default: 1)\n");
+  printf("  -t <s>        alignment time (default: 2s)\n");
+}
+
+int main(int argc, char **argv)
+{
+  int c;
+  while ((c = getopt(argc, argv, "f:l:a:p:j:o:d:t:h")) != -1) {
+    switch (c) {
+      case 'f':
+        opts.filter = replay_filter_find(optarg);
+        if (opts.filter == NULL) {
+          fprintf(stderr, "unknown filter %s\n", optarg);
+          return 1;
+        }
+        break;
+      case 'l': opts.log_file = optarg; break;
+      case 'a': opts.ac_id = atoi(optarg); break;
+      case 'p': opts.params_file = optarg; break;
+      case 'j': opts.jobs = atoi(optarg); break;
+      case 'o': opts.out_prefix = optarg; break;
+      case 'd': opts.decimation = Max(atoi(optarg), 1); break;
+      case 't': opts.align_time = atof(optarg); break;
+      case 'h':
+      default:
+        print_help(argv[0]);
+        return (c == 'h') ? 0 : 1;
+    }
+  }
+  if (opts.filter == NULL || opts.log_file == NULL) {
+    print_help(argv[0]);
+    return 1;
+  }
+  if (opts.jobs <= 0) {
+    opts.jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  }
+
+  double t0 = get_time();
+  if (replay_log_read(&replay_log, opts.log_file, opts.ac_id) <= 0) {
+    fprintf(stderr, "no sensor data in %s\n", opts.log_file);
+    return 1;
+  }
+  printf("read %d samples (gyro %d, accel %d, mag %d, gps %d, baro %d) in %.2fs\n",
+         replay_log.nb_samples,
+         replay_log.nb_by_type[REPLAY_GYRO], replay_log.nb_by_type[REPLAY_ACCEL],
+         replay_log.nb_by_type[REPLAY_MAG], replay_log.nb_by_type[REPLAY_GPS],
+         replay_log.nb_by_type[REPLAY_BARO], get_time() - t0);
+
+  char **sets;
+  int nb_sets = read_param_sets(opts.params_file, &sets);
+  if (nb_sets <= 0) {
+    return 1;
+  }
+
+  fflush(stdout);
+  t0 = get_time();
+  int running = 0, failed = 0;
+  for (int run = 0; run < nb_sets; run++) {
+    if (running >= opts.jobs) {
+      int status;
+      wait(&status);
+      running--;
+      if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        failed++;
+      }
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+      exit(replay_run(run, sets[run]) < 0 ? 1 : 0);
+    } else if (pid < 0) {
+      perror("fork");
+      failed++;
+    } else {
+      running++;
+    }
+  }
+  while (running > 0) {
+    int status;
+    wait(&status);
+    running--;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      failed++;
+    }
+  }
+
+  printf("%d runs (%d failed) of %s in %.2fs\n", nb_sets, failed, opts.filter->name, get_time() - t0);
+
+  for (int i = 0; i < nb_sets; i++) {
+    free(sets[i]);
+  }
+  free(sets);
+  replay_log_free(&replay_log);
+  return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,6 @@
+/* board file for the estimator replay, nothing to configure on the host */
+
+#ifndef REPLAY_BOARD_H
+#define REPLAY_BOARD_H
+
+#endif // REPLAY_BOARD_H
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test/ins_replay/replay_filter.h
+ *
+ * Common interface of the estimators that can be replayed.
+ *
+ * Each adapter calls the filter functions directly (no ABI, no
+ * wrapper), so a replay runs as fast as the filter itself.
+ * Callbacks that a filter does not implement are left NULL.
+ */
+
+#ifndef REPLAY_FILTER_H
+#define REPLAY_FILTER_H
+
+#include "std.h"
+#include "math/pprz_algebra_float.h"
+#include "math/pprz_geodetic_float.h"
+#include "replay_log.h"
+
+/** Estimated state written to the output columns */
+struct ReplayOutput {
+  struct FloatQuat quat;        ///< ltp to body (or imu) quaternion
+  struct FloatRates gyro_bias;  ///< rad/s
+  struct NedCoor_f pos;         ///< m, local NED
+  struct NedCoor_f speed;       ///< m/s, local NED
+  struct NedCoor_f wind;        ///< m/s, local NED
+};
+
+struct ReplayFilter {
+  const char *name;
+  void (*init)(void);
+  /** set a tuning parameter, return false if unknown */
+  bool (*set_param)(const char *name, float value);
+  void (*align)(struct FloatRates *gyro, struct FloatVect3 *accel, struct FloatVect3 *mag);
+  void (*propagate)(struct FloatRates *gyro, struct FloatVect3 *accel, float dt);
+  void (*update_accel)(struct FloatVect3 *accel);
+  void (*update_mag)(struct FloatVect3 *mag);
+  void (*update_gps)(struct ReplayGps *gps);
+  void (*update_baro)(float pressure);
+  void (*get_output)(struct ReplayOutput *out);
+};
+
+/** NULL terminated list of available filters */
+extern const struct ReplayFilter *replay_filters[];
+
+extern const struct ReplayFilter *replay_filter_find(const char *name);
+
+#endif /* REPLAY_FILTER_H */
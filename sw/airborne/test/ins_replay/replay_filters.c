@@ -0,0 +1,333 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test/ins_replay/replay_filters.c
+ *
+ * Adapters between the replay engine and the estimators.
+ */
+
+#include "replay_filter.h"
+
+#include <string.h>
+
+#include "state.h"
+#include "math/pprz_isa.h"
+#include "math/pprz_geodetic_double.h"
+#include "subsystems/gps.h"
+#include "subsystems/ahrs/ahrs_float_utils.h"
+#include "subsystems/ahrs/ahrs_float_mlkf.h"
+#include "subsystems/ins/ins_float_invariant.h"
+#include "modules/ins/ins_mekf_wind.h"
+#include "generated/airframe.h"
+
+/* the invariant filter resets the local origin from this one */
+struct GpsState gps;
+
+struct ReplayParam {
+  const char *name;
+  float *value;
+};
+
+static bool replay_set_param(const struct ReplayParam *params, const char *name, float value)
+{
+  for (const struct ReplayParam *p = params; p->name != NULL; p++) {
+    if (strcmp(p->name, name) == 0) {
+      *(p->value) = value;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void replay_gps_state(struct GpsState *gps_s, struct ReplayGps *g)
+{
+  memset(gps_s, 0, sizeof(struct GpsState));
+  gps_s->ecef_pos = g->ecef_pos;
+  gps_s->lla_pos = g->lla_pos;
+  gps_s->hmsl = g->hmsl;
+  gps_s->ecef_vel = g->ecef_vel;
+  gps_s->pacc = g->pacc;
+  gps_s->sacc = g->sacc;
+  gps_s->num_sv = g->num_sv;
+  gps_s->fix = g->fix;
+  SetBit(gps_s->valid_fields, GPS_VALID_POS_ECEF_BIT);
+  SetBit(gps_s->valid_fields, GPS_VALID_POS_LLA_BIT);
+  SetBit(gps_s->valid_fields, GPS_VALID_VEL_ECEF_BIT);
+  SetBit(gps_s->valid_fields, GPS_VALID_HMSL_BIT);
+}
+
+/** body to imu rotation from the airframe file */
+static struct FloatQuat *replay_body_to_imu_quat(void)
+{
+  static struct FloatQuat q_b2i;
+  struct FloatEulers e = { IMU_BODY_TO_IMU_PHI, IMU_BODY_TO_IMU_THETA, IMU_BODY_TO_IMU_PSI };
+  float_quat_of_eulers(&q_b2i, &e);
+  return &q_b2i;
+}
+
+/*
+ * Multiplicative linearized Kalman filter (AHRS only)
+ */
+
+static void mlkf_init(void)
+{
+  ahrs_mlkf_init();
+  ahrs_mlkf_set_body_to_imu_quat(replay_body_to_imu_quat());
+}
+
+static const struct ReplayParam mlkf_params[] = {
+  { "mag_noise_x", &ahrs_mlkf.mag_noise.x },
+  { "mag_noise_y", &ahrs_mlkf.mag_noise.y },
+  { "mag_noise_z", &ahrs_mlkf.mag_noise.z },
+  { "mag_h_x", &ahrs_mlkf.mag_h.x },
+  { "mag_h_y", &ahrs_mlkf.mag_h.y },
+  { "mag_h_z", &ahrs_mlkf.mag_h.z },
+  { NULL, NULL }
+};
+
+static bool mlkf_set_param(const char *name, float value)
+{
+  return replay_set_param(mlkf_params, name, value);
+}
+
+static void mlkf_align(struct FloatRates *gyro, struct FloatVect3 *accel, struct FloatVect3 *mag)
+{
+  ahrs_mlkf_align(gyro, accel, mag);
+}
+
+static void mlkf_propagate(struct FloatRates *gyro, struct FloatVect3 *accel __attribute__((unused)), float dt)
+{
+  ahrs_mlkf_propagate(gyro, dt);
+}
+
+static void mlkf_get_output(struct ReplayOutput *out)
+{
+  memset(out, 0, sizeof(struct ReplayOutput));
+  struct FloatQuat *body_to_imu_quat = orientationGetQuat_f(&ahrs_mlkf.body_to_imu);
+  float_quat_comp_inv(&out->quat, &ahrs_mlkf.ltp_to_imu_quat, body_to_imu_quat);
+  out->gyro_bias = ahrs_mlkf.gyro_bias;
+}
+
+static const struct ReplayFilter replay_mlkf = {
+  .name = "mlkf",
+  .init = mlkf_init,
+  .set_param = mlkf_set_param,
+  .align = mlkf_align,
+  .propagate = mlkf_propagate,
+  .update_accel = ahrs_mlkf_update_accel,
+  .update_mag = ahrs_mlkf_update_mag,
+  .update_gps = NULL,
+  .update_baro = NULL,
+  .get_output = mlkf_get_output
+};
+
+/*
+ * Invariant filter
+ */
+
+static const struct ReplayParam invariant_params[] = {
+  { "lv", &ins_float_inv.gains.lv },
+  { "lb", &ins_float_inv.gains.lb },
+  { "mv", &ins_float_inv.gains.mv },
+  { "mvz", &ins_float_inv.gains.mvz },
+  { "mh", &ins_float_inv.gains.mh },
+  { "nx", &ins_float_inv.gains.nx },
+  { "nxz", &ins_float_inv.gains.nxz },
+  { "nh", &ins_float_inv.gains.nh },
+  { "ov", &ins_float_inv.gains.ov },
+  { "ob", &ins_float_inv.gains.ob },
+  { "rv", &ins_float_inv.gains.rv },
+  { "rh", &ins_float_inv.gains.rh },
+  { "sh", &ins_float_inv.gains.sh },
+  { NULL, NULL }
+};
+
+static bool invariant_set_param(const char *name, float value)
+{
+  return replay_set_param(invariant_params, name, value);
+}
+
+static void invariant_update_gps(struct ReplayGps *g)
+{
+  replay_gps_state(&gps, g);
+  if (gps.fix >= GPS_FIX_3D && !state.ned_initialized_i) {
+    ins_reset_local_origin();
+  }
+  ins_float_invariant_update_gps(&gps);
+}
+
+static void invariant_get_output(struct ReplayOutput *out)
+{
+  memset(out, 0, sizeof(struct ReplayOutput));
+  out->quat = ins_float_inv.state.quat;
+  out->gyro_bias = ins_float_inv.state.bias;
+  out->pos = ins_float_inv.state.pos;
+  out->speed = ins_float_inv.state.speed;
+}
+
+static void invariant_init(void)
+{
+  stateInit();
+  ins_float_invariant_init();
+  ins_float_inv_set_body_to_imu_quat(replay_body_to_imu_quat());
+}
+
+static const struct ReplayFilter replay_invariant = {
+  .name = "invariant",
+  .init = invariant_init,
+  .set_param = invariant_set_param,
+  .align = ins_float_invariant_align,
+  .propagate = ins_float_invariant_propagate,
+  .update_accel = NULL,
+  .update_mag = ins_float_invariant_update_mag,
+  .update_gps = invariant_update_gps,
+  .update_baro = ins_float_invariant_update_baro,
+  .get_output = invariant_get_output
+};
+
+/*
+ * MEKF with wind estimation
+ */
+
+static const struct ReplayParam mekf_wind_params[] = {
+  { "Q_gyro", &ins_mekf_wind_params.Q_gyro },
+  { "Q_accel", &ins_mekf_wind_params.Q_accel },
+  { "Q_rates_bias", &ins_mekf_wind_params.Q_rates_bias },
+  { "Q_accel_bias", &ins_mekf_wind_params.Q_accel_bias },
+  { "Q_baro_bias", &ins_mekf_wind_params.Q_baro_bias },
+  { "Q_wind", &ins_mekf_wind_params.Q_wind },
+  { "R_speed", &ins_mekf_wind_params.R_speed },
+  { "R_pos", &ins_mekf_wind_params.R_pos },
+  { "R_speed_z", &ins_mekf_wind_params.R_speed_z },
+  { "R_pos_z", &ins_mekf_wind_params.R_pos_z },
+  { "R_mag", &ins_mekf_wind_params.R_mag },
+  { "R_baro", &ins_mekf_wind_params.R_baro },
+  { "R_airspeed", &ins_mekf_wind_params.R_airspeed },
+  { NULL, NULL }
+};
+
+static struct LtpDef_d mekf_wind_ltp;
+static bool mekf_wind_ltp_initialized;
+static float mekf_wind_qfe;
+
+static void mekf_wind_init(void)
+{
+  ins_mekf_wind_init();
+  const struct FloatVect3 mag_h = { AHRS_H_X, AHRS_H_Y, AHRS_H_Z };
+  ins_mekf_wind_set_mag_h(&mag_h);
+  mekf_wind_ltp_initialized = false;
+  mekf_wind_qfe = 0.f;
+}
+
+static bool mekf_wind_set_param(const char *name, float value)
+{
+  if (replay_set_param(mekf_wind_params, name, value)) {
+    ins_mekf_wind_update_params();
+    return true;
+  }
+  if (strcmp(name, "disable_wind") == 0) {
+    ins_mekf_wind_params.disable_wind = (value != 0.f);
+    ins_mekf_wind_update_params();
+    return true;
+  }
+  return false;
+}
+
+static void mekf_wind_align(struct FloatRates *gyro, struct FloatVect3 *accel, struct FloatVect3 *mag)
+{
+  struct FloatQuat quat;
+  ahrs_float_get_quat_from_accel_mag(&quat, accel, mag);
+  ins_mekf_wind_align(gyro, &quat);
+}
+
+static void mekf_wind_update_mag(struct FloatVect3 *mag)
+{
+  ins_mekf_wind_update_mag(mag, false);
+}
+
+static void mekf_wind_update_gps(struct ReplayGps *g)
+{
+  if (g->fix < GPS_FIX_3D) {
+    return;
+  }
+  /* double precision for ECEF coordinates, float is not enough here */
+  struct EcefCoor_d ecef_pos, ecef_vel;
+  VECT3_SDIV(ecef_pos, g->ecef_pos, 100.);
+  VECT3_SDIV(ecef_vel, g->ecef_vel, 100.);
+  if (!mekf_wind_ltp_initialized) {
+    ltp_def_from_ecef_d(&mekf_wind_ltp, &ecef_pos);
+    mekf_wind_ltp_initialized = true;
+  }
+  struct NedCoor_d pos_d, speed_d;
+  ned_of_ecef_point_d(&pos_d, &mekf_wind_ltp, &ecef_pos);
+  ned_of_ecef_vect_d(&speed_d, &mekf_wind_ltp, &ecef_vel);
+  struct FloatVect3 pos, speed;
+  VECT3_COPY(pos, pos_d);
+  VECT3_COPY(speed, speed_d);
+  ins_mekf_wind_update_pos_speed(&pos, &speed);
+}
+
+static void mekf_wind_update_baro(float pressure)
+{
+  if (mekf_wind_qfe == 0.f) {
+    mekf_wind_qfe = pressure;
+  }
+  ins_mekf_wind_update_baro(pprz_isa_height_of_pressure(pressure, mekf_wind_qfe));
+}
+
+static void mekf_wind_get_output(struct ReplayOutput *out)
+{
+  out->quat = ins_mekf_wind_get_quat();
+  out->gyro_bias = ins_mekf_wind_get_rates_bias();
+  out->pos = ins_mekf_wind_get_pos_ned();
+  out->speed = ins_mekf_wind_get_speed_ned();
+  out->wind = ins_mekf_wind_get_wind_ned();
+}
+
+static const struct ReplayFilter replay_mekf_wind = {
+  .name = "mekf_wind",
+  .init = mekf_wind_init,
+  .set_param = mekf_wind_set_param,
+  .align = mekf_wind_align,
+  .propagate = ins_mekf_wind_propagate,
+  .update_accel = NULL,
+  .update_mag = mekf_wind_update_mag,
+  .update_gps = mekf_wind_update_gps,
+  .update_baro = mekf_wind_update_baro,
+  .get_output = mekf_wind_get_output
+};
+
+const struct ReplayFilter *replay_filters[] = {
+  &replay_mlkf,
+  &replay_invariant,
+  &replay_mekf_wind,
+  NULL
+};
+
+const struct ReplayFilter *replay_filter_find(const char *name)
+{
+  for (int i = 0; replay_filters[i] != NULL; i++) {
+    if (strcmp(replay_filters[i]->name, name) == 0) {
+      return replay_filters[i];
+    }
+  }
+  return NULL;
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test/ins_replay/replay_log.c
+ *
+ * Decoder for the sensor messages of a paparazzi .data flight log.
+ *
+ * A .data line is "<time> <ac_id> <MSG_NAME> <field> <field> ...".
+ */
+
+#include "replay_log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_LINE_LEN 1024
+
+static int replay_log_push(struct ReplayLog *log, struct ReplaySample *s)
+{
+  if (log->nb_samples >= log->nb_allocated) {
+    int n = log->nb_allocated > 0 ? 2 * log->nb_allocated : 65536;
+    struct ReplaySample *tmp = realloc(log->samples, n * sizeof(struct ReplaySample));
+    if (tmp == NULL) {
+      return -1;
+    }
+    log->samples = tmp;
+    log->nb_allocated = n;
+  }
+  log->samples[log->nb_samples++] = *s;
+  log->nb_by_type[s->type]++;
+  return 0;
+}
+
+/* stable merge of the sorted runs [lo, mid) and [mid, hi) of src into dst:
+ * samples with the same time keep their order in the log */
+static void replay_merge(struct ReplaySample *dst, const struct ReplaySample *src, int lo, int mid, int hi)
+{
+  int i = lo, j = mid;
+  for (int k = lo; k < hi; k++) {
+    if (i < mid && (j >= hi || src[i].time <= src[j].time)) {
+      dst[k] = src[i++];
+    } else {
+      dst[k] = src[j++];
+    }
+  }
+}
+
+/* order on time, only needed when the log was merged from several sources,
+ * bottom-up merge sort as the order of simultaneous samples matters */
+static int replay_log_sort(struct ReplayLog *log)
+{
+  const int n = log->nb_samples;
+  struct ReplaySample *tmp = malloc(n * sizeof(struct ReplaySample));
+  if (tmp == NULL) {
+    return -1;
+  }
+  struct ReplaySample *src = log->samples, *dst = tmp;
+  for (int width = 1; width < n; width *= 2) {
+    for (int lo = 0; lo < n; lo += 2 * width) {
+      const int mid = Min(lo + width, n);
+      const int hi = Min(lo + 2 * width, n);
+      replay_merge(dst, src, lo, mid, hi);
+    }
+    struct ReplaySample *t = src;
+    src = dst;
+    dst = t;
+  }
+  if (src != log->samples) {
+    memcpy(log->samples, src, n * sizeof(struct ReplaySample));
+  }
+  free(tmp);
+  return 0;
+}
+
+static bool replay_log_is_sorted(struct ReplayLog *log)
+{
+  for (int i = 1; i < log->nb_samples; i++) {
+    if (log->samples[i].time < log->samples[i - 1].time) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool replay_decode(struct ReplaySample *s, const char *name, const char *fields)
+{
+  int32_t v[18];
+  if (strcmp(name, "IMU_GYRO_SCALED") == 0) {
+    if (sscanf(fields, "%d %d %d", &v[0], &v[1], &v[2]) != 3) { return false; }
+    s->type = REPLAY_GYRO;
+    RATES_ASSIGN(s->u.gyro, RATE_FLOAT_OF_BFP(v[0]), RATE_FLOAT_OF_BFP(v[1]), RATE_FLOAT_OF_BFP(v[2]));
+  } else if (strcmp(name, "IMU_ACCEL_SCALED") == 0) {
+    if (sscanf(fields, "%d %d %d", &v[0], &v[1], &v[2]) != 3) { return false; }
+    s->type = REPLAY_ACCEL;
+    VECT3_ASSIGN(s->u.accel, ACCEL_FLOAT_OF_BFP(v[0]), ACCEL_FLOAT_OF_BFP(v[1]), ACCEL_FLOAT_OF_BFP(v[2]));
+  } else if (strcmp(name, "IMU_MAG_SCALED") == 0) {
+    if (sscanf(fields, "%d %d %d", &v[0], &v[1], &v[2]) != 3) { return false; }
+    s->type = REPLAY_MAG;
+    VECT3_ASSIGN(s->u.mag, MAG_FLOAT_OF_BFP(v[0]), MAG_FLOAT_OF_BFP(v[1]), MAG_FLOAT_OF_BFP(v[2]));
+  } else if (strcmp(name, "GPS_INT") == 0) {
+    /* ecef_x ecef_y ecef_z lat lon alt hmsl ecef_xd ecef_yd ecef_zd pacc sacc tow pdop numsv fix */
+    if (sscanf(fields, "%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d",
+               &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8], &v[9],
+               &v[10], &v[11], &v[12], &v[13], &v[14], &v[15]) != 16) {
+      return false;
+    }
+    s->type = REPLAY_GPS;
+    VECT3_ASSIGN(s->u.gps.ecef_pos, v[0], v[1], v[2]);
+    LLA_ASSIGN(s->u.gps.lla_pos, v[3], v[4], v[5]);
+    s->u.gps.hmsl = v[6];
+    VECT3_ASSIGN(s->u.gps.ecef_vel, v[7], v[8], v[9]);
+    s->u.gps.pacc = v[10];
+    s->u.gps.sacc = v[11];
+    s->u.gps.num_sv = v[14];
+    s->u.gps.fix = v[15];
+  } else if (strcmp(name, "BARO_RAW") == 0) {
+    float abs_p;
+    if (sscanf(fields, "%f", &abs_p) != 1) { return false; }
+    s->type = REPLAY_BARO;
+    s->u.pressure = abs_p;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+int replay_log_read(struct ReplayLog *log, const char *filename, int ac_id)
+{
+  FILE *fd = fopen(filename, "r");
+  if (fd == NULL) {
+    return -1;
+  }
+
+  char line[REPLAY_LINE_LEN];
+  char name[64];
+  while (fgets(line, sizeof(line), fd) != NULL) {
+    struct ReplaySample s;
+    int id, offset = 0;
+    if (sscanf(line, "%lf %d %63s %n", &s.time, &id, name, &offset) != 3) {
+      continue;
+    }
+    if (ac_id < 0) {
+      ac_id = id;
+    } else if (id != ac_id) {
+      continue;
+    }
+    if (replay_decode(&s, name, line + offset)) {
+      if (replay_log_push(log, &s) != 0) {
+        fclose(fd);
+        return -1;
+      }
+    }
+  }
+  fclose(fd);
+
+  if (!replay_log_is_sorted(log) && replay_log_sort(log) != 0) {
+    return -1;
+  }
+  return log->nb_samples;
+}
+
+void replay_log_free(struct ReplayLog *log)
+{
+  free(log->samples);
+  memset(log, 0, sizeof(struct ReplayLog));
+}
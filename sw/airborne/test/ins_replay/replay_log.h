@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test/ins_replay/replay_log.h
+ *
+ * Sensor samples decoded from a paparazzi flight log (.data file).
+ *
+ * Only the messages needed to feed the estimators are kept:
+ * IMU_GYRO_SCALED, IMU_ACCEL_SCALED, IMU_MAG_SCALED, GPS_INT and BARO_RAW.
+ * Samples are stored in a single array sorted by timestamp so that replays
+ * only have to walk it linearly.
+ */
+
+#ifndef REPLAY_LOG_H
+#define REPLAY_LOG_H
+
+#include "std.h"
+#include "math/pprz_algebra_float.h"
+#include "math/pprz_geodetic_int.h"
+
+enum ReplaySampleType {
+  REPLAY_GYRO,
+  REPLAY_ACCEL,
+  REPLAY_MAG,
+  REPLAY_GPS,
+  REPLAY_BARO
+};
+
+/** GPS_INT content, in the integer units of the message */
+struct ReplayGps {
+  struct EcefCoor_i ecef_pos;   ///< cm
+  struct LlaCoor_i lla_pos;     ///< 1e7 deg, mm
+  int32_t hmsl;                 ///< mm
+  struct EcefCoor_i ecef_vel;   ///< cm/s
+  uint32_t pacc;                ///< cm
+  uint32_t sacc;                ///< cm/s
+  uint8_t num_sv;
+  uint8_t fix;
+};
+
+struct ReplaySample {
+  double time;                  ///< log time in seconds
+  enum ReplaySampleType type;
+  union {
+    struct FloatRates gyro;     ///< rad/s
+    struct FloatVect3 accel;    ///< m/s^2
+    struct FloatVect3 mag;      ///< normalized unit
+    struct ReplayGps gps;
+    float pressure;             ///< Pa
+  } u;
+};
+
+struct ReplayLog {
+  struct ReplaySample *samples;
+  int nb_samples;
+  int nb_allocated;
+  int nb_by_type[REPLAY_BARO + 1];
+};
+
+/** Read a .data flight log.
+ * @param log destination, must be zero initialized
+ * @param filename path to the .data file
+ * @param ac_id aircraft id to keep, or -1 to keep the first one seen
+ * @return number of samples read, -1 on error
+ */
+extern int replay_log_read(struct ReplayLog *log, const char *filename, int ac_id);
+
+extern void replay_log_free(struct ReplayLog *log);
+
+#endif /* REPLAY_LOG_H */
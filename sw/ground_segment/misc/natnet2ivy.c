@@ -44,6 +44,7 @@
 #include "arch/linux/udp_socket.h"
 #include "math/pprz_geodetic_double.h"
 #include "math/pprz_algebra_double.h"
+#include "natnet_fast.h"
 
 /** Debugging options */
 uint8_t verbose = 0;
@@ -76,6 +77,15 @@ uint32_t freq_transmit          = 30;     ///< Transmitting frequency in Hz
 uint16_t min_velocity_samples   = 4;      ///< The amount of position samples needed for a valid velocity
 bool small_packets              = FALSE;
 
+/** Fast path, one UDP datagram of REMOTE_GPS_LOCAL frames per NatNet frame */
+bool fast_enabled               = FALSE;
+char *fast_addr                 = "239.255.42.100"; ///< multicast or unicast destination
+uint16_t fast_port              = 5010;
+double fast_vel_tau             = 0.02;   ///< time constant of the velocity low-pass filter in seconds
+char *fast_messages             = NULL;   ///< messages.xml, $PAPARAZZI_HOME/var/messages.xml by default
+struct UdpSocket fast_sock;
+struct NatNetFastMsg fast_msg;
+
 /** Connection timeout when not receiving **/
 #define CONNECTION_TIMEOUT          .5
 
@@ -111,6 +121,7 @@ struct RigidBody {
   int nVelocitySamples;             ///< Number of velocity samples gathered
   int totalVelocitySamples;         ///< Total amount of velocity samples possible
   int nVelocityTransmit;            ///< Amount of transmits since last valid velocity transmit
+  bool tracked;                     ///< Rigid body tracked in the last frame
 };
 struct RigidBody rigidBodies[MAX_RIGIDBODIES];    ///< All rigid bodies which are tracked
 
@@ -119,6 +130,13 @@ struct Aircraft {
   uint8_t ac_id;
   float lastSample;
   bool connected;
+  uint16_t decim;                   ///< Fast path: send one frame out of decim
+  uint16_t decim_cnt;               ///< Fast path: frames since last send
+  bool pos_init;                    ///< Fast path: previous position is valid
+  bool vel_valid;                   ///< Fast path: velocity has been differentiated
+  double last_t;                    ///< Fast path: NatNet time of the previous position
+  struct EnuCoor_d last_pos;        ///< Fast path: previous ENU position
+  struct EnuCoor_d vel;             ///< Fast path: filtered ENU velocity
 };
 struct Aircraft aircrafts[MAX_RIGIDBODIES];                  ///< Mapping from rigid body ID to aircraft ID
 
@@ -132,6 +150,100 @@ double tracking_offset_angle;       ///< The offset from the tracking system to
 /** Save the latency from natnet */
 float natnet_latency;
 
+/** Time of week in ms from the local clock */
+static uint32_t get_tow(void)
+{
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  struct tm *ts = localtime(&now.tv_sec);
+
+  return ts->tm_wday * (24 * 60 * 60 * 1000) + ts->tm_hour * (60 * 60 * 1000) + ts->tm_min *
+         (60 * 1000) + ts->tm_sec * 1000 + now.tv_usec / 1000 ;
+}
+
+/** Send the REMOTE_GPS_LOCAL frames of all the aircraft due for this frame in a single datagram
+ * Velocities are differentiated at the NatNet rate using the frame timestamps
+ * and low-pass filtered, independently of the Ivy monitor output.
+ */
+static void natnet_fast_send(double timestamp, int nRigidBodies)
+{
+  static struct NatNetFastBatch batch;
+  const double ca = cos(tracking_offset_angle);
+  const double sa = sin(tracking_offset_angle);
+  uint32_t tow = get_tow();
+  int j;
+
+  natnet_fast_batch_reset(&batch);
+  for (j = 0; j < nRigidBodies; j++) {
+    struct RigidBody *rb = &rigidBodies[j];
+    if (rb->id < 0 || rb->id >= MAX_RIGIDBODIES || aircrafts[rb->id].ac_id == 0) {
+      continue;
+    }
+    struct Aircraft *ac = &aircrafts[rb->id];
+
+    // Only fresh poses are sent, the aircraft would take a lost one for a new fix
+    if (!rb->tracked) {
+      continue;
+    }
+
+    // Rotate the position by the Optitrack angle
+    struct EnuCoor_d pos;
+    pos.x = ca * rb->x - sa * rb->y;
+    pos.y = sa * rb->x + ca * rb->y;
+    pos.z = rb->z;
+
+    // Differentiate on every tracked frame
+    double dt = timestamp - ac->last_t;
+    if (ac->pos_init && dt > 0. && dt < CONNECTION_TIMEOUT) {
+      double alpha = dt / (fast_vel_tau + dt);
+      if (!ac->vel_valid) {
+        alpha = 1.;
+      }
+      ac->vel.x += alpha * ((pos.x - ac->last_pos.x) / dt - ac->vel.x);
+      ac->vel.y += alpha * ((pos.y - ac->last_pos.y) / dt - ac->vel.y);
+      ac->vel.z += alpha * ((pos.z - ac->last_pos.z) / dt - ac->vel.z);
+      ac->vel_valid = TRUE;
+    } else {
+      // first sample or tracking lost for too long
+      ac->vel.x = ac->vel.y = ac->vel.z = 0.;
+      ac->vel_valid = FALSE;
+    }
+    ac->pos_init = TRUE;
+    ac->last_pos = pos;
+    ac->last_t = timestamp;
+
+    // Decimation per aircraft, wait for a velocity
+    if (++ac->decim_cnt < ac->decim || !ac->vel_valid) {
+      continue;
+    }
+    ac->decim_cnt = 0;
+
+    struct DoubleQuat orient = { rb->qw, rb->qx, rb->qy, rb->qz };
+    struct DoubleEulers orient_eulers;
+    double_eulers_of_quat(&orient_eulers, &orient);
+    double course = -orient_eulers.psi + 90.0 / 57.6 - tracking_offset_angle;
+    NormRadAngle(course);
+
+    struct NatNetFastPose pose = {
+      .ac_id = ac->ac_id,
+      .tow = tow,
+      .enu_pos = { pos.x, pos.y, pos.z },
+      .enu_vel = { ac->vel.x, ac->vel.y, ac->vel.z },
+      .course = course
+    };
+    if (natnet_fast_batch_add(&batch, &fast_msg, &pose) != 0) {
+      // more aircraft than fit in one MTU, start a new datagram
+      udp_socket_send_dontwait(&fast_sock, batch.buf, batch.len);
+      natnet_fast_batch_reset(&batch);
+      natnet_fast_batch_add(&batch, &fast_msg, &pose);
+    }
+  }
+
+  if (batch.nb > 0) {
+    udp_socket_send_dontwait(&fast_sock, batch.buf, batch.len);
+  }
+}
+
 /** Parse the packet from NatNet */
 void natnet_parse(unsigned char *in)
 {
@@ -253,48 +365,32 @@ void natnet_parse(unsigned char *in)
         rigidBodies[j].posSampled = FALSE;
       }
 
-      // Associated marker positions
+      // Associated marker positions, IDs and sizes are only printed from the packet
       memcpy(&rigidBodies[j].nMarkers, ptr, 4); ptr += 4;
       printf_natnet("Marker Count: %d\n", rigidBodies[j].nMarkers);
-      int nBytes = rigidBodies[j].nMarkers * 3 * sizeof(float);
-      float *markerData = (float *)malloc(nBytes);
-      memcpy(markerData, ptr, nBytes);
-      ptr += nBytes;
+      char *markerData = ptr;
+      ptr += rigidBodies[j].nMarkers * 3 * sizeof(float);
 
       if (natnet_major >= 2) {
-        // Associated marker IDs
-        nBytes = rigidBodies[j].nMarkers * sizeof(int);
-        int *markerIDs = (int *)malloc(nBytes);
-        memcpy(markerIDs, ptr, nBytes);
-        ptr += nBytes;
-
-        // Associated marker sizes
-        nBytes = rigidBodies[j].nMarkers * sizeof(float);
-        float *markerSizes = (float *)malloc(nBytes);
-        memcpy(markerSizes, ptr, nBytes);
-        ptr += nBytes;
-
-        for (k = 0; k < rigidBodies[j].nMarkers; k++) {
-          printf_natnet("\tMarker %d: id=%d\tsize=%3.1f\tpos=[%3.2f,%3.2f,%3.2f]\n", k, markerIDs[k], markerSizes[k],
-                        markerData[k * 3], markerData[k * 3 + 1], markerData[k * 3 + 2]);
-        }
-
-        if (markerIDs) {
-          free(markerIDs);
-        }
-        if (markerSizes) {
-          free(markerSizes);
+        char *markerIDs = ptr;
+        ptr += rigidBodies[j].nMarkers * sizeof(int);
+        char *markerSizes = ptr;
+        ptr += rigidBodies[j].nMarkers * sizeof(float);
+
+        for (k = 0; verbose > 1 && k < rigidBodies[j].nMarkers; k++) {
+          int id; float size, m[3];
+          memcpy(&id, markerIDs + k * 4, 4);
+          memcpy(&size, markerSizes + k * 4, 4);
+          memcpy(m, markerData + k * 12, 12);
+          printf_natnet("\tMarker %d: id=%d\tsize=%3.1f\tpos=[%3.2f,%3.2f,%3.2f]\n", k, id, size, m[0], m[1], m[2]);
         }
-
       } else {
-        for (k = 0; k < rigidBodies[j].nMarkers; k++) {
-          printf_natnet("\tMarker %d: pos = [%3.2f,%3.2f,%3.2f]\n", k, markerData[k * 3], markerData[k * 3 + 1],
-                        markerData[k * 3 + 2]);
+        for (k = 0; verbose > 1 && k < rigidBodies[j].nMarkers; k++) {
+          float m[3];
+          memcpy(m, markerData + k * 12, 12);
+          printf_natnet("\tMarker %d: pos = [%3.2f,%3.2f,%3.2f]\n", k, m[0], m[1], m[2]);
         }
       }
-      if (markerData) {
-        free(markerData);
-      }
 
       if (natnet_major >= 2) {
         // Mean marker error
@@ -306,7 +402,10 @@ void natnet_parse(unsigned char *in)
       if (((natnet_major == 2) && (natnet_minor >= 6)) || (natnet_major > 2) || (natnet_major == 0)) {
         // params
         short params = 0; memcpy(&params, ptr, 2); ptr += 2;
-//           bool bTrackingValid = params & 0x01; // 0x01 : rigid body was successfully tracked in this frame
+        // 0x01 : rigid body was successfully tracked in this frame
+        rigidBodies[j].tracked = (params & 0x01);
+      } else {
+        rigidBodies[j].tracked = rigidBodies[j].posSampled;
       }
     } // next rigid body
 
@@ -321,10 +420,11 @@ void natnet_parse(unsigned char *in)
         int skeletonID = 0;
         memcpy(&skeletonID, ptr, 4); ptr += 4;
         // # of rigid bodies (bones) in skeleton
-        int nRigidBodies = 0;
-        memcpy(&nRigidBodies, ptr, 4); ptr += 4;
-        printf_natnet("Rigid Body Count : %d\n", nRigidBodies);
-        for (j = 0; j < nRigidBodies; j++) {
+        int nBones = 0;
+        memcpy(&nBones, ptr, 4); ptr += 4;
+        printf_natnet("Rigid Body Count : %d\n", nBones);
+        int b;
+        for (b = 0; b < nBones; b++) {
           // Rigid body pos/ori
           int ID = 0; memcpy(&ID, ptr, 4); ptr += 4;
           float x = 0.0f; memcpy(&x, ptr, 4); ptr += 4;
@@ -338,29 +438,22 @@ void natnet_parse(unsigned char *in)
           printf_natnet("pos: [%3.2f,%3.2f,%3.2f]\n", x, y, z);
           printf_natnet("ori: [%3.2f,%3.2f,%3.2f,%3.2f]\n", qx, qy, qz, qw);
 
-          // Associated marker positions
+          // Associated marker positions, IDs and sizes
           int nRigidMarkers = 0;  memcpy(&nRigidMarkers, ptr, 4); ptr += 4;
           printf_natnet("Marker Count: %d\n", nRigidMarkers);
-          int nBytes = nRigidMarkers * 3 * sizeof(float);
-          float *markerData = (float *)malloc(nBytes);
-          memcpy(markerData, ptr, nBytes);
-          ptr += nBytes;
-
-          // Associated marker IDs
-          nBytes = nRigidMarkers * sizeof(int);
-          int *markerIDs = (int *)malloc(nBytes);
-          memcpy(markerIDs, ptr, nBytes);
-          ptr += nBytes;
-
-          // Associated marker sizes
-          nBytes = nRigidMarkers * sizeof(float);
-          float *markerSizes = (float *)malloc(nBytes);
-          memcpy(markerSizes, ptr, nBytes);
-          ptr += nBytes;
-
-          for (k = 0; k < nRigidMarkers; k++) {
-            printf_natnet("\tMarker %d: id=%d\tsize=%3.1f\tpos=[%3.2f,%3.2f,%3.2f]\n", k, markerIDs[k], markerSizes[k],
-                          markerData[k * 3], markerData[k * 3 + 1], markerData[k * 3 + 2]);
+          char *markerData = ptr;
+          ptr += nRigidMarkers * 3 * sizeof(float);
+          char *markerIDs = ptr;
+          ptr += nRigidMarkers * sizeof(int);
+          char *markerSizes = ptr;
+          ptr += nRigidMarkers * sizeof(float);
+
+          for (k = 0; verbose > 1 && k < nRigidMarkers; k++) {
+            int id; float size, m[3];
+            memcpy(&id, markerIDs + k * 4, 4);
+            memcpy(&size, markerSizes + k * 4, 4);
+            memcpy(m, markerData + k * 12, 12);
+            printf_natnet("\tMarker %d: id=%d\tsize=%3.1f\tpos=[%3.2f,%3.2f,%3.2f]\n", k, id, size, m[0], m[1], m[2]);
           }
 
           // Mean marker error (2.0 and later)
@@ -375,17 +468,6 @@ void natnet_parse(unsigned char *in)
             short params = 0; memcpy(&params, ptr, 2); ptr += 2;
             //bool bTrackingValid = params & 0x01; // 0x01 : rigid body was successfully tracked in this frame
           }
-
-          // Release resources
-          if (markerIDs) {
-            free(markerIDs);
-          }
-          if (markerSizes) {
-            free(markerSizes);
-          }
-          if (markerData) {
-            free(markerData);
-          }
         } // next rigid body
       } // next skeleton
     }
@@ -472,6 +554,10 @@ void natnet_parse(unsigned char *in)
     // End of data tag
     int eod = 0; memcpy(&eod, ptr, 4); ptr += 4;
     printf_natnet("End Packet\n-------------\n");
+
+    if (fast_enabled) {
+      natnet_fast_send(timestamp, nRigidBodies);
+    }
   }
 }
 
@@ -572,12 +658,7 @@ gboolean timeout_transmit_callback(gpointer data)
 
 
     /* Construct time of time of week (tow) */
-    struct timeval now;
-    gettimeofday(&now, NULL);
-    struct tm *ts = localtime(&now.tv_sec);
-
-    uint32_t tow = ts->tm_wday * (24 * 60 * 60 * 1000) + ts->tm_hour * (60 * 60 * 1000) + ts->tm_min *
-                   (60 * 1000) + ts->tm_sec * 1000 + now.tv_usec / 1000 ;
+    uint32_t tow = get_tow();
 
     // Transmit the REMOTE_GPS packet on the ivy bus (either small or big)
     if (small_packets) {
@@ -760,6 +841,13 @@ void print_help(char *filename)
     "   -vel_samples <samples>    Minimum amount of samples for the velocity differentiator (4)\n"
     "   -small                    Send small packets instead of bigger (FALSE)\n\n"
 
+    "   -fast <ip> <port>         Send the REMOTE_GPS_LOCAL of all aircraft of a NatNet frame in one\n"
+    "                             UDP datagram to the aircraft datalink port (multicast or unicast),\n"
+    "                             Ivy is then a low-rate monitor (5Hz)\n"
+    "   -messages <file>          Fast path: messages.xml ($PAPARAZZI_HOME/var/messages.xml)\n"
+    "   -decim <rigid_id> <n>     Fast path: send one NatNet frame out of n for this rigid (1)\n"
+    "   -vel_tau <seconds>        Fast path: velocity filter time constant (0.02)\n\n"
+
     "   -ivy_bus <address:port>   Ivy bus address and port (127.255.255.255:2010)\n";
   fprintf(stderr, usage, filename);
 }
@@ -778,6 +866,7 @@ void check_argcount(int argc, char **argv, int i, int expected)
 static void parse_options(int argc, char **argv)
 {
   int i, count_ac = 0;
+  bool tf_set = FALSE;
   for (i = 1; i < argc; ++i) {
 
     // Print help
@@ -880,6 +969,7 @@ static void parse_options(int argc, char **argv)
       check_argcount(argc, argv, i, 1);
 
       freq_transmit = atoi(argv[++i]);
+      tf_set = TRUE;
     }
     // Set the minimum amount of velocity samples for the differentiator
     else if (strcmp(argv[i], "-vel_samples") == 0) {
@@ -892,6 +982,43 @@ static void parse_options(int argc, char **argv)
       small_packets = TRUE;
     }
 
+    // Enable the binary fast path
+    else if (strcmp(argv[i], "-fast") == 0) {
+      check_argcount(argc, argv, i, 2);
+
+      fast_addr = argv[++i];
+      fast_port = atoi(argv[++i]);
+      fast_enabled = TRUE;
+      if (!tf_set) {
+        freq_transmit = 5;
+      }
+    }
+    // Set the messages definition of the fast path
+    else if (strcmp(argv[i], "-messages") == 0) {
+      check_argcount(argc, argv, i, 1);
+
+      fast_messages = argv[++i];
+    }
+    // Set the fast path decimation of a rigid body
+    else if (strcmp(argv[i], "-decim") == 0) {
+      check_argcount(argc, argv, i, 2);
+
+      int rigid_id = atoi(argv[++i]);
+      int decim = atoi(argv[++i]);
+      if (rigid_id < 0 || rigid_id >= MAX_RIGIDBODIES || decim < 1) {
+        fprintf(stderr, "Invalid rigid body ID or decimation\n\n");
+        print_help(argv[0]);
+        exit(EXIT_FAILURE);
+      }
+      aircrafts[rigid_id].decim = decim;
+    }
+    // Set the fast path velocity filter time constant
+    else if (strcmp(argv[i], "-vel_tau") == 0) {
+      check_argcount(argc, argv, i, 1);
+
+      fast_vel_tau = atof(argv[++i]);
+    }
+
     // Set the ivy bus
     else if (strcmp(argv[i], "-ivy_bus") == 0) {
       check_argcount(argc, argv, i, 1);
@@ -941,6 +1068,17 @@ int main(int argc, char **argv)
   udp_socket_create(&natnet_cmd, natnet_addr, natnet_cmd_port, 0, 1);
   udp_socket_set_recvbuf(&natnet_cmd, 0x100000); // 1MB
 
+  if (fast_enabled) {
+    if (natnet_fast_load(&fast_msg, fast_messages) != 0) {
+      exit(EXIT_FAILURE);
+    }
+    printf_debug("Starting fast path output (address: %s, port: %d)\n", fast_addr, fast_port);
+    if (udp_socket_create(&fast_sock, fast_addr, fast_port, -1, 1) < 0) {
+      fprintf(stderr, "Could not create fast path socket to %s:%d\n", fast_addr, fast_port);
+      exit(EXIT_FAILURE);
+    }
+  }
+
   // Create the Ivy Client
   GMainLoop *ml =  g_main_loop_new(NULL, FALSE);
   IvyInit("natnet2ivy", "natnet2ivy READY", 0, 0, 0, 0);
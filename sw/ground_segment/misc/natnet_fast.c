@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/** \file natnet_fast.c
+*  \brief Batched REMOTE_GPS_LOCAL frames of the natnet2ivy fast path
+*/
+
+#include "natnet_fast.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libxml/parser.h>
+#include <libxml/tree.h>
+
+/** Pose value written in a field, unknown fields (e.g. padding) are zero */
+enum natnet_fast_field {
+  F_ZERO,
+  F_AC_ID,
+  F_ENU_X, F_ENU_Y, F_ENU_Z,
+  F_ENU_XD, F_ENU_YD, F_ENU_ZD,
+  F_TOW,
+  F_COURSE
+};
+
+static const char *field_names[] = {
+  NULL, "ac_id", "enu_x", "enu_y", "enu_z", "enu_xd", "enu_yd", "enu_zd", "tow", "course"
+};
+#define NB_FIELD_NAMES (sizeof(field_names) / sizeof(field_names[0]))
+
+enum natnet_fast_type { T_UINT8, T_INT8, T_UINT16, T_INT16, T_UINT32, T_INT32, T_FLOAT, T_DOUBLE };
+
+static const struct {
+  const char *name;
+  uint8_t size;
+} types[] = {
+  { "uint8", 1 }, { "int8", 1 }, { "uint16", 2 }, { "int16", 2 },
+  { "uint32", 4 }, { "int32", 4 }, { "float", 4 }, { "double", 8 }
+};
+#define NB_TYPES (sizeof(types) / sizeof(types[0]))
+
+/** Fill the definition from a message node
+ * @return 0 on success
+ */
+static int load_message(struct NatNetFastMsg *msg, xmlNodePtr m)
+{
+  int len = NATNET_FAST_HEADER;
+  msg->nb_fields = 0;
+  for (xmlNodePtr f = m->children; f != NULL; f = f->next) {
+    if (f->type != XML_ELEMENT_NODE || xmlStrcmp(f->name, (const xmlChar *)"field") != 0) {
+      continue;
+    }
+    if (msg->nb_fields == NATNET_FAST_MAX_FIELDS) {
+      return -1;
+    }
+    xmlChar *name = xmlGetProp(f, (const xmlChar *)"name");
+    xmlChar *type = xmlGetProp(f, (const xmlChar *)"type");
+    int t = -1;
+    for (unsigned int i = 0; type != NULL && i < NB_TYPES; i++) {
+      if (xmlStrcmp(type, (const xmlChar *)types[i].name) == 0) {
+        t = i;
+      }
+    }
+    uint8_t value = F_ZERO;
+    for (unsigned int i = 1; name != NULL && i < NB_FIELD_NAMES; i++) {
+      if (xmlStrcmp(name, (const xmlChar *)field_names[i]) == 0) {
+        value = i;
+      }
+    }
+    if (t < 0) {
+      // arrays and strings would need a length, REMOTE_GPS_LOCAL has none
+      fprintf(stderr, "natnet_fast: unsupported type %s of field %s\n",
+              type ? (const char *)type : "?", name ? (const char *)name : "?");
+    }
+    xmlFree(name);
+    xmlFree(type);
+    if (t < 0) {
+      return -1;
+    }
+    msg->field[msg->nb_fields] = value;
+    msg->type[msg->nb_fields] = t;
+    msg->nb_fields++;
+    len += types[t].size;
+  }
+  if (len + NATNET_FAST_OVERHEAD > UINT8_MAX) {
+    return -1;
+  }
+  msg->frame_len = len + NATNET_FAST_OVERHEAD;
+  return 0;
+}
+
+int natnet_fast_load(struct NatNetFastMsg *msg, const char *path)
+{
+  char default_path[512];
+  if (path == NULL) {
+    const char *home = getenv("PAPARAZZI_HOME");
+    snprintf(default_path, sizeof(default_path), "%s/var/messages.xml", home ? home : ".");
+    path = default_path;
+  }
+
+  xmlDocPtr doc = xmlReadFile(path, NULL, XML_PARSE_NOWARNING | XML_PARSE_NOERROR);
+  if (doc == NULL) {
+    fprintf(stderr, "natnet_fast: could not read %s\n", path);
+    return -1;
+  }
+
+  int ret = -1;
+  xmlNodePtr root = xmlDocGetRootElement(doc);
+  for (xmlNodePtr c = root ? root->children : NULL; c != NULL && ret != 0; c = c->next) {
+    if (c->type != XML_ELEMENT_NODE || xmlStrcmp(c->name, (const xmlChar *)"msg_class") != 0) {
+      continue;
+    }
+    xmlChar *class_name = xmlGetProp(c, (const xmlChar *)"name");
+    xmlChar *class_id = xmlGetProp(c, (const xmlChar *)"id");
+    if (class_name != NULL && class_id != NULL && xmlStrcmp(class_name, (const xmlChar *)"datalink") == 0) {
+      for (xmlNodePtr m = c->children; m != NULL; m = m->next) {
+        if (m->type != XML_ELEMENT_NODE || xmlStrcmp(m->name, (const xmlChar *)"message") != 0) {
+          continue;
+        }
+        xmlChar *name = xmlGetProp(m, (const xmlChar *)"name");
+        xmlChar *id = xmlGetProp(m, (const xmlChar *)"id");
+        if (name != NULL && id != NULL && xmlStrcmp(name, (const xmlChar *)"REMOTE_GPS_LOCAL") == 0) {
+          msg->class_id = atoi((const char *)class_id) & 0x0F;
+          msg->msg_id = atoi((const char *)id);
+          ret = load_message(msg, m);
+        }
+        xmlFree(name);
+        xmlFree(id);
+      }
+    }
+    xmlFree(class_name);
+    xmlFree(class_id);
+  }
+  xmlFreeDoc(doc);
+
+  if (ret != 0) {
+    fprintf(stderr, "natnet_fast: no usable datalink REMOTE_GPS_LOCAL in %s\n", path);
+  }
+  return ret;
+}
+
+/** Write a value with the type of its field, little endian like the autopilots */
+static void put_value(uint8_t *p, uint8_t type, double v)
+{
+  union {
+    uint8_t u8; int8_t i8; uint16_t u16; int16_t i16; uint32_t u32; int32_t i32; float f; double d;
+  } u;
+  switch (type) {
+    case T_UINT8: u.u8 = (uint8_t)v; break;
+    case T_INT8: u.i8 = (int8_t)v; break;
+    case T_UINT16: u.u16 = (uint16_t)v; break;
+    case T_INT16: u.i16 = (int16_t)v; break;
+    case T_UINT32: u.u32 = (uint32_t)v; break;
+    case T_INT32: u.i32 = (int32_t)v; break;
+    case T_FLOAT: u.f = (float)v; break;
+    default: u.d = v; break;
+  }
+  memcpy(p, &u, types[type].size);
+}
+
+static double pose_value(const struct NatNetFastPose *pose, uint8_t field)
+{
+  switch (field) {
+    case F_AC_ID: return pose->ac_id;
+    case F_ENU_X: return pose->enu_pos[0];
+    case F_ENU_Y: return pose->enu_pos[1];
+    case F_ENU_Z: return pose->enu_pos[2];
+    case F_ENU_XD: return pose->enu_vel[0];
+    case F_ENU_YD: return pose->enu_vel[1];
+    case F_ENU_ZD: return pose->enu_vel[2];
+    case F_TOW: return pose->tow;
+    case F_COURSE: return pose->course;
+    default: return 0.;
+  }
+}
+
+int natnet_fast_batch_add(struct NatNetFastBatch *batch, const struct NatNetFastMsg *msg,
+                          const struct NatNetFastPose *pose)
+{
+  if (batch->len + msg->frame_len > NATNET_FAST_MAX_PAYLOAD) {
+    return -1;
+  }
+
+  uint8_t *frame = batch->buf + batch->len;
+  uint8_t *p = frame + 2;
+  frame[0] = NATNET_FAST_STX;
+  frame[1] = msg->frame_len;
+  *p++ = 0;                   // sender: ground
+  *p++ = pose->ac_id;         // receiver
+  *p++ = msg->class_id;       // component 0
+  *p++ = msg->msg_id;
+  for (uint8_t i = 0; i < msg->nb_fields; i++) {
+    put_value(p, msg->type[i], pose_value(pose, msg->field[i]));
+    p += types[msg->type[i]].size;
+  }
+
+  // checksum over the length and the payload
+  uint8_t ck_a = 0, ck_b = 0;
+  for (uint8_t *c = frame + 1; c < p; c++) {
+    ck_a += *c;
+    ck_b += ck_a;
+  }
+  *p++ = ck_a;
+  *p++ = ck_b;
+
+  batch->len += msg->frame_len;
+  batch->nb++;
+  return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/** \file natnet_fast.h
+*  \brief Batched REMOTE_GPS_LOCAL frames of the natnet2ivy fast path
+*
+*   One UDP datagram is sent per NatNet frame to the datalink port of the
+* aircraft. It is a plain concatenation of pprzlink 2.0 transport frames of
+* the datalink REMOTE_GPS_LOCAL message, one per aircraft due for this frame,
+* so the existing datalink parser and gps_datalink decode it unchanged.
+*
+*   The class and message ids and the field layout are read from messages.xml,
+* positions and velocities are in the ENU frame of the tracking system
+* (offset angle applied).
+*/
+
+#ifndef NATNET_FAST_H
+#define NATNET_FAST_H
+
+#include <stdint.h>
+
+/** max UDP payload in a 1500 bytes MTU (IPv4 and UDP headers removed) */
+#define NATNET_FAST_MAX_PAYLOAD 1472
+
+/** pprzlink 2.0 transport: STX, length, payload, two checksum bytes */
+#define NATNET_FAST_STX         0x99
+#define NATNET_FAST_OVERHEAD    4
+/** payload header: sender id, receiver id, component << 4 | class id, message id */
+#define NATNET_FAST_HEADER      4
+
+#define NATNET_FAST_MAX_FIELDS  16
+
+struct NatNetFastPose {
+  uint8_t ac_id;
+  uint32_t tow;           ///< time of week in ms
+  float enu_pos[3];       ///< m
+  float enu_vel[3];       ///< m/s
+  float course;           ///< rad
+};
+
+/** REMOTE_GPS_LOCAL definition from messages.xml */
+struct NatNetFastMsg {
+  uint8_t class_id;
+  uint8_t msg_id;
+  uint8_t nb_fields;
+  uint8_t field[NATNET_FAST_MAX_FIELDS];    ///< pose value of each field, see natnet_fast.c
+  uint8_t type[NATNET_FAST_MAX_FIELDS];     ///< type of each field
+  uint8_t frame_len;                        ///< length of a complete transport frame
+};
+
+/** Batch of frames sent in one datagram */
+struct NatNetFastBatch {
+  uint8_t buf[NATNET_FAST_MAX_PAYLOAD];
+  uint16_t len;
+  uint8_t nb;
+};
+
+/** Read the REMOTE_GPS_LOCAL definition
+ * @param msg definition
+ * @param path messages.xml, $PAPARAZZI_HOME/var/messages.xml if NULL
+ * @return 0 on success, -1 if the message is missing or has unsupported fields
+ */
+extern int natnet_fast_load(struct NatNetFastMsg *msg, const char *path);
+
+static inline void natnet_fast_batch_reset(struct NatNetFastBatch *batch)
+{
+  batch->len = 0;
+  batch->nb = 0;
+}
+
+/** Append the frame of a pose to the batch
+ * @return 0 on success, -1 if the batch is full (send and reset it first)
+ */
+extern int natnet_fast_batch_add(struct NatNetFastBatch *batch, const struct NatNetFastMsg *msg,
+                                 const struct NatNetFastPose *pose);
+
+#endif /* NATNET_FAST_H */
@@ -41,6 +41,9 @@
 #include <stdio.h>
 #include <libxml/xmlreader.h>
 
+#include "pprzbus.h"
+#include "pprzbus_msgs.h"
+
 
 char defaultAppPass[] = "1234"; //4 char password to control ac's over app "pass ground stg stg stg..
 char* AppPass;
@@ -75,6 +78,20 @@ int verbose = 0;
 //TCP flag
 int uTCP = 0;
 
+//Binary ground bus (ground messages are read from the bus instead of Ivy,
+//they are published as raw pprzlink payloads by the server started with -bus)
+int uBus = 0;
+char BusAddr[64] = PPRZBUS_DEFAULT_ADDR;
+uint16_t BusPort = PPRZBUS_DEFAULT_PORT;
+struct PprzBus bus;
+//Message definitions to decode the raw payloads (default $PAPARAZZI_HOME/var/messages.xml)
+char *MessagesPath = NULL;
+struct PprzBusMsgs BusMsgs;
+int GroundClass = -1;
+
+//UDP socket used to send data to all clients
+GSocket *udpSocket = NULL;
+
 int ProcessID;
 int RequestID;
 
@@ -112,6 +129,8 @@ device_names DevNames[MAXDEVICENUMB];
 typedef struct {
   int used ;
   char client_ip[MAXIPLEN];
+  //Udp destination of the client
+  GSocketAddress *udpSocketAddress;
   //Pointer for tcp connection;
   gpointer ClientTcpData;
 } client_data;
@@ -142,6 +161,10 @@ void remove_client(char* RemClientIpAd) {
         //record found clean it!!
         ConnectedClients[i].client_ip[0]='\0';
         ConnectedClients[i].used=0;
+        if (ConnectedClients[i].udpSocketAddress != NULL) {
+          g_object_unref(ConnectedClients[i].udpSocketAddress);
+          ConnectedClients[i].udpSocketAddress = NULL;
+        }
         if (verbose) {
           printf("App Server: Client removed from client list %s\n", RemClientIpAd);
           fflush(stdout);
@@ -291,37 +314,25 @@ void broadcast_to_clients () {
     return;
   }
 
-  i=0;
+  //Send data on a single socket, destination address is created with the client
+  if (udpSocket == NULL) {
+    udpSocket = g_socket_new(G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM, G_SOCKET_PROTOCOL_UDP, NULL);
+  }
+  size_t len = strlen(ivybuffer);
   for (i = 0; i < MAXCLIENT; i++) {
     if (ConnectedClients[i].used > 0) {
-
-      //Send data
-      GInetAddress *udpAddress;
-      GSocketAddress *udpSocketAddress;
-      GSocket *udpSocket;
-
-      udpAddress = g_inet_address_new_from_string(ConnectedClients[i].client_ip);
-
-      udpSocketAddress = g_inet_socket_address_new(udpAddress, udp_port);
-
-      udpSocket = g_socket_new(G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM, 17, NULL);
-
-      if (g_socket_connect(udpSocket, udpSocketAddress, NULL, NULL) == FALSE) {
-        printf("App Server: stg wrong with socket connect\n");
-        fflush(stdout);
+      if (ConnectedClients[i].udpSocketAddress == NULL) {
+        GInetAddress *udpAddress = g_inet_address_new_from_string(ConnectedClients[i].client_ip);
+        if (udpAddress == NULL) {
+          continue;
+        }
+        ConnectedClients[i].udpSocketAddress = g_inet_socket_address_new(udpAddress, udp_port);
+        g_object_unref(udpAddress);
       }
-      if (g_socket_send(udpSocket, ivybuffer, strlen(ivybuffer) , NULL, NULL) < 0) {
+      if (g_socket_send_to(udpSocket, ConnectedClients[i].udpSocketAddress, ivybuffer, len, NULL, NULL) < 0) {
         printf("App Server: stg wrong with send func\n");
         fflush(stdout);
       }
-      if (g_socket_close(udpSocket, NULL) == FALSE) {
-        printf("App Server: stg wrong with socket close\n");
-        fflush(stdout);
-      }
-      //Unref objects
-      g_object_unref(udpAddress);
-      g_object_unref(udpSocketAddress);
-      g_object_unref(udpSocket);
     }
   }
 
@@ -496,6 +507,48 @@ void Ivy_All_Msgs(IvyClientPtr app, void *user_data, int argc, char *argv[]){
 
 }
 
+//Any client connected
+int has_clients() {
+  int i;
+  for (i = 0; i < MAXCLIENT; i++) {
+    if (ConnectedClients[i].used > 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+//Ground messages from the binary bus, same as Ivy_All_Msgs without regex matching
+//Raw ground payloads of the server are only formatted as text when a client listens,
+//text records (e.g. from pprzbus_ivy_bridge) are forwarded as they are
+gboolean on_bus_data(GIOChannel *chan, GIOCondition cond, gpointer data) {
+  struct PprzBusRecord rec;
+  while (pprzbus_receive(&bus) > 0) {
+    while (pprzbus_next(&bus, &rec)) {
+      if (!has_clients()) {
+        continue;
+      }
+      int len = -1;
+      if (rec.type == PPRZBUS_RAW) {
+        if (pprzbus_payload_class(rec.data, rec.len) != GroundClass) {
+          continue;
+        }
+        len = pprzbus_msgs_to_text(&BusMsgs, rec.data, rec.len, ivybuffer, BUFLEN - 1);
+      } else if (rec.type == PPRZBUS_TEXT && rec.len >= 7 && strncmp((const char *)rec.data, "ground ", 7) == 0) {
+        len = rec.len < BUFLEN - 2 ? rec.len : BUFLEN - 2;
+        memcpy(ivybuffer, rec.data, len);
+      }
+      if (len < 0) {
+        continue;
+      }
+      if (uTCP) ivybuffer[len++] = '\n';
+      ivybuffer[len] = '\0';
+      broadcast_to_clients();
+    }
+  }
+  return TRUE;
+}
+
 //Parse AC flight plan xml (block & waypoint names
 void parse_ac_fp(int DevNameIndex, char *filename) {
   xmlTextReaderPtr reader;
@@ -819,6 +872,8 @@ void print_help() {
   printf("   -b <Ivy bus>\tdefault is %s\n", defaultIvyBus);
   printf("   -p <password>\tpassword for connection with control capabilities (default is %s)\n", defaultAppPass);
   printf("   -utcp \t\tUse TCP communication to send ivy messages (default: UDP )\n");
+  printf("   -bus <addr[:port]>\tRead ground messages from the binary bus, server must run with -bus (default: %s:%d)\n", BusAddr, BusPort);
+  printf("   -messages <file>\tmessages.xml used to decode the bus messages (default: $PAPARAZZI_HOME/var/messages.xml)\n");
   printf("   -v\tverbose\n");
   printf("   -h --help show this help\n");
 }
@@ -866,6 +921,17 @@ int main(int argc, char **argv) {
     else if (strcmp(argv[i], "-utcp") == 0) {
       uTCP = 1;
     }
+    else if (strcmp(argv[i], "-bus") == 0 && i + 1 < argc) {
+      uBus = 1;
+      if (pprzbus_parse_addr(argv[++i], BusAddr, sizeof(BusAddr), &BusPort) != 0) {
+        printf("App Server: Invalid bus address %s\n", argv[i]);
+        print_help();
+        exit(EXIT_FAILURE);
+      }
+    }
+    else if (strcmp(argv[i], "-messages") == 0 && i + 1 < argc) {
+      MessagesPath = argv[++i];
+    }
     else {
       printf("App Server: Unknown option\n");
       print_help();
@@ -910,7 +976,23 @@ int main(int argc, char **argv) {
   //Here comes the ivy bindings
   IvyInit ("PPRZ_App_Server", "Papparazzi App Server Ready!", NULL, NULL, NULL, NULL);
 
-  IvyBindMsg(Ivy_All_Msgs, NULL, "(^ground (\\S*) (\\S*) .*)");
+  if (uBus) {
+    if (pprzbus_msgs_load(&BusMsgs, MessagesPath) != 0) {
+      exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < PPRZBUS_MAX_CLASSES; i++) {
+      if (strcmp(BusMsgs.class_names[i], "ground") == 0) {
+        GroundClass = i;
+      }
+    }
+    if (pprzbus_open(&bus, BusAddr, BusPort, TRUE) != 0) {
+      exit(EXIT_FAILURE);
+    }
+    GIOChannel *bus_channel = g_io_channel_unix_new(bus.fd);
+    g_io_add_watch(bus_channel, G_IO_IN, on_bus_data, NULL);
+  } else {
+    IvyBindMsg(Ivy_All_Msgs, NULL, "(^ground (\\S*) (\\S*) .*)");
+  }
   IvyBindMsg(on_app_server_NEW_AC, NULL, "ground NEW_AIRCRAFT (\\S*)");
   IvyBindMsg(on_app_server_GET_CONFIG, NULL, "(\\S*) ground CONFIG (\\S*) (\\S*) (\\S*) (\\S*) (\\S*) (\\S*) (\\S*)");
   IvyBindMsg(on_app_server_AIRCRAFTS, NULL, "(\\S*) ground AIRCRAFTS (\\S*)");
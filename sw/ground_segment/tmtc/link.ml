@@ -88,6 +88,10 @@ let send_message_over_ivy = fun sender name vs ->
   else
     Tm_Pprz.message_send ?timestamp sender name vs
 
+(** Binary ground bus, raw telemetry payloads are published as records
+    batched in UDP multicast datagrams (see pprzbus.ml) *)
+module Bus = Pprzbus
+
 let send_ground_over_ivy = fun sender name vs ->
   let timestamp =
     match !add_timestamp with
@@ -198,10 +202,14 @@ let use_tele_message = fun ?udp_peername ?raw_data_size payload ->
   let raw_data_size = match raw_data_size with None -> String.length (Protocol.string_of_payload payload) | Some d -> d in
   let buf = Protocol.string_of_payload payload in
   Debug.call 'l' (fun f ->  fprintf f "pprz receiving: %s\n" (Debug.xprint buf));
+  (* sender id is the first byte of the payload *)
+  if !Bus.enabled && String.length buf > 0 then
+    Bus.publish (Char.code buf.[0]) buf;
   try
     let (msg_id, ac_id, values) = Tm_Pprz.values_of_payload payload in
     let msg = Tm_Pprz.message_of_id msg_id in
-    send_message_over_ivy (string_of_int ac_id) msg.PprzLink.name values;
+    if !Bus.ivy_telemetry then
+      send_message_over_ivy (string_of_int ac_id) msg.PprzLink.name values;
     update_status ?udp_peername ac_id raw_data_size (msg.PprzLink.name = "PONG")
   with
       exc ->
@@ -441,6 +449,9 @@ let () =
   (* Parse command line options *)
   let options =
     [ "-b", Arg.Set_string ivy_bus, (sprintf "<ivy bus> Default is %s" !ivy_bus);
+      "-bus", Arg.String Bus.set_address, (sprintf "<addr[:port]> Publish raw telemetry on the binary ground bus (%s:%d)" !Bus.addr !Bus.port);
+      "-bus_flush", Arg.Set_int Bus.flush_period, (sprintf "<period> Max time (in ms) records are batched before sending. Default is %i" !Bus.flush_period);
+      "-no_ivy_telemetry", Arg.Clear Bus.ivy_telemetry, "Do not send telemetry messages over Ivy, only on the binary bus";
       "-d", Arg.Set_string port, (sprintf "<port> Default is %s" !port);
       "-fg",  Arg.Set gen_stat_trafic, "Enable trafic statistics on standard output";
       "-noac_info", Arg.Clear ac_info, (sprintf "Disables AC traffic info (uplink).");
@@ -526,6 +537,8 @@ let () =
     begin
       ignore (Glib.Timeout.add !status_msg_period (fun () -> send_status_msg (); true));
       ignore (Glib.Timeout.add (!status_msg_period / 3) (fun () -> update_ms_since_last_msg (); true));
+      if !Bus.enabled then
+        ignore (Glib.Timeout.add !Bus.flush_period (fun () -> Bus.flush (); true));
       let start_ping = fun () ->
         ignore (Glib.Timeout.add !ping_msg_period (fun () -> send_ping_msg device; true));
         false in
@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pprzbus.c
+ *
+ * Binary ground message bus over UDP multicast.
+ */
+
+#include "pprzbus.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+
+#define PPRZBUS_PAD(_l) (((_l) + 3) & ~3)
+
+_Static_assert(sizeof(struct PprzBusHeader) == PPRZBUS_HEADER_SIZE, "PPRZBUS_HEADER_SIZE mismatch");
+_Static_assert(sizeof(struct PprzBusRecordHeader) == PPRZBUS_RECORD_HEADER_SIZE,
+               "PPRZBUS_RECORD_HEADER_SIZE mismatch");
+
+/** host to/from little endian, the bus format is little endian */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define PPRZBUS_LE16(_x) __builtin_bswap16(_x)
+#define PPRZBUS_LE32(_x) __builtin_bswap32(_x)
+#else
+#define PPRZBUS_LE16(_x) (_x)
+#define PPRZBUS_LE32(_x) (_x)
+#endif
+
+uint32_t pprzbus_stamp(void)
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (uint32_t)(tv.tv_sec * 1000 + tv.tv_usec / 1000);
+}
+
+int pprzbus_parse_addr(const char *str, char *addr, int addr_len, uint16_t *port)
+{
+  const char *sep = strchr(str, ':');
+  int len = sep ? (int)(sep - str) : (int)strlen(str);
+  if (len >= addr_len) {
+    return -1;
+  }
+  if (len > 0) {
+    memcpy(addr, str, len);
+    addr[len] = '\0';
+  }
+  if (sep != NULL && sep[1] != '\0') {
+    *port = atoi(sep + 1);
+  }
+  return 0;
+}
+
+int pprzbus_open(struct PprzBus *bus, const char *addr, uint16_t port, bool subscribe)
+{
+  static uint32_t nb_open = 0;
+  memset(bus, 0, sizeof(struct PprzBus));
+  // unique id per process and per bus instance
+  bus->sender = ((uint32_t)getpid() << 16) ^ pprzbus_stamp() ^ (++nb_open * 0x9E3779B9u);
+
+  bus->fd = socket(PF_INET, SOCK_DGRAM, 0);
+  if (bus->fd < 0) {
+    perror("pprzbus socket");
+    return -1;
+  }
+
+  bus->addr.sin_family = AF_INET;
+  bus->addr.sin_port = htons(port);
+  if (!inet_aton(addr, &bus->addr.sin_addr)) {
+    fprintf(stderr, "pprzbus: invalid address %s\n", addr);
+    close(bus->fd);
+    return -1;
+  }
+
+  int one = 1;
+  setsockopt(bus->fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#ifdef SO_REUSEPORT
+  setsockopt(bus->fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+#endif
+  setsockopt(bus->fd, SOL_SOCKET, SO_BROADCAST, &one, sizeof(one));
+  // local subscribers are the main use case
+  unsigned char loop = 1;
+  setsockopt(bus->fd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+
+  if (subscribe) {
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(bus->fd, (struct sockaddr *)&local, sizeof(local)) < 0) {
+      perror("pprzbus bind");
+      close(bus->fd);
+      return -1;
+    }
+    if (IN_MULTICAST(ntohl(bus->addr.sin_addr.s_addr))) {
+      struct ip_mreq mreq;
+      mreq.imr_multiaddr = bus->addr.sin_addr;
+      mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+      if (setsockopt(bus->fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        perror("pprzbus multicast membership");
+        close(bus->fd);
+        return -1;
+      }
+    }
+    int rcvbuf = 0x100000; // 1MB
+    setsockopt(bus->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  }
+  return 0;
+}
+
+void pprzbus_close(struct PprzBus *bus)
+{
+  pprzbus_flush(bus);
+  close(bus->fd);
+  bus->fd = -1;
+}
+
+void pprzbus_filter_ac(struct PprzBus *bus, uint8_t ac_id)
+{
+  bus->ac_filter[ac_id / 8] |= 1 << (ac_id % 8);
+  bus->filter_set = true;
+}
+
+int pprzbus_flush(struct PprzBus *bus)
+{
+  if (bus->tx_nb == 0) {
+    return 0;
+  }
+  struct PprzBusHeader *h = (struct PprzBusHeader *)bus->tx_buf;
+  h->magic = PPRZBUS_LE16(PPRZBUS_MAGIC);
+  h->version = PPRZBUS_VERSION;
+  h->nb_records = bus->tx_nb;
+  h->seq = PPRZBUS_LE32(bus->seq);
+  h->sender = PPRZBUS_LE32(bus->sender);
+  bus->seq++;
+
+  ssize_t n = sendto(bus->fd, bus->tx_buf, bus->tx_len, 0,
+                     (struct sockaddr *)&bus->addr, sizeof(bus->addr));
+  bus->tx_len = 0;
+  bus->tx_nb = 0;
+  return n < 0 ? -1 : 0;
+}
+
+int pprzbus_publish(struct PprzBus *bus, uint8_t type, uint8_t ac_id, uint32_t stamp,
+                    const void *data, uint16_t len)
+{
+  uint16_t rec_len = sizeof(struct PprzBusRecordHeader) + PPRZBUS_PAD(len);
+  if (sizeof(struct PprzBusHeader) + rec_len > PPRZBUS_MAX_DATAGRAM) {
+    return -1;
+  }
+  if (bus->tx_len + rec_len > PPRZBUS_MAX_DATAGRAM || bus->tx_nb == UINT8_MAX) {
+    if (pprzbus_flush(bus) < 0) {
+      return -1;
+    }
+  }
+  if (bus->tx_len == 0) {
+    bus->tx_len = sizeof(struct PprzBusHeader);
+  }
+
+  struct PprzBusRecordHeader *r = (struct PprzBusRecordHeader *)(bus->tx_buf + bus->tx_len);
+  r->type = type;
+  r->ac_id = ac_id;
+  r->len = PPRZBUS_LE16(len);
+  r->stamp = PPRZBUS_LE32(stamp);
+  memcpy(bus->tx_buf + bus->tx_len + sizeof(struct PprzBusRecordHeader), data, len);
+  bus->tx_len += rec_len;
+  bus->tx_nb++;
+  return 0;
+}
+
+/** Count the sequence gaps of each sender, the least recently heard
+ * sender is forgotten when the table is full.
+ * The gap is a signed difference (wraps around), late or duplicated
+ * datagrams are not counted and don't move the last sequence number back.
+ */
+static void pprzbus_check_seq(struct PprzBus *bus, uint32_t sender, uint32_t seq)
+{
+  int i, oldest = 0;
+  bus->nb_rx++;
+  for (i = 0; i < PPRZBUS_MAX_SENDERS; i++) {
+    if (bus->senders[i].last_rx != 0 && bus->senders[i].sender == sender) {
+      int32_t gap = (int32_t)(seq - bus->senders[i].last_seq);
+      bus->senders[i].last_rx = bus->nb_rx;
+      if (gap <= 0) {
+        return;
+      }
+      bus->nb_lost += gap - 1;
+      break;
+    }
+    if (bus->senders[i].last_rx < bus->senders[oldest].last_rx) {
+      oldest = i;
+    }
+  }
+  if (i == PPRZBUS_MAX_SENDERS) {
+    // new sender
+    i = oldest;
+    bus->senders[i].sender = sender;
+  }
+  bus->senders[i].last_seq = seq;
+  bus->senders[i].last_rx = bus->nb_rx;
+}
+
+int pprzbus_receive(struct PprzBus *bus)
+{
+  bus->rx_left = 0;
+  ssize_t n = recv(bus->fd, bus->rx_buf, PPRZBUS_MAX_DATAGRAM, MSG_DONTWAIT);
+  if (n < 0) {
+    return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+  }
+
+  struct PprzBusHeader *h = (struct PprzBusHeader *)bus->rx_buf;
+  if (n < (ssize_t)sizeof(struct PprzBusHeader) || PPRZBUS_LE16(h->magic) != PPRZBUS_MAGIC ||
+      h->version != PPRZBUS_VERSION) {
+    return 0;
+  }
+  uint32_t sender = PPRZBUS_LE32(h->sender);
+  if (sender == bus->sender && !bus->own) {
+    return 0;
+  }
+  pprzbus_check_seq(bus, sender, PPRZBUS_LE32(h->seq));
+  bus->rx_sender = sender;
+
+  bus->rx_len = n;
+  bus->rx_pos = sizeof(struct PprzBusHeader);
+  bus->rx_left = h->nb_records;
+  return h->nb_records;
+}
+
+bool pprzbus_next(struct PprzBus *bus, struct PprzBusRecord *rec)
+{
+  while (bus->rx_left > 0) {
+    if (bus->rx_pos + sizeof(struct PprzBusRecordHeader) > bus->rx_len) {
+      bus->rx_left = 0;
+      return false;
+    }
+    const struct PprzBusRecordHeader *r = (const struct PprzBusRecordHeader *)(bus->rx_buf + bus->rx_pos);
+    uint16_t data_pos = bus->rx_pos + sizeof(struct PprzBusRecordHeader);
+    uint16_t len = PPRZBUS_LE16(r->len);
+    if (data_pos + len > bus->rx_len) {
+      // truncated datagram
+      bus->rx_left = 0;
+      return false;
+    }
+    bus->rx_pos = data_pos + PPRZBUS_PAD(len);
+    bus->rx_left--;
+
+    if (bus->filter_set && !(bus->ac_filter[r->ac_id / 8] & (1 << (r->ac_id % 8)))) {
+      continue;
+    }
+    rec->type = r->type;
+    rec->ac_id = r->ac_id;
+    rec->len = len;
+    rec->stamp = PPRZBUS_LE32(r->stamp);
+    rec->sender = bus->rx_sender;
+    rec->data = bus->rx_buf + data_pos;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pprzbus.h
+ *
+ * Binary ground message bus over UDP multicast.
+ *
+ * Records are either raw pprzlink payloads (telemetry as received by link,
+ * ground messages encoded by the server, without transport framing, decoded
+ * with pprzbus_msgs.h) or Ivy-like text messages, each with a small header
+ * (type, aircraft id, length, timestamp). Several records are batched in
+ * a single datagram:
+ *
+ *   datagram : PprzBusHeader | record | record | ...
+ *   record   : PprzBusRecordHeader | data | padding to 4 bytes
+ *
+ * All header fields are little endian, whatever the host byte order.
+ * Received records point directly in the receive buffer, they are valid
+ * until the next call to pprzbus_receive().
+ *
+ * The numeric and string constants of this file are also used by the OCaml
+ * agents (pprzbus_defs.ml is generated from it by the Makefile), keep them
+ * as plain "#define PPRZBUS_NAME value" lines.
+ */
+
+#ifndef PPRZBUS_H
+#define PPRZBUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <netinet/in.h>
+
+#define PPRZBUS_DEFAULT_ADDR  "239.255.50.10"
+#define PPRZBUS_DEFAULT_PORT  4250
+
+#define PPRZBUS_MAGIC         0x4250  ///< "PB"
+#define PPRZBUS_VERSION       1
+
+/** max datagram size, keeps datagrams below a 1500 bytes MTU */
+#define PPRZBUS_MAX_DATAGRAM  1472
+
+/** header sizes, checked against the structures in pprzbus.c */
+#define PPRZBUS_HEADER_SIZE         12
+#define PPRZBUS_RECORD_HEADER_SIZE  8
+
+/** number of senders for which datagram losses are tracked */
+#define PPRZBUS_MAX_SENDERS   16
+
+/** record types */
+#define PPRZBUS_RAW           0       ///< raw pprzlink payload (sender_id, msg_id, fields)
+#define PPRZBUS_TEXT          1       ///< Ivy-like text message "sender NAME fields..."
+
+struct __attribute__((packed)) PprzBusHeader {
+  uint16_t magic;
+  uint8_t version;
+  uint8_t nb_records;
+  uint32_t seq;           ///< datagram sequence number of the sender
+  uint32_t sender;        ///< sender unique id
+};
+
+struct __attribute__((packed)) PprzBusRecordHeader {
+  uint8_t type;           ///< PPRZBUS_RAW or PPRZBUS_TEXT
+  uint8_t ac_id;          ///< aircraft id, 0 for ground messages
+  uint16_t len;           ///< data length
+  uint32_t stamp;         ///< reception time in ms (sender clock)
+};
+
+/** A received record, data points in the receive buffer */
+struct PprzBusRecord {
+  uint8_t type;
+  uint8_t ac_id;
+  uint16_t len;
+  uint32_t stamp;
+  uint32_t sender;
+  const uint8_t *data;
+};
+
+struct PprzBus {
+  int fd;                                   ///< socket, can be watched for input
+  struct sockaddr_in addr;                  ///< group address
+  uint32_t sender;                          ///< own sender id
+  uint32_t seq;                             ///< next datagram sequence number
+
+  uint8_t tx_buf[PPRZBUS_MAX_DATAGRAM] __attribute__((aligned(4)));
+  uint16_t tx_len;                          ///< bytes in tx_buf, 0 if empty
+  uint8_t tx_nb;                            ///< records in tx_buf
+
+  uint8_t rx_buf[PPRZBUS_MAX_DATAGRAM] __attribute__((aligned(4)));
+  uint16_t rx_len;                          ///< bytes in rx_buf
+  uint16_t rx_pos;                          ///< position of the next record
+  uint8_t rx_left;                          ///< records left in rx_buf
+  uint32_t rx_sender;                       ///< sender of the current datagram
+
+  uint8_t ac_filter[32];                    ///< accepted aircraft ids, all if empty
+  bool filter_set;
+  bool own;                                 ///< receive own datagrams (default false)
+
+  uint32_t nb_lost;                         ///< datagrams lost (sequence gaps, all senders)
+  struct {
+    uint32_t sender;
+    uint32_t last_seq;
+    uint32_t last_rx;                         ///< receive counter, oldest entry is replaced
+  } senders[PPRZBUS_MAX_SENDERS];
+  uint32_t nb_rx;                           ///< datagrams received
+};
+
+/** Open the bus
+ * @param bus bus structure
+ * @param addr multicast group (or unicast/broadcast) address
+ * @param port UDP port
+ * @param subscribe join the group to receive messages
+ * @return 0 on success, -1 on error
+ */
+extern int pprzbus_open(struct PprzBus *bus, const char *addr, uint16_t port, bool subscribe);
+
+/** Parse a "addr:port" string, port or addr may be omitted
+ * @return 0 on success
+ */
+extern int pprzbus_parse_addr(const char *str, char *addr, int addr_len, uint16_t *port);
+
+extern void pprzbus_close(struct PprzBus *bus);
+
+/** Only receive records of this aircraft (can be called for several ids) */
+extern void pprzbus_filter_ac(struct PprzBus *bus, uint8_t ac_id);
+
+/** Add a record to the pending datagram, sent when full or on pprzbus_flush()
+ * @return 0 on success, -1 on error
+ */
+extern int pprzbus_publish(struct PprzBus *bus, uint8_t type, uint8_t ac_id, uint32_t stamp,
+                           const void *data, uint16_t len);
+
+/** Send the pending datagram */
+extern int pprzbus_flush(struct PprzBus *bus);
+
+/** Read one datagram, non-blocking
+ * @return number of records, 0 if nothing to read, -1 on error
+ */
+extern int pprzbus_receive(struct PprzBus *bus);
+
+/** Get the next record of the last datagram
+ * @return false when there is no more record
+ */
+extern bool pprzbus_next(struct PprzBus *bus, struct PprzBusRecord *rec);
+
+/** Current time in ms for record stamps */
+extern uint32_t pprzbus_stamp(void);
+
+#endif /* PPRZBUS_H */
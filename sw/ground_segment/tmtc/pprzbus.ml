@@ -0,0 +1,106 @@
+(*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ *)
+
+(** Binary ground bus, publisher side: records are batched in UDP multicast
+    datagrams (format described in pprzbus.h, constants in the generated
+    Pprzbus_defs module) *)
+
+open Printf
+
+module D = Pprzbus_defs
+
+let enabled = ref false
+let addr = ref D.default_addr
+let port = ref D.default_port
+let flush_period = ref 5 (** ms *)
+(* Also send decoded telemetry as Ivy text messages *)
+let ivy_telemetry = ref true
+
+let socket = lazy (
+  let s = Unix.socket Unix.PF_INET Unix.SOCK_DGRAM 0 in
+  Unix.setsockopt s Unix.SO_BROADCAST true;
+  s)
+
+let stamp = fun () ->
+  int_of_float (mod_float (Unix.gettimeofday () *. 1000.) 4294967296.)
+
+let sender = ((Unix.getpid () lsl 16) lxor (stamp ())) land 0xffffffff
+let seq = ref 0
+let nb = ref 0
+let buf = Buffer.create D.max_datagram
+
+(* all fields are little endian *)
+let add_u8 = fun b x -> Buffer.add_char b (Char.chr (x land 0xff))
+let add_u16 = fun b x -> add_u8 b x; add_u8 b (x lsr 8)
+let add_u32 = fun b x -> add_u16 b (x land 0xffff); add_u16 b ((x lsr 16) land 0xffff)
+
+(** Parse "addr[:port]", for Arg.String *)
+let set_address = fun s ->
+  let a, p =
+    try
+      let i = String.index s ':' in
+      let p = String.sub s (i + 1) (String.length s - i - 1) in
+      String.sub s 0 i, (if p = "" then !port else int_of_string p)
+    with
+      Not_found -> s, !port
+    | Failure _ -> raise (Arg.Bad (sprintf "invalid bus port in %s" s)) in
+  if p < 0 || p > 65535 then
+    raise (Arg.Bad (sprintf "invalid bus port in %s" s));
+  if a <> "" then begin
+    try ignore (Unix.inet_addr_of_string a)
+    with Failure _ -> raise (Arg.Bad (sprintf "invalid bus address in %s" s))
+  end;
+  if a <> "" then addr := a;
+  port := p;
+  enabled := true
+
+let flush = fun () ->
+  if !nb > 0 then begin
+    let h = Buffer.create D.header_size in
+    add_u16 h D.magic; add_u8 h D.version; add_u8 h !nb;
+    add_u32 h !seq; add_u32 h sender;
+    let data = Buffer.contents h ^ Buffer.contents buf in
+    let sockaddr = Unix.ADDR_INET (Unix.inet_addr_of_string !addr, !port) in
+    begin
+      try ignore (Unix.sendto (Lazy.force socket) (Bytes.of_string data) 0 (String.length data) [] sockaddr)
+      with exc -> Debug.call 'W' (fun f -> fprintf f "bus send: %s\n" (Printexc.to_string exc))
+    end;
+    seq := (!seq + 1) land 0xffffffff;
+    Buffer.clear buf;
+    nb := 0
+  end
+
+(** Add a record (raw pprzlink payload by default) to the pending datagram *)
+let publish = fun ?(record_type = D.raw) ac_id payload ->
+  let len = String.length payload in
+  let padded = (len + 3) land (lnot 3) in
+  if D.header_size + D.record_header_size + padded <= D.max_datagram then begin
+    if D.header_size + Buffer.length buf + D.record_header_size + padded > D.max_datagram || !nb = 255 then
+      flush ();
+    add_u8 buf record_type;
+    add_u8 buf ac_id;
+    add_u16 buf len;
+    add_u32 buf (stamp ());
+    Buffer.add_string buf payload;
+    for _i = len to padded - 1 do Buffer.add_char buf '\000' done;
+    incr nb
+  end
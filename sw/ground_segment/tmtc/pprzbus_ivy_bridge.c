@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pprzbus_ivy_bridge.c
+ *
+ * Compatibility bridge between the Ivy bus and the binary ground bus.
+ *
+ * - Ivy messages matching the -to_bus regular expressions are published
+ *   on the binary bus as text records, so that bus clients also get the
+ *   messages of Ivy-only agents (the server publishes its ground messages
+ *   on the bus itself when started with -bus).
+ * - with -from_bus, text records and raw telemetry records of the binary bus
+ *   are sent on Ivy, so that Ivy agents get the telemetry of a link started
+ *   with -bus -no_ivy_telemetry and the messages of bus-only agents.
+ *
+ * Forwarding from the bus is off by default: the agents publishing on the
+ * bus usually also send on Ivy, each message would be received twice.
+ * Raw records of the other classes (e.g. the ground messages of the server)
+ * are never forwarded, their publisher always sends them on Ivy.
+ * The Ivy messages sent by the bridge are not received by its own -to_bus
+ * bindings, and its own records are not received from the bus, so a message
+ * can't loop through the bridge.
+ */
+
+#include <glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <Ivy/ivy.h>
+#include <Ivy/ivyglibloop.h>
+
+#include "pprzbus.h"
+#include "pprzbus_msgs.h"
+
+#ifdef __APPLE__
+char *ivy_bus = "224.255.255.255:2010";
+#else
+char *ivy_bus = "127.255.255.255:2010";
+#endif
+
+char bus_addr[64] = PPRZBUS_DEFAULT_ADDR;
+uint16_t bus_port = PPRZBUS_DEFAULT_PORT;
+struct PprzBus bus;
+
+bool from_bus = false;
+char *messages_path = NULL;
+struct PprzBusMsgs msgs;
+int telemetry_class = -1;
+int flush_period = 5; ///< ms
+int verbose = 0;
+
+long nb_to_bus = 0;
+long nb_from_bus = 0;
+
+/** Ivy message to bus text record, aircraft id is the sender if numeric */
+static void on_ivy_msg(IvyClientPtr app, void *user_data, int argc, char *argv[])
+{
+  if (argc < 1) {
+    return;
+  }
+  const char *msg = argv[0];
+  uint8_t ac_id = isdigit((unsigned char)msg[0]) ? atoi(msg) : 0;
+  size_t len = strlen(msg);
+  if (len > UINT16_MAX) {
+    return;
+  }
+  pprzbus_publish(&bus, PPRZBUS_TEXT, ac_id, pprzbus_stamp(), msg, len);
+  nb_to_bus++;
+}
+
+/** bus text and raw telemetry records to Ivy */
+static gboolean on_bus_data(GIOChannel *chan, GIOCondition cond, gpointer data)
+{
+  struct PprzBusRecord rec;
+  char text[4096];
+  while (pprzbus_receive(&bus) > 0) {
+    while (pprzbus_next(&bus, &rec)) {
+      if (rec.type == PPRZBUS_TEXT) {
+        IvySendMsg("%.*s", rec.len, (const char *)rec.data);
+        nb_from_bus++;
+      } else if (rec.type == PPRZBUS_RAW && pprzbus_payload_class(rec.data, rec.len) == telemetry_class) {
+        if (pprzbus_msgs_to_text(&msgs, rec.data, rec.len, text, sizeof(text)) >= 0) {
+          IvySendMsg("%s", text);
+          nb_from_bus++;
+        }
+      }
+    }
+  }
+  return TRUE;
+}
+
+static gboolean flush_bus(gpointer data)
+{
+  pprzbus_flush(&bus);
+  return TRUE;
+}
+
+static gboolean print_stats(gpointer data)
+{
+  fprintf(stderr, "to bus: %ld, from bus: %ld, lost datagrams: %u\n", nb_to_bus, nb_from_bus, bus.nb_lost);
+  return TRUE;
+}
+
+void print_help(char *name)
+{
+  fprintf(stderr, "Usage: %s [options]\n"
+          " Options :\n"
+          "   -b <Ivy bus>          default is %s\n"
+          "   -bus <addr[:port]>    binary bus address (default %s:%d)\n"
+          "   -to_bus <regexp>      forward Ivy messages matching regexp to the bus (multiple possible)\n"
+          "   -from_bus             forward bus text and raw telemetry messages to Ivy\n"
+          "                         (only if their publishers don't send them on Ivy)\n"
+          "   -messages <file>      messages.xml for the raw telemetry (default $PAPARAZZI_HOME/var/messages.xml)\n"
+          "   -flush <ms>           max time records are batched (default %d)\n"
+          "   -v                    print statistics\n"
+          "   -h --help             show this help\n",
+          name, ivy_bus, bus_addr, bus_port, flush_period);
+}
+
+int main(int argc, char **argv)
+{
+  char *regexps[32];
+  int nb_regexps = 0;
+  int i;
+
+  for (i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+      print_help(argv[0]);
+      exit(0);
+    } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+      ivy_bus = argv[++i];
+    } else if (strcmp(argv[i], "-bus") == 0 && i + 1 < argc) {
+      if (pprzbus_parse_addr(argv[++i], bus_addr, sizeof(bus_addr), &bus_port) != 0) {
+        fprintf(stderr, "Invalid bus address %s\n", argv[i]);
+        exit(EXIT_FAILURE);
+      }
+    } else if (strcmp(argv[i], "-to_bus") == 0 && i + 1 < argc && nb_regexps < 32) {
+      regexps[nb_regexps++] = argv[++i];
+    } else if (strcmp(argv[i], "-from_bus") == 0) {
+      from_bus = true;
+    } else if (strcmp(argv[i], "-messages") == 0 && i + 1 < argc) {
+      messages_path = argv[++i];
+    } else if (strcmp(argv[i], "-flush") == 0 && i + 1 < argc) {
+      flush_period = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-v") == 0) {
+      verbose = 1;
+    } else {
+      fprintf(stderr, "Unknown option %s\n", argv[i]);
+      print_help(argv[0]);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  if (from_bus) {
+    if (pprzbus_msgs_load(&msgs, messages_path) != 0) {
+      exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < PPRZBUS_MAX_CLASSES; i++) {
+      if (strcmp(msgs.class_names[i], "telemetry") == 0) {
+        telemetry_class = i;
+      }
+    }
+  }
+  if (pprzbus_open(&bus, bus_addr, bus_port, from_bus) != 0) {
+    exit(EXIT_FAILURE);
+  }
+
+  GMainLoop *ml = g_main_loop_new(NULL, FALSE);
+
+  IvyInit("pprzbus_ivy_bridge", "pprzbus_ivy_bridge READY", NULL, NULL, NULL, NULL);
+  for (i = 0; i < nb_regexps; i++) {
+    // capture the whole message
+    char re[512];
+    snprintf(re, sizeof(re), "(%s)", regexps[i]);
+    IvyBindMsg(on_ivy_msg, NULL, "%s", re);
+  }
+  IvyStart(ivy_bus);
+
+  if (from_bus) {
+    GIOChannel *chan = g_io_channel_unix_new(bus.fd);
+    g_io_add_watch(chan, G_IO_IN, on_bus_data, NULL);
+  }
+  if (nb_regexps > 0) {
+    g_timeout_add(flush_period, flush_bus, NULL);
+  }
+  if (verbose) {
+    g_timeout_add(5000, print_stats, NULL);
+  }
+
+  g_main_loop_run(ml);
+
+  pprzbus_close(&bus);
+  return 0;
+}
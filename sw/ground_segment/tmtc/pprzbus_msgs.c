@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pprzbus_msgs.c
+ *
+ * Decoding of the raw pprzlink payloads of the binary ground bus.
+ */
+
+#include "pprzbus_msgs.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libxml/parser.h>
+#include <libxml/tree.h>
+
+static const struct {
+  const char *name;
+  uint8_t type;
+  uint8_t size;
+} types[] = {
+  { "uint8", PPRZBUS_T_UINT8, 1 },
+  { "int8", PPRZBUS_T_INT8, 1 },
+  { "uint16", PPRZBUS_T_UINT16, 2 },
+  { "int16", PPRZBUS_T_INT16, 2 },
+  { "uint32", PPRZBUS_T_UINT32, 4 },
+  { "int32", PPRZBUS_T_INT32, 4 },
+  { "uint64", PPRZBUS_T_UINT64, 8 },
+  { "int64", PPRZBUS_T_INT64, 8 },
+  { "float", PPRZBUS_T_FLOAT, 4 },
+  { "double", PPRZBUS_T_DOUBLE, 8 },
+  { "char", PPRZBUS_T_CHAR, 1 },
+  { "string", PPRZBUS_T_STRING, 1 },
+};
+#define NB_TYPES (sizeof(types) / sizeof(types[0]))
+
+/** Parse a field type, e.g. "int16", "float[]", "uint8[3]", "string"
+ * @return 0 on success
+ */
+static int parse_type(struct PprzBusField *f, const char *s)
+{
+  const char *bracket = strchr(s, '[');
+  size_t len = bracket ? (size_t)(bracket - s) : strlen(s);
+  for (unsigned int i = 0; i < NB_TYPES; i++) {
+    if (strlen(types[i].name) == len && strncmp(s, types[i].name, len) == 0) {
+      f->type = types[i].type;
+      f->array = (bracket != NULL) || f->type == PPRZBUS_T_STRING;
+      f->fixed_len = bracket ? (uint8_t)atoi(bracket + 1) : 0;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+static int load_class(struct PprzBusMsgs *msgs, xmlNodePtr class_node)
+{
+  xmlChar *name = xmlGetProp(class_node, (const xmlChar *)"name");
+  xmlChar *id = xmlGetProp(class_node, (const xmlChar *)"id");
+  int class_id = id ? atoi((const char *)id) : -1;
+  int ret = 0;
+  if (name == NULL || class_id < 0 || class_id >= PPRZBUS_MAX_CLASSES) {
+    ret = -1;
+    goto end;
+  }
+  snprintf(msgs->class_names[class_id], sizeof(msgs->class_names[class_id]), "%s", (const char *)name);
+
+  for (xmlNodePtr m = class_node->children; m != NULL; m = m->next) {
+    if (m->type != XML_ELEMENT_NODE || xmlStrcmp(m->name, (const xmlChar *)"message") != 0) {
+      continue;
+    }
+    xmlChar *msg_name = xmlGetProp(m, (const xmlChar *)"name");
+    xmlChar *msg_id = xmlGetProp(m, (const xmlChar *)"id");
+    struct PprzBusMsgDef *def = calloc(1, sizeof(struct PprzBusMsgDef));
+    int mid = msg_id ? atoi((const char *)msg_id) : -1;
+    if (msg_name != NULL && mid >= 0 && mid < 256 && def != NULL) {
+      snprintf(def->name, sizeof(def->name), "%s", (const char *)msg_name);
+      for (xmlNodePtr f = m->children; f != NULL; f = f->next) {
+        if (f->type != XML_ELEMENT_NODE || xmlStrcmp(f->name, (const xmlChar *)"field") != 0) {
+          continue;
+        }
+        xmlChar *type = xmlGetProp(f, (const xmlChar *)"type");
+        if (type == NULL || def->nb_fields == PPRZBUS_MAX_FIELDS ||
+            parse_type(&def->fields[def->nb_fields], (const char *)type) != 0) {
+          fprintf(stderr, "pprzbus: unsupported field in %s %s\n", (const char *)name, def->name);
+          def->nb_fields = 0;
+          xmlFree(type);
+          break;
+        }
+        def->nb_fields++;
+        xmlFree(type);
+      }
+      free(msgs->defs[class_id][mid]);
+      msgs->defs[class_id][mid] = def;
+    } else {
+      free(def);
+    }
+    xmlFree(msg_name);
+    xmlFree(msg_id);
+  }
+
+end:
+  xmlFree(name);
+  xmlFree(id);
+  return ret;
+}
+
+int pprzbus_msgs_load(struct PprzBusMsgs *msgs, const char *path)
+{
+  char default_path[512];
+  memset(msgs, 0, sizeof(struct PprzBusMsgs));
+  if (path == NULL) {
+    const char *home = getenv("PAPARAZZI_HOME");
+    snprintf(default_path, sizeof(default_path), "%s/var/messages.xml", home ? home : ".");
+    path = default_path;
+  }
+
+  xmlDocPtr doc = xmlReadFile(path, NULL, XML_PARSE_NOWARNING | XML_PARSE_NOERROR);
+  if (doc == NULL) {
+    fprintf(stderr, "pprzbus: could not read %s\n", path);
+    return -1;
+  }
+  xmlNodePtr root = xmlDocGetRootElement(doc);
+  for (xmlNodePtr c = root ? root->children : NULL; c != NULL; c = c->next) {
+    if (c->type == XML_ELEMENT_NODE && xmlStrcmp(c->name, (const xmlChar *)"msg_class") == 0) {
+      load_class(msgs, c);
+    }
+  }
+  xmlFreeDoc(doc);
+  return 0;
+}
+
+void pprzbus_msgs_free(struct PprzBusMsgs *msgs)
+{
+  for (int c = 0; c < PPRZBUS_MAX_CLASSES; c++) {
+    for (int m = 0; m < 256; m++) {
+      free(msgs->defs[c][m]);
+      msgs->defs[c][m] = NULL;
+    }
+  }
+}
+
+/** Output buffer with overflow detection */
+struct text_out {
+  char *buf;
+  int len;
+  int size;
+};
+
+static void out_printf(struct text_out *o, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void out_printf(struct text_out *o, const char *fmt, ...)
+{
+  if (o->len >= o->size) {
+    return;
+  }
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(o->buf + o->len, o->size - o->len, fmt, ap);
+  va_end(ap);
+  o->len = n < 0 ? o->size : o->len + n;
+}
+
+/** Format one element, p must have enough bytes */
+static void format_value(struct text_out *o, uint8_t type, const uint8_t *p)
+{
+  union {
+    uint8_t u8; int8_t i8; uint16_t u16; int16_t i16; uint32_t u32; int32_t i32;
+    uint64_t u64; int64_t i64; float f; double d;
+  } v;
+  // payload fields are little endian, like the hosts of the ground segment
+  memcpy(&v, p, types[type].size);
+  switch (type) {
+    case PPRZBUS_T_UINT8: out_printf(o, "%u", v.u8); break;
+    case PPRZBUS_T_INT8: out_printf(o, "%d", v.i8); break;
+    case PPRZBUS_T_UINT16: out_printf(o, "%u", v.u16); break;
+    case PPRZBUS_T_INT16: out_printf(o, "%d", v.i16); break;
+    case PPRZBUS_T_UINT32: out_printf(o, "%u", v.u32); break;
+    case PPRZBUS_T_INT32: out_printf(o, "%d", v.i32); break;
+    case PPRZBUS_T_UINT64: out_printf(o, "%llu", (unsigned long long)v.u64); break;
+    case PPRZBUS_T_INT64: out_printf(o, "%lld", (long long)v.i64); break;
+    case PPRZBUS_T_FLOAT: out_printf(o, "%.7g", v.f); break;
+    case PPRZBUS_T_DOUBLE: out_printf(o, "%.15g", v.d); break;
+    default: break;
+  }
+}
+
+int pprzbus_msgs_to_text(struct PprzBusMsgs *msgs, const uint8_t *payload, uint16_t len,
+                         char *buf, int buf_len)
+{
+  int class_id = pprzbus_payload_class(payload, len);
+  if (class_id < 0 || msgs->class_names[class_id][0] == '\0') {
+    return -1;
+  }
+  const struct PprzBusMsgDef *def = msgs->defs[class_id][payload[3]];
+  if (def == NULL) {
+    return -1;
+  }
+
+  struct text_out o = { buf, 0, buf_len };
+  if (strcmp(msgs->class_names[class_id], "telemetry") == 0) {
+    out_printf(&o, "%u %s", payload[0], def->name);
+  } else {
+    out_printf(&o, "%s %s", msgs->class_names[class_id], def->name);
+  }
+
+  uint16_t pos = PPRZBUS_PAYLOAD_HEADER;
+  for (uint8_t i = 0; i < def->nb_fields; i++) {
+    const struct PprzBusField *f = &def->fields[i];
+    const uint8_t size = types[f->type].size;
+    uint16_t nb = 1;
+    if (f->array) {
+      if (f->fixed_len > 0) {
+        nb = f->fixed_len;
+      } else {
+        if (pos + 1 > len) {
+          return -1;
+        }
+        nb = payload[pos++];
+      }
+    }
+    if (pos + nb * size > len) {
+      return -1;
+    }
+    out_printf(&o, " ");
+    if (f->type == PPRZBUS_T_CHAR || f->type == PPRZBUS_T_STRING) {
+      // text, quoted if it would be split by the Ivy parsers
+      const char *s = (const char *)payload + pos;
+      int n = strnlen(s, nb);
+      bool quote = n == 0 || memchr(s, ' ', n) != NULL;
+      out_printf(&o, quote ? "\"%.*s\"" : "%.*s", n, s);
+    } else {
+      for (uint16_t k = 0; k < nb; k++) {
+        if (k > 0) {
+          out_printf(&o, ",");
+        }
+        format_value(&o, f->type, payload + pos + k * size);
+      }
+    }
+    pos += nb * size;
+  }
+  return o.len < o.size ? o.len : -1;
+}
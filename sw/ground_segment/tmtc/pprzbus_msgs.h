@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pprzbus_msgs.h
+ *
+ * Decoding of the raw pprzlink 2.0 payloads of the binary ground bus,
+ * with the message definitions of messages.xml.
+ *
+ * Payload: sender id, receiver id, component << 4 | class id, message id,
+ * then the fields, little endian. Variable length arrays and strings are
+ * prefixed with their length (uint8), fixed length arrays are not.
+ */
+
+#ifndef PPRZBUS_MSGS_H
+#define PPRZBUS_MSGS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PPRZBUS_PAYLOAD_HEADER 4
+#define PPRZBUS_MAX_CLASSES    16
+#define PPRZBUS_MAX_FIELDS     64
+
+enum PprzBusType {
+  PPRZBUS_T_UINT8,
+  PPRZBUS_T_INT8,
+  PPRZBUS_T_UINT16,
+  PPRZBUS_T_INT16,
+  PPRZBUS_T_UINT32,
+  PPRZBUS_T_INT32,
+  PPRZBUS_T_UINT64,
+  PPRZBUS_T_INT64,
+  PPRZBUS_T_FLOAT,
+  PPRZBUS_T_DOUBLE,
+  PPRZBUS_T_CHAR,
+  PPRZBUS_T_STRING
+};
+
+struct PprzBusField {
+  uint8_t type;             ///< enum PprzBusType
+  bool array;               ///< array or string
+  uint8_t fixed_len;        ///< number of elements of a fixed length array, 0 if variable
+};
+
+struct PprzBusMsgDef {
+  char name[64];
+  uint8_t nb_fields;
+  struct PprzBusField fields[PPRZBUS_MAX_FIELDS];
+};
+
+struct PprzBusMsgs {
+  char class_names[PPRZBUS_MAX_CLASSES][32];    ///< empty if the class isn't loaded
+  struct PprzBusMsgDef *defs[PPRZBUS_MAX_CLASSES][256];
+};
+
+/** Load the message definitions
+ * @param msgs definitions, freed with pprzbus_msgs_free()
+ * @param path messages.xml, $PAPARAZZI_HOME/var/messages.xml if NULL
+ * @return 0 on success, -1 on error
+ */
+extern int pprzbus_msgs_load(struct PprzBusMsgs *msgs, const char *path);
+
+extern void pprzbus_msgs_free(struct PprzBusMsgs *msgs);
+
+/** Class id of a raw payload, -1 if it is too short */
+static inline int pprzbus_payload_class(const uint8_t *payload, uint16_t len)
+{
+  return len < PPRZBUS_PAYLOAD_HEADER ? -1 : (payload[2] & 0x0F);
+}
+
+/** Format a raw payload as an Ivy text message, e.g. "12 ATTITUDE 0.1 0.2 0.3"
+ * for telemetry (sender id first) or "ground FLIGHT_PARAM ..." for the other
+ * classes (class name first)
+ * @return length of the text, -1 if the message is unknown, truncated or
+ *         doesn't fit in buf
+ */
+extern int pprzbus_msgs_to_text(struct PprzBusMsgs *msgs, const uint8_t *payload, uint16_t len,
+                                char *buf, int buf_len);
+
+#endif /* PPRZBUS_MSGS_H */
@@ -38,7 +38,17 @@ module U = Unix
 module LL = Latlong
 
 module Ground = struct let name = "ground" end
-module Ground_Pprz = PprzLink.Messages(Ground)
+(** Ground messages are also published as raw pprzlink payloads on the binary
+    ground bus when enabled (-bus), encoded once without text formatting, so
+    that bus clients (e.g. app_server -bus) do not need Ivy *)
+module Ground_Pprz = struct
+  include PprzLink.Messages(Ground)
+  let message_send = fun ?timestamp ?link_id sender name vs ->
+    message_send ?timestamp ?link_id sender name vs;
+    if !Pprzbus.enabled then
+      let msg_id = fst (message_of_name name) in
+      Pprzbus.publish 0 (Protocol.string_of_payload (payload_of_values msg_id 0 vs))
+end
 module Tm_Pprz = PprzLink.Messages (struct let name = "telemetry" end)
 module Alerts_Pprz = PprzLink.Messages(struct let name = "alert" end)
 module Dl_Pprz = PprzLink.Messages (struct let name = "datalink" end)
@@ -916,7 +926,9 @@ let () =
       "-n", Arg.Clear logging, "Disable log";
       "-timestamp", Arg.Set timestamp, "Bind on timestampped messages";
       "-no_md5_check", Arg.Set no_md5_check, "Disable safety matching of live and current configurations";
-      "-replay_old_log", Arg.Set replay_old_log, "Enable aircraft registering on PPRZ_MODE messages"] in
+      "-replay_old_log", Arg.Set replay_old_log, "Enable aircraft registering on PPRZ_MODE messages";
+      "-bus", Arg.String Pprzbus.set_address, (sprintf "<addr[:port]> Also publish ground messages on the binary ground bus (%s:%d)" !Pprzbus.addr !Pprzbus.port);
+      "-bus_flush", Arg.Set_int Pprzbus.flush_period, (sprintf "<period> Max time (in ms) records are batched before sending. Default is %i" !Pprzbus.flush_period)] in
 
   Arg.parse
     options
@@ -945,6 +957,9 @@ let () =
   (* Forward messages from ground agents to vehicles *)
   ground_to_uplink logging;
 
+  if !Pprzbus.enabled then
+    ignore (Glib.Timeout.add !Pprzbus.flush_period (fun () -> Pprzbus.flush (); true));
+
   (* call periodic_handle_intruders every second *)
   ignore (Glib.Timeout.add 1000 (fun () -> periodic_handle_intruders (); true));
 
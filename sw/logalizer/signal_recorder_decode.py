@@ -0,0 +1,164 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Paparazzi Team
+#
+# This file is part of paparazzi.
+#
+# paparazzi is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2, or (at your option)
+# any later version.
+#
+# paparazzi is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with paparazzi; see the file COPYING.  If not, see
+# <http://www.gnu.org/licenses/>.
+#
+
+"""
+Decode the files of the signal_recorder module (.srec) to CSV or NumPy (.npz).
+
+usage: signal_recorder_decode.py [-o output.csv|output.npz] file.srec
+"""
+
+from __future__ import print_function
+import sys
+import struct
+import argparse
+
+# column types, same codes as modules/loggers/signal_recorder.c
+TYPES = {
+    0: ('B', 1, 'u1'),
+    1: ('b', 1, 'i1'),
+    2: ('H', 2, '<u2'),
+    3: ('h', 2, '<i2'),
+    4: ('I', 4, '<u4'),
+    5: ('i', 4, '<i4'),
+    6: ('f', 4, '<f4'),
+    7: ('d', 8, '<f8'),
+}
+
+
+def lz4_block_decompress(src, raw_size):
+    """ Decode a LZ4 block, bytearray in and out so that indexing gives
+    integers with Python 2 and 3 """
+    try:
+        import lz4.block
+        return bytearray(lz4.block.decompress(bytes(src), uncompressed_size=raw_size))
+    except ImportError:
+        pass
+    src = bytearray(src)
+    dst = bytearray()
+    ip = 0
+    n = len(src)
+    while ip < n:
+        token = src[ip]
+        ip += 1
+        lit_len = token >> 4
+        if lit_len == 15:
+            while True:
+                b = src[ip]
+                ip += 1
+                lit_len += b
+                if b != 255:
+                    break
+        dst += src[ip:ip + lit_len]
+        ip += lit_len
+        if ip >= n:
+            break
+        offset = src[ip] | (src[ip + 1] << 8)
+        ip += 2
+        match_len = token & 0xF
+        if match_len == 15:
+            while True:
+                b = src[ip]
+                ip += 1
+                match_len += b
+                if b != 255:
+                    break
+        match_len += 4
+        start = len(dst) - offset
+        for i in range(match_len):
+            dst.append(dst[start + i])
+    if len(dst) != raw_size:
+        raise ValueError("corrupted block")
+    return dst
+
+
+def read_srec(filename):
+    """ Return the list of column (name, type) and the list of columns values """
+    with open(filename, 'rb') as f:
+        data = bytearray(f.read())
+
+    if data[0:4] != b'SREC':
+        raise ValueError("not a signal recorder file")
+    version, nb = struct.unpack_from('<HH', data, 4)
+    if version != 1:
+        raise ValueError("unsupported version %d" % version)
+    pos = 8
+    columns = []
+    for _ in range(nb):
+        ctype, length = struct.unpack_from('<BB', data, pos)
+        pos += 2
+        name = data[pos:pos + length].decode('ascii')
+        pos += length
+        columns.append((name, ctype))
+
+    values = [[] for _ in columns]
+    while pos + 16 <= len(data):
+        if data[pos:pos + 4] != b'SRBK':
+            raise ValueError("bad block at offset %d" % pos)
+        nb_rows, flags, raw_size, size = struct.unpack_from('<HHII', data, pos + 4)
+        pos += 16
+        if pos + size > len(data):
+            print("truncated last block, ignored", file=sys.stderr)
+            break
+        block = data[pos:pos + size]
+        pos += size
+        if flags & 1:
+            block = lz4_block_decompress(block, raw_size)
+        # columns with shuffled bytes
+        cpos = 0
+        for c, (name, ctype) in enumerate(columns):
+            fmt, csize, _ = TYPES[ctype]
+            planes = [block[cpos + b * nb_rows:cpos + (b + 1) * nb_rows] for b in range(csize)]
+            cpos += csize * nb_rows
+            raw = bytes(bytearray(planes[b][r] for r in range(nb_rows) for b in range(csize)))
+            values[c].extend(struct.unpack('<%d%s' % (nb_rows, fmt), raw))
+    return columns, values
+
+
+def write_csv(filename, columns, values):
+    with open(filename, 'w') as out:
+        out.write(','.join(name for name, _ in columns) + '\n')
+        for row in zip(*values):
+            out.write(','.join(str(v) for v in row) + '\n')
+
+
+def write_npz(filename, columns, values):
+    import numpy as np
+    arrays = {}
+    for (name, ctype), v in zip(columns, values):
+        arrays[name] = np.array(v, dtype=TYPES[ctype][2])
+    np.savez(filename, **arrays)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Decode signal recorder files (.srec)")
+    parser.add_argument('file', help="input .srec file")
+    parser.add_argument('-o', '--output', help="output file, .csv (default) or .npz")
+    args = parser.parse_args()
+
+    output = args.output
+    if output is None:
+        output = args.file.rsplit('.', 1)[0] + '.csv'
+    columns, values = read_srec(args.file)
+    if output.endswith('.npz'):
+        write_npz(output, columns, values)
+    else:
+        write_csv(output, columns, values)
+    print("%d rows, %d columns written to %s" % (len(values[0]), len(columns), output))
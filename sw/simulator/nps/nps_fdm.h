@@ -138,6 +138,11 @@ extern void nps_fdm_set_wind_ned(double wind_north, double wind_east, double win
 extern void nps_fdm_set_turbulence(double wind_speed, int turbulence_severity);
 /** Set temperature in degrees Celcius at given height h above MSL */
 extern void nps_fdm_set_temperature(double temp, double h);
+/**
+ * Set a parameter of the FDM model by name (e.g. a JSBSim property)
+ * @return false if the FDM has no such parameter
+ */
+extern bool nps_fdm_set_property(const char *name, double value);
 
 #ifdef __cplusplus
 } /* extern "C" */
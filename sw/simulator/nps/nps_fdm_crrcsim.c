@@ -213,6 +213,12 @@ void nps_fdm_set_turbulence(double wind_speed __attribute__((unused)),
 {
 }
 
+bool nps_fdm_set_property(const char *name __attribute__((unused)),
+                          double value __attribute__((unused)))
+{
+  return false;
+}
+
 /***************************************************************************
  ** Open and configure UDP connection
  ****************************************************************************/
@@ -318,6 +318,13 @@ void nps_fdm_set_temperature(
 {
 }
 
+bool nps_fdm_set_property(
+  const char *name __attribute__((unused)),
+  double value __attribute__((unused)))
+{
+  return false;
+}
+
 // Internal functions
 /**
  * Set up a Gazebo server.
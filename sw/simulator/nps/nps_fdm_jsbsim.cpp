@@ -296,6 +296,15 @@ void nps_fdm_set_temperature(double temp, double h)
   FDMExec->GetAtmosphere()->SetTemperature(temp, h, FGAtmosphere::eCelsius);
 }
 
+bool nps_fdm_set_property(const char *name, double value)
+{
+  FGPropertyNode *node = FDMExec->GetPropertyManager()->GetNode(string(name));
+  if (node == NULL) {
+    return false;
+  }
+  return node->SetDouble("", value);
+}
+
 /**
  * Feed JSBSim with the latest actuator commands.
  *
@@ -30,6 +30,7 @@ pthread_mutex_t fdm_mutex; // mutex for fdm data
 int pauseSignal; // for catching SIGTSTP
 
 bool nps_main_parse_options(int argc, char **argv);
+bool nps_main_ivy_enabled(void);
 
 int nps_main_init(int argc, char **argv);
 void nps_radio_and_autopilot_init(void);
@@ -63,8 +64,10 @@ struct NpsMain {
   char *spektrum_dev;
   int rc_script;
   bool norc;
-  char *ivy_bus;
+  char *ivy_bus;               ///< NULL for default bus, "none" to run without Ivy
   bool nodisplay;
+  double batch_duration;       ///< if > 0, run as fast as possible for this sim time (s) and exit
+  char *metrics_file;          ///< write the metrics of the run there at exit, "-" for stdout
 };
 
 struct NpsMain nps_main;
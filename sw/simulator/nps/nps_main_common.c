@@ -24,12 +24,22 @@
 #include "nps_main.h"
 #include <signal.h>
 #include <stdio.h>
+#include <string.h>
 #include <getopt.h>
 
 #include "nps_flightgear.h"
+#include "nps_random.h"
 
 #include "nps_ivy.h"
 
+/* scenario options, applied once the FDM is initialized */
+#define NPS_MAIN_MAX_FDM_PROPS 16
+static struct DoubleVect3 wind_ned;
+static bool wind_set = false;
+static int turbulence = -1;
+static char *fdm_props[NPS_MAIN_MAX_FDM_PROPS];
+static int nb_fdm_props = 0;
+
 #ifdef __MACH__
 pthread_mutex_t clock_mutex; // mutex for clock
 void clock_get_current_time(struct timespec *ts)
@@ -99,6 +109,20 @@ int nps_main_init(int argc, char **argv)
 
   nps_fdm_init(SIM_DT);
   nps_atmosphere_init();
+  if (wind_set) {
+    nps_atmosphere_set_wind_ned(wind_ned.x, wind_ned.y, wind_ned.z);
+  }
+  if (turbulence >= 0) {
+    nps_atmosphere.turbulence_severity = turbulence;
+  }
+  for (int i = 0; i < nb_fdm_props; i++) {
+    char *eq = strchr(fdm_props[i], '=');
+    *eq = '\0';
+    if (!nps_fdm_set_property(fdm_props[i], atof(eq + 1))) {
+      fprintf(stderr, "FDM has no property %s\n", fdm_props[i]);
+      return 1;
+    }
+  }
   nps_sensors_init(nps_main.sim_time);
   printf("Simulating with dt of %f\n", SIM_DT);
 
@@ -159,6 +183,8 @@ bool nps_main_parse_options(int argc, char **argv)
   nps_main.host_time_factor = 1.0;
   nps_main.fg_fdm = 0;
   nps_main.nodisplay = false;
+  nps_main.batch_duration = 0.;
+  nps_main.metrics_file = NULL;
 
   static const char *usage =
     "Usage: %s [options]\n"
@@ -175,6 +201,13 @@ bool nps_main_parse_options(int argc, char **argv)
     "   --ivy_bus <ivy bus>                    e.g. 127.255.255.255\n"
     "   --time_factor <factor>                 e.g. 2.5\n"
     "   --nodisplay                            e.g. disable NPS ivy messages\n"
+    "   --seed <number>                        seed of the sensor noise, e.g. 42\n"
+    "   --batch <duration in seconds>          run as fast as possible and exit, e.g. 600\n"
+    "   --metrics <file>                       write the metrics at the end of a batch run, - for stdout\n"
+    "   --wind <north,east,down>               wind in m/s, e.g. 5,-2,0\n"
+    "   --turbulence <severity>                from 0 to 7\n"
+    "   --fdm_prop <name=value>                set a parameter of the FDM model (repeatable)\n"
+    "   --fault <sensor:start[:end]>           sensor dropout in seconds (repeatable), e.g. gps:60:90\n"
     "   --fg_fdm";
 
 
@@ -193,6 +226,13 @@ bool nps_main_parse_options(int argc, char **argv)
       {"fg_fdm", 0, NULL, 0},
       {"fg_port_in", 1, NULL, 0},
       {"nodisplay", 0, NULL, 0},
+      {"seed", 1, NULL, 0},
+      {"batch", 1, NULL, 0},
+      {"metrics", 1, NULL, 0},
+      {"wind", 1, NULL, 0},
+      {"turbulence", 1, NULL, 0},
+      {"fdm_prop", 1, NULL, 0},
+      {"fault", 1, NULL, 0},
       {0, 0, 0, 0}
     };
     int option_index = 0;
@@ -231,6 +271,34 @@ bool nps_main_parse_options(int argc, char **argv)
             nps_main.fg_port_in = atoi(optarg); break;
           case 11:
             nps_main.nodisplay = true; break;
+          case 12:
+            nps_random_set_seed(strtoul(optarg, NULL, 0)); break;
+          case 13:
+            nps_main.batch_duration = atof(optarg); break;
+          case 14:
+            nps_main.metrics_file = strdup(optarg); break;
+          case 15:
+            if (sscanf(optarg, "%lf,%lf,%lf", &wind_ned.x, &wind_ned.y, &wind_ned.z) != 3) {
+              fprintf(stderr, "invalid wind: %s\n", optarg);
+              return FALSE;
+            }
+            wind_set = true;
+            break;
+          case 16:
+            turbulence = atoi(optarg); break;
+          case 17:
+            if (nb_fdm_props >= NPS_MAIN_MAX_FDM_PROPS || strchr(optarg, '=') == NULL) {
+              fprintf(stderr, "invalid or too many fdm_prop: %s\n", optarg);
+              return FALSE;
+            }
+            fdm_props[nb_fdm_props++] = strdup(optarg);
+            break;
+          case 18:
+            if (!nps_sensors_add_fault(optarg)) {
+              fprintf(stderr, "invalid or too many fault: %s\n", optarg);
+              return FALSE;
+            }
+            break;
           default:
             break;
         }
@@ -255,6 +323,12 @@ bool nps_main_parse_options(int argc, char **argv)
 }
 
 
+bool nps_main_ivy_enabled(void)
+{
+  return (nps_main.ivy_bus == NULL || strcmp(nps_main.ivy_bus, "none") != 0);
+}
+
+
 void *nps_flight_gear_loop(void *data __attribute__((unused)))
 {
   struct timespec requestStart;
@@ -314,6 +388,9 @@ void *nps_main_display(void *data __attribute__((unused)))
   struct NpsFdm fdm_ivy;
   struct NpsSensors sensors_ivy;
 
+  if (!nps_main_ivy_enabled()) {
+    return(NULL);
+  }
   nps_ivy_init(nps_main.ivy_bus);
 
   // start the loop only if no_display is false
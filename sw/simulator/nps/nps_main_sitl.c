@@ -28,15 +28,21 @@
 
 #include "nps_main.h"
 #include "nps_fdm.h"
+#include "nps_metrics.h"
 
 
-
+static int nps_main_batch(void);
 
 int main(int argc, char **argv)
 {
   if (nps_main_init(argc, argv)) {
     return 1;
   }
+  nps_metrics_init(nps_main.sim_time);
+
+  if (nps_main.batch_duration > 0.) {
+    return nps_main_batch();
+  }
 
   if (nps_main.fg_host) {
     pthread_create(&th_flight_gear, NULL, nps_flight_gear_loop, NULL);
@@ -83,6 +89,40 @@ void nps_main_run_sim_step(void)
 
   nps_autopilot_run_step(nps_main.sim_time);
 
+  nps_metrics_run_step(nps_main.sim_time);
+}
+
+
+/**
+ * Run the simulation without waiting for real time, until the end
+ * of the batch duration or a crash, then write the metrics.
+ * The Ivy display still runs (for monitoring) unless the bus is "none".
+ */
+static int nps_main_batch(void)
+{
+  if (nps_main_ivy_enabled()) {
+    pthread_create(&th_display_ivy, NULL, nps_main_display, NULL);
+  }
+
+  while (nps_main.sim_time < nps_main.batch_duration && !nps_metrics.crashed) {
+    pthread_mutex_lock(&fdm_mutex);
+    nps_main_run_sim_step();
+    nps_main.sim_time += SIM_DT;
+    pthread_mutex_unlock(&fdm_mutex);
+  }
+
+  if (nps_main.metrics_file) {
+    FILE *f = strcmp(nps_main.metrics_file, "-") == 0 ? stdout : fopen(nps_main.metrics_file, "w");
+    if (f == NULL) {
+      perror("metrics");
+      return 1;
+    }
+    nps_metrics_write(f, nps_main.sim_time);
+    if (f != stdout) {
+      fclose(f);
+    }
+  }
+  return nps_metrics.crashed ? 2 : 0;
 }
 
 
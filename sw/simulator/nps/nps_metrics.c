@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file nps_metrics.c
+ * Outcome of a simulated flight, for batch runs.
+ */
+
+#include "nps_metrics.h"
+
+#include <math.h>
+#include <string.h>
+#include "generated/airframe.h"
+#include "generated/flight_plan.h"
+#include "nps_fdm.h"
+#include "nps_autopilot.h"
+#include "state.h"
+#include "autopilot.h"
+#include "subsystems/electrical.h"
+#include "subsystems/navigation/common_flight_plan.h"
+#ifdef FIXEDWING_FIRMWARE
+#include "nav.h"
+#else
+#include "navigation.h"
+#endif
+
+/** Sampling frequency of the metrics (Hz) */
+#ifndef NPS_METRICS_FREQ
+#define NPS_METRICS_FREQ 20.
+#endif
+
+/** Vertical speed at touchdown above which the landing is a crash (m/s) */
+#ifndef NPS_METRICS_CRASH_SPEED
+#ifdef FIXEDWING_FIRMWARE
+#define NPS_METRICS_CRASH_SPEED 3.
+#else
+#define NPS_METRICS_CRASH_SPEED 2.
+#endif
+#endif
+
+/** Bank or pitch angle on ground above which the aircraft is crashed (rad) */
+#ifndef NPS_METRICS_CRASH_ANGLE
+#define NPS_METRICS_CRASH_ANGLE RadOfDeg(60.)
+#endif
+
+struct NpsMetrics nps_metrics;
+
+/** First entry time of each flight plan block, negative if never entered */
+static double block_enter_time[NB_BLOCK];
+static const char *block_names[NB_BLOCK] = FP_BLOCKS;
+
+/** Local frame of the autopilot, to compare the true position with the navigation target */
+static struct LtpDef_d ltp_def;
+static bool ltp_initialized;
+
+void nps_metrics_init(double time)
+{
+  memset(&nps_metrics, 0, sizeof(nps_metrics));
+  nps_metrics.next_update = time;
+  nps_metrics.was_on_ground = true;
+  for (int i = 0; i < NB_BLOCK; i++) {
+    block_enter_time[i] = -1.;
+  }
+  ltp_initialized = false;
+}
+
+/** Horizontal distance between the true position and the navigation target */
+static bool tracking_error(double *err)
+{
+  if (!ltp_initialized) {
+    if (!state.ned_initialized_i) {
+      return false;
+    }
+    struct EcefCoor_d ecef0;
+    ECEF_DOUBLE_OF_BFP(ecef0, state.ned_origin_i.ecef);
+    ltp_def_from_ecef_d(&ltp_def, &ecef0);
+    ltp_initialized = true;
+  }
+  struct EnuCoor_d pos;
+  enu_of_ecef_point_d(&pos, &ltp_def, &fdm.ecef_pos);
+#ifdef FIXEDWING_FIRMWARE
+  double dx = desired_x - pos.x;
+  double dy = desired_y - pos.y;
+#else
+  double dx = POS_FLOAT_OF_BFP(navigation_target.x) - pos.x;
+  double dy = POS_FLOAT_OF_BFP(navigation_target.y) - pos.y;
+#endif
+  *err = sqrt(dx * dx + dy * dy);
+  return true;
+}
+
+static void crash(double time, double speed)
+{
+  if (!nps_metrics.crashed) {
+    nps_metrics.crashed = true;
+    nps_metrics.crash_time = time;
+    nps_metrics.impact_speed = speed;
+  }
+}
+
+void nps_metrics_run_step(double time)
+{
+  if (time < nps_metrics.next_update) {
+    return;
+  }
+  const double dt = 1. / NPS_METRICS_FREQ;
+  nps_metrics.next_update += dt;
+
+  if (nav_block < NB_BLOCK && block_enter_time[nav_block] < 0.) {
+    block_enter_time[nav_block] = time;
+  }
+
+  double effort = 0.;
+  for (int i = 0; i < NPS_COMMANDS_NB; i++) {
+    effort += fabs(nps_autopilot.commands[i]);
+  }
+  nps_metrics.effort += effort / NPS_COMMANDS_NB * dt;
+
+  if (autopilot_in_flight()) {
+    nps_metrics.flight_time += dt;
+    double err;
+    if (tracking_error(&err)) {
+      nps_metrics.tracking_error_sum += err;
+      if (err > nps_metrics.tracking_error_max) {
+        nps_metrics.tracking_error_max = err;
+      }
+      nps_metrics.nb_samples++;
+    }
+  }
+
+  // descent speed, positive down
+  double vz = fdm.ltp_ecef_vel.z;
+  if (fdm.nan_count > 0 || isnan(vz)) {
+    crash(time, -1.);
+  }
+  // only set by the JSBSim FDM, the touchdown checks are skipped with the others
+  if (fdm.on_ground) {
+    if (!nps_metrics.was_on_ground && nps_metrics.last_vz > NPS_METRICS_CRASH_SPEED) {
+      crash(time, nps_metrics.last_vz);
+    }
+    if (fabs(fdm.ltp_to_body_eulers.phi) > NPS_METRICS_CRASH_ANGLE ||
+        fabs(fdm.ltp_to_body_eulers.theta) > NPS_METRICS_CRASH_ANGLE) {
+      crash(time, vz);
+    }
+  }
+  nps_metrics.was_on_ground = fdm.on_ground;
+  nps_metrics.last_vz = vz;
+}
+
+void nps_metrics_write(FILE *f, double time)
+{
+  double mean = nps_metrics.nb_samples > 0 ?
+                nps_metrics.tracking_error_sum / nps_metrics.nb_samples : 0.;
+  fprintf(f, "{\"time\": %.3f, \"flight_time\": %.3f, \"crashed\": %s, ",
+          time, nps_metrics.flight_time, nps_metrics.crashed ? "true" : "false");
+  if (nps_metrics.crashed) {
+    fprintf(f, "\"crash_time\": %.3f, \"impact_speed\": %.2f, ",
+            nps_metrics.crash_time, nps_metrics.impact_speed);
+  }
+  fprintf(f, "\"tracking_error_mean\": %.3f, \"tracking_error_max\": %.3f, ",
+          mean, nps_metrics.tracking_error_max);
+  fprintf(f, "\"energy\": %.4f, \"effort\": %.3f, \"blocks\": {",
+          electrical.energy, nps_metrics.effort);
+  bool first = true;
+  for (int i = 0; i < NB_BLOCK; i++) {
+    if (block_enter_time[i] >= 0.) {
+      fprintf(f, "%s\"%s\": %.3f", first ? "" : ", ", block_names[i], block_enter_time[i]);
+      first = false;
+    }
+  }
+  fprintf(f, "}}\n");
+  fflush(f);
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file nps_metrics.h
+ * Outcome of a simulated flight, for batch runs (see sw/simulator/nps_fanout.py).
+ *
+ * Sampled at NPS_METRICS_FREQ from the true state of the FDM:
+ *  - horizontal distance to the navigation target while in flight
+ *  - consumed energy (electrical model) and mean command effort
+ *  - time of the first entry in each flight plan block
+ *  - crash: touchdown with a descent speed above NPS_METRICS_CRASH_SPEED,
+ *    on ground with a bank or pitch larger than NPS_METRICS_CRASH_ANGLE,
+ *    or diverged FDM
+ *
+ * The touchdown checks use fdm.on_ground, which is only set by the JSBSim
+ * FDM: with the other FDMs only a diverged FDM is reported as a crash.
+ */
+
+#ifndef NPS_METRICS_H
+#define NPS_METRICS_H
+
+#include <stdio.h>
+#include "std.h"
+
+struct NpsMetrics {
+  double next_update;
+  uint32_t nb_samples;          ///< number of tracking error samples
+  double tracking_error_sum;    ///< sum of the tracking errors (m)
+  double tracking_error_max;    ///< max tracking error (m)
+  double effort;                ///< integral of the mean absolute command (s)
+  double flight_time;           ///< time in flight (s)
+  bool was_on_ground;
+  double last_vz;               ///< descent speed at the previous sample (m/s)
+  bool crashed;
+  double crash_time;            ///< sim time of the crash (s)
+  double impact_speed;          ///< descent speed at the crash (m/s), -1 if the FDM diverged
+};
+
+extern struct NpsMetrics nps_metrics;
+
+extern void nps_metrics_init(double time);
+extern void nps_metrics_run_step(double time);
+/** Write the metrics of the run as a single JSON object and a new line */
+extern void nps_metrics_write(FILE *f, double time);
+
+#endif /* NPS_METRICS_H */
@@ -2,289 +2,203 @@
 
 
 #include <math.h>
-#include <limits.h>
+#include <string.h>
 
+/** Seed of the noise, can be changed with --seed */
+#ifndef NPS_RANDOM_SEED
+#define NPS_RANDOM_SEED 0
+#endif
 
-#if 0
-/*
- * R250
- * Kirkpatrick, S., and E. Stoll, 1981; "A Very Fast
- * Shift-Register Sequence Random Number Generator",
- * Journal of Computational Physics, V.40
- *
- */
-
-static void         r250_init(int seed);
-//static unsigned int r250( void );
-static double       dr250(void);
+static uint32_t nps_random_seed = NPS_RANDOM_SEED;
 
 /*
- * randclg
- * Linear Congruential Method, the "minimal standard generator"
- * Park & Miller, 1988, Comm of the ACM, 31(10), pp. 1192-1201
- *
+ * Philox4x32-10
+ * Salmon, Moraes, Dror, Shaw, 2011; "Parallel Random Numbers: As Easy as 1, 2, 3",
+ * SC '11, counter based generator passing BigCrush
  */
-
-static long              set_seed(long);
-//static long              get_seed(void);
-static unsigned long int randlcg(void);
-#endif
-
-
-void double_vect3_add_gaussian_noise(struct DoubleVect3 *vect, struct DoubleVect3 *std_dev)
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+
+static inline void philox4x32(uint32_t out[4], uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3,
+                              uint32_t k0, uint32_t k1)
 {
-  vect->x += get_gaussian_noise() * std_dev->x;
-  vect->y += get_gaussian_noise() * std_dev->y;
-  vect->z += get_gaussian_noise() * std_dev->z;
+  for (int i = 0; i < PHILOX_ROUNDS; i++) {
+    uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+    uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+    uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+    uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+    c1 = (uint32_t)p1;
+    c3 = (uint32_t)p0;
+    c0 = n0;
+    c2 = n2;
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
 }
 
-void float_vect3_add_gaussian_noise(struct FloatVect3 *vect, struct FloatVect3 *std_dev)
+void nps_random_philox(uint32_t out[4], const uint32_t ctr[4], const uint32_t key[2])
 {
-  vect->x += get_gaussian_noise() * std_dev->x;
-  vect->y += get_gaussian_noise() * std_dev->y;
-  vect->z += get_gaussian_noise() * std_dev->z;
+  philox4x32(out, ctr[0], ctr[1], ctr[2], ctr[3], key[0], key[1]);
 }
 
-void float_rates_add_gaussian_noise(struct FloatRates *vect, struct FloatRates *std_dev)
+/** Uniform in (0, 1) from 32 random bits, never 0 for the log */
+#define UNIFORM_OF_U32(_x) (((double)(_x) + 0.5) * (1. / 4294967296.))
+
+/** Box-Muller transform of 2 pairs of random words to 4 gaussian numbers
+ *
+ * The transform stays scalar, with the double log, sqrt, cos and sin of the
+ * libm (the compiler merges the last two into one sincos call): vectorizing them would need the vector libm and -ffast-math, which
+ * NPS is not built with, and it would change the numbers of a given seed.
+ * The batch only groups the Philox blocks, which are plain integer loops.
+ */
+static inline void gauss4_of_u32(double *g, const uint32_t u[4])
 {
-  vect->p += get_gaussian_noise() * std_dev->p;
-  vect->q += get_gaussian_noise() * std_dev->q;
-  vect->r += get_gaussian_noise() * std_dev->r;
+  for (int i = 0; i < 2; i++) {
+    double r = sqrt(-2. * log(UNIFORM_OF_U32(u[2 * i])));
+    double theta = 2. * M_PI * UNIFORM_OF_U32(u[2 * i + 1]);
+    g[2 * i] = r * cos(theta);
+    g[2 * i + 1] = r * sin(theta);
+  }
 }
 
-
-
-void double_vect3_get_gaussian_noise(struct DoubleVect3 *vect, struct DoubleVect3 *std_dev)
+void nps_random_set_seed(uint32_t seed)
 {
-  vect->x = get_gaussian_noise() * std_dev->x;
-  vect->y = get_gaussian_noise() * std_dev->y;
-  vect->z = get_gaussian_noise() * std_dev->z;
+  nps_random_seed = seed;
 }
 
-
-void double_vect3_update_random_walk(struct DoubleVect3 *rw, struct DoubleVect3 *std_dev, double dt, double thau)
+void nps_random_stream_init(struct NpsRandomStream *s, uint32_t id)
 {
-  struct DoubleVect3 drw;
-  double_vect3_get_gaussian_noise(&drw, std_dev);
-  struct DoubleVect3 tmp;
-  VECT3_SMUL(tmp, *rw, (-1. / thau));
-  VECT3_ADD(drw, tmp);
-  VECT3_SMUL(drw, drw, dt);
-  VECT3_ADD(*rw, drw);
+  s->key[0] = nps_random_seed;
+  s->key[1] = id;
+  s->counter = 0;
+  s->nb_buf = 0;
 }
 
-
-
-
-
-#if 0
-/*
-   http://www.taygeta.com/random/gaussian.html
-*/
-double get_gaussian_noise(void)
+void nps_random_gaussian(struct NpsRandomStream *s, double *out, uint16_t n)
 {
-
-  double x1;
-  static int nb_call = 0;
-  static double x2, w;
-  if (nb_call == 0) { r250_init(0); }
-  nb_call++;
-  if (nb_call % 2) {
-    do {
-      x1 = 2.0 * dr250() - 1.0;
-      x2 = 2.0 * dr250() - 1.0;
-      w = x1 * x1 + x2 * x2;
-    } while (w >= 1.0);
-
-    w = sqrt((-2.0 * log(w)) / w);
-    return x1 * w;
-  } else {
-    return x2 * w;
+  uint32_t u[4];
+  double g[4];
+  for (uint16_t i = 0; i < n; i += 4) {
+    philox4x32(u, (uint32_t)s->counter, (uint32_t)(s->counter >> 32), 0, 0, s->key[0], s->key[1]);
+    s->counter++;
+    gauss4_of_u32(g, u);
+    memcpy(&out[i], g, (n - i < 4 ? n - i : 4) * sizeof(double));
   }
 }
-#else
-#include <gsl/gsl_rng.h>
-#include <gsl/gsl_randist.h>
-#include <stdlib.h>
-double get_gaussian_noise(void)
+
+double nps_random_gaussian_1(struct NpsRandomStream *s)
 {
-  static gsl_rng *r = NULL;
-  // select random number generator
-  if (!r) { r = gsl_rng_alloc(gsl_rng_mt19937); }
-  return gsl_ran_gaussian(r, 1.);
+  if (s->nb_buf == 0) {
+    nps_random_gaussian(s, s->buf, 4);
+    s->nb_buf = 4;
+  }
+  return s->buf[--s->nb_buf];
 }
-#endif
-
-
-#if 0
-/*
- * R250
- * Kirkpatrick, S., and E. Stoll, 1981; "A Very Fast
- * Shift-Register Sequence Random Number Generator",
- * Journal of Computational Physics, V.40
- *
- */
-
-/* defines to allow for 16 or 32 bit integers */
-#define BITS 31
-
-
-#if WORD_BIT == 32
-#ifndef BITS
-#define BITS  32
-#endif
-#else
-#ifndef BITS
-#define BITS    16
-#endif
-#endif
 
-#if BITS == 31
-#define MSB          0x40000000L
-#define ALL_BITS     0x7fffffffL
-#define HALF_RANGE   0x20000000L
-#define STEP         7
-#endif
-
-#if BITS == 32
-#define MSB          0x80000000L
-#define ALL_BITS     0xffffffffL
-#define HALF_RANGE   0x40000000L
-#define STEP         7
-#endif
-
-#if BITS == 16
-#define MSB         0x8000
-#define ALL_BITS    0xffff
-#define HALF_RANGE  0x4000
-#define STEP        11
-#endif
-
-static unsigned int r250_buffer[ 250 ];
-static int r250_index;
-
-static void r250_init(int sd)
+void nps_random_batch_reset(struct NpsRandomBatch *b)
 {
-  int j, k;
-  unsigned int mask, msb;
-  set_seed(sd);
+  b->nb_blocks = 0;
+}
 
-  r250_index = 0;
-  for (j = 0; j < 250; j++) {    /* fill r250 buffer with BITS-1 bit values */
-    r250_buffer[j] = randlcg();
+double *nps_random_batch_add(struct NpsRandomBatch *b, struct NpsRandomStream *s, uint16_t n)
+{
+  uint16_t nb = (n + 3) / 4;
+  if (b->nb_blocks + nb > NPS_RANDOM_BATCH_MAX_BLOCKS) {
+    return NULL;
   }
-
-  for (j = 0; j < 250; j++) /* set some MSBs to 1 */
-    if (randlcg() > HALF_RANGE) {
-      r250_buffer[j] |= MSB;
-    }
-
-  msb = MSB;          /* turn on diagonal bit */
-  mask = ALL_BITS;  /* turn off the leftmost bits */
-
-  for (j = 0; j < BITS; j++)  {
-    k = STEP * j + 3; /* select a word to operate on */
-    r250_buffer[k] &= mask; /* turn off bits left of the diagonal */
-    r250_buffer[k] |= msb;  /* turn on the diagonal bit */
-    mask >>= 1;
-    msb  >>= 1;
+  double *out = &b->gauss[4 * b->nb_blocks];
+  for (uint16_t i = 0; i < nb; i++) {
+    b->key0[b->nb_blocks] = s->key[0];
+    b->key1[b->nb_blocks] = s->key[1];
+    b->ctr0[b->nb_blocks] = (uint32_t)s->counter;
+    b->ctr1[b->nb_blocks] = (uint32_t)(s->counter >> 32);
+    b->nb_blocks++;
+    s->counter++;
   }
-
+  return out;
 }
 
-#if 0
-/* returns a random unsigned integer */
-static unsigned int r250(void)
+void nps_random_batch_run(struct NpsRandomBatch *b)
 {
-  register int  j;
-  register unsigned int new_rand;
-
-  if (r250_index >= 147) {
-    j = r250_index - 147;  /* wrap pointer around */
-  } else {
-    j = r250_index + 103;
+  uint32_t u[4 * NPS_RANDOM_BATCH_MAX_BLOCKS];
+  for (uint16_t i = 0; i < b->nb_blocks; i++) {
+    philox4x32(&u[4 * i], b->ctr0[i], b->ctr1[i], 0, 0, b->key0[i], b->key1[i]);
   }
-
-  new_rand = r250_buffer[ r250_index ] ^ r250_buffer[ j ];
-  r250_buffer[ r250_index ] = new_rand;
-
-  if (r250_index >= 249) { /* increment pointer for next time */
-    r250_index = 0;
-  } else {
-    r250_index++;
+  for (uint16_t i = 0; i < b->nb_blocks; i++) {
+    gauss4_of_u32(&b->gauss[4 * i], &u[4 * i]);
   }
-
-  return new_rand;
-
 }
-#endif
 
-/* returns a random double in range 0..1 */
-static double dr250(void)
+double get_gaussian_noise(void)
 {
-  register int  j;
-  register unsigned int new_rand;
-
-  if (r250_index >= 147) {
-    j = r250_index - 147;  /* wrap pointer around */
-  } else {
-    j = r250_index + 103;
+  static struct NpsRandomStream s;
+  static bool initialized = false;
+  if (!initialized) {
+    nps_random_stream_init(&s, NPS_RANDOM_STREAM_DEFAULT);
+    initialized = true;
   }
+  return nps_random_gaussian_1(&s);
+}
 
-  new_rand = r250_buffer[ r250_index ] ^ r250_buffer[ j ];
-  r250_buffer[ r250_index ] = new_rand;
 
-  if (r250_index >= 249) { /* increment pointer for next time */
-    r250_index = 0;
-  } else {
-    r250_index++;
-  }
+void double_vect3_add_noise(struct DoubleVect3 *vect, struct DoubleVect3 *std_dev, const double *noise)
+{
+  vect->x += noise[0] * std_dev->x;
+  vect->y += noise[1] * std_dev->y;
+  vect->z += noise[2] * std_dev->z;
+}
 
-  return (double)new_rand / ALL_BITS;
+void double_vect3_add_gaussian_noise(struct DoubleVect3 *vect, struct DoubleVect3 *std_dev)
+{
+  vect->x += get_gaussian_noise() * std_dev->x;
+  vect->y += get_gaussian_noise() * std_dev->y;
+  vect->z += get_gaussian_noise() * std_dev->z;
+}
 
+void float_vect3_add_gaussian_noise(struct FloatVect3 *vect, struct FloatVect3 *std_dev)
+{
+  vect->x += get_gaussian_noise() * std_dev->x;
+  vect->y += get_gaussian_noise() * std_dev->y;
+  vect->z += get_gaussian_noise() * std_dev->z;
 }
 
-/*
- * randclg
- * Linear Congruential Method, the "minimal standard generator"
- * Park & Miller, 1988, Comm of the ACM, 31(10), pp. 1192-1201
- *
- */
+void float_rates_add_gaussian_noise(struct FloatRates *vect, struct FloatRates *std_dev)
+{
+  vect->p += get_gaussian_noise() * std_dev->p;
+  vect->q += get_gaussian_noise() * std_dev->q;
+  vect->r += get_gaussian_noise() * std_dev->r;
+}
 
-static long int quotient  = LONG_MAX / 16807L;
-static long int my_remainder = LONG_MAX % 16807L;
 
-static long int seed_val = 1L;
 
-static long set_seed(long int sd)
+void double_vect3_get_gaussian_noise(struct DoubleVect3 *vect, struct DoubleVect3 *std_dev)
 {
-  return seed_val = sd;
+  vect->x = get_gaussian_noise() * std_dev->x;
+  vect->y = get_gaussian_noise() * std_dev->y;
+  vect->z = get_gaussian_noise() * std_dev->z;
 }
 
-//static long get_seed(void) {
-//  return seed_val;
-//}
 
-/* returns a random unsigned integer */
-unsigned long int randlcg()
+void double_vect3_update_random_walk_noise(struct DoubleVect3 *rw, struct DoubleVect3 *std_dev, double dt,
+    double thau, const double *noise)
 {
-  if (seed_val <= quotient) {
-    seed_val = (seed_val * 16807L) % LONG_MAX;
-  } else {
-    long int high_part = seed_val / quotient;
-    long int low_part  = seed_val % quotient;
-
-    long int test = 16807L * low_part - my_remainder * high_part;
-
-    if (test > 0) {
-      seed_val = test;
-    } else {
-      seed_val = test + LONG_MAX;
-    }
-
-  }
-
-  return seed_val;
+  struct DoubleVect3 drw = { noise[0] * std_dev->x, noise[1] * std_dev->y, noise[2] * std_dev->z };
+  struct DoubleVect3 tmp;
+  VECT3_SMUL(tmp, *rw, (-1. / thau));
+  VECT3_ADD(drw, tmp);
+  VECT3_SMUL(drw, drw, dt);
+  VECT3_ADD(*rw, drw);
 }
 
-#endif /* 0*/
+void double_vect3_update_random_walk(struct DoubleVect3 *rw, struct DoubleVect3 *std_dev, double dt, double thau)
+{
+  double noise[3] = { get_gaussian_noise(), get_gaussian_noise(), get_gaussian_noise() };
+  double_vect3_update_random_walk_noise(rw, std_dev, dt, thau, noise);
+}
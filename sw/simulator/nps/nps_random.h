@@ -3,16 +3,85 @@
 
 #include "math/pprz_algebra_double.h"
 
+/**
+ * Counter based random stream (Philox4x32-10).
+ * Block n of a stream only depends on the seed, the stream id and n, so each
+ * sensor draws the same noise sequence for a given seed, whatever the other
+ * sensors and their rates are.
+ */
+struct NpsRandomStream {
+  uint32_t key[2];      ///< seed and stream id
+  uint64_t counter;     ///< next block of 4 numbers
+  double buf[4];        ///< numbers left of the last block, for single draws
+  uint8_t nb_buf;
+};
+
+/** Stream ids */
+enum NpsRandomStreamId {
+  NPS_RANDOM_STREAM_DEFAULT,
+  NPS_RANDOM_STREAM_GYRO,
+  NPS_RANDOM_STREAM_ACCEL,
+  NPS_RANDOM_STREAM_MAG,
+  NPS_RANDOM_STREAM_BARO,
+  NPS_RANDOM_STREAM_GPS
+};
+
+/** Maximum number of blocks of 4 numbers in a batch */
+#define NPS_RANDOM_BATCH_MAX_BLOCKS 16
+
+/**
+ * Gaussian numbers of several streams, generated in one pass.
+ * Reserve the numbers with nps_random_batch_add(), then compute all of them
+ * with nps_random_batch_run(), in two loops over independent blocks
+ * instead of one call per sensor axis.
+ * The time is spent in the scalar libm transform, so this is not faster
+ * than drawing from each stream (about 550 ns per step for the gyro, accel,
+ * mag and baro on a x86-64 VM, see tests/nps), whole blocks of 4 numbers
+ * are drawn per sensor to keep the streams independent.
+ */
+struct NpsRandomBatch {
+  uint16_t nb_blocks;
+  uint32_t key0[NPS_RANDOM_BATCH_MAX_BLOCKS];
+  uint32_t key1[NPS_RANDOM_BATCH_MAX_BLOCKS];
+  uint32_t ctr0[NPS_RANDOM_BATCH_MAX_BLOCKS];
+  uint32_t ctr1[NPS_RANDOM_BATCH_MAX_BLOCKS];
+  double gauss[4 * NPS_RANDOM_BATCH_MAX_BLOCKS];
+};
+
+/** One Philox4x32-10 block, e.g. for the known answer tests */
+extern void nps_random_philox(uint32_t out[4], const uint32_t ctr[4], const uint32_t key[2]);
+
+/** Set the seed of the streams initialized after this call (default NPS_RANDOM_SEED) */
+extern void nps_random_set_seed(uint32_t seed);
+extern void nps_random_stream_init(struct NpsRandomStream *s, uint32_t id);
+/** Fill out with n standard gaussian numbers */
+extern void nps_random_gaussian(struct NpsRandomStream *s, double *out, uint16_t n);
+/** One standard gaussian number */
+extern double nps_random_gaussian_1(struct NpsRandomStream *s);
+
+extern void nps_random_batch_reset(struct NpsRandomBatch *b);
+/**
+ * Reserve n numbers of a stream in a batch
+ * @return where the numbers will be after nps_random_batch_run(), NULL if the batch is full
+ */
+extern double *nps_random_batch_add(struct NpsRandomBatch *b, struct NpsRandomStream *s, uint16_t n);
+extern void nps_random_batch_run(struct NpsRandomBatch *b);
+
+/** Standard gaussian number of the default stream */
 extern double get_gaussian_noise(void);
 extern void double_vect3_add_gaussian_noise(struct DoubleVect3 *vect, struct DoubleVect3 *std_dev);
 extern void double_vect3_get_gaussian_noise(struct DoubleVect3 *vect, struct DoubleVect3 *std_dev);
 extern void double_vect3_update_random_walk(struct DoubleVect3 *rw, struct DoubleVect3 *std_dev, double dt,
     double thau);
 
+/** Same as above with given standard gaussian numbers (3 per vector) */
+extern void double_vect3_add_noise(struct DoubleVect3 *vect, struct DoubleVect3 *std_dev, const double *noise);
+extern void double_vect3_update_random_walk_noise(struct DoubleVect3 *rw, struct DoubleVect3 *std_dev, double dt,
+    double thau, const double *noise);
+
 extern void float_vect3_add_gaussian_noise(struct FloatVect3 *vect, struct FloatVect3 *std_dev);
 extern void float_rates_add_gaussian_noise(struct FloatRates *vect, struct FloatRates *std_dev);
 
 
 
 #endif /* NPS_RANDOM_H */
-
@@ -20,16 +20,24 @@ void nps_sensor_accel_init(struct NpsSensorAccel *accel, double time)
                NPS_ACCEL_NOISE_STD_DEV_X, NPS_ACCEL_NOISE_STD_DEV_Y, NPS_ACCEL_NOISE_STD_DEV_Z);
   VECT3_ASSIGN(accel->bias,
                NPS_ACCEL_BIAS_X, NPS_ACCEL_BIAS_Y, NPS_ACCEL_BIAS_Z);
+  nps_random_stream_init(&accel->noise_stream, NPS_RANDOM_STREAM_ACCEL);
   accel->next_update = time;
   accel->data_available = FALSE;
 }
 
-void nps_sensor_accel_run_step(struct NpsSensorAccel *accel, double time, struct DoubleRMat *body_to_imu)
+void nps_sensor_accel_run_step(struct NpsSensorAccel *accel, double time, struct DoubleRMat *body_to_imu,
+                               const double *noise)
 {
   if (time < accel->next_update) {
     return;
   }
 
+  double own_noise[NPS_ACCEL_NB_NOISE];
+  if (noise == NULL) {
+    nps_random_gaussian(&accel->noise_stream, own_noise, NPS_ACCEL_NB_NOISE);
+    noise = own_noise;
+  }
+
   /* transform to imu frame */
   struct DoubleVect3 accelero_imu;
   MAT33_VECT3_MUL(accelero_imu, *body_to_imu, fdm.body_accel);
@@ -43,7 +51,7 @@ void nps_sensor_accel_run_step(struct NpsSensorAccel *accel, double time, struct
   /* constant bias */
   VECT3_COPY(accelero_error, accel->bias);
   /* white noise   */
-  double_vect3_add_gaussian_noise(&accelero_error, &accel->noise_std_dev);
+  double_vect3_add_noise(&accelero_error, &accel->noise_std_dev, noise);
   /* scale */
   struct DoubleVect3 gain = {accel->sensitivity.m[0], accel->sensitivity.m[4], accel->sensitivity.m[8]};
   VECT3_EW_MUL(accelero_error, accelero_error, gain);
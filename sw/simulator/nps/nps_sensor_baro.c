@@ -15,12 +15,13 @@ void nps_sensor_baro_init(struct NpsSensorBaro *baro, double time)
 {
   baro->value = 0.;
   baro->noise_std_dev = NPS_BARO_NOISE_STD_DEV;
+  nps_random_stream_init(&baro->noise_stream, NPS_RANDOM_STREAM_BARO);
   baro->next_update = time;
   baro->data_available = FALSE;
 }
 
 
-void nps_sensor_baro_run_step(struct NpsSensorBaro *baro, double time)
+void nps_sensor_baro_run_step(struct NpsSensorBaro *baro, double time, const double *noise)
 {
   if (time < baro->next_update) {
     return;
@@ -29,7 +30,8 @@ void nps_sensor_baro_run_step(struct NpsSensorBaro *baro, double time)
   /* pressure in Pascal */
   baro->value = fdm.pressure;
   /* add noise with std dev Pascal */
-  baro->value += get_gaussian_noise() * baro->noise_std_dev;
+  double n = noise ? noise[0] : nps_random_gaussian_1(&baro->noise_stream);
+  baro->value += n * baro->noise_std_dev;
 
   baro->next_update += NPS_BARO_DT;
   baro->data_available = TRUE;
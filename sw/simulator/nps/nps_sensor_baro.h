@@ -5,16 +5,25 @@
 #include "math/pprz_algebra_double.h"
 #include "math/pprz_algebra_float.h"
 #include "std.h"
+#include "nps_random.h"
+
+/** Number of standard gaussian numbers used at each step */
+#define NPS_BARO_NB_NOISE 1
 
 struct NpsSensorBaro {
   double  value;          ///< pressure in Pascal
   double  noise_std_dev;  ///< noise standard deviation
+  struct NpsRandomStream noise_stream;
   double  next_update;
   bool  data_available;
 };
 
 
 extern void nps_sensor_baro_init(struct NpsSensorBaro *baro, double time);
-extern void nps_sensor_baro_run_step(struct NpsSensorBaro *baro, double time);
+/**
+ * Run a step of the sensor
+ * @param noise NPS_BARO_NB_NOISE standard gaussian numbers, NULL to draw them from the sensor stream
+ */
+extern void nps_sensor_baro_run_step(struct NpsSensorBaro *baro, double time, const double *noise);
 
 #endif /* NPS_SENSOR_BARO_H */
@@ -25,6 +25,7 @@ void nps_sensor_gps_init(struct NpsSensorGps *gps, double time)
                NPS_GPS_POS_BIAS_RANDOM_WALK_STD_DEV_Y,
                NPS_GPS_POS_BIAS_RANDOM_WALK_STD_DEV_Z);
   FLOAT_VECT3_ZERO(gps->pos_bias_random_walk_value);
+  nps_random_stream_init(&gps->noise_stream, NPS_RANDOM_STREAM_GPS);
   gps->next_update = time;
   gps->data_available = FALSE;
 }
@@ -42,13 +43,17 @@ void nps_sensor_gps_run_step(struct NpsSensorGps *gps, double time)
     return;
   }
 
+  /* speed noise, position noise and random walk */
+  double noise[9];
+  nps_random_gaussian(&gps->noise_stream, noise, 9);
+
   /*
    * simulate speed sensor
    */
   struct DoubleVect3 cur_speed_reading;
   VECT3_COPY(cur_speed_reading, fdm.ecef_ecef_vel);
   /* add a gaussian noise */
-  double_vect3_add_gaussian_noise(&cur_speed_reading, &gps->speed_noise_std_dev);
+  double_vect3_add_noise(&cur_speed_reading, &gps->speed_noise_std_dev, &noise[0]);
 
   /* store that for later and retrieve a previously stored data */
   UpdateSensorLatency(time, &cur_speed_reading, &gps->speed_history, gps->speed_latency, &gps->ecef_vel);
@@ -61,9 +66,10 @@ void nps_sensor_gps_run_step(struct NpsSensorGps *gps, double time)
   struct DoubleVect3 pos_error;
   VECT3_COPY(pos_error, gps->pos_bias_initial);
   /* add a gaussian noise */
-  double_vect3_add_gaussian_noise(&pos_error, &gps->pos_noise_std_dev);
+  double_vect3_add_noise(&pos_error, &gps->pos_noise_std_dev, &noise[3]);
   /* update random walk bias and add it to error*/
-  double_vect3_update_random_walk(&gps->pos_bias_random_walk_value, &gps->pos_bias_random_walk_std_dev, NPS_GPS_DT, 5.);
+  double_vect3_update_random_walk_noise(&gps->pos_bias_random_walk_value, &gps->pos_bias_random_walk_std_dev, NPS_GPS_DT, 5.,
+                                        &noise[6]);
   VECT3_ADD(pos_error, gps->pos_bias_random_walk_value);
 
   /* add error to current pos reading */
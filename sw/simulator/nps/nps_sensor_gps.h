@@ -9,6 +9,7 @@
 #include "math/pprz_geodetic_double.h"
 
 #include "std.h"
+#include "nps_random.h"
 
 struct NpsSensorGps {
   struct EcefCoor_d ecef_pos;
@@ -26,6 +27,7 @@ struct NpsSensorGps {
   GSList *pos_history;
   GSList *lla_history;
   GSList *speed_history;
+  struct NpsRandomStream noise_stream;
   double next_update;
   bool data_available;
 };
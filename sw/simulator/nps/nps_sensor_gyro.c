@@ -24,17 +24,25 @@ void  nps_sensor_gyro_init(struct NpsSensorGyro *gyro, double time)
                NPS_GYRO_BIAS_RANDOM_WALK_STD_DEV_Q,
                NPS_GYRO_BIAS_RANDOM_WALK_STD_DEV_R);
   FLOAT_VECT3_ZERO(gyro->bias_random_walk_value);
+  nps_random_stream_init(&gyro->noise_stream, NPS_RANDOM_STREAM_GYRO);
   gyro->next_update = time;
   gyro->data_available = FALSE;
 }
 
-void nps_sensor_gyro_run_step(struct NpsSensorGyro *gyro, double time, struct DoubleRMat *body_to_imu)
+void nps_sensor_gyro_run_step(struct NpsSensorGyro *gyro, double time, struct DoubleRMat *body_to_imu,
+                              const double *noise)
 {
 
   if (time < gyro->next_update) {
     return;
   }
 
+  double own_noise[NPS_GYRO_NB_NOISE];
+  if (noise == NULL) {
+    nps_random_gaussian(&gyro->noise_stream, own_noise, NPS_GYRO_NB_NOISE);
+    noise = own_noise;
+  }
+
   /* transform body rates to IMU frame */
   struct DoubleVect3 *rate_body = (struct DoubleVect3 *)(&fdm.body_inertial_rotvel);
   struct DoubleVect3 rate_imu;
@@ -45,9 +53,9 @@ void nps_sensor_gyro_run_step(struct NpsSensorGyro *gyro, double time, struct Do
   /* compute gyro error readings */
   struct DoubleVect3 gyro_error;
   VECT3_COPY(gyro_error, gyro->bias_initial);
-  double_vect3_add_gaussian_noise(&gyro_error, &gyro->noise_std_dev);
-  double_vect3_update_random_walk(&gyro->bias_random_walk_value, &gyro->bias_random_walk_std_dev,
-                                  NPS_GYRO_DT, 5.);
+  double_vect3_add_noise(&gyro_error, &gyro->noise_std_dev, &noise[0]);
+  double_vect3_update_random_walk_noise(&gyro->bias_random_walk_value, &gyro->bias_random_walk_std_dev,
+                                        NPS_GYRO_DT, 5., &noise[3]);
   VECT3_ADD(gyro_error, gyro->bias_random_walk_value);
 
   struct DoubleVect3 gain = {gyro->sensitivity.m[0], gyro->sensitivity.m[4], gyro->sensitivity.m[8]};
@@ -5,6 +5,10 @@
 #include "math/pprz_algebra_double.h"
 #include "math/pprz_algebra_float.h"
 #include "std.h"
+#include "nps_random.h"
+
+/** Number of standard gaussian numbers used at each step */
+#define NPS_GYRO_NB_NOISE 6
 
 struct NpsSensorGyro {
   struct DoubleVect3  value;
@@ -16,13 +20,19 @@ struct NpsSensorGyro {
   struct DoubleVect3  bias_initial;
   struct DoubleVect3  bias_random_walk_std_dev;
   struct DoubleVect3  bias_random_walk_value;
+  struct NpsRandomStream noise_stream;
   double       next_update;
   bool       data_available;
 };
 
 
 extern void   nps_sensor_gyro_init(struct NpsSensorGyro *gyro, double time);
-extern void   nps_sensor_gyro_run_step(struct NpsSensorGyro *gyro, double time, struct DoubleRMat *body_to_imu);
+/**
+ * Run a step of the sensor
+ * @param noise NPS_GYRO_NB_NOISE standard gaussian numbers, NULL to draw them from the sensor stream
+ */
+extern void   nps_sensor_gyro_run_step(struct NpsSensorGyro *gyro, double time, struct DoubleRMat *body_to_imu,
+                                       const double *noise);
 
 #endif /* NPS_SENSOR_GYRO_H */
 
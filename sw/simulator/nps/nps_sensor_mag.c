@@ -19,17 +19,25 @@ void nps_sensor_mag_init(struct NpsSensorMag *mag, double time)
   struct DoubleEulers imu_to_sensor_eulers =
     { NPS_MAG_IMU_TO_SENSOR_PHI, NPS_MAG_IMU_TO_SENSOR_THETA, NPS_MAG_IMU_TO_SENSOR_PSI };
   double_rmat_of_eulers(&(mag->imu_to_sensor_rmat), &imu_to_sensor_eulers);
+  nps_random_stream_init(&mag->noise_stream, NPS_RANDOM_STREAM_MAG);
   mag->next_update = time;
   mag->data_available = FALSE;
 }
 
-void nps_sensor_mag_run_step(struct NpsSensorMag *mag, double time, struct DoubleRMat *body_to_imu)
+void nps_sensor_mag_run_step(struct NpsSensorMag *mag, double time, struct DoubleRMat *body_to_imu,
+                             const double *noise)
 {
 
   if (time < mag->next_update) {
     return;
   }
 
+  double own_noise[NPS_MAG_NB_NOISE];
+  if (noise == NULL) {
+    nps_random_gaussian(&mag->noise_stream, own_noise, NPS_MAG_NB_NOISE);
+    noise = own_noise;
+  }
+
   /* transform magnetic field to body frame */
   struct DoubleVect3 h_body;
   double_quat_vmult(&h_body, &fdm.ltp_to_body_quat, &fdm.ltp_h);
@@ -45,7 +53,17 @@ void nps_sensor_mag_run_step(struct NpsSensorMag *mag, double time, struct Doubl
   /* compute magnetometer reading */
   MAT33_VECT3_MUL(mag->value, mag->sensitivity, h_sensor);
   VECT3_ADD(mag->value, mag->neutral);
-  /* FIXME: ADD error reading */
+
+  /* white noise, scaled by the sensitivity like the other imu sensors
+   * NPS_MAG_NOISE_STD_DEV used to be ignored (readings were noise free),
+   * set it to 0 in the sensors parameters to get the former behavior
+   */
+  struct DoubleVect3 mag_error;
+  VECT3_ASSIGN(mag_error, 0., 0., 0.);
+  double_vect3_add_noise(&mag_error, &mag->noise_std_dev, noise);
+  struct DoubleVect3 gain = {mag->sensitivity.m[0], mag->sensitivity.m[4], mag->sensitivity.m[8]};
+  VECT3_EW_MUL(mag_error, mag_error, gain);
+  VECT3_ADD(mag->value, mag_error);
 
   /* round signal to account for adc discretisation */
   DOUBLE_VECT3_ROUND(mag->value);
@@ -5,6 +5,10 @@
 #include "math/pprz_algebra_double.h"
 #include "math/pprz_algebra_float.h"
 #include "std.h"
+#include "nps_random.h"
+
+/** Number of standard gaussian numbers used at each step */
+#define NPS_MAG_NB_NOISE 3
 
 struct NpsSensorMag {
   struct DoubleVect3  value;
@@ -14,12 +18,18 @@ struct NpsSensorMag {
   struct DoubleVect3 neutral;
   struct DoubleVect3 noise_std_dev;
   struct DoubleRMat  imu_to_sensor_rmat;
+  struct NpsRandomStream noise_stream;
   double       next_update;
   bool       data_available;
 };
 
 
 extern void nps_sensor_mag_init(struct NpsSensorMag *mag, double time);
-extern void nps_sensor_mag_run_step(struct NpsSensorMag *mag, double time, struct DoubleRMat *body_to_imu);
+/**
+ * Run a step of the sensor
+ * @param noise NPS_MAG_NB_NOISE standard gaussian numbers, NULL to draw them from the sensor stream
+ */
+extern void nps_sensor_mag_run_step(struct NpsSensorMag *mag, double time, struct DoubleRMat *body_to_imu,
+                                    const double *noise);
 
 #endif /* NPS_SENSOR_MAG_H */
@@ -1,10 +1,61 @@
 #include "nps_sensors.h"
 
+#include <stdio.h>
+#include <string.h>
 #include "generated/airframe.h"
 #include NPS_SENSORS_PARAMS
 
 struct NpsSensors sensors;
 
+#ifndef NPS_SENSORS_MAX_FAULTS
+#define NPS_SENSORS_MAX_FAULTS 8
+#endif
+
+/** Sensor dropout */
+struct NpsSensorFault {
+  bool *data_available;
+  double start;
+  double end;
+};
+
+static struct NpsSensorFault faults[NPS_SENSORS_MAX_FAULTS];
+static int nb_faults = 0;
+
+bool nps_sensors_add_fault(const char *spec)
+{
+  const struct {
+    const char *name;
+    bool *data_available;
+  } names[] = {
+    { "gyro", &sensors.gyro.data_available },
+    { "accel", &sensors.accel.data_available },
+    { "mag", &sensors.mag.data_available },
+    { "baro", &sensors.baro.data_available },
+    { "gps", &sensors.gps.data_available },
+    { "sonar", &sensors.sonar.data_available },
+    { "airspeed", &sensors.airspeed.data_available },
+    { "temperature", &sensors.temp.data_available },
+    { "aoa", &sensors.aoa.data_available },
+    { "sideslip", &sensors.sideslip.data_available },
+  };
+  char name[16];
+  double start, end = 1e9;
+  if (nb_faults >= NPS_SENSORS_MAX_FAULTS ||
+      sscanf(spec, "%15[a-z]:%lf:%lf", name, &start, &end) < 2) {
+    return false;
+  }
+  for (unsigned int i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+    if (strcmp(name, names[i].name) == 0) {
+      faults[nb_faults].data_available = names[i].data_available;
+      faults[nb_faults].start = start;
+      faults[nb_faults].end = end;
+      nb_faults++;
+      return true;
+    }
+  }
+  return false;
+}
+
 void nps_sensors_init(double time)
 {
 
@@ -25,18 +76,38 @@ void nps_sensors_init(double time)
 }
 
 
+/** Reserve the noise of a sensor in the batch if it is updated at this step */
+#define NPS_SENSORS_NOISE(_batch, _s, _nb, _time) \
+  (((_time) >= (_s).next_update) ? nps_random_batch_add(_batch, &(_s).noise_stream, _nb) : NULL)
+
 void nps_sensors_run_step(double time)
 {
-  nps_sensor_gyro_run_step(&sensors.gyro, time, &sensors.body_to_imu_rmat);
-  nps_sensor_accel_run_step(&sensors.accel, time, &sensors.body_to_imu_rmat);
-  nps_sensor_mag_run_step(&sensors.mag, time, &sensors.body_to_imu_rmat);
-  nps_sensor_baro_run_step(&sensors.baro, time);
+  /* noise of the imu sensors and baro generated in one pass,
+   * a sensor still draws its own noise if it gets NULL */
+  struct NpsRandomBatch batch;
+  nps_random_batch_reset(&batch);
+  const double *gyro_noise = NPS_SENSORS_NOISE(&batch, sensors.gyro, NPS_GYRO_NB_NOISE, time);
+  const double *accel_noise = NPS_SENSORS_NOISE(&batch, sensors.accel, NPS_ACCEL_NB_NOISE, time);
+  const double *mag_noise = NPS_SENSORS_NOISE(&batch, sensors.mag, NPS_MAG_NB_NOISE, time);
+  const double *baro_noise = NPS_SENSORS_NOISE(&batch, sensors.baro, NPS_BARO_NB_NOISE, time);
+  nps_random_batch_run(&batch);
+
+  nps_sensor_gyro_run_step(&sensors.gyro, time, &sensors.body_to_imu_rmat, gyro_noise);
+  nps_sensor_accel_run_step(&sensors.accel, time, &sensors.body_to_imu_rmat, accel_noise);
+  nps_sensor_mag_run_step(&sensors.mag, time, &sensors.body_to_imu_rmat, mag_noise);
+  nps_sensor_baro_run_step(&sensors.baro, time, baro_noise);
   nps_sensor_gps_run_step(&sensors.gps, time);
   nps_sensor_sonar_run_step(&sensors.sonar, time);
   nps_sensor_airspeed_run_step(&sensors.airspeed, time);
   nps_sensor_temperature_run_step(&sensors.temp, time);
   nps_sensor_aoa_run_step(&sensors.aoa, time);
   nps_sensor_sideslip_run_step(&sensors.sideslip,time);
+
+  for (int i = 0; i < nb_faults; i++) {
+    if (time >= faults[i].start && time < faults[i].end) {
+      *faults[i].data_available = FALSE;
+    }
+  }
 }
 
 
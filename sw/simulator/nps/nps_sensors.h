@@ -32,6 +32,14 @@ extern struct NpsSensors sensors;
 extern void nps_sensors_init(double time);
 extern void nps_sensors_run_step(double time);
 
+/**
+ * Add a sensor dropout, no new data of the sensor is available in the time window
+ * @param spec "<sensor>:<start>[:<end>]" with sensor in gyro, accel, mag, baro,
+ *             gps, sonar, airspeed, temperature, aoa, sideslip, and times in s
+ * @return false if spec is invalid
+ */
+extern bool nps_sensors_add_fault(const char *spec);
+
 extern bool nps_sensors_gyro_available();
 extern bool nps_sensors_mag_available();
 extern bool nps_sensors_baro_available();
@@ -0,0 +1,265 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Paparazzi Team
+#
+# This file is part of paparazzi.
+#
+# paparazzi is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2, or (at your option)
+# any later version.
+#
+# paparazzi is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with paparazzi; see the file COPYING.  If not, see
+# <http://www.gnu.org/licenses/>.
+
+"""
+Run a flight plan under a matrix of scenarios with parallel NPS instances.
+
+Each run is a separate simsitl process in batch mode (--batch), running as
+fast as possible on its own core, without Ivy or on a bus of its own. The
+metrics of each run (see sw/simulator/nps/nps_metrics.h) are appended to the
+report as soon as it ends, one JSON object per line, and a summary by
+scenario value is printed at the end.
+
+The scenario file gives the duration, the common simsitl arguments and the
+matrix, whose keys are simsitl options. All the combinations of the values
+are run, each with `seeds` noise seeds:
+
+    {
+      "duration": 600,
+      "args": ["--rc_script", "0"],
+      "seeds": 10,
+      "matrix": {
+        "wind": ["0,0,0", "6,0,0", "0,-9,0"],
+        "fdm_prop": ["inertia/pointmass-weight-lbs[0]=0", "inertia/pointmass-weight-lbs[0]=1.5"],
+        "fault": [null, "gps:120:150", ["gps:120:150", "mag:0"]]
+      }
+    }
+
+A null value leaves the option out, a list repeats it.
+
+    nps_fanout.py -a Microjet scenarios.json -o sweep.jsonl
+"""
+
+from __future__ import print_function, division
+
+import argparse
+import itertools
+import json
+import multiprocessing
+import os
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+try:
+    import queue
+except ImportError:
+    import Queue as queue
+
+
+def failed(result):
+    """simsitl exits with 0, or 2 if the aircraft crashed"""
+    return result["metrics"] is None or result["returncode"] not in (0, 2)
+
+
+def expand(scenario):
+    """List of (parameters, simsitl arguments) for all the combinations of the matrix"""
+    matrix = scenario.get("matrix", {})
+    keys = sorted(matrix.keys())
+    runs = []
+    for values in itertools.product(*[matrix[k] for k in keys]):
+        for seed in range(scenario.get("seeds", 1)):
+            params = dict(zip(keys, values))
+            params["seed"] = seed
+            args = list(scenario.get("args", [])) + ["--seed", str(seed)]
+            for k, v in zip(keys, values):
+                if v is None:
+                    continue
+                for item in (v if isinstance(v, list) else [v]):
+                    args += ["--" + k, str(item)]
+            runs.append((params, args))
+    return runs
+
+
+class Runner(object):
+    def __init__(self, simsitl, duration, jobs, ivy, ivy_port, timeout, report, log_dir):
+        self.simsitl = simsitl
+        self.duration = duration
+        self.jobs = jobs
+        self.ivy = ivy
+        self.ivy_port = ivy_port
+        self.timeout = timeout
+        self.report = report
+        self.log_dir = log_dir
+        self.lock = threading.Lock()
+        self.results = []
+        self.done = 0
+
+    def run_one(self, slot, run_id, params, args):
+        """Run a simulation pinned to the core of the slot, return its result"""
+        metrics_file = os.path.join(self.log_dir, "run_%05d.json" % run_id)
+        log_file = os.path.join(self.log_dir, "run_%05d.log" % run_id)
+        if self.ivy == "none":
+            bus = "none"
+        else:
+            # one bus per slot, a slot only runs one simulation at a time
+            bus = "127.255.255.255:%d" % (self.ivy_port + slot)
+        cmd = [self.simsitl, "--batch", str(self.duration), "--metrics", metrics_file,
+               "--ivy_bus", bus, "--nodisplay"] + args
+
+        def pin():
+            if hasattr(os, "sched_setaffinity"):
+                os.sched_setaffinity(0, [slot % multiprocessing.cpu_count()])
+
+        start = time.time()
+        with open(log_file, "w") as log:
+            proc = subprocess.Popen(cmd, stdout=log, stderr=subprocess.STDOUT, preexec_fn=pin)
+            while proc.poll() is None and time.time() - start < self.timeout:
+                time.sleep(0.05)
+            if proc.poll() is None:
+                proc.kill()
+                proc.wait()
+        result = {"id": run_id, "params": params, "returncode": proc.returncode,
+                  "wall_time": round(time.time() - start, 3)}
+        try:
+            with open(metrics_file) as f:
+                result["metrics"] = json.loads(f.read())
+            os.remove(metrics_file)
+        except (IOError, ValueError):
+            result["metrics"] = None
+        if failed(result):
+            result["log"] = log_file
+        else:
+            # keep the log of failed runs only
+            os.remove(log_file)
+        return result
+
+    def worker(self, slot, todo):
+        while True:
+            try:
+                run_id, params, args = todo.get_nowait()
+            except queue.Empty:
+                return
+            result = self.run_one(slot, run_id, params, args)
+            with self.lock:
+                self.results.append(result)
+                self.report.write(json.dumps(result, sort_keys=True) + "\n")
+                self.report.flush()
+                self.done += 1
+                status = "failed" if failed(result) else \
+                    ("crashed" if result["metrics"]["crashed"] else "ok")
+                print("[%d/%d] run %d %s (%.1fs)" % (self.done, self.total, run_id, status, result["wall_time"]))
+
+    def run(self, runs):
+        todo = queue.Queue()
+        for i, (params, args) in enumerate(runs):
+            todo.put((i, params, args))
+        self.total = len(runs)
+        threads = [threading.Thread(target=self.worker, args=(slot, todo)) for slot in range(self.jobs)]
+        for t in threads:
+            t.daemon = True
+            t.start()
+        for t in threads:
+            while t.is_alive():
+                t.join(1.)
+        return self.results
+
+
+def percentile(values, p):
+    if not values:
+        return float("nan")
+    values = sorted(values)
+    return values[min(len(values) - 1, int(p / 100. * len(values)))]
+
+
+def summarize(results):
+    """Crash rate and tracking error for all runs and by value of each scenario parameter"""
+    def stats(rs):
+        ok = [r["metrics"] for r in rs if not failed(r)]
+        err = [m["tracking_error_mean"] for m in ok if not m["crashed"]]
+        return {"runs": len(rs), "failed": len(rs) - len(ok),
+                "crashed": sum(1 for m in ok if m["crashed"]),
+                "tracking_error_p50": percentile(err, 50),
+                "tracking_error_p95": percentile(err, 95),
+                "energy_mean": sum(m["energy"] for m in ok) / len(ok) if ok else float("nan")}
+
+    summary = {"all": stats(results), "by_param": {}}
+    keys = set(k for r in results for k in r["params"] if k != "seed")
+    for k in sorted(keys):
+        groups = {}
+        for r in results:
+            groups.setdefault(json.dumps(r["params"].get(k)), []).append(r)
+        summary["by_param"][k] = dict((v, stats(rs)) for v, rs in groups.items())
+    return summary
+
+
+def print_summary(summary):
+    def line(name, s):
+        print("  %-48s %6d %6d %6d %10.2f %10.2f %10.4f" %
+              (name[:48], s["runs"], s["failed"], s["crashed"], s["tracking_error_p50"],
+               s["tracking_error_p95"], s["energy_mean"]))
+    print("  %-48s %6s %6s %6s %10s %10s %10s" % ("", "runs", "failed", "crash", "err p50", "err p95", "energy"))
+    line("all", summary["all"])
+    for k, groups in sorted(summary["by_param"].items()):
+        print(k)
+        for v, s in sorted(groups.items()):
+            line(v, s)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run NPS simulations for a matrix of scenarios")
+    parser.add_argument("scenario", help="scenario file (JSON)")
+    parser.add_argument("-a", "--aircraft", help="aircraft name, the nps target must be built")
+    parser.add_argument("-s", "--simsitl", help="simulator binary, instead of the aircraft one")
+    parser.add_argument("-j", "--jobs", type=int, default=multiprocessing.cpu_count(),
+                        help="number of parallel simulations (default: number of cores)")
+    parser.add_argument("-o", "--output", default="nps_fanout.jsonl", help="report, one JSON line per run")
+    parser.add_argument("--ivy", choices=["none", "unique"], default="none",
+                        help="run without Ivy or with a bus per simulation")
+    parser.add_argument("--ivy_port", type=int, default=3010, help="first port of the unique buses")
+    parser.add_argument("--timeout", type=float, default=3600., help="wall time limit of a run (s)")
+    args = parser.parse_args()
+
+    if args.simsitl:
+        simsitl = args.simsitl
+    elif args.aircraft:
+        home = os.environ.get("PAPARAZZI_HOME", os.getcwd())
+        simsitl = os.path.join(home, "var", "aircrafts", args.aircraft, "nps", "simsitl")
+    else:
+        parser.error("Please specify the aircraft name or the simulator binary.")
+    if not os.path.isfile(simsitl):
+        print("Error: " + simsitl + " is missing. Is target nps built?")
+        sys.exit(1)
+
+    with open(args.scenario) as f:
+        scenario = json.load(f)
+    runs = expand(scenario)
+    log_dir = tempfile.mkdtemp(prefix="nps_fanout_")
+    print("%d runs on %d cores, logs of failed runs in %s" % (len(runs), args.jobs, log_dir))
+
+    start = time.time()
+    with open(args.output, "w") as report:
+        runner = Runner(simsitl, scenario.get("duration", 600), args.jobs, args.ivy, args.ivy_port,
+                        args.timeout, report, log_dir)
+        results = runner.run(runs)
+    print("%d runs in %.0fs" % (len(results), time.time() - start))
+
+    summary = summarize(results)
+    with open(os.path.splitext(args.output)[0] + ".summary.json", "w") as f:
+        json.dump(summary, f, indent=2, sort_keys=True)
+    print_summary(summary)
+    if not os.listdir(log_dir):
+        os.rmdir(log_dir)
+
+
+if __name__ == "__main__":
+    main()
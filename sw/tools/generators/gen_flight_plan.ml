@@ -320,6 +320,7 @@ let rec index_stage = fun x ->
 
 
 let inside_function = fun name -> "Inside" ^ Compat.capitalize_ascii name
+let distance_function = fun name -> "SectorDistance" ^ Compat.capitalize_ascii name
 
 (* pre call utility function *)
 let fp_pre_call = fun out x ->
@@ -761,30 +762,47 @@ let dummy_waypoint =
                [])
 
 
+(** Slab decomposition of a static sector, see nav_sector.h
+    Slabs are between the sorted y of the corners. The edges crossing a slab
+    don't intersect inside it, they are sorted by x at the middle of the slab *)
+let sector_slabs = fun pts ->
+  let pts = Array.of_list pts in
+  let n = Array.length pts in
+  let ys = Array.of_list (List.sort_uniq compare (Array.to_list (Array.map (fun p -> p.G2D.y2D) pts))) in
+  let slab = fun k ->
+    let y0 = ys.(k) and y1 = ys.(k+1) in
+    let ym = (y0 +. y1) /. 2. in
+    let edges = ref [] in
+    for i = 0 to n - 1 do
+      let a = pts.(i) and b = pts.((i+1) mod n) in
+      if (a.G2D.y2D <= y0 && b.G2D.y2D >= y1) || (b.G2D.y2D <= y0 && a.G2D.y2D >= y1) then begin
+        let slope = (b.G2D.x2D -. a.G2D.x2D) /. (b.G2D.y2D -. a.G2D.y2D) in
+        edges := (a.G2D.x2D +. slope *. (y0 -. a.G2D.y2D), slope) :: !edges
+      end
+    done;
+    let x_mid = fun (x, slope) -> x +. slope *. (ym -. y0) in
+    List.sort (fun e1 e2 -> compare (x_mid e1) (x_mid e2)) !edges in
+  (ys, Array.init (max 0 (Array.length ys - 1)) slab)
+
 let print_inside_polygon = fun out pts ->
   let (_, pts) = List.split pts in
-  let layers = Geometry_2d.slice_polygon (Array.of_list pts) in
-  let rec f = fun i j ->
-    if i = j then
-      let {G2D.top=yl; left_side=(xg, ag); right_side=(xd, ad)} = layers.(i) in
-      if xg > xd then begin
-        lprintf out "return FALSE;\n"
-      end else begin
-        if ad <> 0. || ag <> 0. then
-          lprintf out "float dy = _y - %.1f;\n" yl;
-        let dy_times = fun f -> if f = 0. then "" else sprintf "+dy*%f" f in
-        lprintf out "return (%.1f%s<= _x && _x <= %.1f%s);\n" xg (dy_times ag) xd (dy_times ad)
-      end
-    else
-      let ij2 = (i+j) / 2 in
-      let yl = layers.(ij2).G2D.top in
-      lprintf out "if (_y <= %.1f) {\n" yl;
-      right (); f i ij2; left ();
-      lprintf out "} else {\n";
-      right (); f (ij2+1) j; left ();
-      lprintf out "}\n"
-  in
-  f 0 (Array.length layers - 1);;
+  let (ys, slabs) = sector_slabs pts in
+  let edges = List.concat (Array.to_list slabs) in
+  if edges = [] then
+    lprintf out "return false;\n"
+  else begin
+    let first = ref 0 in
+    let firsts = Array.to_list (Array.map (fun e -> let f = !first in first := f + List.length e; f) slabs) @ [!first] in
+    lprintf out "static const float ys[] = { %s };\n" (String.concat ", " (Array.to_list (Array.map (sprintf "%f") ys)));
+    lprintf out "static const uint16_t first[] = { %s };\n" (String.concat ", " (List.map string_of_int firsts));
+    lprintf out "static const struct NavSectorEdge edges[] = {\n";
+    right ();
+    List.iter (fun (x, slope) -> lprintf out "{ %f, %f },\n" x slope) edges;
+    left ();
+    lprintf out "};\n";
+    lprintf out "static const struct NavSector sector = { %d, ys, first, edges };\n" (Array.length slabs);
+    lprintf out "return nav_sector_inside(&sector, _x, _y);\n"
+  end
 
 let print_inside_polygon_global = fun out pts ->
   lprintf out "uint8_t i, j;\n";
@@ -809,6 +827,82 @@ let print_inside_polygon_global = fun out pts ->
 
 type sector_type = StaticSector | DynamicSector
 
+(** Grid of the candidate nearest edges of a static sector, see nav_sector.h
+    The grid covers the polygon with a margin. The distance to an edge is
+    convex, so its max over a cell is reached at a corner: an edge whose
+    distance to the cell is larger than the smallest of these max can't be
+    the nearest one from a point of the cell. Cells are enlarged by 1% to
+    cover the float rounding of the cell index. *)
+let sector_grid = fun pts ->
+  let pts = Array.of_list pts in
+  let n = Array.length pts in
+  let xs = Array.map (fun p -> p.G2D.x2D) pts and ys = Array.map (fun p -> p.G2D.y2D) pts in
+  let amin = Array.fold_left min infinity and amax = Array.fold_left max neg_infinity in
+  let margin = 0.25 *. (max (amax xs -. amin xs) (amax ys -. amin ys)) +. 1. in
+  let x0 = amin xs -. margin and y0 = amin ys -. margin in
+  let g = max 1 (min 16 (2 * truncate (ceil (sqrt (float n))))) in
+  let dx = (amax xs +. margin -. x0) /. float g and dy = (amax ys +. margin -. y0) /. float g in
+  let seg_dist = fun x y i ->
+    let a = pts.(i) and b = pts.((i+1) mod n) in
+    let ux = b.G2D.x2D -. a.G2D.x2D and uy = b.G2D.y2D -. a.G2D.y2D in
+    let l2 = ux *. ux +. uy *. uy in
+    let t = if l2 > 0. then max 0. (min 1. (((x -. a.G2D.x2D) *. ux +. (y -. a.G2D.y2D) *. uy) /. l2)) else 0. in
+    sqrt ((a.G2D.x2D +. t *. ux -. x) ** 2. +. (a.G2D.y2D +. t *. uy -. y) ** 2.) in
+  let edges = Array.to_list (Array.init n (fun i -> i)) in
+  let cell = fun k ->
+    let cx0 = x0 +. (float (k mod g) -. 0.01) *. dx and cy0 = y0 +. (float (k / g) -. 0.01) *. dy in
+    let cx1 = cx0 +. 1.02 *. dx and cy1 = cy0 +. 1.02 *. dy in
+    let corners = [(cx0, cy0); (cx1, cy0); (cx0, cy1); (cx1, cy1)] in
+    let max_dist = fun i -> List.fold_left (fun m (x, y) -> max m (seg_dist x y i)) 0. corners in
+    let bound = List.fold_left (fun m i -> min m (max_dist i)) infinity edges in
+    (* lower bound of the distance from the cell to an edge, from their
+       bounding boxes and from the circle around the cell *)
+    let cx = (cx0 +. cx1) /. 2. and cy = (cy0 +. cy1) /. 2. in
+    let r = (sqrt ((cx1 -. cx0) ** 2. +. (cy1 -. cy0) ** 2.)) /. 2. in
+    let min_dist = fun i ->
+      let a = pts.(i) and b = pts.((i+1) mod n) in
+      let ddx = max 0. (max (min a.G2D.x2D b.G2D.x2D -. cx1) (cx0 -. max a.G2D.x2D b.G2D.x2D))
+      and ddy = max 0. (max (min a.G2D.y2D b.G2D.y2D -. cy1) (cy0 -. max a.G2D.y2D b.G2D.y2D)) in
+      max (sqrt (ddx *. ddx +. ddy *. ddy)) (seg_dist cx cy i -. r) in
+    List.filter (fun i -> min_dist i <= bound) edges in
+  (x0, y0, dx, dy, g, Array.init (g * g) cell)
+
+let print_sector_distance = fun out t (s, pts) ->
+  lprintf out "static inline float %s(float _x, float _y) {\n" (distance_function s);
+  right ();
+  let nb_pts = List.length pts in
+  begin
+    match t with
+    | StaticSector ->
+        lprintf out "static const struct FloatVect2 pts[] = {\n";
+        right ();
+        List.iter (fun (_, p) -> lprintf out "{ %f, %f },\n" p.G2D.x2D p.G2D.y2D) pts;
+        left ();
+        lprintf out "};\n";
+        let (_, pts_2d) = List.split pts in
+        let (x0, y0, dx, dy, g, cells) = sector_grid pts_2d in
+        let first = ref 0 in
+        let firsts = Array.to_list (Array.map (fun c -> let f = !first in first := f + List.length c; f) cells) @ [!first] in
+        let edges = List.concat (Array.to_list cells) in
+        lprintf out "static const uint16_t first[] = { %s };\n" (String.concat ", " (List.map string_of_int firsts));
+        lprintf out "static const uint16_t edges[] = { %s };\n" (String.concat ", " (List.map string_of_int edges));
+        lprintf out "static const struct NavSectorGrid grid = { %f, %f, %f, %f, %d, %d, first, edges };\n" x0 y0 dx dy g g;
+        lprintf out "return nav_sector_grid_distance(&grid, pts, %d, %s(_x, _y), _x, _y);\n" nb_pts (inside_function s)
+    | DynamicSector ->
+        let (ids, _) = List.split pts in
+        lprintf out "const uint8_t wps_id[] = { %s };\n" (String.concat ", " ids);
+        lprintf out "struct FloatVect2 pts[%d];\n" nb_pts;
+        lprintf out "for (uint8_t i = 0; i < %d; i++) {\n" nb_pts;
+        right ();
+        lprintf out "pts[i].x = WaypointX(wps_id[i]);\n";
+        lprintf out "pts[i].y = WaypointY(wps_id[i]);\n";
+        left ();
+        lprintf out "}\n";
+        lprintf out "return nav_sector_distance(pts, %d, %s(_x, _y), _x, _y);\n" nb_pts (inside_function s)
+  end;
+  left ();
+  lprintf out "}\n"
+
 let print_inside_sector = fun out t (s, pts) ->
   lprintf out "static inline bool %s(float _x, float _y) {\n" (inside_function s);
   right ();
@@ -818,7 +912,8 @@ let print_inside_sector = fun out t (s, pts) ->
     | DynamicSector -> print_inside_polygon_global out pts
   end;
   left ();
-  lprintf out "}\n"
+  lprintf out "}\n";
+  print_sector_distance out t (s, pts)
 
 
 let parse_wpt_sector = fun indexes waypoints xml ->
@@ -944,7 +1039,8 @@ let print_flight_plan_h = fun xml utm0 xml_file out_file ->
   fprintf out "#include \"std.h\"\n";
   fprintf out "#include \"generated/modules.h\"\n";
   fprintf out "#include \"subsystems/abi.h\"\n";
-  fprintf out "#include \"autopilot.h\"\n\n";
+  fprintf out "#include \"autopilot.h\"\n";
+  fprintf out "#include \"subsystems/navigation/nav_sector.h\"\n\n";
   (* print variables and ABI bindings declaration *)
 
   let variables = parse_variables variables in
@@ -1119,7 +1215,8 @@ let print_flight_plan_h = fun xml utm0 xml_file out_file ->
   begin
     try
       let geofence_sector = Xml.attrib xml "geofence_sector" in
-      lprintf out "#define InGeofenceSector(_x, _y) %s(_x, _y)\n" (inside_function geofence_sector)
+      lprintf out "#define InGeofenceSector(_x, _y) %s(_x, _y)\n" (inside_function geofence_sector);
+      lprintf out "#define GeofenceSectorDistance(_x, _y) %s(_x, _y)\n" (distance_function geofence_sector)
     with
         _ -> ()
   end;
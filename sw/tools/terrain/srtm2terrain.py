@@ -0,0 +1,158 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Paparazzi Team
+#
+# This file is part of paparazzi.
+#
+# paparazzi is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2, or (at your option)
+# any later version.
+#
+# paparazzi is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with paparazzi; see the file COPYING.  If not, see
+# <http://www.gnu.org/licenses/>.
+
+"""
+Convert SRTM tiles (.hgt or .hgt.zip, as in data/srtm) to the tiled format
+of the onboard terrain module (modules/terrain).
+
+    srtm2terrain.py -o terrain/ data/srtm/N43E001.hgt.zip data/srtm/N43E002.hgt.zip
+
+Copy the output directory to TERRAIN_PATH on the aircraft.
+
+Needs numpy 1.17 or later (bitorder of np.packbits), which is not available
+for Python 2: the script keeps Python 2 syntax but only runs with Python 3.
+"""
+
+from __future__ import print_function, division
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zipfile
+
+import numpy as np
+
+MAGIC = b"PPTR"
+VERSION = 1
+BLOCK_SIZE = 64     # must match TERRAIN_BLOCK_SIZE
+HEADER_FMT = "<4sHHHHhh16x"
+SRTM_VOID = -32768
+
+
+def read_hgt(path):
+    """Read a SRTM tile, return the south-west corner and the heights (rows from north)"""
+    name = os.path.basename(path)
+    m = re.match(r"([NS])(\d+)([EW])(\d+)\.hgt", name, re.IGNORECASE)
+    if m is None:
+        raise ValueError("not a SRTM tile name: " + name)
+    lat = int(m.group(2)) * (1 if m.group(1).upper() == 'N' else -1)
+    lon = int(m.group(4)) * (1 if m.group(3).upper() == 'E' else -1)
+
+    if path.lower().endswith(".zip"):
+        with zipfile.ZipFile(path) as z:
+            data = z.read([n for n in z.namelist() if n.lower().endswith(".hgt")][0])
+    else:
+        with open(path, "rb") as f:
+            data = f.read()
+    samples = int(round(np.sqrt(len(data) // 2)))
+    if samples * samples * 2 != len(data):
+        raise ValueError("unexpected size for " + name)
+    h = np.frombuffer(data, dtype=">i2").reshape(samples, samples).astype(np.int32)
+    return lat, lon, fill_voids(h)
+
+
+def fill_voids(h):
+    """Replace the voids by the mean of their valid neighbours, growing from the edges of the voids"""
+    void = h == SRTM_VOID
+    if void.all():
+        return np.zeros_like(h)
+    h = h.copy()
+    while void.any():
+        acc = np.zeros(h.shape)
+        cnt = np.zeros(h.shape)
+        valid = ~void
+        hp = np.pad(np.where(valid, h, 0), 1)
+        vp = np.pad(valid, 1)
+        for dy, dx in ((-1, 0), (1, 0), (0, -1), (0, 1)):
+            acc += hp[1 + dy:hp.shape[0] - 1 + dy, 1 + dx:hp.shape[1] - 1 + dx]
+            cnt += vp[1 + dy:vp.shape[0] - 1 + dy, 1 + dx:vp.shape[1] - 1 + dx]
+        grow = void & (cnt > 0)
+        h[grow] = np.round(acc[grow] / cnt[grow])
+        void &= ~grow
+    return h
+
+
+def pack_block(block):
+    """Base height, number of bits and the offsets packed LSB first"""
+    base = int(block.min())
+    offsets = (block - base).astype(np.uint32).ravel()
+    bits = int(offsets.max()).bit_length()
+    out = bytearray(struct.pack("<hBx", base, bits))
+    if bits > 0:
+        # bit i of each value, then interleave to get the values LSB first
+        planes = ((offsets[:, None] >> np.arange(bits, dtype=np.uint32)) & 1).astype(np.uint8)
+        out += np.packbits(planes.ravel(), bitorder="little").tobytes()
+    return bytes(out)
+
+
+def write_terrain(path, lat, lon, h):
+    samples = h.shape[0]
+    nb_blocks = (samples - 1 + BLOCK_SIZE - 1) // BLOCK_SIZE
+    # pad with the last row and column so that all the blocks are full
+    size = nb_blocks * BLOCK_SIZE + 1
+    padded = np.pad(h, ((0, size - samples), (0, size - samples)), mode="edge")
+
+    header = struct.pack(HEADER_FMT, MAGIC, VERSION, BLOCK_SIZE, samples, nb_blocks, lat, lon)
+    blocks = []
+    for by in range(nb_blocks):
+        for bx in range(nb_blocks):
+            y, x = by * BLOCK_SIZE, bx * BLOCK_SIZE
+            blocks.append(pack_block(padded[y:y + BLOCK_SIZE + 1, x:x + BLOCK_SIZE + 1]))
+
+    offset = len(header) + 4 * (len(blocks) + 1)
+    offsets = []
+    for b in blocks:
+        offsets.append(offset)
+        offset += len(b)
+    offsets.append(offset)
+
+    with open(path, "wb") as f:
+        f.write(header)
+        f.write(struct.pack("<%dI" % len(offsets), *offsets))
+        for b in blocks:
+            f.write(b)
+    return offset
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert SRTM tiles for the onboard terrain module")
+    parser.add_argument("tiles", nargs="+", help="SRTM tiles (.hgt or .hgt.zip)")
+    parser.add_argument("-o", "--output", default=".", help="output directory")
+    args = parser.parse_args()
+
+    if not os.path.isdir(args.output):
+        os.makedirs(args.output)
+    for tile in args.tiles:
+        try:
+            lat, lon, h = read_hgt(tile)
+        except (IOError, ValueError, zipfile.BadZipfile) as e:
+            print("skipping %s: %s" % (tile, e), file=sys.stderr)
+            continue
+        name = "%c%02d%c%03d.ter" % ('N' if lat >= 0 else 'S', abs(lat), 'E' if lon >= 0 else 'W', abs(lon))
+        out = os.path.join(args.output, name)
+        size = write_terrain(out, lat, lon, h)
+        print("%s: %dx%d samples, %d bytes (%.0f%% of the raw tile)" %
+              (out, h.shape[0], h.shape[1], size, 100. * size / (2 * h.size)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file bench_indi_pseudo_inverse.c
+ * @brief Cost of the pseudo-inverse of the INDI control effectiveness.
+ *
+ * Compares the generic loops with float_mat_inv_4d, as previously done by
+ * stabilization_indi, with the 4 x n kernels, for 4, 6 and 8 actuators.
+ * Then counts how often the pseudo-inverse is computed again during a
+ * simulated adaptation for several STABILIZATION_INDI_PINV_UPDATE_THRESHOLD.
+ *
+ * Run with "make bench", prints the time per call, and the cycles per
+ * call on x86 (time stamp counter). This is a host benchmark only, there is
+ * no Cortex-M4/M7 variant (DWT cycle counter) and no target numbers.
+ */
+
+#include "math/pprz_algebra_float.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_CYCLES 1
+#endif
+
+#ifndef BENCH_NB_CALLS
+#define BENCH_NB_CALLS 1000000
+#endif
+
+#define MAX_ACT 8
+#define NB_STEPS 10000
+
+static float g[4][MAX_ACT];
+static float pinv[MAX_ACT][4];
+static volatile float sink;
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static unsigned long long cycles(void)
+{
+#if BENCH_HAS_CYCLES
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+/** previous implementation of calc_g1g2_pseudo_inv */
+static void pinv_ref(int n)
+{
+  float mt[4][4], inv[4][4];
+  for (int row = 0; row < 4; row++) {
+    for (int col = 0; col < 4; col++) {
+      float element = 0;
+      for (int i = 0; i < n; i++) {
+        element = element + g[row][i] * g[col][i];
+      }
+      mt[row][col] = element;
+    }
+  }
+  float_vect_scale((float *)mt, 100.0, 16);
+  float_mat_inv_4d((float *)inv, (float *)mt);
+  float_vect_scale((float *)inv, 100.0, 16);
+  for (int row = 0; row < n; row++) {
+    for (int col = 0; col < 4; col++) {
+      float element = 0;
+      for (int i = 0; i < 4; i++) {
+        element = element + g[i][row] * inv[col][i];
+      }
+      pinv[row][col] = element;
+    }
+  }
+}
+
+static void pinv_kernels(int n)
+{
+  float mt[16], inv[16];
+  float gn[4 * MAX_ACT];
+  // g is stored with MAX_ACT columns, the kernels expect n
+  for (int i = 0; i < 4; i++) {
+    float_vect_copy(&gn[i * n], g[i], n);
+  }
+  float_mat_mul_transpose_4n(mt, gn, n);
+  if (float_mat_sym_inv_4d(inv, mt)) {
+    float_mat_transpose_mul_4n(pinv[0], gn, inv, n);
+  }
+}
+
+static void init_g(int n)
+{
+  for (int j = 0; j < n; j++) {
+    float a = 2.f * M_PI * j / n;
+    g[0][j] = 0.020f * sinf(a);
+    g[1][j] = 0.014f * cosf(a);
+    g[2][j] = (j % 2) ? 0.001f : -0.001f;
+    g[3][j] = -0.0004f;
+  }
+}
+
+static void bench(const char *name, void (*f)(int), int n, double *t_out)
+{
+  init_g(n);
+  double t0 = now();
+  unsigned long long c0 = cycles();
+  for (int k = 0; k < BENCH_NB_CALLS; k++) {
+    // tiny change so that nothing is hoisted out of the loop
+    g[3][k % n] *= 1.0000001f;
+    f(n);
+    sink = pinv[k % n][0];
+  }
+  unsigned long long c = cycles() - c0;
+  double t = now() - t0;
+  *t_out = t;
+  printf("  %-8s %7.1f ns/call", name, t / BENCH_NB_CALLS * 1e9);
+#if BENCH_HAS_CYCLES
+  printf(", %6.0f cycles/call", (double)c / BENCH_NB_CALLS);
+#else
+  (void)c;
+#endif
+  printf("\n");
+}
+
+/** number of pseudo-inverses over NB_STEPS steps of a random walk adaptation */
+static int nb_updates(int n, float threshold)
+{
+  float g1g2[4][MAX_ACT];
+  init_g(n);
+  for (int i = 0; i < 4; i++) {
+    float_vect_copy(g1g2[i], g[i], n);
+  }
+  srand(42);
+  int nb = 0;
+  for (int k = 0; k < NB_STEPS; k++) {
+    // LMS like step: small update of a row proportional to the input change
+    int i = k % 4;
+    for (int j = 0; j < n; j++) {
+      g[i][j] += g[i][j] * 1e-4f * (rand() / (float)RAND_MAX - 0.5f);
+    }
+    bool changed = false;
+    for (int r = 0; r < 4 && !changed; r++) {
+      for (int j = 0; j < n; j++) {
+        if (fabsf(g[r][j] - g1g2[r][j]) > threshold * fabsf(g1g2[r][j])) {
+          changed = true;
+          break;
+        }
+      }
+    }
+    if (changed) {
+      for (int r = 0; r < 4; r++) {
+        float_vect_copy(g1g2[r], g[r], n);
+      }
+      nb++;
+    }
+  }
+  return nb;
+}
+
+int main(void)
+{
+  int nb_act[] = { 4, 6, 8 };
+  printf("pseudo-inverse of G1+G2, %d calls\n", BENCH_NB_CALLS);
+  for (unsigned int k = 0; k < sizeof(nb_act) / sizeof(nb_act[0]); k++) {
+    double t_ref, t_ker;
+    printf("%d actuators\n", nb_act[k]);
+    bench("generic", pinv_ref, nb_act[k], &t_ref);
+    bench("4n", pinv_kernels, nb_act[k], &t_ker);
+    printf("  speedup %.2f\n", t_ref / t_ker);
+  }
+
+  float thresholds[] = { 0.f, 0.001f, 0.01f };
+  printf("pseudo-inverses during %d adaptation steps, 6 actuators\n", NB_STEPS);
+  for (unsigned int k = 0; k < sizeof(thresholds) / sizeof(thresholds[0]); k++) {
+    printf("  threshold %.3f: %d\n", thresholds[k], nb_updates(6, thresholds[k]));
+  }
+  return 0;
+}
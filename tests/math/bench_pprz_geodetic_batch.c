@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file bench_pprz_geodetic_batch.c
+ * @brief Throughput of the batch geodetic conversions vs. the scalar ones.
+ *
+ * Run with "make bench", prints millions of points per second.
+ *
+ * The scalar reference is built from source with the flags of the batch file
+ * (-O3 -fno-math-errno), both sides get the same optimization.
+ *
+ * Speedups measured over 5 runs of 1M points on a shared x86-64 Xeon VM,
+ * gcc 12.2 (the spread comes from the host load):
+ *   ecef_of_lla 1.3-1.7, lla_of_ecef 0.9-1.3, enu_of_ecef_point 3.2-3.6,
+ *   enu_of_lla_point 1.1-1.9, utm_of_lla 1.0-1.4, lla_of_utm 1.0-1.1
+ * Only the ENU/NED transforms of ECEF points are vectorized, the other
+ * conversions are bound by the libm calls and gain little or nothing.
+ */
+
+#include "math/pprz_geodetic_double.h"
+#include "math/pprz_geodetic_batch.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef BENCH_NB_POINTS
+#define BENCH_NB_POINTS 1000000
+#endif
+
+#define NB (BENCH_NB_POINTS)
+
+static double a[NB], b[NB], c[NB];
+static double x[NB], y[NB], z[NB];
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report(const char *name, double t_scalar, double t_batch)
+{
+  printf("%-20s scalar %7.1f Mpts/s, batch %7.1f Mpts/s, speedup %.2f\n", name,
+         NB / t_scalar * 1e-6, NB / t_batch * 1e-6, t_scalar / t_batch);
+}
+
+int main(void)
+{
+  struct LlaCoor_d lla0 = { RadOfDeg(43.6052765), RadOfDeg(1.4427764), 180.123 };
+  struct LtpDef_d def;
+  ltp_def_from_lla_d(&def, &lla0);
+
+  srand(42);
+  for (int i = 0; i < NB; i++) {
+    a[i] = lla0.lat + (rand() / (double)RAND_MAX - 0.5) * 0.02;
+    b[i] = lla0.lon + (rand() / (double)RAND_MAX - 0.5) * 0.02;
+    c[i] = (rand() / (double)RAND_MAX) * 5000.;
+  }
+  struct LlaCoorArray_d lla = { a, b, c };
+  struct EcefCoorArray_d ecef = { x, y, z };
+  struct LtpCoorArray_d enu = { x, y, z };
+  struct UtmCoorArray_d utm = { x, y, z, 0 };
+  double t0, t_scalar;
+
+  printf("%d points\n", NB);
+
+  t0 = now();
+  for (int i = 0; i < NB; i++) {
+    struct LlaCoor_d l = { a[i], b[i], c[i] };
+    struct EcefCoor_d e;
+    ecef_of_lla_d(&e, &l);
+    x[i] = e.x; y[i] = e.y; z[i] = e.z;
+  }
+  t_scalar = now() - t0;
+  t0 = now();
+  ecef_of_lla_batch_d(&ecef, &lla, NB);
+  report("ecef_of_lla", t_scalar, now() - t0);
+
+  // ECEF points of the LLA ones stay in x, y, z
+  t0 = now();
+  for (int i = 0; i < NB; i++) {
+    struct EcefCoor_d e = { x[i], y[i], z[i] };
+    struct LlaCoor_d l;
+    lla_of_ecef_d(&l, &e);
+    a[i] = l.lat; b[i] = l.lon; c[i] = l.alt;
+  }
+  t_scalar = now() - t0;
+  t0 = now();
+  lla_of_ecef_batch_d(&lla, &ecef, NB);
+  report("lla_of_ecef", t_scalar, now() - t0);
+
+  static double e_[NB], n_[NB], u_[NB];
+  struct LtpCoorArray_d enu_out = { e_, n_, u_ };
+  t0 = now();
+  for (int i = 0; i < NB; i++) {
+    struct EcefCoor_d e = { x[i], y[i], z[i] };
+    struct EnuCoor_d l;
+    enu_of_ecef_point_d(&l, &def, &e);
+    e_[i] = l.x; n_[i] = l.y; u_[i] = l.z;
+  }
+  t_scalar = now() - t0;
+  t0 = now();
+  enu_of_ecef_point_batch_d(&enu_out, &def, &ecef, NB);
+  report("enu_of_ecef_point", t_scalar, now() - t0);
+
+  t0 = now();
+  for (int i = 0; i < NB; i++) {
+    struct LlaCoor_d l = { a[i], b[i], c[i] };
+    struct EnuCoor_d p;
+    enu_of_lla_point_d(&p, &def, &l);
+    x[i] = p.x; y[i] = p.y; z[i] = p.z;
+  }
+  t_scalar = now() - t0;
+  t0 = now();
+  enu_of_lla_point_batch_d(&enu, &def, &lla, NB);
+  report("enu_of_lla_point", t_scalar, now() - t0);
+
+  t0 = now();
+  for (int i = 0; i < NB; i++) {
+    struct LlaCoor_d l = { a[i], b[i], c[i] };
+    struct UtmCoor_d u = { .zone = 31 };
+    utm_of_lla_d(&u, &l);
+    x[i] = u.north; y[i] = u.east; z[i] = u.alt;
+  }
+  t_scalar = now() - t0;
+  t0 = now();
+  utm_of_lla_batch_d(&utm, &lla, NB);
+  report("utm_of_lla", t_scalar, now() - t0);
+
+  t0 = now();
+  for (int i = 0; i < NB; i++) {
+    struct UtmCoor_d u = { x[i], y[i], z[i], 31 };
+    struct LlaCoor_d l;
+    lla_of_utm_d(&l, &u);
+    a[i] = l.lat; b[i] = l.lon; c[i] = l.alt;
+  }
+  t_scalar = now() - t0;
+  t0 = now();
+  lla_of_utm_batch_d(&lla, &utm, NB);
+  report("lla_of_utm", t_scalar, now() - t0);
+
+  return 0;
+}
@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_pprz_geodetic_batch.c
+ * @brief Tests of the batch geodetic conversions against the scalar ones.
+ *
+ * Using libtap to create a TAP (TestAnythingProtocol) producer:
+ * https://github.com/zorgnax/libtap
+ *
+ */
+
+#include "tap.h"
+
+#include "math/pprz_geodetic_double.h"
+#include "math/pprz_geodetic_batch.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define NB_POINTS 10000
+
+static uint32_t rand_state = 42;
+
+/** Deterministic uniform random number in [min, max] */
+static double rand_range(double min, double max)
+{
+  rand_state = rand_state * 1664525u + 1013904223u;
+  return min + (max - min) * (rand_state / 4294967295.);
+}
+
+struct Points {
+  double a[NB_POINTS], b[NB_POINTS], c[NB_POINTS];
+};
+
+static struct Points in, out, ref;
+
+static double max_diff(double *u, double *v)
+{
+  double m = 0.;
+  for (int i = 0; i < NB_POINTS; i++) {
+    m = Max(m, fabs(u[i] - v[i]));
+  }
+  return m;
+}
+
+static double max_diff3(struct Points *p, struct Points *q)
+{
+  return Max(Max(max_diff(p->a, q->a), max_diff(p->b, q->b)), max_diff(p->c, q->c));
+}
+
+/** Random LLA points all around the world, from below sea level to 20km */
+static void random_lla(struct Points *p)
+{
+  for (int i = 0; i < NB_POINTS; i++) {
+    p->a[i] = rand_range(-M_PI_2, M_PI_2);
+    p->b[i] = rand_range(-M_PI, M_PI);
+    p->c[i] = rand_range(-500., 20000.);
+  }
+}
+
+/** Random local points in a 50km range around the origin */
+static void random_ltp(struct Points *p)
+{
+  for (int i = 0; i < NB_POINTS; i++) {
+    p->a[i] = rand_range(-50000., 50000.);
+    p->b[i] = rand_range(-50000., 50000.);
+    p->c[i] = rand_range(-1000., 5000.);
+  }
+}
+
+static void test_ecef_lla(void)
+{
+  note("--- Compare ecef_of_lla and lla_of_ecef batch vs. scalar on %d points", NB_POINTS);
+  random_lla(&in);
+
+  struct LlaCoorArray_d lla = { in.a, in.b, in.c };
+  struct EcefCoorArray_d ecef = { out.a, out.b, out.c };
+  ecef_of_lla_batch_d(&ecef, &lla, NB_POINTS);
+  for (int i = 0; i < NB_POINTS; i++) {
+    struct LlaCoor_d l = { in.a[i], in.b[i], in.c[i] };
+    struct EcefCoor_d e;
+    ecef_of_lla_d(&e, &l);
+    ref.a[i] = e.x;
+    ref.b[i] = e.y;
+    ref.c[i] = e.z;
+  }
+  double err = max_diff3(&out, &ref);
+  note("ecef_of_lla max error %g m", err);
+  ok(err < 1e-6, "ecef_of_lla batch matches scalar below 1e-6m");
+
+  struct LlaCoorArray_d lla_out = { in.a, in.b, in.c };
+  lla_of_ecef_batch_d(&lla_out, &ecef, NB_POINTS);
+  double err_lat = 0., err_lon = 0., err_alt = 0.;
+  for (int i = 0; i < NB_POINTS; i++) {
+    struct EcefCoor_d e = { out.a[i], out.b[i], out.c[i] };
+    struct LlaCoor_d l;
+    lla_of_ecef_d(&l, &e);
+    err_lat = Max(err_lat, fabs(l.lat - in.a[i]));
+    err_lon = Max(err_lon, fabs(l.lon - in.b[i]));
+    err_alt = Max(err_alt, fabs(l.alt - in.c[i]));
+  }
+  note("lla_of_ecef max error %g rad, %g rad, %g m", err_lat, err_lon, err_alt);
+  ok(err_lat < 1e-12 && err_lon < 1e-12 && err_alt < 1e-6, "lla_of_ecef batch matches scalar below 1e-12rad and 1e-6m");
+}
+
+static void test_ltp(void)
+{
+  note("--- Compare local tangent plane conversions batch vs. scalar on %d points", NB_POINTS);
+  struct LlaCoor_d lla0 = { RadOfDeg(43.6052765), RadOfDeg(1.4427764), 180.123 };
+  struct LtpDef_d def;
+  ltp_def_from_lla_d(&def, &lla0);
+
+  // ECEF points around the origin
+  random_ltp(&ref);
+  for (int i = 0; i < NB_POINTS; i++) {
+    struct EnuCoor_d l = { ref.a[i], ref.b[i], ref.c[i] };
+    struct EcefCoor_d e;
+    ecef_of_enu_point_d(&e, &def, &l);
+    in.a[i] = e.x;
+    in.b[i] = e.y;
+    in.c[i] = e.z;
+  }
+  struct EcefCoorArray_d ecef = { in.a, in.b, in.c };
+  struct LtpCoorArray_d ltp = { out.a, out.b, out.c };
+
+  enu_of_ecef_point_batch_d(&ltp, &def, &ecef, NB_POINTS);
+  for (int i = 0; i < NB_POINTS; i++) {
+    struct EcefCoor_d e = { in.a[i], in.b[i], in.c[i] };
+    struct EnuCoor_d l;
+    enu_of_ecef_point_d(&l, &def, &e);
+    ref.a[i] = l.x;
+    ref.b[i] = l.y;
+    ref.c[i] = l.z;
+  }
+  ok(max_diff3(&out, &ref) < 1e-8, "enu_of_ecef_point batch matches scalar below 1e-8m");
+
+  ned_of_ecef_point_batch_d(&ltp, &def, &ecef, NB_POINTS);
+  for (int i = 0; i < NB_POINTS; i++) {
+    struct EcefCoor_d e = { in.a[i], in.b[i], in.c[i] };
+    struct NedCoor_d l;
+    ned_of_ecef_point_d(&l, &def, &e);
+    ref.a[i] = l.x;
+    ref.b[i] = l.y;
+    ref.c[i] = l.z;
+  }
+  ok(max_diff3(&out, &ref) < 1e-8, "ned_of_ecef_point batch matches scalar below 1e-8m");
+
+  struct EcefCoorArray_d ecef_out = { in.a, in.b, in.c };
+  ecef_of_ned_point_batch_d(&ecef_out, &def, &ltp, NB_POINTS);
+  for (int i = 0; i < NB_POINTS; i++) {
+    struct NedCoor_d l = { out.a[i], out.b[i], out.c[i] };
+    struct EcefCoor_d e;
+    ecef_of_ned_point_d(&e, &def, &l);
+    ref.a[i] = e.x;
+    ref.b[i] = e.y;
+    ref.c[i] = e.z;
+  }
+  ok(max_diff3(&in, &ref) < 1e-8, "ecef_of_ned_point batch matches scalar below 1e-8m");
+
+  random_ltp(&out);
+  ecef_of_enu_point_batch_d(&ecef_out, &def, &ltp, NB_POINTS);
+  for (int i = 0; i < NB_POINTS; i++) {
+    struct EnuCoor_d l = { out.a[i], out.b[i], out.c[i] };
+    struct EcefCoor_d e;
+    ecef_of_enu_point_d(&e, &def, &l);
+    ref.a[i] = e.x;
+    ref.b[i] = e.y;
+    ref.c[i] = e.z;
+  }
+  ok(max_diff3(&in, &ref) < 1e-8, "ecef_of_enu_point batch matches scalar below 1e-8m");
+
+  // LLA points around the origin
+  for (int i = 0; i < NB_POINTS; i++) {
+    in.a[i] = lla0.lat + rand_range(-0.01, 0.01);
+    in.b[i] = lla0.lon + rand_range(-0.01, 0.01);
+    in.c[i] = rand_range(-500., 5000.);
+  }
+  struct LlaCoorArray_d lla = { in.a, in.b, in.c };
+
+  enu_of_lla_point_batch_d(&ltp, &def, &lla, NB_POINTS);
+  for (int i = 0; i < NB_POINTS; i++) {
+    struct LlaCoor_d l = { in.a[i], in.b[i], in.c[i] };
+    struct EnuCoor_d p;
+    enu_of_lla_point_d(&p, &def, &l);
+    ref.a[i] = p.x;
+    ref.b[i] = p.y;
+    ref.c[i] = p.z;
+  }
+  ok(max_diff3(&out, &ref) < 1e-6, "enu_of_lla_point batch matches scalar below 1e-6m");
+
+  ned_of_lla_point_batch_d(&ltp, &def, &lla, NB_POINTS);
+  for (int i = 0; i < NB_POINTS; i++) {
+    struct LlaCoor_d l = { in.a[i], in.b[i], in.c[i] };
+    struct NedCoor_d p;
+    ned_of_lla_point_d(&p, &def, &l);
+    ref.a[i] = p.x;
+    ref.b[i] = p.y;
+    ref.c[i] = p.z;
+  }
+  ok(max_diff3(&out, &ref) < 1e-6, "ned_of_lla_point batch matches scalar below 1e-6m");
+}
+
+static void test_utm(void)
+{
+  note("--- Compare utm_of_lla and lla_of_utm batch vs. scalar on %d points", NB_POINTS);
+  // points in UTM zone 31, from the equator to 80 degrees north
+  for (int i = 0; i < NB_POINTS; i++) {
+    in.a[i] = RadOfDeg(rand_range(0., 80.));
+    in.b[i] = RadOfDeg(rand_range(0.1, 5.9));
+    in.c[i] = rand_range(0., 5000.);
+  }
+  struct LlaCoorArray_d lla = { in.a, in.b, in.c };
+  struct UtmCoorArray_d utm = { out.a, out.b, out.c, 0 };
+  utm_of_lla_batch_d(&utm, &lla, NB_POINTS);
+  cmp_ok(utm.zone, "==", 31, "UTM zone of the first point");
+
+  for (int i = 0; i < NB_POINTS; i++) {
+    struct LlaCoor_d l = { in.a[i], in.b[i], in.c[i] };
+    struct UtmCoor_d u = { .zone = 31 };
+    utm_of_lla_d(&u, &l);
+    ref.a[i] = u.north;
+    ref.b[i] = u.east;
+    ref.c[i] = u.alt;
+  }
+  double err = max_diff3(&out, &ref);
+  note("utm_of_lla max error %g m", err);
+  ok(err < 1e-6, "utm_of_lla batch matches scalar below 1e-6m");
+
+  struct LlaCoorArray_d lla_out = { ref.a, ref.b, ref.c };
+  lla_of_utm_batch_d(&lla_out, &utm, NB_POINTS);
+  double err_lat = 0., err_lon = 0.;
+  for (int i = 0; i < NB_POINTS; i++) {
+    struct UtmCoor_d u = { out.a[i], out.b[i], out.c[i], 31 };
+    struct LlaCoor_d l;
+    lla_of_utm_d(&l, &u);
+    err_lat = Max(err_lat, fabs(l.lat - ref.a[i]));
+    err_lon = Max(err_lon, fabs(l.lon - ref.b[i]));
+  }
+  note("lla_of_utm max error %g rad, %g rad", err_lat, err_lon);
+  ok(err_lat < 1e-9 && err_lon < 1e-12, "lla_of_utm batch matches scalar below 1e-9rad");
+}
+
+int main()
+{
+  note("running batch geodetic math tests");
+  plan(11);
+
+  test_ecef_lla();
+  test_ltp();
+  test_utm();
+
+  done_testing();
+}
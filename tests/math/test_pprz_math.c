@@ -34,7 +34,7 @@
 int main()
 {
   note("running algebra math tests");
-  plan(3);
+  plan(7);
 
   /* test int32_vect2_normalize */
   struct Int32Vect2 v = {2300, -4200};
@@ -58,5 +58,58 @@ int main()
      "float_quat_of_eulers_zxy(float_eulers_of_quat_zxy(0.9266,   -0.2317,    0.1165,    0.2722)) returned [%f, %f, %f, %f]", quat_zxy.qi, quat_zxy.qx, quat_zxy.qy, quat_zxy.qz);
 
 
+  /* test the 4 x n kernels on a 4x6 effectiveness matrix */
+  float b[4][6] = {
+    { 20.f, -20.f, -20.f, 20.f, 10.f, -10.f },
+    { 14.f, 14.f, -14.f, -14.f, 7.f, -7.f },
+    { -1.f, 1.f, -1.f, 1.f, 2.f, -2.f },
+    { -.4f, -.4f, -.4f, -.4f, -.3f, -.3f }
+  };
+  float bbt[16], bbt_ref[16];
+  for (int r = 0; r < 4; r++) {
+    for (int c = 0; c < 4; c++) {
+      bbt_ref[4 * r + c] = 0.f;
+      for (int j = 0; j < 6; j++) {
+        bbt_ref[4 * r + c] += b[r][j] * b[c][j];
+      }
+    }
+  }
+  float_mat_mul_transpose_4n(bbt, b[0], 6);
+  float err = 0.f;
+  for (int i = 0; i < 16; i++) {
+    err = fmaxf(err, fabsf(bbt[i] - bbt_ref[i]));
+  }
+  ok(err < 1e-3f, "float_mat_mul_transpose_4n max error %g", err);
+
+  float inv[16], inv_ref[16], scaled[16];
+  bool inv_ok = float_mat_sym_inv_4d(inv, bbt);
+  /* scaled as in the INDI controller to stay above the determinant threshold */
+  for (int i = 0; i < 16; i++) {
+    scaled[i] = bbt[i] * 100.f;
+  }
+  float_mat_inv_4d(inv_ref, scaled);
+  err = 0.f;
+  for (int i = 0; i < 16; i++) {
+    err = fmaxf(err, fabsf(inv[i] - inv_ref[i] * 100.f) / fabsf(inv_ref[i] * 100.f));
+  }
+  ok(inv_ok && err < 1e-3f, "float_mat_sym_inv_4d max relative error to float_mat_inv_4d %g", err);
+
+  float pinv[6][4];
+  float_mat_transpose_mul_4n(pinv[0], b[0], inv, 6);
+  err = 0.f;
+  for (int r = 0; r < 4; r++) {
+    for (int c = 0; c < 4; c++) {
+      float e = (r == c) ? -1.f : 0.f;
+      for (int j = 0; j < 6; j++) {
+        e += b[r][j] * pinv[j][c];
+      }
+      err = fmaxf(err, fabsf(e));
+    }
+  }
+  ok(err < 1e-4f, "b * float_mat_transpose_mul_4n(b, (b*b')^-1) = I, max error %g", err);
+
+  float singular[16] = { 1.f, 2.f, 0.f, 0.f, 2.f, 4.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f };
+  ok(!float_mat_sym_inv_4d(inv, singular), "float_mat_sym_inv_4d fails on a singular matrix");
+
   done_testing();
 }
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_natnet_fast.c
+ * @brief Tests of the natnet2ivy fast path datagrams.
+ *
+ * The datagrams are decoded byte per byte with the state machine of the
+ * pprzlink 2.0 transport, as the aircraft datalink does, and the fields are
+ * read at the offsets of the generated DL_REMOTE_GPS_LOCAL_* accessors of
+ * messages_natnet.xml.
+ *
+ * Using libtap to create a TAP (TestAnythingProtocol) producer:
+ * https://github.com/zorgnax/libtap
+ */
+
+#include "tap.h"
+#include "natnet_fast.h"
+
+#include <string.h>
+
+#define DATALINK_CLASS_ID 2
+#define REMOTE_GPS_LOCAL_ID 56
+
+/** Decoded frames of a datagram */
+struct Decoded {
+  int nb;
+  int errors;
+  uint8_t payload[64][256];
+  uint8_t len[64];
+};
+
+/** pprzlink 2.0 transport parser: STX, length, payload, ck_a, ck_b */
+static void decode(struct Decoded *d, const uint8_t *buf, int len)
+{
+  enum { UNINIT, GOT_STX, GOT_LENGTH, GOT_PAYLOAD, GOT_CRC1 } status = UNINIT;
+  uint8_t payload[256], payload_len = 0, idx = 0, ck_a = 0, ck_b = 0;
+
+  memset(d, 0, sizeof(struct Decoded));
+  for (int i = 0; i < len; i++) {
+    uint8_t c = buf[i];
+    switch (status) {
+      case UNINIT:
+        if (c == NATNET_FAST_STX) {
+          status = GOT_STX;
+        }
+        break;
+      case GOT_STX:
+        payload_len = c - NATNET_FAST_OVERHEAD;
+        ck_a = ck_b = c;
+        idx = 0;
+        status = GOT_LENGTH;
+        break;
+      case GOT_LENGTH:
+        payload[idx++] = c;
+        ck_a += c;
+        ck_b += ck_a;
+        if (idx == payload_len) {
+          status = GOT_PAYLOAD;
+        }
+        break;
+      case GOT_PAYLOAD:
+        status = c == ck_a ? GOT_CRC1 : UNINIT;
+        d->errors += c != ck_a;
+        break;
+      case GOT_CRC1:
+        if (c == ck_b && d->nb < 64) {
+          memcpy(d->payload[d->nb], payload, payload_len);
+          d->len[d->nb++] = payload_len;
+        } else {
+          d->errors++;
+        }
+        status = UNINIT;
+        break;
+    }
+  }
+}
+
+static float get_float(const uint8_t *p)
+{
+  float f;
+  memcpy(&f, p, 4);
+  return f;
+}
+
+static uint32_t get_uint32(const uint8_t *p)
+{
+  uint32_t u;
+  memcpy(&u, p, 4);
+  return u;
+}
+
+static struct NatNetFastPose make_pose(int i)
+{
+  struct NatNetFastPose pose = {
+    .ac_id = 10 + i,
+    .tow = 123456 + i,
+    .enu_pos = { 1.5f + i, -2.25f, 0.75f },
+    .enu_vel = { 0.1f, -0.2f * i, 0.3f },
+    .course = 0.5f
+  };
+  return pose;
+}
+
+int main(void)
+{
+  struct NatNetFastMsg msg;
+  static struct NatNetFastBatch batch;
+  static struct Decoded d;
+
+  note("running natnet fast path tests");
+  plan(14);
+
+  ok(natnet_fast_load(&msg, "messages_natnet.xml") == 0, "REMOTE_GPS_LOCAL loaded");
+  ok(msg.class_id == DATALINK_CLASS_ID && msg.msg_id == REMOTE_GPS_LOCAL_ID,
+     "datalink class %d and message id %d", msg.class_id, msg.msg_id);
+  cmp_ok(msg.frame_len, "==", 42, "frame length");
+  ok(natnet_fast_load(&msg, "missing.xml") != 0, "missing messages.xml is an error");
+  natnet_fast_load(&msg, "messages_natnet.xml");
+
+  // three aircraft in one datagram
+  natnet_fast_batch_reset(&batch);
+  for (int i = 0; i < 3; i++) {
+    struct NatNetFastPose pose = make_pose(i);
+    natnet_fast_batch_add(&batch, &msg, &pose);
+  }
+  cmp_ok(batch.len, "==", 3 * 42, "datagram length");
+  decode(&d, batch.buf, batch.len);
+  ok(d.nb == 3 && d.errors == 0, "3 frames decoded, %d checksum errors", d.errors);
+
+  int header_ok = 1, fields_ok = 1;
+  for (int i = 0; i < d.nb; i++) {
+    const uint8_t *p = d.payload[i];
+    struct NatNetFastPose pose = make_pose(i);
+    header_ok &= p[0] == 0 && p[1] == pose.ac_id && (p[2] & 0x0F) == DATALINK_CLASS_ID
+                 && p[3] == REMOTE_GPS_LOCAL_ID && d.len[i] == 38;
+    // DL_REMOTE_GPS_LOCAL_* offsets: ac_id 4, pad 5, enu_x 6 ... enu_zd 26, tow 30, course 34
+    fields_ok &= p[4] == pose.ac_id && p[5] == 0
+                 && get_float(p + 6) == pose.enu_pos[0] && get_float(p + 10) == pose.enu_pos[1]
+                 && get_float(p + 14) == pose.enu_pos[2] && get_float(p + 18) == pose.enu_vel[0]
+                 && get_float(p + 22) == pose.enu_vel[1] && get_float(p + 26) == pose.enu_vel[2]
+                 && get_uint32(p + 30) == pose.tow && get_float(p + 34) == pose.course;
+  }
+  ok(header_ok, "sender ground, receiver aircraft, class and message ids");
+  ok(fields_ok, "fields at the REMOTE_GPS_LOCAL offsets");
+
+  // a corrupted frame is dropped, the others are still decoded
+  batch.buf[42 + 10] ^= 0xFF;
+  decode(&d, batch.buf, batch.len);
+  ok(d.nb == 2 && d.errors == 1, "corrupted frame dropped, %d frames left", d.nb);
+  ok(d.payload[0][1] == 10 && d.payload[1][1] == 12, "neighbour frames intact");
+
+  // a full batch stays within one MTU
+  natnet_fast_batch_reset(&batch);
+  int nb = 0;
+  for (int i = 0; i < 100; i++) {
+    struct NatNetFastPose pose = make_pose(i);
+    if (natnet_fast_batch_add(&batch, &msg, &pose) != 0) {
+      break;
+    }
+    nb++;
+  }
+  cmp_ok(nb, "==", NATNET_FAST_MAX_PAYLOAD / 42, "frames in a full batch");
+  cmp_ok(batch.len, "<=", NATNET_FAST_MAX_PAYLOAD, "full batch within the MTU");
+  decode(&d, batch.buf, batch.len);
+  ok(d.nb == nb && d.errors == 0, "full batch decoded");
+  cmp_ok(batch.nb, "==", nb, "batch count");
+
+  done_testing();
+}
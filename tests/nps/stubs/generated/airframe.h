@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file generated/airframe.h
+ * Airframe of the nps_metrics test: two commands.
+ */
+
+#ifndef TEST_GENERATED_AIRFRAME_H
+#define TEST_GENERATED_AIRFRAME_H
+
+#define COMMANDS_NB 2
+
+#endif /* TEST_GENERATED_AIRFRAME_H */
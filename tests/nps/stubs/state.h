@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file state.h
+ * Origin of the local frame, the only part of the state used by nps_metrics.
+ */
+
+#ifndef TEST_STATE_H
+#define TEST_STATE_H
+
+#include "std.h"
+#include "math/pprz_geodetic_int.h"
+
+struct State {
+  bool ned_initialized_i;
+  struct LtpDef_i ned_origin_i;
+};
+
+extern struct State state;
+
+#endif /* TEST_STATE_H */
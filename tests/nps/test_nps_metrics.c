@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_nps_metrics.c
+ * @brief Tests of the metrics of the NPS batch runs.
+ *
+ * The FDM state, the navigation target and the autopilot flags are set by the
+ * test (see the headers in stubs/), built once for a rotorcraft and once with
+ * FIXEDWING_FIRMWARE.
+ *
+ * Using libtap to create a TAP (TestAnythingProtocol) producer:
+ * https://github.com/zorgnax/libtap
+ */
+
+#include "tap.h"
+#include "nps_metrics.h"
+#include "nps_fdm.h"
+#include "nps_autopilot.h"
+#include "state.h"
+#include "autopilot.h"
+#include "subsystems/electrical.h"
+#include "subsystems/navigation/common_flight_plan.h"
+#ifdef FIXEDWING_FIRMWARE
+#include "nav.h"
+#else
+#include "navigation.h"
+#endif
+
+#include <math.h>
+#include <string.h>
+
+#define SIM_DT (1. / 512.)
+
+struct NpsFdm fdm;
+struct NpsAutopilot nps_autopilot;
+struct State state;
+struct Electrical electrical;
+bool test_in_flight;
+uint8_t nav_block;
+#ifdef FIXEDWING_FIRMWARE
+float desired_x, desired_y;
+#else
+struct EnuCoor_i navigation_target;
+#endif
+
+static struct LtpDef_d ltp_def;
+static double sim_time;
+
+static void set_target(double x, double y)
+{
+#ifdef FIXEDWING_FIRMWARE
+  desired_x = x;
+  desired_y = y;
+#else
+  navigation_target.x = POS_BFP_OF_REAL(x);
+  navigation_target.y = POS_BFP_OF_REAL(y);
+#endif
+}
+
+static void set_position(double x, double y, double z)
+{
+  struct EnuCoor_d enu = { x, y, z };
+  ecef_of_enu_point_d(&fdm.ecef_pos, &ltp_def, &enu);
+}
+
+static void run(double duration)
+{
+  for (double end = sim_time + duration; sim_time < end - SIM_DT / 2.; sim_time += SIM_DT) {
+    nps_metrics_run_step(sim_time);
+  }
+}
+
+static void reset(void)
+{
+  memset(&fdm, 0, sizeof(fdm));
+  memset(&nps_autopilot, 0, sizeof(nps_autopilot));
+  fdm.on_ground = true;
+  set_position(0., 0., 0.);
+  set_target(0., 0.);
+  test_in_flight = false;
+  nav_block = 0;
+  sim_time = 0.;
+  nps_metrics_init(sim_time);
+}
+
+/** Metrics written by nps_metrics_write */
+static char *write_metrics(void)
+{
+  static char buf[1024];
+  FILE *f = tmpfile();
+  nps_metrics_write(f, sim_time);
+  rewind(f);
+  size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+  buf[n] = '\0';
+  fclose(f);
+  return buf;
+}
+
+int main(void)
+{
+  note("running nps metrics tests");
+  plan(17);
+
+  struct LlaCoor_d lla0 = { RadOfDeg(43.56), RadOfDeg(1.48), 180. };
+  ltp_def_from_lla_d(&ltp_def, &lla0);
+  state.ned_origin_i.ecef.x = (int32_t)(ltp_def.ecef.x * 100.);
+  state.ned_origin_i.ecef.y = (int32_t)(ltp_def.ecef.y * 100.);
+  state.ned_origin_i.ecef.z = (int32_t)(ltp_def.ecef.z * 100.);
+  electrical.energy = 1.25f;
+
+  // on ground then a flight 50 m away from the target
+  reset();
+  nps_autopilot.commands[0] = 0.5;
+  nps_autopilot.commands[1] = -1.;
+  run(1.);
+  cmp_ok(nps_metrics.nb_samples, "==", 0, "no tracking error on ground");
+  state.ned_initialized_i = true;
+  test_in_flight = true;
+  fdm.on_ground = false;
+  nav_block = 1;
+  set_position(130., 40., 50.);
+  set_target(100., 0.);
+  run(2.);
+  double mean = nps_metrics.tracking_error_sum / nps_metrics.nb_samples;
+  cmp_ok(nps_metrics.nb_samples, "==", 40, "tracking error sampled at 20Hz in flight");
+  ok(fabs(mean - 50.) < 0.01, "horizontal tracking error %.3f m", mean);
+  ok(fabs(nps_metrics.tracking_error_max - 50.) < 0.01, "max tracking error");
+  ok(fabs(nps_metrics.flight_time - 2.) < 1e-9, "flight time %.3f s", nps_metrics.flight_time);
+  ok(fabs(nps_metrics.effort - 0.75 * 3.) < 1e-9, "mean absolute command effort %.3f", nps_metrics.effort);
+  ok(!nps_metrics.crashed, "not crashed in flight");
+
+  // hard touchdown
+  fdm.ltp_ecef_vel.z = 5.;
+  run(0.05);
+  fdm.on_ground = true;
+  run(0.05);
+  ok(nps_metrics.crashed && nps_metrics.impact_speed == 5., "touchdown at 5 m/s is a crash");
+  ok(fabs(nps_metrics.crash_time - 3.05) < 2. * SIM_DT, "crash time %.3f s", nps_metrics.crash_time);
+
+  char *json = write_metrics();
+  ok(strstr(json, "\"crashed\": true, \"crash_time\": 3.05") != NULL &&
+     strstr(json, "\"impact_speed\": 5.00") != NULL, "crash in the report");
+  ok(strstr(json, "\"energy\": 1.2500") != NULL, "energy in the report");
+  ok(strstr(json, "\"blocks\": {\"Wait GPS\": 0.000, \"Takeoff\": 1.00") != NULL &&
+     strstr(json, "Circle") == NULL, "entered blocks in the report");
+  ok(json[0] == '{' && strchr(json, '\n') == json + strlen(json) - 1, "a single JSON line: %s", json);
+
+  // soft touchdown
+  reset();
+  fdm.on_ground = false;
+  fdm.ltp_ecef_vel.z = 1.;
+  run(0.05);
+  fdm.on_ground = true;
+  run(1.);
+  ok(!nps_metrics.crashed, "touchdown at 1 m/s is not a crash");
+  json = write_metrics();
+  ok(strstr(json, "\"crashed\": false, \"tracking_error_mean\": 0.000") != NULL, "no crash in the report");
+
+  // on the side
+  fdm.ltp_to_body_eulers.phi = RadOfDeg(70.);
+  run(0.05);
+  ok(nps_metrics.crashed, "bank of 70 deg on ground is a crash");
+
+  // diverged FDM
+  reset();
+  fdm.nan_count = 1;
+  run(0.05);
+  ok(nps_metrics.crashed && nps_metrics.impact_speed == -1., "diverged FDM is a crash");
+
+  done_testing();
+}
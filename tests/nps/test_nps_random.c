@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_nps_random.c
+ * @brief Tests of the counter based noise of the NPS sensors.
+ *
+ * Philox4x32-10 is checked against the known answer vectors of Random123
+ * (kat_vectors), the batched draws against the per stream ones, and the
+ * time of the noise of one simulation step (gyro, accel, mag and baro) is
+ * printed for both.
+ *
+ * Using libtap to create a TAP (TestAnythingProtocol) producer:
+ * https://github.com/zorgnax/libtap
+ */
+
+#include "tap.h"
+#include "nps_random.h"
+
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+/** numbers drawn per step: gyro, accel, mag (3 each) and baro (1) */
+static const uint16_t step_nb[] = { 3, 3, 3, 1 };
+#define NB_SENSORS 4
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void init_streams(struct NpsRandomStream *s)
+{
+  for (int i = 0; i < NB_SENSORS; i++) {
+    nps_random_stream_init(&s[i], NPS_RANDOM_STREAM_GYRO + i);
+  }
+}
+
+int main(void)
+{
+  note("running nps random tests");
+  plan(9);
+
+  // Random123 kat_vectors, philox4x32 10 rounds
+  static const struct {
+    uint32_t ctr[4], key[2], out[4];
+  } kat[] = {
+    { { 0, 0, 0, 0 }, { 0, 0 }, { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 } },
+    {
+      { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, { 0xffffffff, 0xffffffff },
+      { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd }
+    },
+    {
+      { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 },
+      { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 }
+    },
+  };
+  for (int i = 0; i < 3; i++) {
+    uint32_t out[4];
+    nps_random_philox(out, kat[i].ctr, kat[i].key);
+    ok(memcmp(out, kat[i].out, sizeof(out)) == 0, "Philox4x32-10 known answer %d", i);
+  }
+
+  // batched draws of several streams match the per stream ones
+  struct NpsRandomStream s[NB_SENSORS], ref[NB_SENSORS];
+  static struct NpsRandomBatch batch;
+  init_streams(s);
+  init_streams(ref);
+  int batch_ok = 1, full_ok = 1;
+  for (int step = 0; step < 1000; step++) {
+    double *noise[NB_SENSORS];
+    nps_random_batch_reset(&batch);
+    for (int i = 0; i < NB_SENSORS; i++) {
+      noise[i] = nps_random_batch_add(&batch, &s[i], step_nb[i]);
+      full_ok &= noise[i] != NULL;
+    }
+    nps_random_batch_run(&batch);
+    for (int i = 0; i < NB_SENSORS && full_ok; i++) {
+      double expected[4];
+      nps_random_gaussian(&ref[i], expected, step_nb[i]);
+      batch_ok &= memcmp(noise[i], expected, step_nb[i] * sizeof(double)) == 0;
+    }
+  }
+  ok(full_ok, "batch has room for one step");
+  ok(batch_ok, "batched draws equal to the per stream draws");
+
+  // a stream doesn't depend on the draws of the others
+  init_streams(s);
+  init_streams(ref);
+  double a[8], b[8];
+  nps_random_gaussian(&s[0], a, 8);
+  nps_random_gaussian(&ref[1], b, 8);
+  nps_random_gaussian(&ref[0], b, 8);
+  ok(memcmp(a, b, sizeof(a)) == 0, "streams are independent");
+
+  // a full batch is refused
+  nps_random_batch_reset(&batch);
+  ok(nps_random_batch_add(&batch, &s[0], 4 * NPS_RANDOM_BATCH_MAX_BLOCKS) != NULL &&
+     nps_random_batch_add(&batch, &s[0], 1) == NULL, "full batch refused");
+
+  // moments of the standard gaussian
+  double sum = 0., sum2 = 0.;
+  const int n = 1000000;
+  nps_random_stream_init(&s[0], NPS_RANDOM_STREAM_DEFAULT);
+  for (int i = 0; i < n; i++) {
+    double g = nps_random_gaussian_1(&s[0]);
+    sum += g;
+    sum2 += g * g;
+  }
+  ok(fabs(sum / n) < 5e-3, "mean %f", sum / n);
+  ok(fabs(sum2 / n - 1.) < 5e-3, "variance %f", sum2 / n);
+
+  // time of the noise of one step
+  const int nb_steps = 200000;
+  double t0 = now();
+  volatile double sink = 0.;
+  for (int step = 0; step < nb_steps; step++) {
+    double *noise[NB_SENSORS];
+    nps_random_batch_reset(&batch);
+    for (int i = 0; i < NB_SENSORS; i++) {
+      noise[i] = nps_random_batch_add(&batch, &s[i], step_nb[i]);
+    }
+    nps_random_batch_run(&batch);
+    sink += noise[0][0];
+  }
+  double t_batch = (now() - t0) / nb_steps;
+  t0 = now();
+  for (int step = 0; step < nb_steps; step++) {
+    double noise[4];
+    for (int i = 0; i < NB_SENSORS; i++) {
+      nps_random_gaussian(&s[i], noise, step_nb[i]);
+    }
+    sink += noise[0];
+  }
+  double t_stream = (now() - t0) / nb_steps;
+  t0 = now();
+  for (int step = 0; step < nb_steps; step++) {
+    for (int i = 0; i < 10; i++) {
+      sink += get_gaussian_noise();
+    }
+  }
+  double t_single = (now() - t0) / nb_steps;
+  note("noise of one step: batch %.0f ns, per stream %.0f ns, 10 single draws %.0f ns",
+       t_batch * 1e9, t_stream * 1e9, t_single * 1e9);
+
+  done_testing();
+}
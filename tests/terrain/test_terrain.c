@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_terrain.c
+ * @brief Round trip of a tile through srtm2terrain.py and the terrain module.
+ *
+ * A synthetic SRTM tile is converted by sw/tools/terrain/srtm2terrain.py
+ * (pack_block), then all its samples are read back with terrain_get_height
+ * (block_decompress): blocks of 0, 1, 16 and about 12 bits per height, and
+ * the padded last row and column of blocks.
+ *
+ * Using libtap to create a TAP (TestAnythingProtocol) producer:
+ * https://github.com/zorgnax/libtap
+ */
+
+#include "tap.h"
+#include "modules/terrain/terrain.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define SAMPLES 1201
+#define BLOCK TERRAIN_BLOCK_SIZE
+
+static int16_t heights[SAMPLES][SAMPLES];
+
+/** Height of a sample, rows from the north edge */
+static int16_t sample(int iy, int ix)
+{
+  const int by = iy / BLOCK, bx = ix / BLOCK;
+  if (by == 0 && bx == 0) {
+    return 100;                                   // flat, 0 bit
+  } else if (by == 0 && bx == 1) {
+    return 50 + ((iy * 31 + ix * 17) & 1);        // 1 bit
+  } else if (by == 1 && bx == 1) {
+    return ((iy * 7919 + ix * 104729) % 64001) - 32000; // 16 bits
+  }
+  return ((iy * 7 + ix * 13) % 3000) - 200;
+}
+
+static bool write_hgt(const char *path)
+{
+  FILE *f = fopen(path, "wb");
+  if (f == NULL) {
+    return false;
+  }
+  for (int iy = 0; iy < SAMPLES; iy++) {
+    for (int ix = 0; ix < SAMPLES; ix++) {
+      heights[iy][ix] = sample(iy, ix);
+      // big endian
+      const uint8_t b[2] = { (uint16_t)heights[iy][ix] >> 8, (uint16_t)heights[iy][ix] & 0xFF };
+      fwrite(b, 1, 2, f);
+    }
+  }
+  return fclose(f) == 0;
+}
+
+/** Max difference with the samples in a range of rows and columns */
+static float max_error(int y0, int y1, int x0, int x1)
+{
+  float err = 0.f;
+  for (int iy = y0; iy < y1; iy++) {
+    for (int ix = x0; ix < x1; ix++) {
+      float h;
+      // the north and east edges are in the next tiles, query just inside
+      const double lat = fmin(44. - iy / (SAMPLES - 1.), 44. - 1e-9);
+      const double lon = fmin(1. + ix / (SAMPLES - 1.), 2. - 1e-9);
+      if (!terrain_get_height(&h, lat, lon)) {
+        return INFINITY;
+      }
+      err = fmaxf(err, fabsf(h - heights[iy][ix]));
+    }
+  }
+  return err;
+}
+
+int main(void)
+{
+  note("running terrain tests");
+  plan(10);
+
+  unlink("N43E001.ter");
+  ok(write_hgt("N43E001.hgt"), "synthetic SRTM tile written");
+  ok(system(PYTHON " " SRTM2TERRAIN " -o . N43E001.hgt > /dev/null") == 0, "tile converted by srtm2terrain.py");
+
+  terrain_init();
+  float h;
+  ok(!terrain_get_height(&h, 43.5, 1.5), "no height before the tile is opened");
+  int waits = 0;
+  while (!terrain_get_height(&h, 43.5, 1.5) && waits < 2000) {
+    usleep(1000);
+    waits++;
+  }
+  ok(waits < 2000 && terrain.nb_tiles == 1, "tile opened by the prefetch thread after %d ms", waits);
+
+  // interpolation at the samples gives back the heights
+  float err = max_error(0, BLOCK + 1, 0, BLOCK + 1);
+  ok(err < 1e-3f, "flat block, error %g m", err);
+  err = max_error(0, BLOCK + 1, BLOCK, 2 * BLOCK + 1);
+  ok(err < 1e-3f, "1 bit block, error %g m", err);
+  err = max_error(BLOCK, 2 * BLOCK + 1, BLOCK, 2 * BLOCK + 1);
+  ok(err < 1e-2f, "16 bits block, error %g m", err);
+  err = max_error(0, SAMPLES, 0, SAMPLES);
+  ok(err < 1e-2f, "all the samples, with the padded last blocks, error %g m", err);
+  ok(terrain.nb_misses > 0, "%u blocks decompressed", terrain.nb_misses);
+
+  // the missing tile is only looked for once
+  bool found = terrain_get_height(&h, 45.5, 1.5);
+  for (waits = 0; terrain.nb_tiles == 1 && waits < 2000; waits++) {
+    usleep(1000);
+  }
+  found |= terrain_get_height(&h, 45.5, 1.5);
+  ok(!found && terrain.nb_tiles == 2, "no height without a tile");
+
+  unlink("N43E001.hgt");
+  done_testing();
+}
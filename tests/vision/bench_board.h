@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file bench_board.h
+ * Board configuration of the vision benchmark, the cameras are defined in bench_cv.c
+ */
+
+#ifndef BENCH_BOARD_H
+#define BENCH_BOARD_H
+
+#include "peripherals/video_device.h"
+
+extern struct video_config_t front_camera;
+extern struct video_config_t bottom_camera;
+
+#endif /* BENCH_BOARD_H */
@@ -0,0 +1,540 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file bench_cv.c
+ * @brief Latency of the computer vision primitives and pipelines.
+ *
+ * Each stage is run over a fixed sequence of UYVY frames at several
+ * resolutions. The reference sequence is generated from a fixed texture,
+ * seen by a camera translating and moving forward, with an orange gate in
+ * front of it, so it is identical on every host and every build. Recorded
+ * sequences (raw frames of video_usb_logger) can be used instead.
+ *
+ * For each stage, the first call is a warm-up and the following ones are
+ * timed one by one. The report gives the latency distribution, the
+ * throughput and the number of heap allocations per frame, counted by
+ * wrapping malloc at link time.
+ *
+ * Usage: bench_cv.bench [-n frames] [-r WxH] [-d dir] [-o results.csv]
+ *  -n  number of frames per sequence (default 60)
+ *  -r  only run this resolution (default 160x120, 320x240 and 640x480)
+ *  -d  read the frames img_00000.yuv, img_00001.yuv... from dir, -r is required
+ *  -o  also write the results as csv, for comparison between builds
+ */
+
+#include "std.h"
+#include "lib/vision/image.h"
+#include "lib/vision/fast_rosten.h"
+#include "lib/vision/act_fast.h"
+#include "lib/vision/lucas_kanade.h"
+#include "lib/vision/color_segmentation.h"
+#include "lib/encoding/jpeg.h"
+#include "snake_gate_detection.h"
+#include "opticflow/opticflow_calculator.h"
+#include BOARD_CONFIG
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef BENCH_GIT_REV
+#define BENCH_GIT_REV "unknown"
+#endif
+
+#if defined(__aarch64__)
+#define BENCH_ARCH "aarch64"
+#elif defined(__arm__)
+#define BENCH_ARCH "arm"
+#elif defined(__x86_64__)
+#define BENCH_ARCH "x86_64"
+#else
+#define BENCH_ARCH "unknown"
+#endif
+
+#define BENCH_DEFAULT_FRAMES 60
+
+/* Orange of the gate, and thresholds of the color stages */
+#define GATE_Y 130
+#define GATE_U 70
+#define GATE_V 190
+#define GATE_Ym 80
+#define GATE_YM 180
+#define GATE_Um 40
+#define GATE_UM 100
+#define GATE_Vm 160
+#define GATE_VM 230
+#define BRIGHT_Ym 180
+
+/* Cameras referenced by the opticflow calculator */
+struct video_config_t front_camera = {
+  .dev_name = "/dev/video1",
+  .camera_intrinsics = { .focal_x = 350.f, .focal_y = 350.f, .center_x = 160.f, .center_y = 120.f, .Dhane_k = 1.f },
+};
+struct video_config_t bottom_camera = {
+  .dev_name = "/dev/video0",
+  .camera_intrinsics = { .focal_x = 350.f, .focal_y = 350.f, .center_x = 160.f, .center_y = 120.f, .Dhane_k = 1.f },
+};
+float agl_dist_value_filtered = 1.f;
+
+/*
+ * Allocation counting, the benchmarked code is linked with
+ * -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc
+ */
+extern void *__real_malloc(size_t size);
+extern void *__real_calloc(size_t nmemb, size_t size);
+extern void *__real_realloc(void *ptr, size_t size);
+
+static bool count_allocs = false;
+static uint32_t nb_allocs = 0;
+static size_t alloc_bytes = 0;
+
+void *__wrap_malloc(size_t size)
+{
+  if (count_allocs) {
+    nb_allocs++;
+    alloc_bytes += size;
+  }
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+  if (count_allocs) {
+    nb_allocs++;
+    alloc_bytes += nmemb * size;
+  }
+  return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+  if (count_allocs) {
+    nb_allocs++;
+    alloc_bytes += size;
+  }
+  return __real_realloc(ptr, size);
+}
+
+/* Timing of the measured part of a stage */
+static uint64_t t_start;
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void tic(void)
+{
+  count_allocs = true;
+  t_start = now_ns();
+}
+
+static uint64_t toc(void)
+{
+  uint64_t t = now_ns() - t_start;
+  count_allocs = false;
+  return t;
+}
+
+/*
+ * Reference sequence
+ */
+
+/** Integer hash for the texture */
+static uint32_t hash2(int32_t x, int32_t y)
+{
+  uint32_t h = (uint32_t)x * 374761393u + (uint32_t)y * 668265263u;
+  h = (h ^ (h >> 13)) * 1274126177u;
+  return h ^ (h >> 16);
+}
+
+/** Blocks at two scales, in world units (one unit is a pixel at 640x480) */
+static float texture(float u, float v)
+{
+  uint32_t a = hash2((int32_t)floorf(u / 16.f), (int32_t)floorf(v / 16.f));
+  uint32_t b = hash2((int32_t)floorf(u / 5.f) + 7919, (int32_t)floorf(v / 5.f));
+  return 0.65f * (a & 0xFF) + 0.35f * (b & 0xFF);
+}
+
+/** Render frame f of the reference sequence in a UYVY image */
+static void render_frame(struct image_t *img, int f)
+{
+  const float k = 640.f / img->w;
+  const float s = 1.f + 0.003f * (f % 100);   // forward motion
+  const float ox = 1.5f * f, oy = 0.6f * f;   // translation
+  uint8_t *buf = img->buf;
+
+  for (uint16_t y = 0; y < img->h; y++) {
+    for (uint16_t x = 0; x < img->w; x++) {
+      // 2x2 supersampling of the texture
+      float t = 0.f;
+      for (int j = 0; j < 2; j++) {
+        for (int i = 0; i < 2; i++) {
+          float px = ((x + 0.25f + 0.5f * i) * k - 320.f) / s;
+          float py = ((y + 0.25f + 0.5f * j) * k - 240.f) / s;
+          t += texture(px + ox, py + oy);
+        }
+      }
+      uint8_t Y = (uint8_t)(t / 4.f);
+      uint8_t U = 128 + (hash2(x / 8, y / 8) & 0xF) - 8;
+      uint8_t V = 128 + ((hash2(x / 8, y / 8) >> 4) & 0xF) - 8;
+
+      // square gate, centered and growing with the forward motion
+      float gx = fabsf((x + 0.5f) * k - 340.f) / s;
+      float gy = fabsf((y + 0.5f) * k - 240.f) / s;
+      float g = Max(gx, gy);
+      if (g > 100.f && g < 112.f) {
+        Y = GATE_Y;
+        U = GATE_U;
+        V = GATE_V;
+      }
+
+      buf[2 * x + 1] = Y;
+      buf[2 * x] = (x % 2 == 0) ? U : V;
+    }
+    buf += 2 * img->w;
+  }
+}
+
+/** Load frame f of a recorded sequence */
+static bool load_frame(struct image_t *img, const char *dir, int f)
+{
+  char path[512];
+  snprintf(path, sizeof(path), "%s/img_%05d.yuv", dir, f);
+  FILE *fp = fopen(path, "rb");
+  if (fp == NULL) {
+    return false;
+  }
+  size_t n = fread(img->buf, 1, img->buf_size, fp);
+  fclose(fp);
+  return n == img->buf_size;
+}
+
+/*
+ * Stages
+ */
+
+/** Frames and working memory at one resolution */
+struct bench_ctx {
+  uint16_t w, h;
+  int nb;                       ///< number of frames
+  struct image_t *frames;       ///< UYVY frames
+  struct image_t *gray;         ///< grayscale frames
+  struct image_t out;           ///< UYVY output
+  struct image_t out_gray;      ///< grayscale output
+  struct image_t jpeg;          ///< jpeg output
+  struct point_t *corners;
+  uint16_t corners_size;
+  struct color_seg_lut lut;
+  struct color_seg seg;
+  struct color_seg_run *runs;
+  struct color_seg_blob blobs[256];
+  struct opticflow_t *of;
+  struct opticflow_result_t of_result;
+};
+
+static struct bench_ctx ctx;
+static struct opticflow_t opticflow[1];
+
+static uint64_t stage_grayscale(int i)
+{
+  tic();
+  image_to_grayscale(&ctx.frames[i], &ctx.out_gray);
+  return toc();
+}
+
+static uint64_t stage_colorfilt(int i)
+{
+  tic();
+  image_yuv422_colorfilt(&ctx.frames[i], &ctx.out, GATE_Ym, GATE_YM, GATE_Um, GATE_UM, GATE_Vm, GATE_VM);
+  return toc();
+}
+
+static uint64_t stage_fast9(int i)
+{
+  uint16_t nb_corners = 0;
+  tic();
+  fast9_detect(&ctx.gray[i], 20, 10, 20, 20, &nb_corners, &ctx.corners_size, &ctx.corners, NULL);
+  return toc();
+}
+
+static uint64_t stage_act_fast(int i)
+{
+  uint16_t nb_corners = 0;
+  tic();
+  act_fast(&ctx.gray[i], 20, &nb_corners, &ctx.corners, 25, 10, 10.f, 2.f, 10, 1, 0);
+  return toc();
+}
+
+static uint64_t stage_lucas_kanade(int i)
+{
+  struct image_t *prev = &ctx.gray[(i + ctx.nb - 1) % ctx.nb];
+  uint16_t nb_corners = 0;
+  fast9_detect(prev, 20, 10, 20, 20, &nb_corners, &ctx.corners_size, &ctx.corners, NULL);
+  nb_corners = Min(nb_corners, 100);
+
+  tic();
+  struct flow_t *vectors = opticFlowLK(&ctx.gray[i], prev, ctx.corners, &nb_corners, 10, 10, 10, 2, 100, 2, 0);
+  uint64_t t = toc();
+  free(vectors);
+  return t;
+}
+
+static uint64_t stage_jpeg(int i)
+{
+  tic();
+  jpeg_encode_image(&ctx.frames[i], &ctx.jpeg, 85, true);
+  return toc();
+}
+
+static uint64_t stage_snake_gate(int i)
+{
+  static struct gate_img gates[MAX_GATES];
+  struct gate_img best_gate;
+  int nb_gates;
+  tic();
+  snake_gate_detection(&ctx.frames[i], 2000, 30, 0.15f, 0.f, 3, GATE_Ym, GATE_YM, GATE_Um, GATE_UM, GATE_Vm, GATE_VM,
+                       &best_gate, gates, &nb_gates, 0, 0);
+  return toc();
+}
+
+static uint64_t stage_color_seg(int i)
+{
+  tic();
+  color_seg_process(&ctx.seg, &ctx.lut, &ctx.frames[i], 20);
+  return toc();
+}
+
+static uint64_t stage_opticflow(int i)
+{
+  if (i == 0) {
+    // switch the method away and back, as from the settings, so that the
+    // image buffers are created at this resolution
+    ctx.of->method = 2;
+    opticflow_calc_frame(ctx.of, &ctx.frames[i], &ctx.of_result);
+    ctx.of->method = 0;
+  }
+  tic();
+  opticflow_calc_frame(ctx.of, &ctx.frames[i], &ctx.of_result);
+  return toc();
+}
+
+struct bench_stage {
+  const char *name;
+  uint64_t (*run)(int i);
+};
+
+static const struct bench_stage stages[] = {
+  { "image_to_grayscale", stage_grayscale },
+  { "image_yuv422_colorfilt", stage_colorfilt },
+  { "fast9_detect", stage_fast9 },
+  { "act_fast", stage_act_fast },
+  { "opticFlowLK", stage_lucas_kanade },
+  { "jpeg_encode_image", stage_jpeg },
+  { "snake_gate_detection", stage_snake_gate },
+  { "color_seg_process", stage_color_seg },
+  { "opticflow_calc_frame", stage_opticflow },
+};
+
+#define NB_STAGES (sizeof(stages) / sizeof(stages[0]))
+
+/*
+ * Sequence setup and report
+ */
+
+static bool ctx_init(uint16_t w, uint16_t h, int nb, const char *dir)
+{
+  ctx.w = w;
+  ctx.h = h;
+  ctx.nb = nb;
+  ctx.frames = calloc(nb, sizeof(struct image_t));
+  ctx.gray = calloc(nb, sizeof(struct image_t));
+  for (int i = 0; i < nb; i++) {
+    image_create(&ctx.frames[i], w, h, IMAGE_YUV422);
+    image_create(&ctx.gray[i], w, h, IMAGE_GRAYSCALE);
+    if (dir != NULL) {
+      if (!load_frame(&ctx.frames[i], dir, i)) {
+        fprintf(stderr, "could not read frame %d of %dx%d from %s\n", i, w, h, dir);
+        return false;
+      }
+    } else {
+      render_frame(&ctx.frames[i], i);
+    }
+    // 30 fps
+    ctx.frames[i].ts.tv_sec = i / 30;
+    ctx.frames[i].ts.tv_usec = (i % 30) * 33333;
+    ctx.frames[i].pprz_ts = i * 33333;
+    image_to_grayscale(&ctx.frames[i], &ctx.gray[i]);
+  }
+  image_create(&ctx.out, w, h, IMAGE_YUV422);
+  image_create(&ctx.out_gray, w, h, IMAGE_GRAYSCALE);
+  image_create(&ctx.jpeg, w, h, IMAGE_JPEG);
+  ctx.corners_size = FAST9_MAX_CORNERS;
+  ctx.corners = calloc(ctx.corners_size, sizeof(struct point_t));
+
+  color_seg_lut_init(&ctx.lut);
+  color_seg_lut_set_class(&ctx.lut, 0, GATE_Ym, GATE_YM, GATE_Um, GATE_UM, GATE_Vm, GATE_VM);
+  color_seg_lut_set_class(&ctx.lut, 1, BRIGHT_Ym, 255, 0, 255, 0, 255);
+  uint32_t max_runs = (uint32_t)w * h / 4;
+  ctx.runs = calloc(max_runs, sizeof(struct color_seg_run));
+  color_seg_init(&ctx.seg, ctx.runs, max_runs, ctx.blobs, 256);
+
+  ctx.of = &opticflow[0];
+  return true;
+}
+
+static void ctx_free(void)
+{
+  for (int i = 0; i < ctx.nb; i++) {
+    image_free(&ctx.frames[i]);
+    image_free(&ctx.gray[i]);
+  }
+  free(ctx.frames);
+  free(ctx.gray);
+  image_free(&ctx.out);
+  image_free(&ctx.out_gray);
+  image_free(&ctx.jpeg);
+  free(ctx.corners);
+  free(ctx.runs);
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static void run_stage(const struct bench_stage *stage, uint64_t *samples, FILE *csv)
+{
+  // warm-up
+  stage->run(0);
+
+  nb_allocs = 0;
+  alloc_bytes = 0;
+  const int n = ctx.nb - 1;
+  uint64_t sum = 0;
+  for (int i = 0; i < n; i++) {
+    samples[i] = stage->run(i + 1);
+    sum += samples[i];
+  }
+  qsort(samples, n, sizeof(uint64_t), cmp_u64);
+
+  const double mean = sum / (double)n / 1000.;
+  const double p50 = samples[(n - 1) * 50 / 100] / 1000.;
+  const double p95 = samples[(n - 1) * 95 / 100] / 1000.;
+  const double max = samples[n - 1] / 1000.;
+  const double fps = 1e6 / mean;
+  const double allocs = nb_allocs / (double)n;
+  const double bytes = alloc_bytes / (double)n;
+
+  printf("%-24s %10.1f %10.1f %10.1f %10.1f %9.1f %8.1f %10.0f\n", stage->name, mean, p50, p95, max, fps, allocs, bytes);
+  if (csv != NULL) {
+    fprintf(csv, "%s,%s,\"%s\",%d,%d,%s,%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.0f\n", BENCH_GIT_REV, BENCH_ARCH, __VERSION__,
+            ctx.w, ctx.h, stage->name, n, mean, p50, p95, max, fps, allocs, bytes);
+  }
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr, "usage: %s [-n frames] [-r WxH] [-d dir] [-o results.csv]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+  struct img_size_t sizes[3] = { { 160, 120 }, { 320, 240 }, { 640, 480 } };
+  int nb_sizes = 3;
+  int nb_frames = BENCH_DEFAULT_FRAMES;
+  const char *dir = NULL;
+  const char *csv_path = NULL;
+  int opt;
+  unsigned int w, h;
+
+  while ((opt = getopt(argc, argv, "n:r:d:o:h")) != -1) {
+    switch (opt) {
+      case 'n':
+        nb_frames = atoi(optarg);
+        break;
+      case 'r':
+        if (sscanf(optarg, "%ux%u", &w, &h) != 2 || w < 64 || h < 64 || w % 2 != 0) {
+          fprintf(stderr, "invalid resolution %s\n", optarg);
+          return 1;
+        }
+        sizes[0].w = w;
+        sizes[0].h = h;
+        nb_sizes = 1;
+        break;
+      case 'd':
+        dir = optarg;
+        break;
+      case 'o':
+        csv_path = optarg;
+        break;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+  if (nb_frames < 2 || (dir != NULL && nb_sizes != 1)) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  FILE *csv = NULL;
+  if (csv_path != NULL) {
+    csv = fopen(csv_path, "w");
+    if (csv == NULL) {
+      perror(csv_path);
+      return 1;
+    }
+    fprintf(csv, "rev,arch,compiler,width,height,stage,frames,mean_us,p50_us,p95_us,max_us,fps,allocs_per_frame,"
+            "bytes_per_frame\n");
+  }
+
+  printf("rev %s, %s, %s, %d frames from %s\n", BENCH_GIT_REV, BENCH_ARCH, __VERSION__, nb_frames,
+         dir != NULL ? dir : "the reference sequence");
+
+  opticflow_calc_init(opticflow);
+  uint64_t *samples = calloc(nb_frames, sizeof(uint64_t));
+
+  for (int s = 0; s < nb_sizes; s++) {
+    if (!ctx_init(sizes[s].w, sizes[s].h, nb_frames, dir)) {
+      return 1;
+    }
+    printf("\n%dx%d\n", sizes[s].w, sizes[s].h);
+    printf("%-24s %10s %10s %10s %10s %9s %8s %10s\n", "stage", "mean [us]", "p50 [us]", "p95 [us]", "max [us]",
+           "fps", "allocs", "bytes");
+    for (uint16_t i = 0; i < NB_STAGES; i++) {
+      run_stage(&stages[i], samples, csv);
+    }
+    ctx_free();
+  }
+
+  free(samples);
+  if (csv != NULL) {
+    fclose(csv);
+  }
+  return 0;
+}